@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <regex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "models/uuid.hpp"
+#include "server/db/account_search_index.hpp"
+
+namespace {
+
+/**
+ * The search UserTable::get_uuids_matching_regex used to run: every username is matched
+ * against the regex while the table's lock is held.
+ */
+class FullScanDirectory {
+   public:
+    void add(const std::string& username, UUID uid) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->accounts.emplace_back(username, uid);
+    }
+
+    size_t search(const std::string& regex) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        std::regex re(regex);
+        size_t found = 0;
+        for (const auto& [username, uid] : this->accounts) {
+            if (std::regex_match(username, re) && ++found == 255) {
+                break;
+            }
+        }
+        return found;
+    }
+
+   private:
+    std::vector<std::pair<std::string, UUID>> accounts;
+    std::mutex mutex;
+};
+
+class IndexedDirectory {
+   public:
+    void add(const std::string& username, UUID uid) {
+        this->index.add(username, uid);
+    }
+
+    size_t search(const std::string& regex) {
+        return std::get<AccountSearchIndex::Page>(this->index.search(regex, 255)).uids.size();
+    }
+
+   private:
+    AccountSearchIndex index;
+};
+
+/**
+ * Random lowercase usernames of 6 to 12 letters.
+ */
+std::vector<std::string> make_usernames(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> length(6, 12);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> usernames;
+    usernames.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        std::string username;
+        for (int j = length(rng); j > 0; j--) {
+            username.push_back(static_cast<char>(letter(rng)));
+        }
+        usernames.push_back(username + std::to_string(i));
+    }
+    return usernames;
+}
+
+template <typename Directory>
+Directory& populated_directory() {
+    static Directory directory;
+    static std::once_flag populated;
+    std::call_once(populated, []() {
+        for (const std::string& username : make_usernames(1000000, 1)) {
+            directory.add(username, UUID());
+        }
+    });
+    return directory;
+}
+
+}  // namespace
+
+/**
+ * Answers one ListAccounts page against a million accounts.
+ */
+template <typename Directory>
+static void BM_AccountSearch(benchmark::State& state, std::string regex) {
+    Directory& directory = populated_directory<Directory>();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(directory.search(regex));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Registers accounts while another thread keeps searching with a pattern that has no literal
+ * to narrow it, so every search visits every account.
+ */
+template <typename Directory>
+static void BM_RegisterDuringSearch(benchmark::State& state) {
+    Directory directory;
+    for (const std::string& username : make_usernames(100000, 2)) {
+        directory.add(username, UUID());
+    }
+    std::vector<std::string> usernames = make_usernames(1000000, 3);
+
+    std::atomic<bool> done = false;
+    std::thread searcher([&]() {
+        while (!done) {
+            benchmark::DoNotOptimize(directory.search("(zz|yy)[a-z]*"));
+        }
+    });
+
+    size_t i = 0;
+    for (auto _ : state) {
+        directory.add(usernames[i++ % usernames.size()], UUID());
+    }
+    done = true;
+    searcher.join();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_RegisterDuringSearch, FullScanDirectory)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RegisterDuringSearch, IndexedDirectory)->UseRealTime();
+
+template <typename Directory>
+static void register_search_benchmarks(const std::string& directory_name) {
+    const std::pair<const char*, const char*> queries[] = {
+        {"Prefix", "kal.*"},
+        {"Substring", ".*mor.*"},
+        {"Regex", "ka[a-z]*mor.*"},
+        {"Alternation", "(zz|yy)[a-z]*"},
+    };
+    for (const auto& [query_name, regex] : queries) {
+        benchmark::RegisterBenchmark(
+            ("BM_AccountSearch<" + directory_name + ">/" + query_name).c_str(),
+            BM_AccountSearch<Directory>, std::string(regex))
+            ->Unit(benchmark::kMicrosecond);
+    }
+}
+
+static const bool registered = [] {
+    register_search_benchmarks<FullScanDirectory>("FullScanDirectory");
+    register_search_benchmarks<IndexedDirectory>("IndexedDirectory");
+    return true;
+}();
@@ -0,0 +1,29 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "alloc_counter.hpp"
+
+namespace {
+std::atomic<size_t> allocations = 0;
+}
+
+size_t allocation_count() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * @brief Gets the number of heap allocations made by the process so far.
+ *
+ * Every benchmark binary counts calls to the global operator new; take the difference of two
+ * readings around a measured region to get its allocation count.
+ *
+ * @return The number of allocations since startup.
+ */
+size_t allocation_count();
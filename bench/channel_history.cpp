@@ -0,0 +1,105 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "message/fetch_history.hpp"
+#include "message/fetch_history_response.hpp"
+#include "models/channel.hpp"
+#include "models/user.hpp"
+#include "server/db/database.hpp"
+
+namespace {
+
+/**
+ * A database holding one channel with the given number of messages.
+ */
+struct History {
+    Database db;
+    UUID channel_uid;
+
+    explicit History(size_t num_messages) {
+        User::SharedPtr user = std::make_shared<User>("historian", "Historian");
+        this->db.add_user(user, "password");
+        auto channel = this->db.add_channel("history", {user->get_uid()});
+        this->channel_uid = std::get<Channel::SharedPtr>(channel)->get_uid();
+        std::string text(40, 'x');
+        for (size_t i = 0; i < num_messages; i++) {
+            this->db.add_message(user->get_uid(), this->channel_uid, text);
+        }
+    }
+};
+
+History& history(size_t num_messages) {
+    static std::unique_ptr<History> cached;
+    static size_t cached_size = 0;
+    if (!cached || cached_size != num_messages) {
+        cached.reset();
+        cached = std::make_unique<History>(num_messages);
+        cached_size = num_messages;
+    }
+    return *cached;
+}
+
+}  // namespace
+
+/**
+ * Reads the newest page of a channel by copying its whole message list and keeping the tail,
+ * the only way to read it before the history was indexed.
+ */
+static void BM_NewestPageFromFullCopy(benchmark::State& state) {
+    History& data = history(state.range(0));
+    Channel::SharedPtr channel = data.db.get_channel_by_uid(data.channel_uid).value();
+    for (auto _ : state) {
+        std::vector<uint64_t> snowflakes = channel->get_message_snowflakes();
+        size_t start = snowflakes.size() - std::min<size_t>(snowflakes.size(),
+                                                            FetchHistoryMessage::DEFAULT_LIMIT);
+        HistoryPage page;
+        page.channel_uid = data.channel_uid;
+        for (size_t i = start; i < snowflakes.size(); i++) {
+            page.messages.push_back(data.db.get_message_by_uid(snowflakes[i]).value());
+        }
+        benchmark::DoNotOptimize(page);
+    }
+}
+BENCHMARK(BM_NewestPageFromFullCopy)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Reads the newest page of a channel through the snowflake-ordered index, and encodes the
+ * response the way on_fetch_history does.
+ */
+static void BM_FetchNewestPage(benchmark::State& state) {
+    History& data = history(state.range(0));
+    std::vector<uint8_t> buf;
+    for (auto _ : state) {
+        auto res = data.db.get_channel_history(data.channel_uid, 0, 0,
+                                               FetchHistoryMessage::DEFAULT_LIMIT);
+        Database::ChannelHistory& found = std::get<Database::ChannelHistory>(res);
+        HistoryPage page{data.channel_uid, std::move(found.messages), found.has_more};
+        buf.clear();
+        FetchHistoryResponse(std::move(page)).serialize_msg(buf);
+        benchmark::DoNotOptimize(buf.data());
+    }
+}
+BENCHMARK(BM_FetchNewestPage)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Reads a page from the middle of the channel, as scrolling back does.
+ */
+static void BM_FetchOlderPage(benchmark::State& state) {
+    History& data = history(state.range(0));
+    Channel::SharedPtr channel = data.db.get_channel_by_uid(data.channel_uid).value();
+    uint64_t before = channel->get_message_snowflakes()[state.range(0) / 2];
+    std::vector<uint8_t> buf;
+    for (auto _ : state) {
+        auto res = data.db.get_channel_history(data.channel_uid, before, 0,
+                                               FetchHistoryMessage::DEFAULT_LIMIT);
+        Database::ChannelHistory& found = std::get<Database::ChannelHistory>(res);
+        HistoryPage page{data.channel_uid, std::move(found.messages), found.has_more};
+        buf.clear();
+        FetchHistoryResponse(std::move(page)).serialize_msg(buf);
+        benchmark::DoNotOptimize(buf.data());
+    }
+}
+BENCHMARK(BM_FetchOlderPage)->Arg(1000000)->Unit(benchmark::kMicrosecond);
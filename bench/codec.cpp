@@ -0,0 +1,257 @@
+#include <benchmark/benchmark.h>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "alloc_counter.hpp"
+#include "constants.hpp"
+#include "message/create_channel.hpp"
+#include "message/create_channel_response.hpp"
+#include "message/delete_account.hpp"
+#include "message/delete_account_response.hpp"
+#include "message/delete_message.hpp"
+#include "message/delete_message_response.hpp"
+#include "message/fetch_history.hpp"
+#include "message/fetch_history_response.hpp"
+#include "message/header.hpp"
+#include "message/hello.hpp"
+#include "message/list_accounts.hpp"
+#include "message/list_accounts_response.hpp"
+#include "message/login.hpp"
+#include "message/login_response.hpp"
+#include "message/register_account.hpp"
+#include "message/register_account_response.hpp"
+#include "message/send_message.hpp"
+#include "message/send_message_response.hpp"
+#include "message/sync.hpp"
+#include "message/sync_response.hpp"
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+#include "models/uuid.hpp"
+
+namespace {
+
+/**
+ * @brief A codec and the name its benchmarks are reported under.
+ */
+struct CodecVersion {
+    const char* name;
+    uint8_t version;
+};
+
+constexpr CodecVersion CODECS[] = {
+    {"binary", PROTOCOL_VERSION_VARINT},
+    {"json", PROTOCOL_VERSION_JSON},
+};
+
+/// The payload sizes of samples that grow: list lengths, and texts of 16 bytes per unit.
+constexpr std::initializer_list<size_t> SIZES = {1, 16, 256};
+/// The only size of samples that are fixed-size.
+constexpr std::initializer_list<size_t> FIXED = {1};
+
+std::string text_of(size_t n) {
+    return std::string(16 * n, 'x');
+}
+
+std::vector<UUID> uuids_of(size_t n) {
+    return std::vector<UUID>(n);
+}
+
+User::SharedPtr user_of(size_t n) {
+    return std::make_shared<User>("user" + std::to_string(n), "Display " + text_of(n));
+}
+
+Message::SharedPtr message_of(size_t n) {
+    return std::make_shared<Message>(UUID(), UUID(), text_of(n));
+}
+
+Channel::SharedPtr channel_of(size_t n) {
+    return std::make_shared<Channel>("general", uuids_of(n));
+}
+
+void report(benchmark::State& state, size_t allocations_before, size_t bytes) {
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+    state.counters["allocs_per_op"] =
+        static_cast<double>(allocation_count() - allocations_before) /
+        static_cast<double>(state.iterations());
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+
+}  // namespace
+
+/**
+ * Serializes a sample into a reused buffer, as ClientHandler::send does.
+ */
+template <typename T>
+static void BM_CodecSerialize(benchmark::State& state, std::shared_ptr<T> sample,
+                              uint8_t version) {
+    std::vector<uint8_t> buf;
+    sample->serialize(buf, version);
+    size_t bytes = buf.size();
+
+    size_t allocations_before = allocation_count();
+    for (auto _ : state) {
+        buf.clear();
+        sample->serialize(buf, version);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    report(state, allocations_before, bytes);
+}
+
+/**
+ * Decodes a serialized sample into the same object over and over, as a handler decodes a frame.
+ */
+template <typename T>
+static void BM_CodecDeserialize(benchmark::State& state, std::shared_ptr<T> sample,
+                                uint8_t version) {
+    std::vector<uint8_t> buf;
+    sample->serialize(buf, version);
+    auto decoded = std::make_shared<T>();
+
+    size_t allocations_before = allocation_count();
+    for (auto _ : state) {
+        decoded->deserialize(buf, version);
+        benchmark::DoNotOptimize(decoded.get());
+    }
+    report(state, allocations_before, buf.size());
+}
+
+/**
+ * Computes the serialized size of a sample, as senders do to fill in the header.
+ */
+template <typename T>
+static void BM_CodecSize(benchmark::State& state, std::shared_ptr<T> sample, uint8_t version) {
+    size_t bytes = sample->size(version);
+
+    size_t allocations_before = allocation_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sample->size(version));
+    }
+    report(state, allocations_before, bytes);
+}
+
+/**
+ * Registers the serialize, deserialize and size benchmarks of one sample.
+ *
+ * Benchmarks are named BM_Codec<Operation>/<type>/<codec>/<size>, so that one type, codec or
+ * operation can be picked out with --benchmark_filter.
+ */
+template <typename T>
+static void register_sample(const std::string& name, const CodecVersion& codec, size_t n,
+                            std::shared_ptr<T> sample) {
+    std::string suffix = "/" + name + "/" + codec.name + "/" + std::to_string(n);
+    benchmark::RegisterBenchmark(("BM_CodecSerialize" + suffix).c_str(), BM_CodecSerialize<T>,
+                                 sample, codec.version);
+    benchmark::RegisterBenchmark(("BM_CodecDeserialize" + suffix).c_str(),
+                                 BM_CodecDeserialize<T>, sample, codec.version);
+    benchmark::RegisterBenchmark(("BM_CodecSize" + suffix).c_str(), BM_CodecSize<T>, sample,
+                                 codec.version);
+}
+
+/**
+ * Registers the benchmarks of a type for every codec, with a sample of each size.
+ */
+template <typename T>
+static void register_codec_benchmarks(const std::string& name,
+                                      std::function<std::shared_ptr<T>(size_t)> make,
+                                      std::initializer_list<size_t> sizes = SIZES) {
+    for (const CodecVersion& codec : CODECS) {
+        for (size_t n : sizes) {
+            register_sample(name, codec, n, make(n));
+        }
+    }
+}
+
+static const bool registered = [] {
+    // Models
+    register_codec_benchmarks<UUID>(
+        "UUID", [](size_t) { return std::make_shared<UUID>(); }, FIXED);
+    register_codec_benchmarks<User>("User", user_of);
+    register_codec_benchmarks<Message>("Message", message_of);
+    register_codec_benchmarks<Channel>("Channel", channel_of);
+
+    // Every frame starts with a header, whose layout depends on the version rather than a codec
+    for (const CodecVersion& codec : CODECS) {
+        register_sample("Header", codec, 1,
+                        std::make_shared<Header>(codec.version, Operation::SEND_MESSAGE, 256));
+    }
+
+    // Requests
+    register_codec_benchmarks<HelloMessage>(
+        "HelloMessage", [](size_t) { return std::make_shared<HelloMessage>(0); }, FIXED);
+    register_codec_benchmarks<RegisterAccountMessage>("RegisterAccountMessage", [](size_t n) {
+        return std::make_shared<RegisterAccountMessage>("username", text_of(n), "Display Name");
+    });
+    register_codec_benchmarks<LoginMessage>("LoginMessage", [](size_t n) {
+        return std::make_shared<LoginMessage>("username", text_of(n));
+    });
+    register_codec_benchmarks<DeleteAccountMessage>("DeleteAccountMessage", [](size_t n) {
+        return std::make_shared<DeleteAccountMessage>("username", text_of(n));
+    });
+    register_codec_benchmarks<ListAccountsMessage>("ListAccountsMessage", [](size_t n) {
+        return std::make_shared<ListAccountsMessage>(text_of(n), 64, "cursor");
+    });
+    register_codec_benchmarks<CreateChannelMessage>("CreateChannelMessage", [](size_t n) {
+        return std::make_shared<CreateChannelMessage>("general", uuids_of(n));
+    });
+    register_codec_benchmarks<SendMessageMessage>("SendMessageMessage", [](size_t n) {
+        return std::make_shared<SendMessageMessage>(UUID(), UUID(), text_of(n));
+    });
+    register_codec_benchmarks<DeleteMessageMessage>(
+        "DeleteMessageMessage",
+        [](size_t) { return std::make_shared<DeleteMessageMessage>(UUID(), 1ULL << 40); }, FIXED);
+    register_codec_benchmarks<FetchHistoryMessage>(
+        "FetchHistoryMessage",
+        [](size_t) { return std::make_shared<FetchHistoryMessage>(UUID(), 1ULL << 40, 0, 50); },
+        FIXED);
+    register_codec_benchmarks<SyncMessage>(
+        "SyncMessage", [](size_t) { return std::make_shared<SyncMessage>(1ULL << 40, 0, 50); },
+        FIXED);
+
+    // Responses
+    register_codec_benchmarks<RegisterAccountResponse>(
+        "RegisterAccountResponse",
+        [](size_t) { return std::make_shared<RegisterAccountResponse>(std::monostate()); }, FIXED);
+    register_codec_benchmarks<LoginResponse>("LoginResponse", [](size_t n) {
+        return std::make_shared<LoginResponse>(user_of(n));
+    });
+    register_codec_benchmarks<DeleteAccountResponse>("DeleteAccountResponse", [](size_t n) {
+        return std::make_shared<DeleteAccountResponse>(user_of(n));
+    });
+    register_codec_benchmarks<ListAccountsResponse>("ListAccountsResponse", [](size_t n) {
+        std::vector<User::SharedPtr> users;
+        for (size_t i = 0; i < n; i++) {
+            users.push_back(user_of(i));
+        }
+        return std::make_shared<ListAccountsResponse>(std::move(users), "cursor");
+    });
+    register_codec_benchmarks<CreateChannelResponse>("CreateChannelResponse", [](size_t n) {
+        return std::make_shared<CreateChannelResponse>(channel_of(n));
+    });
+    register_codec_benchmarks<SendMessageResponse>("SendMessageResponse", [](size_t n) {
+        return std::make_shared<SendMessageResponse>(message_of(n));
+    });
+    register_codec_benchmarks<DeleteMessageResponse>("DeleteMessageResponse", [](size_t n) {
+        return std::make_shared<DeleteMessageResponse>(message_of(n));
+    });
+    register_codec_benchmarks<FetchHistoryResponse>("FetchHistoryResponse", [](size_t n) {
+        HistoryPage page{UUID(), {}};
+        for (size_t i = 0; i < n; i++) {
+            page.messages.push_back(message_of(1));
+        }
+        return std::make_shared<FetchHistoryResponse>(std::move(page));
+    });
+    register_codec_benchmarks<SyncResponse>("SyncResponse", [](size_t n) {
+        SyncBatch batch;
+        for (size_t i = 0; i < n; i++) {
+            batch.channels.push_back(channel_of(1));
+            batch.messages.push_back(message_of(1));
+        }
+        return std::make_shared<SyncResponse>(std::move(batch));
+    });
+    return true;
+}();
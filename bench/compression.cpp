@@ -0,0 +1,160 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/create_channel_response.hpp"
+#include "message/fetch_history_response.hpp"
+#include "message/frame_compression.hpp"
+#include "message/header.hpp"
+#include "message/list_accounts_response.hpp"
+#include "message/login_response.hpp"
+#include "message/send_message_response.hpp"
+#include "message/sync_response.hpp"
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+
+namespace {
+
+/**
+ * Text that varies from message to message, unlike a run of a single character, which deflate
+ * would squeeze to almost nothing.
+ */
+std::string chat_text(size_t i) {
+    static const std::vector<std::string> words = {
+        "the",   "meeting", "moved", "to",      "three", "tomorrow", "can",   "you",
+        "send",  "notes",   "after", "lunch",   "sure",  "thanks",   "sounds", "good",
+        "where", "is",      "the",   "draft",   "for",   "review",   "I",     "pushed"};
+    std::string text;
+    for (size_t word = 0; word < 12; word++) {
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += words[(i * 7 + word * 13) % words.size()];
+    }
+    return text;
+}
+
+std::vector<Message::SharedPtr> make_messages(size_t n, const UUID& channel_uid) {
+    std::vector<UUID> senders(8);
+    std::vector<Message::SharedPtr> messages;
+    for (size_t i = 0; i < n; i++) {
+        messages.push_back(std::make_shared<Message>(senders[i % senders.size()], channel_uid,
+                                                     chat_text(i)));
+    }
+    return messages;
+}
+
+std::vector<User::SharedPtr> make_users(size_t n) {
+    std::vector<User::SharedPtr> users;
+    for (size_t i = 0; i < n; i++) {
+        users.push_back(
+            std::make_shared<User>("user" + std::to_string(i), "Display Name " + std::to_string(i)));
+    }
+    return users;
+}
+
+/**
+ * A frame as the binary protocol sends it.
+ */
+template <typename T>
+std::vector<uint8_t> binary_frame(const T& sample) {
+    std::vector<uint8_t> frame;
+    sample.serialize_msg(frame, PROTOCOL_VERSION_VARINT);
+    return frame;
+}
+
+/**
+ * A frame as the JSON protocol sends it; every message converts itself to JSON in any build.
+ */
+template <typename T>
+std::vector<uint8_t> json_frame(Operation operation, const T& sample) {
+    std::string json = sample.to_json();
+    std::vector<uint8_t> frame;
+    Header(PROTOCOL_VERSION_JSON, operation, json.size()).serialize(frame);
+    frame.insert(frame.end(), json.begin(), json.end());
+    return frame;
+}
+
+}  // namespace
+
+/**
+ * Compresses a frame just before it is written, reporting the bytes that reach the wire.
+ */
+static void BM_CompressFrame(benchmark::State& state, std::vector<uint8_t> frame) {
+    std::vector<uint8_t> buf;
+    for (auto _ : state) {
+        buf.assign(frame.begin(), frame.end());
+        FrameCompressor::compress_frame(buf);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetBytesProcessed(state.iterations() * frame.size());
+    state.counters["bytes_raw"] = static_cast<double>(frame.size());
+    state.counters["bytes_wire"] = static_cast<double>(buf.size());
+    state.counters["ratio"] = static_cast<double>(buf.size()) / static_cast<double>(frame.size());
+}
+
+/**
+ * Restores the payload of a compressed frame, as the receiving FrameDecoder does.
+ */
+static void BM_DecompressFrame(benchmark::State& state, std::vector<uint8_t> frame) {
+    size_t raw_size = frame.size();
+    FrameCompressor::compress_frame(frame);
+    Header header;
+    header.deserialize(frame);
+    std::span<const uint8_t> payload = std::span<const uint8_t>(frame).subspan(header.size());
+    for (auto _ : state) {
+        std::vector<uint8_t> original =
+            FrameCompressor::decompress(payload, Header::MAX_PACKET_LENGTH);
+        benchmark::DoNotOptimize(original.data());
+    }
+    state.SetBytesProcessed(state.iterations() * raw_size);
+}
+
+template <typename T>
+static void register_compression_benchmarks(const std::string& name, Operation operation,
+                                            const T& sample) {
+    for (const auto& [codec, frame] : {std::pair{"binary", binary_frame(sample)},
+                                       std::pair{"json", json_frame(operation, sample)}}) {
+        std::string suffix = name + "/" + codec;
+        benchmark::RegisterBenchmark(("BM_CompressFrame/" + suffix).c_str(), BM_CompressFrame,
+                                     frame);
+        benchmark::RegisterBenchmark(("BM_DecompressFrame/" + suffix).c_str(),
+                                     BM_DecompressFrame, frame);
+    }
+}
+
+static const bool registered = [] {
+    User::SharedPtr user = std::make_shared<User>("username", "Display Name");
+    register_compression_benchmarks("LoginResponse", Operation::LOGIN, LoginResponse(user));
+
+    UUID channel_uid;
+    register_compression_benchmarks("SendMessageResponse", Operation::SEND_MESSAGE,
+                                    SendMessageResponse(make_messages(1, channel_uid)[0]));
+
+    register_compression_benchmarks(
+        "CreateChannelResponse", Operation::CREATE_CHANNEL,
+        CreateChannelResponse(std::make_shared<Channel>("general", std::vector<UUID>(16))));
+
+    register_compression_benchmarks("ListAccountsResponse", Operation::LIST_ACCOUNTS,
+                                    ListAccountsResponse(make_users(64)));
+
+    HistoryPage page;
+    page.channel_uid = channel_uid;
+    page.messages = make_messages(50, channel_uid);
+    page.has_more = true;
+    register_compression_benchmarks("FetchHistoryResponse", Operation::FETCH_HISTORY,
+                                    FetchHistoryResponse(page));
+
+    SyncBatch batch;
+    for (size_t i = 0; i < 8; i++) {
+        batch.channels.push_back(
+            std::make_shared<Channel>("channel " + std::to_string(i), std::vector<UUID>(8)));
+    }
+    batch.messages = make_messages(200, channel_uid);
+    batch.has_more = true;
+    register_compression_benchmarks("SyncResponse", Operation::SYNC, SyncResponse(batch));
+    return true;
+}();
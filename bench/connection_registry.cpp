@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+#include "message/list_accounts.hpp"
+#include "message/send_message_response.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+#include "server/model/client_handler.hpp"
+#include "server/model/connection_registry.hpp"
+#include "server_fixture.hpp"
+
+/**
+ * Packs N idle connections onto a single worker thread and measures the round trip of one active
+ * client on the same worker. With addressed delivery this should stay flat as N grows.
+ */
+static void BM_RequestCostPerThread(benchmark::State& state) {
+    raise_fd_limit();
+    const size_t num_idle = state.range(0);
+
+    BenchServer server(1);
+    std::vector<BenchClient> idle;
+    idle.reserve(num_idle);
+    for (size_t i = 0; i < num_idle; i++) {
+        idle.emplace_back(server.get_port());
+    }
+    BenchClient probe(server.get_port());
+    server.wait_for_connections(num_idle + 1);
+
+    ListAccountsMessage message("^$");
+    std::vector<uint8_t> request;
+    message.serialize_msg(request);
+
+    for (auto _ : state) {
+        probe.send(request);
+        probe.read_frame();
+    }
+    state.counters["connections_per_thread"] = num_idle + 1;
+}
+BENCHMARK(BM_RequestCostPerThread)
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Unit(benchmark::kMicrosecond);
+
+/**
+ * Measures addressing a single user's session in a registry holding N authenticated sessions.
+ */
+static void BM_RegistrySendToUser(benchmark::State& state) {
+    const size_t num_sessions = state.range(0);
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+
+    std::vector<std::unique_ptr<ClientHandler>> handlers;
+    std::vector<User::SharedPtr> users;
+    for (size_t i = 0; i < num_sessions; i++) {
+        handlers.push_back(std::make_unique<ClientHandler>(-1));
+        users.push_back(std::make_shared<User>("user" + std::to_string(i), "User"));
+        handlers.back()->set_authenticated_user(users.back());
+    }
+
+    std::vector<uint8_t> frame(64);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(registry.send_to_user(users[i++ % num_sessions]->get_uid(), frame));
+    }
+}
+BENCHMARK(BM_RegistrySendToUser)->Arg(10)->Arg(1000)->Arg(100000);
+
+/**
+ * Fans a message out to a channel of N online members, one session each, the way the database
+ * reports it: a single call for the whole channel, so the message is encoded once.
+ */
+static void BM_ChannelFanOut(benchmark::State& state) {
+    const size_t num_members = state.range(0);
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+
+    std::vector<std::unique_ptr<ClientHandler>> handlers;
+    std::vector<User::SharedPtr> users;
+    std::vector<UUID> user_uids;
+    for (size_t i = 0; i < num_members; i++) {
+        handlers.push_back(std::make_unique<ClientHandler>(-1));
+        users.push_back(std::make_shared<User>("member" + std::to_string(i), "Member"));
+        handlers.back()->set_authenticated_user(users.back());
+        user_uids.push_back(users.back()->get_uid());
+    }
+
+    auto message = std::make_shared<Message>(user_uids[0], UUID(), std::string(200, 'x'));
+    for (auto _ : state) {
+        registry.on_message_added(message, user_uids);
+    }
+    state.SetItemsProcessed(state.iterations() * num_members);
+}
+BENCHMARK(BM_ChannelFanOut)->Arg(10)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * The same fan-out addressed one member at a time, which encodes the message once per member.
+ */
+static void BM_ChannelFanOutPerMember(benchmark::State& state) {
+    const size_t num_members = state.range(0);
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+
+    std::vector<std::unique_ptr<ClientHandler>> handlers;
+    std::vector<User::SharedPtr> users;
+    for (size_t i = 0; i < num_members; i++) {
+        handlers.push_back(std::make_unique<ClientHandler>(-1));
+        users.push_back(std::make_shared<User>("member" + std::to_string(i), "Member"));
+        handlers.back()->set_authenticated_user(users.back());
+    }
+
+    auto message = std::make_shared<Message>(users[0]->get_uid(), UUID(), std::string(200, 'x'));
+    SendMessageResponse response(message);
+    for (auto _ : state) {
+        for (const User::SharedPtr& user : users) {
+            registry.send_to_user(user->get_uid(),
+                                  [&response](uint8_t version, std::vector<uint8_t>& buf) {
+                                      response.serialize_msg(buf, version);
+                                  });
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * num_members);
+}
+BENCHMARK(BM_ChannelFanOutPerMember)->Arg(10)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <vector>
+
+#include "server_fixture.hpp"
+#include "message/list_accounts.hpp"
+
+namespace {
+
+std::vector<uint8_t> list_accounts_request() {
+    ListAccountsMessage message("^$");
+    std::vector<uint8_t> buf;
+    message.serialize_msg(buf);
+    return buf;
+}
+
+std::vector<BenchClient> open_clients(BenchServer& server, size_t n) {
+    std::vector<BenchClient> clients;
+    clients.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        clients.emplace_back(server.get_port());
+    }
+    server.wait_for_connections(n);
+    return clients;
+}
+
+}  // namespace
+
+/**
+ * Holds N idle connections open and measures the request latency seen by one extra active
+ * client, along with the resident memory cost of each idle connection.
+ */
+static void BM_IdleConnections(benchmark::State& state) {
+    raise_fd_limit();
+    const size_t num_clients = state.range(0);
+
+    BenchServer server;
+    size_t baseline_kb = resident_memory_kb();
+    std::vector<BenchClient> idle = open_clients(server, num_clients);
+    size_t loaded_kb = resident_memory_kb();
+
+    BenchClient probe(server.get_port());
+    std::vector<uint8_t> request = list_accounts_request();
+    std::vector<double> latencies;
+
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        probe.send(request);
+        probe.read_frame();
+        latencies.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                .count());
+    }
+
+    state.counters["rss_kb"] = loaded_kb;
+    state.counters["kb_per_conn"] =
+        static_cast<double>(loaded_kb - baseline_kb) / static_cast<double>(num_clients);
+    state.counters["p50_us"] = percentile(latencies, 50);
+    state.counters["p99_us"] = percentile(latencies, 99);
+}
+BENCHMARK(BM_IdleConnections)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Every one of N connections issues a request per iteration; each iteration is one full round of
+ * N pipelined requests and N responses.
+ */
+static void BM_ActiveConnections(benchmark::State& state) {
+    raise_fd_limit();
+    const size_t num_clients = state.range(0);
+
+    BenchServer server;
+    size_t baseline_kb = resident_memory_kb();
+    std::vector<BenchClient> clients = open_clients(server, num_clients);
+    size_t loaded_kb = resident_memory_kb();
+
+    std::vector<uint8_t> request = list_accounts_request();
+    std::vector<std::chrono::steady_clock::time_point> sent_at(num_clients);
+    std::vector<double> latencies;
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < num_clients; i++) {
+            sent_at[i] = std::chrono::steady_clock::now();
+            clients[i].send(request);
+        }
+        for (size_t i = 0; i < num_clients; i++) {
+            clients[i].read_frame();
+            latencies.push_back(std::chrono::duration<double, std::micro>(
+                                    std::chrono::steady_clock::now() - sent_at[i])
+                                    .count());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * num_clients);
+    state.counters["rss_kb"] = loaded_kb;
+    state.counters["kb_per_conn"] =
+        static_cast<double>(loaded_kb - baseline_kb) / static_cast<double>(num_clients);
+    state.counters["p50_us"] = percentile(latencies, 50);
+    state.counters["p99_us"] = percentile(latencies, 99);
+}
+BENCHMARK(BM_ActiveConnections)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
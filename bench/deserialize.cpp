@@ -0,0 +1,112 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "alloc_counter.hpp"
+#include "constants.hpp"
+#include "message/byte_reader.hpp"
+#include "message/create_channel.hpp"
+#include "message/header.hpp"
+#include "message/list_accounts_response.hpp"
+#include "message/login.hpp"
+#include "message/send_message.hpp"
+#include "message/send_message_response.hpp"
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+
+namespace {
+
+std::vector<UUID> make_uuids(size_t n) {
+    return std::vector<UUID>(n);
+}
+
+std::vector<User::SharedPtr> make_users(size_t n) {
+    std::vector<User::SharedPtr> users;
+    for (size_t i = 0; i < n; i++) {
+        users.push_back(
+            std::make_shared<User>("user" + std::to_string(i), "Display Name " + std::to_string(i)));
+    }
+    return users;
+}
+
+template <typename T>
+std::vector<uint8_t> frame_of(const T& sample) {
+    std::vector<uint8_t> frame;
+    Header(PROTOCOL_VERSION, Operation::SEND_MESSAGE, sample.size()).serialize(frame);
+    sample.serialize(frame);
+    return frame;
+}
+
+void report(benchmark::State& state, size_t allocations_before) {
+    state.SetItemsProcessed(state.iterations());
+    state.counters["allocs_per_msg"] =
+        static_cast<double>(allocation_count() - allocations_before) /
+        static_cast<double>(state.iterations());
+}
+
+}  // namespace
+
+/**
+ * The path a socket handler takes when it only has vectors: split the frame into a header and a
+ * payload vector, then decode the payload.
+ */
+template <typename T>
+static void BM_DeserializeVector(benchmark::State& state, std::vector<uint8_t> frame) {
+    Header header;
+    T decoded;
+
+    size_t allocations_before = allocation_count();
+    for (auto _ : state) {
+        header.deserialize(frame);
+        std::vector<uint8_t> payload(frame.begin() + header.size(), frame.end());
+        decoded.deserialize(payload);
+        benchmark::DoNotOptimize(decoded);
+    }
+    report(state, allocations_before);
+}
+
+/**
+ * Decodes the header and the payload with a single reader over the received frame.
+ */
+template <typename T>
+static void BM_DeserializeInPlace(benchmark::State& state, std::vector<uint8_t> frame) {
+    Header header;
+    T decoded;
+
+    size_t allocations_before = allocation_count();
+    for (auto _ : state) {
+        ByteReader reader(frame);
+        header.deserialize(reader);
+        decoded.deserialize(reader);
+        benchmark::DoNotOptimize(decoded);
+    }
+    report(state, allocations_before);
+}
+
+template <typename T>
+static void register_deserialize_benchmarks(const std::string& name, const T& sample) {
+    std::vector<uint8_t> frame = frame_of(sample);
+    benchmark::RegisterBenchmark(("BM_DeserializeVector/" + name).c_str(),
+                                 BM_DeserializeVector<T>, frame);
+    benchmark::RegisterBenchmark(("BM_DeserializeInPlace/" + name).c_str(),
+                                 BM_DeserializeInPlace<T>, frame);
+}
+
+static const bool registered = [] {
+    register_deserialize_benchmarks(
+        "LoginMessage", LoginMessage("username", "correct horse battery staple"));
+    register_deserialize_benchmarks(
+        "SendMessageMessage", SendMessageMessage(UUID(), UUID(), std::string(200, 'x')));
+    register_deserialize_benchmarks("CreateChannelMessage",
+                                    CreateChannelMessage("general", make_uuids(16)));
+    register_deserialize_benchmarks("Message", Message(UUID(), UUID(), std::string(200, 'x')));
+    register_deserialize_benchmarks("Channel", Channel("general", make_uuids(16)));
+    register_deserialize_benchmarks(
+        "SendMessageResponse",
+        SendMessageResponse(std::make_shared<Message>(UUID(), UUID(), std::string(200, 'x'))));
+    register_deserialize_benchmarks("ListAccountsResponse",
+                                    ListAccountsResponse(make_users(32)));
+    return true;
+}();
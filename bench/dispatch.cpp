@@ -0,0 +1,146 @@
+#include <benchmark/benchmark.h>
+#include <QDebug>
+#include <functional>
+#include <iostream>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/header.hpp"
+#include "message/message_types.hpp"
+#include "models/message_handler.hpp"
+
+namespace {
+
+/// The frames the benchmarks dispatch in turn, as a server receives them.
+struct Frame {
+    Header header;
+    std::vector<uint8_t> payload;
+};
+
+template <typename T>
+Frame frame_of(Operation operation, const T& message) {
+    Frame frame;
+    message.serialize(frame.payload, PROTOCOL_VERSION);
+    frame.header = Header(PROTOCOL_VERSION, operation, frame.payload.size());
+    return frame;
+}
+
+std::vector<Frame> make_frames() {
+    return {frame_of(LOGIN, LoginMessage("username", "password")),
+            frame_of(SEND_MESSAGE, SendMessageMessage(UUID(), UUID(), "hello")),
+            frame_of(SYNC, SyncMessage(0, 0)),
+            frame_of(DELETE_MESSAGE, DeleteMessageMessage(UUID(), 42)),
+            frame_of(LIST_ACCOUNTS, ListAccountsMessage("^user")),
+            frame_of(HELLO, HelloMessage())};
+}
+
+template <typename T>
+void on_message(QTcpSocket* socket, T& msg) {
+    benchmark::DoNotOptimize(&msg);
+}
+
+/**
+ * The dispatcher the opcode table replaced: a switch that decodes the payload, then a lookup by
+ * type_index and two calls through std::function.
+ */
+class TypeIndexDispatcher {
+   public:
+    TypeIndexDispatcher() {
+        register_handler<LoginMessage>(&on_message<LoginMessage>);
+        register_handler<SendMessageMessage>(&on_message<SendMessageMessage>);
+        register_handler<SyncMessage>(&on_message<SyncMessage>);
+        register_handler<DeleteMessageMessage>(&on_message<DeleteMessageMessage>);
+        register_handler<ListAccountsMessage>(&on_message<ListAccountsMessage>);
+        register_handler<HelloMessage>(&on_message<HelloMessage>);
+    }
+
+    void dispatch_frame(QTcpSocket* socket, const Header& header, const std::vector<uint8_t>& msg) {
+        switch (header.get_operation()) {
+            case LOGIN:
+                decode_and_dispatch<LoginMessage>(socket, header, msg);
+                break;
+            case SEND_MESSAGE:
+                decode_and_dispatch<SendMessageMessage>(socket, header, msg);
+                break;
+            case SYNC:
+                decode_and_dispatch<SyncMessage>(socket, header, msg);
+                break;
+            case DELETE_MESSAGE:
+                decode_and_dispatch<DeleteMessageMessage>(socket, header, msg);
+                break;
+            case LIST_ACCOUNTS:
+                decode_and_dispatch<ListAccountsMessage>(socket, header, msg);
+                break;
+            case HELLO:
+                decode_and_dispatch<HelloMessage>(socket, header, msg);
+                break;
+            default:
+                break;
+        }
+    }
+
+   private:
+    template <typename T>
+    void register_handler(std::function<void(QTcpSocket*, T&)> handler) {
+        this->handlers[typeid(T)] = [handler](void* socket, void* message) {
+            handler(static_cast<QTcpSocket*>(socket), *static_cast<T*>(message));
+        };
+    }
+
+    template <typename T>
+    void decode_and_dispatch(QTcpSocket* socket, const Header& header,
+                             const std::vector<uint8_t>& msg) {
+        T message;
+        message.deserialize(msg, header.get_version());
+        qDebug() << "Trying to dispatch handler for: " << typeid(T).name();
+        auto it = this->handlers.find(typeid(T));
+        if (it != this->handlers.end()) {
+            it->second(socket, &message);
+        } else {
+            std::cerr << "No handler registered for type: " << typeid(T).name() << std::endl;
+        }
+    }
+
+    std::unordered_map<std::type_index, std::function<void(void*, void*)>> handlers;
+};
+
+}  // namespace
+
+/**
+ * Decodes and dispatches a mix of small requests through the switch and the type_index map.
+ */
+static void BM_DispatchTypeIndex(benchmark::State& state) {
+    TypeIndexDispatcher dispatcher;
+    std::vector<Frame> frames = make_frames();
+    size_t i = 0;
+    for (auto _ : state) {
+        const Frame& frame = frames[i++ % frames.size()];
+        dispatcher.dispatch_frame(nullptr, frame.header, frame.payload);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DispatchTypeIndex);
+
+/**
+ * Decodes and dispatches the same mix through the table indexed by operation.
+ */
+static void BM_DispatchOpcodeTable(benchmark::State& state) {
+    MessageHandler handler;
+    handler.register_handler<&on_message<LoginMessage>>();
+    handler.register_handler<&on_message<SendMessageMessage>>();
+    handler.register_handler<&on_message<SyncMessage>>();
+    handler.register_handler<&on_message<DeleteMessageMessage>>();
+    handler.register_handler<&on_message<ListAccountsMessage>>();
+    handler.register_handler<&on_message<HelloMessage>>();
+    std::vector<Frame> frames = make_frames();
+    size_t i = 0;
+    for (auto _ : state) {
+        const Frame& frame = frames[i++ % frames.size()];
+        benchmark::DoNotOptimize(handler.dispatch(nullptr, frame.header, frame.payload));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DispatchOpcodeTable);
@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+#include <QDebug>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/list_accounts_response.hpp"
+#include "message/login.hpp"
+#include "models/logger.hpp"
+#include "models/user.hpp"
+
+namespace {
+
+ListAccountsResponse make_response() {
+    std::vector<User::SharedPtr> users;
+    for (size_t i = 0; i < 16; i++) {
+        std::string name = std::to_string(i);
+        users.push_back(std::make_shared<User>("user" + name, "Display Name " + name));
+    }
+    return ListAccountsResponse(users);
+}
+
+}  // namespace
+
+/**
+ * Encodes a binary response and logs its JSON through qDebug(), as every handler used to. The
+ * JSON is rendered even when the output is discarded.
+ */
+static void BM_RespondLoggingWithQDebug(benchmark::State& state) {
+    ListAccountsResponse response = make_response();
+    LoginMessage request("username", "password");
+    std::vector<uint8_t> buf;
+    for (auto _ : state) {
+        buf.clear();
+        qDebug() << request.to_json().c_str();
+        response.serialize_msg(buf, PROTOCOL_VERSION);
+        qDebug() << "ListAccountsResponse: " << response.to_json().c_str();
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RespondLoggingWithQDebug);
+
+/**
+ * The same response with the statements at DEBUG and the logger at INFO: nothing is rendered.
+ */
+static void BM_RespondLoggingOff(benchmark::State& state) {
+    Logger& logger = Logger::get_instance();
+    LogLevel level = logger.get_level();
+    logger.set_level(LogLevel::INFO);
+    ListAccountsResponse response = make_response();
+    LoginMessage request("username", "password");
+    std::vector<uint8_t> buf;
+    for (auto _ : state) {
+        buf.clear();
+        LOG_DEBUG << request.to_json();
+        response.serialize_msg(buf, PROTOCOL_VERSION);
+        LOG_DEBUG << "ListAccountsResponse:" << response.to_json();
+        benchmark::DoNotOptimize(buf.data());
+    }
+    logger.set_level(level);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RespondLoggingOff);
+
+/**
+ * The same response with DEBUG enabled, rendered on the calling thread and written to /dev/null by
+ * the writer thread.
+ */
+static void BM_RespondLoggingAsync(benchmark::State& state) {
+    FILE* out = std::fopen("/dev/null", "w");
+    {
+        Logger logger(out, Logger::DEFAULT_CAPACITY, LogLevel::DEBUG);
+        ListAccountsResponse response = make_response();
+        LoginMessage request("username", "password");
+        std::vector<uint8_t> buf;
+        for (auto _ : state) {
+            buf.clear();
+            LogLine(logger, LogLevel::DEBUG) << request.to_json();
+            response.serialize_msg(buf, PROTOCOL_VERSION);
+            LogLine(logger, LogLevel::DEBUG) << "ListAccountsResponse:" << response.to_json();
+            benchmark::DoNotOptimize(buf.data());
+        }
+        state.counters["dropped"] = logger.get_num_dropped();
+        state.SetItemsProcessed(state.iterations());
+    }
+    std::fclose(out);
+}
+BENCHMARK(BM_RespondLoggingAsync);
+
+/**
+ * Formats a UUID as hex, as the JSON codec and log statements do.
+ */
+static void BM_UUIDToString(benchmark::State& state) {
+    UUID uuid;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(uuid.to_string());
+    }
+}
+BENCHMARK(BM_UUIDToString);
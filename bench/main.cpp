@@ -0,0 +1,14 @@
+#include <benchmark/benchmark.h>
+#include <QCoreApplication>
+
+int main(int argc, char** argv) {
+    // Qt networking requires an application instance, even without a running event loop
+    QCoreApplication app(argc, argv);
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    ::benchmark::RunSpecifiedBenchmarks();
+    ::benchmark::Shutdown();
+    return 0;
+}
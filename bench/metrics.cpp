@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/header.hpp"
+#include "message/send_message.hpp"
+#include "message/send_message_response.hpp"
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+#include "server/db/database.hpp"
+#include "server/db/password_hasher.hpp"
+#include "server/model/metrics.hpp"
+
+namespace {
+
+/**
+ * A database with two members in one channel, for messages to be sent to.
+ */
+struct Chat {
+    Database db;
+    UUID sender_uid;
+    UUID channel_uid;
+
+    Chat() {
+        PasswordHasher::Credentials credentials = PasswordHasher::hash("password");
+        User::SharedPtr sender = std::make_shared<User>("sender", "Sender");
+        User::SharedPtr recipient = std::make_shared<User>("recipient", "Recipient");
+        this->db.add_user(sender, credentials);
+        this->db.add_user(recipient, credentials);
+        this->sender_uid = sender->get_uid();
+        std::vector<UUID> members = {sender->get_uid(), recipient->get_uid()};
+        Channel::SharedPtr channel =
+            std::get<Channel::SharedPtr>(this->db.add_channel("channel", members));
+        this->channel_uid = channel->get_uid();
+    }
+};
+
+Chat& chat() {
+    static Chat* chat = new Chat();
+    return *chat;
+}
+
+}  // namespace
+
+/**
+ * The server side of sending a message, without the sockets: decode the request, add the message
+ * and encode the frame fanned out to the members. With range(0) set, also records what the
+ * connection and the registry record for it, to compare against the 1% budget for metrics.
+ */
+static void BM_SendPath(benchmark::State& state) {
+    Chat& data = chat();
+    Metrics metrics;
+    bool recorded = state.range(0) != 0;
+
+    std::vector<uint8_t> request;
+    SendMessageMessage message(data.channel_uid, data.sender_uid, "hello");
+    message.serialize(request, PROTOCOL_VERSION);
+    size_t request_bytes = request.size() + Header::MAX_SIZE;
+    std::vector<uint8_t> frame;
+    for (auto _ : state) {
+        std::chrono::steady_clock::time_point received;
+        if (recorded) {
+            received = std::chrono::steady_clock::now();
+            metrics.record_request(SEND_MESSAGE, request_bytes);
+        }
+
+        SendMessageMessage decoded;
+        decoded.deserialize(request, PROTOCOL_VERSION);
+        Message::SharedPtr added = std::get<Message::SharedPtr>(data.db.add_message(
+            decoded.get_sender_uid(), decoded.get_channel_uid(), decoded.get_text()));
+        frame.clear();
+        SendMessageResponse(added).serialize_msg(frame, PROTOCOL_VERSION);
+
+        if (recorded) {
+            metrics.record_fanout(2);
+            metrics.record_response(SEND_MESSAGE, frame.size());
+            metrics.record_latency(SEND_MESSAGE, std::chrono::steady_clock::now() - received);
+        }
+        benchmark::DoNotOptimize(frame.data());
+        data.db.remove_message(added->get_snowflake());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SendPath)->ArgName("recorded")->Arg(0)->Arg(1);
+
+/**
+ * Everything a request records, from many threads at once into the same operation.
+ */
+static void BM_RecordRequest(benchmark::State& state) {
+    static Metrics metrics;
+    for (auto _ : state) {
+        auto received = std::chrono::steady_clock::now();
+        metrics.record_request(SEND_MESSAGE, 64);
+        metrics.record_response(SEND_MESSAGE, 96);
+        metrics.record_latency(SEND_MESSAGE, std::chrono::steady_clock::now() - received);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RecordRequest)->ThreadRange(1, 8)->UseRealTime();
+
+/**
+ * Renders the metrics, as a scrape does.
+ */
+static void BM_RenderMetrics(benchmark::State& state) {
+    Metrics metrics;
+    for (size_t op = 0; op < NUM_OPERATIONS; op++) {
+        for (int64_t ns = 1000; ns < 10000000; ns *= 3) {
+            metrics.record_latency(static_cast<Operation>(op), std::chrono::nanoseconds(ns));
+        }
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(metrics.render());
+    }
+}
+BENCHMARK(BM_RenderMetrics)->Unit(benchmark::kMicrosecond);
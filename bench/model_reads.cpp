@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/uuid.hpp"
+
+namespace {
+
+/**
+ * A message guarding its text with a mutex, the way the models did before their state was
+ * published, kept here as the baseline.
+ */
+class LockedMessage {
+   public:
+    explicit LockedMessage(std::string text) : text(std::move(text)) {}
+
+    std::string get_text() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->text;
+    }
+
+   private:
+    std::string text;
+    std::mutex mutex;
+};
+
+/// Fits in the small string buffer, so that copying it measures synchronization, not allocation.
+const std::string TEXT = "short message";
+
+Message::SharedPtr shared_message = std::make_shared<Message>(UUID(), UUID(), TEXT);
+LockedMessage locked_message(TEXT);
+
+std::vector<UUID> members(256);
+Channel::SharedPtr shared_channel = std::make_shared<Channel>("general", members);
+
+}  // namespace
+
+/**
+ * Every thread reads the text of the same message, as fan-out and history replay do.
+ */
+static void BM_MessageGetText(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(shared_message->get_text());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MessageGetText)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_LockedMessageGetText(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(locked_message.get_text());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LockedMessageGetText)->ThreadRange(1, 64)->UseRealTime();
+
+/**
+ * Every thread encodes the same message, reading all of its state in one consistent version.
+ */
+static void BM_MessageSerialize(benchmark::State& state) {
+    std::vector<uint8_t> buf;
+    for (auto _ : state) {
+        buf.clear();
+        shared_message->serialize_msg(buf);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MessageSerialize)->ThreadRange(1, 64)->UseRealTime();
+
+/**
+ * Every thread checks membership of the same channel while thread 0 keeps editing the members.
+ */
+static void BM_ChannelHasUserWhileEdited(benchmark::State& state) {
+    UUID newcomer;
+    size_t i = 0;
+    for (auto _ : state) {
+        if (state.thread_index() == 0 && i++ % 64 == 0) {
+            shared_channel->add_user(newcomer);
+            shared_channel->remove_user(newcomer);
+        }
+        benchmark::DoNotOptimize(shared_channel->has_user(members[i % members.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ChannelHasUserWhileEdited)->ThreadRange(1, 64)->UseRealTime();
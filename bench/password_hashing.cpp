@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "message/list_accounts.hpp"
+#include "message/login.hpp"
+#include "models/user.hpp"
+#include "server/db/database.hpp"
+#include "server/db/password_hasher.hpp"
+#include "server_fixture.hpp"
+
+namespace {
+
+/// The hex SHA-256 of "password" salted with "salt", as hashes were stored before scrypt.
+const PasswordHasher::Credentials LEGACY_CREDENTIALS = {
+    "7a37b85c8918eac19a9089c0fa5a2ab4dce3f90528dcdeec108b23ddf3607b99", "salt"};
+
+template <typename M>
+std::vector<uint8_t> serialize(const M& message) {
+    std::vector<uint8_t> buf;
+    message.serialize_msg(buf);
+    return buf;
+}
+
+}  // namespace
+
+/**
+ * Derives one hash at the given cost, the work every registration costs a worker.
+ */
+static void BM_HashPassword(benchmark::State& state) {
+    uint8_t cost = state.range(0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordHasher::hash("password", cost));
+    }
+}
+BENCHMARK(BM_HashPassword)->Arg(10)->Arg(12)->Arg(PasswordHasher::DEFAULT_COST)->Unit(
+    benchmark::kMillisecond);
+
+/**
+ * Verifies a password against a scrypt hash at the given cost, the work every login costs a
+ * worker, against a legacy salted SHA-256 as a baseline.
+ */
+static void BM_VerifyPassword(benchmark::State& state) {
+    PasswordHasher::Credentials credentials = PasswordHasher::hash("password", state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordHasher::verify("password", credentials));
+    }
+}
+BENCHMARK(BM_VerifyPassword)->Arg(10)->Arg(12)->Arg(PasswordHasher::DEFAULT_COST)->Unit(
+    benchmark::kMillisecond);
+
+static void BM_VerifyLegacyPassword(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordHasher::verify("password", LEGACY_CREDENTIALS));
+    }
+}
+BENCHMARK(BM_VerifyLegacyPassword);
+
+/**
+ * Submits a storm of verifications to a pool with one worker per core and waits for all of them.
+ * Reports how long a submission holds up the submitting thread, which is what a connection's
+ * event loop pays per login, separately from the time the pool takes to work through the storm.
+ */
+static void BM_PoolVerificationStorm(benchmark::State& state) {
+    const size_t num_logins = state.range(0);
+    PasswordHasher::Credentials credentials =
+        PasswordHasher::hash("password", PasswordHasher::DEFAULT_COST);
+    PasswordHasher pool(std::max(1u, std::thread::hardware_concurrency()), num_logins);
+    std::vector<double> submit_latencies;
+
+    for (auto _ : state) {
+        std::atomic<size_t> remaining = num_logins;
+        for (size_t i = 0; i < num_logins; i++) {
+            auto start = std::chrono::steady_clock::now();
+            pool.submit([&]() {
+                benchmark::DoNotOptimize(PasswordHasher::verify("password", credentials));
+                remaining--;
+            });
+            submit_latencies.push_back(
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                    .count());
+        }
+        while (remaining > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * num_logins);
+    state.counters["submit_p50_us"] = percentile(submit_latencies, 50);
+    state.counters["submit_p99_us"] = percentile(submit_latencies, 99);
+}
+BENCHMARK(BM_PoolVerificationStorm)->Arg(16)->Arg(64)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/**
+ * N clients log in at once while one more client lists accounts. Each iteration is one full round
+ * of N logins; the latency of the probe shows whether the storm stalls the connection threads.
+ */
+static void BM_LoginStorm(benchmark::State& state) {
+    raise_fd_limit();
+    const size_t num_clients = state.range(0);
+
+    User::SharedPtr user = std::make_shared<User>("storm", "Storm");
+    Database::get_instance().add_user(user, "password");
+
+    BenchServer server;
+    std::vector<BenchClient> clients;
+    clients.reserve(num_clients);
+    for (size_t i = 0; i < num_clients; i++) {
+        clients.emplace_back(server.get_port());
+    }
+    BenchClient probe(server.get_port());
+    server.wait_for_connections(num_clients + 1);
+
+    LoginMessage login("storm", "password");
+    std::vector<uint8_t> login_request = serialize(login);
+    ListAccountsMessage list_accounts("^$");
+    std::vector<uint8_t> probe_request = serialize(list_accounts);
+    std::vector<double> login_latencies;
+    std::vector<double> probe_latencies;
+
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        for (BenchClient& client : clients) {
+            client.send(login_request);
+        }
+        probe.send(probe_request);
+        probe.read_frame();
+        probe_latencies.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                .count());
+        for (BenchClient& client : clients) {
+            client.read_frame();
+            login_latencies.push_back(
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                    .count());
+        }
+    }
+
+    Database::get_instance().remove_user(user->get_uid());
+    state.SetItemsProcessed(state.iterations() * num_clients);
+    state.counters["login_p50_us"] = percentile(login_latencies, 50);
+    state.counters["login_p99_us"] = percentile(login_latencies, 99);
+    state.counters["probe_p50_us"] = percentile(probe_latencies, 50);
+    state.counters["probe_p99_us"] = percentile(probe_latencies, 99);
+}
+BENCHMARK(BM_LoginStorm)->Arg(16)->Arg(64)->Arg(256)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "alloc_counter.hpp"
+#include "message/create_channel_response.hpp"
+#include "message/login_response.hpp"
+#include "message/send_message_response.hpp"
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+
+namespace {
+
+void report(benchmark::State& state, size_t allocations_before) {
+    state.SetItemsProcessed(state.iterations());
+    state.counters["allocs_per_msg"] =
+        static_cast<double>(allocation_count() - allocations_before) /
+        static_cast<double>(state.iterations());
+}
+
+}  // namespace
+
+/**
+ * Serializes every response into a fresh vector, as handlers did before they had a reusable
+ * output buffer.
+ */
+template <typename T>
+static void BM_SerializeFresh(benchmark::State& state, std::shared_ptr<T> response) {
+    size_t allocations_before = allocation_count();
+    for (auto _ : state) {
+        std::vector<uint8_t> buf;
+        response->serialize_msg(buf);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    report(state, allocations_before);
+}
+
+/**
+ * Serializes every response into the same buffer, as ClientHandler::send does.
+ */
+template <typename T>
+static void BM_SerializeReused(benchmark::State& state, std::shared_ptr<T> response) {
+    std::vector<uint8_t> buf;
+    size_t allocations_before = allocation_count();
+    for (auto _ : state) {
+        buf.clear();
+        response->serialize_msg(buf);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    report(state, allocations_before);
+}
+
+template <typename T>
+static void register_serialize_benchmarks(const std::string& name, std::shared_ptr<T> response) {
+    benchmark::RegisterBenchmark(("BM_SerializeFresh/" + name).c_str(), BM_SerializeFresh<T>,
+                                 response);
+    benchmark::RegisterBenchmark(("BM_SerializeReused/" + name).c_str(), BM_SerializeReused<T>,
+                                 response);
+}
+
+static const bool registered = [] {
+    register_serialize_benchmarks(
+        "SendMessageResponse",
+        std::make_shared<SendMessageResponse>(
+            std::make_shared<Message>(UUID(), UUID(), std::string(200, 'x'))));
+    register_serialize_benchmarks(
+        "CreateChannelResponse",
+        std::make_shared<CreateChannelResponse>(
+            std::make_shared<Channel>("general", std::vector<UUID>(16))));
+    register_serialize_benchmarks(
+        "LoginResponse",
+        std::make_shared<LoginResponse>(std::make_shared<User>("username", "Display Name")));
+    return true;
+}();
@@ -0,0 +1,173 @@
+#pragma once
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "message/header.hpp"
+#include "server/model/tcp_server.hpp"
+
+/**
+ * @brief Runs a TcpServer on a dedicated acceptor thread, listening on an ephemeral local port.
+ */
+class BenchServer {
+   public:
+    explicit BenchServer(int num_workers = QThread::idealThreadCount(),
+                         SchedulingPolicy policy = SchedulingPolicy::ROUND_ROBIN) {
+        acceptor = new QThread();
+        acceptor->start();
+        server = new TcpServer(num_workers, policy);
+        server->moveToThread(acceptor);
+        QMetaObject::invokeMethod(
+            server,
+            [this]() {
+                server->listen(QHostAddress::LocalHost, 0);
+                port = server->serverPort();
+            },
+            Qt::BlockingQueuedConnection);
+    }
+
+    ~BenchServer() {
+        QMetaObject::invokeMethod(server, [this]() { delete server; }, Qt::BlockingQueuedConnection);
+        acceptor->quit();
+        acceptor->wait();
+        delete acceptor;
+    }
+
+    [[nodiscard]] quint16 get_port() const { return port; }
+
+    [[nodiscard]] TcpServer& get_server() { return *server; }
+
+    /**
+     * @brief Blocks until the server reports the expected number of live connections.
+     */
+    void wait_for_connections(size_t expected) const {
+        while (server->get_connection_count() != expected) {
+            QThread::msleep(1);
+        }
+    }
+
+   private:
+    QThread* acceptor;
+    TcpServer* server;
+    quint16 port = 0;
+};
+
+/**
+ * @brief A minimal blocking client speaking the wire protocol over a raw socket.
+ *
+ * Raw sockets keep the client side of the benchmark cheap, so that memory measurements are
+ * dominated by the server.
+ */
+class BenchClient {
+   public:
+    explicit BenchClient(quint16 port) {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create socket");
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to connect");
+        }
+    }
+
+    BenchClient(const BenchClient&) = delete;
+    BenchClient& operator=(const BenchClient&) = delete;
+    BenchClient(BenchClient&& other) noexcept : fd(other.fd) { other.fd = -1; }
+
+    ~BenchClient() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    void send(const std::vector<uint8_t>& data) const {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, 0);
+            if (n <= 0) {
+                throw std::runtime_error("Failed to send");
+            }
+            sent += n;
+        }
+    }
+
+    /**
+     * @brief Reads one complete frame, returning its header and payload.
+     */
+    std::pair<Header, std::vector<uint8_t>> read_frame() const {
+        Header header;
+        std::vector<uint8_t> header_bytes = read_exact(header.size());
+        header.deserialize(header_bytes);
+        return {header, read_exact(header.get_packet_length())};
+    }
+
+   private:
+    std::vector<uint8_t> read_exact(size_t n) const {
+        std::vector<uint8_t> buf(n);
+        size_t received = 0;
+        while (received < n) {
+            ssize_t r = ::recv(fd, buf.data() + received, n - received, 0);
+            if (r <= 0) {
+                throw std::runtime_error("Connection closed");
+            }
+            received += r;
+        }
+        return buf;
+    }
+
+    int fd;
+};
+
+/**
+ * @brief Raises the open file limit so that thousands of sockets can be held at once.
+ */
+inline void raise_fd_limit() {
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+/**
+ * @brief Reads the resident set size of this process in kilobytes.
+ */
+inline size_t resident_memory_kb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            return std::stoul(line.substr(6));
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the requested percentile (0-100) of a set of samples.
+ */
+inline double percentile(std::vector<double> samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(p / 100.0 * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
@@ -0,0 +1,226 @@
+#include <benchmark/benchmark.h>
+#include <unistd.h>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+#include "server/db/database.hpp"
+#include "server/db/snapshot.hpp"
+#include "server/db/write_ahead_log.hpp"
+
+namespace {
+
+constexpr size_t NUM_USERS = 1000;
+constexpr size_t NUM_CHANNELS = 100;
+constexpr size_t MEMBERS_PER_CHANNEL = 10;
+constexpr uint64_t FIRST_SNOWFLAKE = 1ull << 40;
+
+/**
+ * The same history of a server stored twice: as a write-ahead log holding every change, and as
+ * a snapshot of its end state next to a log whose covered records have been discarded.
+ */
+class History {
+   public:
+    explicit History(size_t num_messages) {
+        std::string prefix = (std::filesystem::temp_directory_path() /
+                              ("bench-" + std::to_string(::getpid()) + "-" +
+                               std::to_string(num_messages)))
+                                 .string();
+        this->full_log = prefix + "-full.wal";
+        this->tail_log = prefix + "-tail.wal";
+        this->snapshot = prefix + ".snapshot";
+
+        std::vector<User::SharedPtr> users;
+        for (size_t i = 0; i < NUM_USERS; i++) {
+            users.push_back(std::make_shared<User>("user" + std::to_string(i), "User"));
+        }
+        std::vector<Channel::SharedPtr> channels;
+        for (size_t i = 0; i < NUM_CHANNELS; i++) {
+            std::vector<User::SharedPtr> members;
+            std::vector<UUID> member_uids;
+            for (size_t j = 0; j < MEMBERS_PER_CHANNEL; j++) {
+                members.push_back(users[(i * MEMBERS_PER_CHANNEL + j) % NUM_USERS]);
+                member_uids.push_back(members.back()->get_uid());
+            }
+            auto channel = std::make_shared<Channel>("channel" + std::to_string(i), member_uids);
+            for (const User::SharedPtr& user : members) {
+                user->add_channel(channel->get_uid());
+            }
+            channels.push_back(channel);
+        }
+
+        std::filesystem::remove(this->full_log);
+        {
+            WriteAheadLog wal(this->full_log, SyncPolicy::NONE);
+            for (const User::SharedPtr& user : users) {
+                wal.append(LogRecord(LogRecordType::ADD_USER)
+                               .put_uuid(user->get_uid())
+                               .put_string(user->get_username())
+                               .put_string(user->get_display_name())
+                               .put_string(user->get_profile_pic())
+                               .put_string(std::string(64, 'h'))
+                               .put_string(std::string(16, 's')));
+            }
+            for (const Channel::SharedPtr& channel : channels) {
+                wal.append(LogRecord(LogRecordType::ADD_CHANNEL)
+                               .put_uuid(channel->get_uid())
+                               .put_string(channel->get_name())
+                               .put_uuids(channel->get_user_uids()));
+            }
+            for (size_t i = 0; i < num_messages; i++) {
+                Message::SharedPtr message = make_message(channels, i);
+                wal.append(LogRecord(LogRecordType::ADD_MESSAGE)
+                               .put_u64(message->get_snowflake())
+                               .put_uuid(message->get_sender_id())
+                               .put_uuid(message->get_channel_id())
+                               .put_u64(message->get_created_at())
+                               .put_u64(message->get_modified_at())
+                               .put_string(message->get_text()));
+                channels[i % NUM_CHANNELS]->add_message(message->get_snowflake());
+            }
+        }
+        uint64_t lsn = std::filesystem::file_size(this->full_log);
+
+        SnapshotWriter writer(this->snapshot);
+        for (const User::SharedPtr& user : users) {
+            writer.add_user(user, std::string(64, 'h'), std::string(16, 's'));
+        }
+        for (const Channel::SharedPtr& channel : channels) {
+            writer.add_channel(channel);
+        }
+        std::vector<uint8_t> buf;
+        for (size_t i = 0; i < num_messages; i++) {
+            buf.clear();
+            make_message(channels, i)->serialize(buf);
+            writer.add_message(FIRST_SNOWFLAKE + i, buf);
+        }
+        writer.finish(lsn);
+
+        make_tail(this->tail_log);
+    }
+
+    ~History() {
+        std::filesystem::remove(this->full_log);
+        std::filesystem::remove(this->tail_log);
+        std::filesystem::remove(this->snapshot);
+    }
+
+    /**
+     * Creates a log that is empty past the end of the snapshot, as it is once the snapshot has
+     * been written and the records it covers discarded.
+     */
+    void make_tail(const std::string& path) const {
+        std::filesystem::copy_file(this->full_log, path,
+                                   std::filesystem::copy_options::overwrite_existing);
+        WriteAheadLog(path, SyncPolicy::NONE)
+            .discard_before(std::filesystem::file_size(this->full_log));
+    }
+
+    std::string full_log;
+    std::string tail_log;
+    std::string snapshot;
+
+   private:
+    static Message::SharedPtr make_message(const std::vector<Channel::SharedPtr>& channels,
+                                           size_t i) {
+        const Channel::SharedPtr& channel = channels[i % NUM_CHANNELS];
+        UUID sender = channel->get_user_uids()[i % MEMBERS_PER_CHANNEL];
+        uint64_t created_at = 1700000000000 + i;
+        return std::make_shared<Message>(FIRST_SNOWFLAKE + i, sender, channel->get_uid(),
+                                         created_at, created_at,
+                                         "message number " + std::to_string(i));
+    }
+};
+
+const History& history(size_t num_messages) {
+    static std::map<size_t, std::unique_ptr<History>> histories;
+    std::unique_ptr<History>& found = histories[num_messages];
+    if (!found) {
+        found = std::make_unique<History>(num_messages);
+    }
+    return *found;
+}
+
+}  // namespace
+
+/**
+ * Restarts by replaying every change from the write-ahead log.
+ */
+static void BM_RestartFromLog(benchmark::State& state) {
+    const History& files = history(state.range(0));
+    for (auto _ : state) {
+        auto db = std::make_unique<Database>();
+        auto replayed = db->open_log(files.full_log, SyncPolicy::NONE);
+        benchmark::DoNotOptimize(replayed);
+        state.PauseTiming();
+        db.reset();
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_RestartFromLog)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * Restarts by loading the snapshot and replaying the rest of the log, which is empty.
+ */
+static void BM_RestartFromSnapshot(benchmark::State& state) {
+    const History& files = history(state.range(0));
+    for (auto _ : state) {
+        auto db = std::make_unique<Database>();
+        db->load_snapshot(files.snapshot);
+        db->open_log(files.tail_log, SyncPolicy::NONE);
+        state.PauseTiming();
+        db.reset();
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_RestartFromSnapshot)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(5)
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * Takes a snapshot after one more message, starting from a database restarted from the
+ * previous snapshot.
+ */
+static void BM_WriteSnapshot(benchmark::State& state) {
+    const History& files = history(state.range(0));
+    // Work on copies, since each snapshot replaces the previous one and extends the log
+    std::string snapshot = files.snapshot + ".copy";
+    std::string log = files.tail_log + ".copy";
+    std::filesystem::copy_file(files.snapshot, snapshot,
+                               std::filesystem::copy_options::overwrite_existing);
+    files.make_tail(log);
+    {
+        Database db;
+        db.load_snapshot(snapshot);
+        db.open_log(log, SyncPolicy::NONE);
+        User::SharedPtr user = std::make_shared<User>("snapshotter", "Snapshotter");
+        db.add_user(user, "password");
+        auto channel = db.add_channel("new", {user->get_uid()});
+        UUID channel_uid = std::get<Channel::SharedPtr>(channel)->get_uid();
+        for (auto _ : state) {
+            db.add_message(user->get_uid(), channel_uid, "one more");
+            auto res = db.write_snapshot(snapshot);
+            if (std::holds_alternative<std::string>(res)) {
+                state.SkipWithError(std::get<std::string>(res).c_str());
+            }
+        }
+    }
+    std::filesystem::remove(snapshot);
+    std::filesystem::remove(log);
+}
+BENCHMARK(BM_WriteSnapshot)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "message/create_channel_response.hpp"
+#include "message/send_message_response.hpp"
+#include "message/sync.hpp"
+#include "message/sync_response.hpp"
+#include "models/channel.hpp"
+#include "models/message.hpp"
+
+namespace {
+
+constexpr size_t NUM_CHANNELS = 50;
+
+/**
+ * The channels of a user and their history, in the order the server reads them.
+ */
+struct History {
+    std::vector<Channel::SharedPtr> channels;
+    std::vector<Message::SharedPtr> messages;
+};
+
+const History& history(size_t messages_per_channel) {
+    static History cached;
+    if (cached.messages.size() != NUM_CHANNELS * messages_per_channel) {
+        cached = History();
+        for (size_t i = 0; i < NUM_CHANNELS; i++) {
+            cached.channels.push_back(std::make_shared<Channel>("channel " + std::to_string(i),
+                                                                std::vector<UUID>(8)));
+        }
+        for (size_t i = 0; i < NUM_CHANNELS * messages_per_channel; i++) {
+            cached.messages.push_back(std::make_shared<Message>(
+                UUID(), cached.channels[i % NUM_CHANNELS]->get_uid(), std::string(40, 'x')));
+        }
+    }
+    return cached;
+}
+
+void report(benchmark::State& state, size_t frames, size_t bytes) {
+    state.SetItemsProcessed(state.iterations() * history(state.range(0)).messages.size());
+    state.counters["frames"] = static_cast<double>(frames);
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+
+}  // namespace
+
+/**
+ * Encodes a login history the way on_login used to: one frame per channel and one per message,
+ * each also converted to JSON for the log.
+ */
+static void BM_LoginHistoryPerMessage(benchmark::State& state) {
+    const History& data = history(state.range(0));
+    std::vector<uint8_t> buf;
+    size_t frames = 0;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        frames = 0;
+        bytes = 0;
+        for (const Channel::SharedPtr& channel : data.channels) {
+            CreateChannelResponse response(channel);
+            benchmark::DoNotOptimize(response.to_json());
+            buf.clear();
+            response.serialize_msg(buf);
+            frames++;
+            bytes += buf.size();
+        }
+        for (const Message::SharedPtr& message : data.messages) {
+            SendMessageResponse response(message);
+            benchmark::DoNotOptimize(response.to_json());
+            buf.clear();
+            response.serialize_msg(buf);
+            frames++;
+            bytes += buf.size();
+        }
+    }
+    report(state, frames, bytes);
+}
+BENCHMARK(BM_LoginHistoryPerMessage)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Encodes the same history as SYNC pages filled up to the frame size, as on_sync does.
+ */
+static void BM_LoginHistorySync(benchmark::State& state) {
+    const History& data = history(state.range(0));
+    std::vector<uint8_t> buf;
+    size_t frames = 0;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        frames = 0;
+        bytes = 0;
+        size_t channel = 0;
+        size_t message = 0;
+        while (channel < data.channels.size() || message < data.messages.size()) {
+            SyncResponse::Batch batch;
+            size_t size = SyncResponse::empty_size();
+            for (; channel < data.channels.size(); channel++) {
+                size_t entry_size = SyncResponse::entry_size(data.channels[channel]);
+                if (size + entry_size > SyncResponse::max_size()) {
+                    break;
+                }
+                size += entry_size;
+                batch.channels.push_back(data.channels[channel]);
+            }
+            for (; channel == data.channels.size() && message < data.messages.size() &&
+                   batch.messages.size() < SyncMessage::MAX_LIMIT;
+                 message++) {
+                size_t entry_size = SyncResponse::entry_size(data.messages[message]);
+                if (size + entry_size > SyncResponse::max_size()) {
+                    break;
+                }
+                size += entry_size;
+                batch.messages.push_back(data.messages[message]);
+            }
+            buf.clear();
+            SyncResponse(std::move(batch)).serialize_msg(buf);
+            frames++;
+            bytes += buf.size();
+        }
+    }
+    report(state, frames, bytes);
+}
+BENCHMARK(BM_LoginHistorySync)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
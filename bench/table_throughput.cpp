@@ -0,0 +1,122 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+#include "models/uuid.hpp"
+#include "server/db/database.hpp"
+#include "server/db/password_hasher.hpp"
+#include "server/db/sharded_map.hpp"
+
+namespace {
+
+constexpr size_t NUM_USERS = 10000;
+constexpr size_t NUM_CHANNELS = 64;
+/// The lookups each sent message is followed by, roughly what delivering and syncing it costs.
+constexpr size_t LOOKUPS_PER_SEND = 8;
+
+/**
+ * A database with users, channels and a message history, built once and shared by every run.
+ */
+struct Populated {
+    Database db;
+    std::vector<UUID> user_uids;
+    std::vector<UUID> channel_uids;
+    /// The messages of the history, to look up.
+    std::vector<uint64_t> message_snowflakes;
+
+    Populated() {
+        // scrypt takes tens of milliseconds, so every user shares one hash
+        PasswordHasher::Credentials credentials = PasswordHasher::hash("password");
+        for (size_t i = 0; i < NUM_USERS; i++) {
+            User::SharedPtr user = std::make_shared<User>("user" + std::to_string(i), "User");
+            this->user_uids.push_back(user->get_uid());
+            this->db.add_user(user, credentials);
+        }
+        for (size_t i = 0; i < NUM_CHANNELS; i++) {
+            std::vector<UUID> members = {this->user_uids[i], this->user_uids[i + NUM_CHANNELS]};
+            Channel::SharedPtr channel =
+                std::get<Channel::SharedPtr>(this->db.add_channel("channel", members));
+            this->channel_uids.push_back(channel->get_uid());
+        }
+        for (size_t i = 0; i < NUM_USERS; i++) {
+            Message::SharedPtr message = std::get<Message::SharedPtr>(
+                this->db.add_message(this->user_uids[i], this->channel_uids[i % NUM_CHANNELS],
+                                     "history"));
+            this->message_snowflakes.push_back(message->get_snowflake());
+        }
+    }
+};
+
+Populated& populated() {
+    static Populated* populated = new Populated();
+    return *populated;
+}
+
+}  // namespace
+
+/**
+ * Each thread sends messages to its own channel and follows every message with lookups of users,
+ * messages and channels, as the handlers of a busy server do. Each message is deleted again, so
+ * that the tables keep their size however long the benchmark runs. Lookups no longer wait for a
+ * table lock; writes still take the write-ahead log lock, which orders the records of every table.
+ */
+static void BM_SendMessageWithLookups(benchmark::State& state) {
+    Populated& data = populated();
+    size_t thread = state.thread_index();
+    UUID channel_uid = data.channel_uids[thread % NUM_CHANNELS];
+    UUID sender_uid = data.user_uids[thread % NUM_CHANNELS];
+    size_t i = thread * 7919;
+
+    for (auto _ : state) {
+        Message::SharedPtr message =
+            std::get<Message::SharedPtr>(data.db.add_message(sender_uid, channel_uid, "hello"));
+        for (size_t j = 0; j < LOOKUPS_PER_SEND; j++) {
+            i += 104729;
+            benchmark::DoNotOptimize(data.db.get_user_by_uid(data.user_uids[i % NUM_USERS]));
+            benchmark::DoNotOptimize(data.db.get_message_by_uid(
+                data.message_snowflakes[i % data.message_snowflakes.size()]));
+            benchmark::DoNotOptimize(
+                data.db.get_channel_by_uid(data.channel_uids[i % NUM_CHANNELS]));
+        }
+        data.db.remove_message(message->get_snowflake());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SendMessageWithLookups)->ThreadRange(1, 64)->UseRealTime();
+
+/**
+ * The same mix of inserts and lookups against a bare map, sharded or behind a single lock as the
+ * tables used to be.
+ */
+template <size_t NUM_SHARDS>
+static void BM_MapInsertWithLookups(benchmark::State& state) {
+    using Map = std::unordered_map<uint64_t, std::shared_ptr<int>>;
+    static ShardedMap<uint64_t, std::shared_ptr<int>, Map, NUM_SHARDS> map;
+    static std::once_flag populated;
+    std::call_once(populated, []() {
+        for (uint64_t key = 0; key < NUM_USERS; key++) {
+            map.insert(key, std::make_shared<int>(0));
+        }
+    });
+
+    auto value = std::make_shared<int>(0);
+    uint64_t key = NUM_USERS + state.thread_index();
+    size_t i = state.thread_index() * 7919;
+    for (auto _ : state) {
+        map.insert(key, value);
+        for (size_t j = 0; j < LOOKUPS_PER_SEND * 3; j++) {
+            i += 104729;
+            benchmark::DoNotOptimize(map.find(i % NUM_USERS));
+        }
+        map.erase(key);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_MapInsertWithLookups, 1)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_MapInsertWithLookups, 64)->ThreadRange(1, 64)->UseRealTime();
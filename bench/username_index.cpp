@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "models/user.hpp"
+#include "server/db/user_table.hpp"
+
+namespace {
+
+std::string username_of(size_t i) {
+    return "user" + std::to_string(i);
+}
+
+/**
+ * A table of a million users, built once and shared by every login benchmark.
+ */
+UserTable& populated_table() {
+    static UserTable table;
+    static std::once_flag populated;
+    std::call_once(populated, []() {
+        for (size_t i = 0; i < 1000000; i++) {
+            table.add_user(std::make_shared<User>(username_of(i), "Display Name"));
+        }
+    });
+    return table;
+}
+
+}  // namespace
+
+/**
+ * Resolves a username and fetches the user, as on_login does before verifying the password,
+ * from several threads at once against a million registered users.
+ */
+static void BM_ConcurrentLoginLookup(benchmark::State& state) {
+    UserTable& table = populated_table();
+    size_t i = state.thread_index() * 7919;
+
+    for (auto _ : state) {
+        std::optional<UUID> user_uid = table.get_uid_from_username(username_of(i % 1000000));
+        benchmark::DoNotOptimize(table.get_by_uid(user_uid.value()));
+        i += 104729;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConcurrentLoginLookup)->ThreadRange(1, 8)->UseRealTime();
+
+/**
+ * Registers N users into an empty table; each registration checks the username for uniqueness.
+ */
+static void BM_RegistrationStorm(benchmark::State& state) {
+    const size_t num_users = state.range(0);
+    std::vector<User::SharedPtr> users;
+    for (size_t i = 0; i < num_users; i++) {
+        users.push_back(std::make_shared<User>(username_of(i), "Display Name"));
+    }
+
+    for (auto _ : state) {
+        UserTable table;
+        for (const User::SharedPtr& user : users) {
+            table.add_user(user);
+        }
+        benchmark::DoNotOptimize(table);
+    }
+    state.SetItemsProcessed(state.iterations() * num_users);
+}
+BENCHMARK(BM_RegistrationStorm)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
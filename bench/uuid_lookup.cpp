@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "models/uuid.hpp"
+#include "models/uuid_map.hpp"
+
+namespace {
+
+/**
+ * The hash std::hash<UUID> used to compute, kept here as the baseline.
+ */
+struct StringUUIDHash {
+    size_t operator()(const UUID& uuid) const {
+        return std::hash<std::string>{}(uuid.to_string());
+    }
+};
+
+/**
+ * Builds n keys and the order in which the benchmarks look them up.
+ */
+std::pair<std::vector<UUID>, std::vector<UUID>> make_keys(size_t n) {
+    std::vector<UUID> keys(n);
+    std::vector<UUID> lookups = keys;
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937(42));
+    return {keys, lookups};
+}
+
+}  // namespace
+
+template <typename Map>
+static void BM_UnorderedMapLookup(benchmark::State& state) {
+    auto [keys, lookups] = make_keys(state.range(0));
+    Map map;
+    for (const UUID& key : keys) {
+        map.insert({key, std::make_shared<int>(0)});
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(lookups[i]));
+        i = i + 1 == lookups.size() ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_UnorderedMapLookup,
+                   std::unordered_map<UUID, std::shared_ptr<int>, StringUUIDHash>)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->Arg(1000000);
+BENCHMARK_TEMPLATE(BM_UnorderedMapLookup, std::unordered_map<UUID, std::shared_ptr<int>>)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->Arg(1000000);
+
+static void BM_UUIDMapLookup(benchmark::State& state) {
+    auto [keys, lookups] = make_keys(state.range(0));
+    UUIDMap<std::shared_ptr<int>> map;
+    for (const UUID& key : keys) {
+        map.insert(key, std::make_shared<int>(0));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(lookups[i]));
+        i = i + 1 == lookups.size() ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UUIDMapLookup)->Arg(1000)->Arg(100000)->Arg(1000000);
@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <unistd.h>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "models/channel.hpp"
+#include "models/user.hpp"
+#include "server/db/database.hpp"
+
+namespace {
+
+std::unique_ptr<Database> db;
+UUID sender_uid;
+UUID channel_uid;
+
+std::string log_path() {
+    return (std::filesystem::temp_directory_path() /
+            ("bench-" + std::to_string(::getpid()) + ".wal"))
+        .string();
+}
+
+/**
+ * Opens a fresh database with one user in one channel, logging to an empty file unless no
+ * policy is given.
+ */
+void open_database(std::optional<SyncPolicy> policy, std::chrono::microseconds sync_delay) {
+    std::filesystem::remove(log_path());
+    db = std::make_unique<Database>();
+    if (policy.has_value()) {
+        db->open_log(log_path(), policy.value(), sync_delay);
+    }
+
+    User::SharedPtr user = std::make_shared<User>("sender", "Sender");
+    sender_uid = user->get_uid();
+    db->add_user(user, "password");
+    auto channel = db->add_channel("general", {sender_uid});
+    channel_uid = std::get<Channel::SharedPtr>(channel)->get_uid();
+}
+
+void close_database() {
+    db.reset();
+    std::filesystem::remove(log_path());
+}
+
+}  // namespace
+
+/**
+ * Posts messages from every thread into a database whose changes are logged with the given
+ * policy. With SyncPolicy::COMMIT every add_message returns only once its record is on disk.
+ */
+static void BM_LoggedAddMessage(benchmark::State& state, std::optional<SyncPolicy> policy,
+                                int sync_delay_us) {
+    if (state.thread_index() == 0) {
+        open_database(policy, std::chrono::microseconds(sync_delay_us));
+    }
+    std::string text(64, 'x');
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->add_message(sender_uid, channel_uid, text));
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        close_database();
+    }
+}
+
+static void register_log_benchmarks(const char* name, std::optional<SyncPolicy> policy,
+                                    int sync_delay_us) {
+    benchmark::RegisterBenchmark((std::string("BM_LoggedAddMessage/") + name).c_str(),
+                                 BM_LoggedAddMessage, policy, sync_delay_us)
+        ->ThreadRange(1, 16)
+        ->UseRealTime();
+}
+
+static const bool registered = [] {
+    register_log_benchmarks("Unlogged", std::nullopt, 0);
+    register_log_benchmarks("Commit", SyncPolicy::COMMIT, 0);
+    register_log_benchmarks("CommitGroup100us", SyncPolicy::COMMIT, 100);
+    register_log_benchmarks("Interval10ms", SyncPolicy::INTERVAL, 10000);
+    register_log_benchmarks("None", SyncPolicy::NONE, 0);
+    return true;
+}();
@@ -6,6 +6,7 @@
 #include <QVBoxLayout>
 #include <QWidget>
 
+#include "models/channel.hpp"
 #include "models/message.hpp"
 
 /**
@@ -40,6 +41,12 @@ class ChatArea : public QWidget {
      */
     void addMessageToLayout(Message::SharedPtr message);
 
+    /**
+     * @brief Replace the displayed messages with those of the active channel
+     * 
+     */
+    void redrawMessages();
+
    private slots:
     void validateMessage();
     void onActiveChannelChanged();
@@ -48,6 +55,8 @@ class ChatArea : public QWidget {
     void onSendMessageFailure(const QString& error_message);
     void onDeleteMessageSuccess(Message::SharedPtr message);
     void onDeleteMessageFailure(const QString& error_message);
+    void onScrolled(int value);
+    void onFetchHistorySuccess(Channel::SharedPtr channel);
 
    private:
     QLabel* chatTitle;
@@ -4,6 +4,7 @@
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -11,6 +12,8 @@
 #include "client/model/tcp_client.hpp"
 #include "models/uuid.hpp"
 
+struct HistoryPage;
+
 enum Window { CONNECTION = 0, AUTHENTICATION = 1, MAIN = 2 };
 
 /**
@@ -74,12 +77,42 @@ class Session : public QObject {
      */
     void add_channel(const Channel::SharedPtr& channel);
 
+    /**
+     * @brief Checks whether the session holds a channel.
+     * @param channel_uid The UUID of the channel.
+     * @return True if the channel has been added to the session.
+     */
+    bool has_channel(const UUID& channel_uid) const;
+
+    /**
+     * @brief Gets the snowflake of the newest message received, from which a sync continues.
+     * @return The newest snowflake added to the session, or 0 if it holds no messages.
+     */
+    uint64_t get_sync_watermark() const;
+
     /**
      * @brief Adds a message to the active channel.
      * @param message A shared pointer to the message to be added.
      */
     void add_message(const Message::SharedPtr& message);
 
+    /**
+     * @brief Requests the page of history that precedes the oldest message held for a channel.
+     *
+     * Does nothing while a request for the channel is outstanding or once the server has
+     * returned its first message.
+     *
+     * @param channel_uid The UUID of the channel.
+     */
+    void request_older_messages(const UUID& channel_uid);
+
+    /**
+     * @brief Adds a page of history requested by request_older_messages.
+     * @param page The page returned by the server.
+     * @return The channel the page belongs to, or std::nullopt if the session does not hold it.
+     */
+    std::optional<Channel::SharedPtr> add_history(const HistoryPage& page);
+
     /**
      * @brief Removes a message from the active channel.
      * @param message A shared pointer to the message to be removed.
@@ -101,6 +134,9 @@ class Session : public QObject {
     std::optional<Channel::SharedPtr> open_channel;
     std::unordered_map<UUID, Channel::SharedPtr> channels;
     std::unordered_map<UUID, std::vector<Message::SharedPtr>> channel_messages;
+    uint64_t sync_watermark = 0;
+    std::unordered_set<UUID> history_requested;
+    std::unordered_set<UUID> history_complete;
 
     /**
      * @brief Private constructor to enforce the singleton pattern.
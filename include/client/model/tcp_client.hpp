@@ -2,6 +2,8 @@
 #include <QHostAddress>
 #include <QTcpSocket>
 
+#include "message/frame_compression.hpp"
+#include "message/frame_decoder.hpp"
 #include "models/channel.hpp"
 #include "models/message.hpp"
 #include "models/user.hpp"
@@ -89,12 +91,48 @@ class TcpClient : public QObject {
                            const UUID& sender_uid,
                            const std::string& text);
 
+    /**
+     * @brief Requests the next page of the logged-in user's channels and message history.
+     * @param since The snowflake of the newest message already received, or 0.
+     * @param channel_offset The number of the user's channels already received.
+     */
+    void sync(uint64_t since, uint32_t channel_offset);
+
+    /**
+     * @brief Requests one page of the history of a channel.
+     * @param channel_uid The UUID of the channel.
+     * @param before The snowflake before which the page ends, or 0 for the newest messages.
+     * @param after The snowflake after which the page starts, or 0 for no bound.
+     * @param limit The maximum number of messages, or 0 for the server's default.
+     */
+    void fetch_history(const UUID& channel_uid, uint64_t before, uint64_t after, uint16_t limit);
+
     /**
      * @brief Gets the current connection status of the socket.
      * @return The current socket state.
      */
     [[nodiscard]] QAbstractSocket::SocketState getConnectionStatus() const;
 
+    /**
+     * @brief Enables or disables compression of the frames sent to the server.
+     *
+     * Enabled once the server has accepted compression in its answer to the HelloMessage sent on
+     * connecting, and disabled again on every new connection.
+     *
+     * @param compression Whether large frames are compressed.
+     */
+    void set_compression(bool compression);
+
+    /**
+     * @brief Sets the protocol version spoken to the server.
+     *
+     * The server answers in the version of the first frame it receives, so this must be set before
+     * connecting.
+     *
+     * @param version PROTOCOL_VERSION_VARINT, PROTOCOL_VERSION_CUSTOM or PROTOCOL_VERSION_JSON.
+     */
+    void set_version(uint8_t version);
+
    signals:
     /**
      * @brief Emitted when user registration is successful.
@@ -177,9 +215,36 @@ class TcpClient : public QObject {
      */
     void deleteMessageFailure(const QString& error_message);
 
+    /**
+     * @brief Emitted when a page of the history of a channel has been added to the session.
+     * @param channel A shared pointer to the channel.
+     */
+    void fetchHistorySuccess(Channel::SharedPtr channel);
+
    private:
     QTcpSocket* socket; ///< The TCP socket used for network communication.
 
+    FrameDecoder decoder; ///< Reassembles frames from the bytes received on the socket.
+
+    bool compression = false; ///< Whether the server accepts compressed frames.
+
+    uint8_t version = PROTOCOL_VERSION; ///< The protocol version spoken to the server.
+
+    /**
+     * @brief Serializes a message, compressing it if the server accepts that, and writes it.
+     * @param message Any message providing serialize_msg.
+     */
+    template <typename T>
+    void send(const T& message) {
+        std::vector<uint8_t> data;
+        message.serialize_msg(data, this->version);
+        if (this->compression) {
+            FrameCompressor::compress_frame(data);
+        }
+        socket->write(reinterpret_cast<const char*>(data.data()), data.size());
+        socket->flush();
+    }
+
    private slots:
    /**
      * @brief Slot triggered when the client successfully connects to the server.
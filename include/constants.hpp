@@ -7,17 +7,19 @@
  * @brief Defines protocol version constants used in the application.
  *
  * This file specifies the protocol version numbers for different communication
- * formats. Two protocol versions are defined:
- * - A custom binary protocol version.
+ * formats. Three protocol versions are defined:
+ * - The original custom binary protocol version.
  * - A JSON-based protocol version.
- * The active protocol version is selected at compile time based on whether the
- * PROTOCOL_JSON macro is defined.
+ * - A custom binary protocol version with variable-length lengths and counts.
+ * Every binary speaks all three: the server answers each connection in the version of the first
+ * frame it sends, and clients pick theirs when they start.
  */
 
 /**
  * @brief Custom protocol version.
  *
- * This version is used when the custom binary protocol is employed.
+ * The original binary protocol. Strings and counts are prefixed by a single byte and frames are
+ * limited to 64 KiB. Servers keep speaking it to clients that do.
  */
 constexpr uint8_t PROTOCOL_VERSION_CUSTOM = 1;
 
@@ -28,20 +30,29 @@ constexpr uint8_t PROTOCOL_VERSION_CUSTOM = 1;
  */
 constexpr uint8_t PROTOCOL_VERSION_JSON = 2;
 
-#ifdef PROTOCOL_JSON
 /**
- * @brief The active protocol version.
+ * @brief Varint protocol version.
  *
- * When the PROTOCOL_JSON macro is defined, the active protocol version is set
- * to the JSON protocol version.
+ * The binary protocol clients speak by default. Strings and counts are prefixed by their
+ * length as a LEB128 varint, integers are big-endian and frame lengths are 32 bits wide.
  */
-constexpr uint8_t PROTOCOL_VERSION = PROTOCOL_VERSION_JSON;
-#else
+constexpr uint8_t PROTOCOL_VERSION_VARINT = 3;
+
+/**
+ * @brief The default protocol version.
+ *
+ * The version clients speak unless told otherwise, and that payloads are serialized with when no
+ * version is given.
+ */
+constexpr uint8_t PROTOCOL_VERSION = PROTOCOL_VERSION_VARINT;
+
 /**
- * @brief The active protocol version.
+ * @brief Checks whether a peer speaking a protocol version can be served.
  *
- * When the PROTOCOL_JSON macro is not defined, the active protocol version is set
- * to the custom binary protocol version.
+ * @param version The version in a received header.
+ * @return True if frames of that version can be decoded and answered.
  */
-constexpr uint8_t PROTOCOL_VERSION = PROTOCOL_VERSION_CUSTOM;
-#endif
+constexpr bool is_supported_version(uint8_t version) {
+    return version == PROTOCOL_VERSION_VARINT || version == PROTOCOL_VERSION_JSON ||
+           version == PROTOCOL_VERSION_CUSTOM;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <QTcpSocket>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/frame_decoder.hpp"
+#include "models/uuid.hpp"
+
+class LoadGenerator;
+
+/**
+ * @brief One simulated user of the load generator, on a connection of its own.
+ *
+ * The client only writes requests when the LoadGenerator tells it to. The frames it receives are
+ * dispatched to the loadgen's message handlers, which report back to the generator through
+ * get_generator(). Unlike the GUI client, nothing here touches the Session or any widget, so
+ * thousands of clients can share one event loop.
+ */
+class LoadClient : public QObject {
+    Q_OBJECT
+
+   public:
+    /// The password every simulated user registers with.
+    static constexpr const char* PASSWORD = "loadgen-password";
+
+    /**
+     * @brief Constructs a client; call connect_to_server() to open its connection.
+     *
+     * @param generator The generator driving the client, which must outlive it.
+     * @param username The username the client registers and logs in as.
+     * @param version The protocol version spoken to the server.
+     * @param parent Optional parent QObject.
+     */
+    LoadClient(LoadGenerator& generator, std::string username, uint8_t version,
+               QObject* parent = nullptr);
+
+    /**
+     * @brief Retrieves the LoadClient owning a socket.
+     *
+     * @param socket The socket passed to a message handler.
+     * @return The owning LoadClient, or nullptr if the socket is not owned by one.
+     */
+    static LoadClient* from_socket(QTcpSocket* socket);
+
+    /**
+     * @brief Starts connecting; the generator is told once the connection is open.
+     * @param host The server hostname or IP address.
+     * @param port The server port number.
+     */
+    void connect_to_server(const QString& host, quint16 port);
+
+    /**
+     * @brief Registers the user of the client.
+     */
+    void register_account();
+
+    /**
+     * @brief Logs the user of the client in.
+     */
+    void login();
+
+    /**
+     * @brief Creates a channel; the server tells every member, this client included.
+     * @param members The UUIDs of the members.
+     */
+    void create_channel(const std::vector<UUID>& members);
+
+    /**
+     * @brief Sends a message to the channel of the client, stamped with the time it was sent.
+     */
+    void send_message();
+
+    /**
+     * @brief Reads the time a message was sent from a text written by send_message().
+     *
+     * @param text The text of a delivered message.
+     * @return The time since the epoch of std::chrono::steady_clock, or std::nullopt if the
+     *         message was not sent by a load generator.
+     */
+    static std::optional<std::chrono::nanoseconds> parse_sent_time(const std::string& text);
+
+    /**
+     * @brief Gets the generator driving the client.
+     */
+    [[nodiscard]] LoadGenerator& get_generator() const;
+
+    /**
+     * @brief Gets the username the client registers and logs in as.
+     */
+    [[nodiscard]] const std::string& get_username() const;
+
+    /**
+     * @brief Gets the UUID of the user, known once the client has logged in.
+     */
+    [[nodiscard]] const std::optional<UUID>& get_user_uid() const;
+
+    /**
+     * @brief Records the UUID the server assigned to the user.
+     */
+    void set_user_uid(const UUID& user_uid);
+
+    /**
+     * @brief Gets the channel the client sends to, known once it has been created.
+     */
+    [[nodiscard]] const std::optional<UUID>& get_channel_uid() const;
+
+    /**
+     * @brief Records the channel the client sends to.
+     */
+    void set_channel_uid(const UUID& channel_uid);
+
+   private:
+    /// The generator driving the client.
+    LoadGenerator& generator;
+    /// The connection to the server.
+    QTcpSocket* socket;
+    /// Reassembles frames from the bytes received on the socket.
+    FrameDecoder decoder;
+    /// The protocol version spoken to the server.
+    uint8_t version;
+    /// The username the client registers and logs in as.
+    std::string username;
+    /// The UUID of the user, once logged in.
+    std::optional<UUID> user_uid;
+    /// The channel the client sends to, once created.
+    std::optional<UUID> channel_uid;
+    /// Reusable output buffer for the frames written by send().
+    std::vector<uint8_t> write_buffer;
+
+    /**
+     * @brief Serializes a message into the reusable output buffer and writes it.
+     * @param message Any message providing serialize_msg.
+     */
+    template <typename T>
+    void send(const T& message) {
+        this->write_buffer.clear();
+        message.serialize_msg(this->write_buffer, this->version);
+        this->socket->write(reinterpret_cast<const char*>(this->write_buffer.data()),
+                            this->write_buffer.size());
+    }
+
+   private slots:
+    /**
+     * @brief Tells the generator that the connection is open.
+     */
+    void on_connected();
+
+    /**
+     * @brief Dispatches every frame completed by the bytes available on the socket.
+     */
+    void on_read_data();
+
+    /**
+     * @brief Tells the generator that the connection failed.
+     */
+    void on_error(QAbstractSocket::SocketError error);
+};
@@ -0,0 +1,187 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <chrono>
+#include <deque>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "constants.hpp"
+#include "loadgen/load_client.hpp"
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/uuid.hpp"
+
+/**
+ * @brief What the load generator does to the server.
+ */
+struct LoadConfig {
+    /// The server hostname or IP address.
+    QString host = "127.0.0.1";
+    /// The server port number.
+    quint16 port = 0;
+    /// The number of simulated users, each on a connection of its own.
+    size_t connections = 1000;
+    /// The number of members of each channel, so the number of deliveries of each message.
+    size_t fanout = 8;
+    /// The messages sent per second, across every user.
+    double rate = 1000;
+    /// How long messages are sent for.
+    std::chrono::seconds duration = std::chrono::seconds(10);
+    /// How long to wait for the last deliveries once sending stops.
+    std::chrono::seconds drain_timeout = std::chrono::seconds(5);
+    /// The number of registrations and logins in flight at once. Each costs the server a password
+    /// hash, and it turns requests away when its hashing queue is full.
+    size_t handshake_window = 64;
+    /// The protocol version spoken to the server.
+    uint8_t version = PROTOCOL_VERSION;
+};
+
+/**
+ * @brief Drives a server with many simulated users and reports its throughput and latency.
+ *
+ * The run goes through the phases below, each starting once the previous one has completed
+ * for every client:
+ *
+ * 1. Every client connects.
+ * 2. Clients register and log in, a bounded number at a time, retrying when the server is busy.
+ * 3. Clients are grouped into channels of LoadConfig::fanout members, each created by its first
+ *    member.
+ * 4. Clients take turns sending messages at LoadConfig::rate for LoadConfig::duration. Each
+ *    message carries the time it was sent, and every other member of its channel measures the
+ *    time to its delivery.
+ * 5. Once every delivery has arrived, or LoadConfig::drain_timeout has passed, the results are
+ *    printed and the application exits.
+ *
+ * Everything runs on the thread of the event loop, so the clients need no locking.
+ */
+class LoadGenerator : public QObject {
+    Q_OBJECT
+
+   public:
+    /**
+     * @brief Constructs a generator; call start() to begin the run.
+     *
+     * @param config What to do to the server.
+     * @param parent Optional parent QObject.
+     */
+    explicit LoadGenerator(LoadConfig config, QObject* parent = nullptr);
+
+    /**
+     * @brief Opens every connection, starting the run.
+     */
+    void start();
+
+    /**
+     * @brief Called when a client's connection is open.
+     */
+    void on_connected(LoadClient& client);
+
+    /**
+     * @brief Called when a client's registration is answered.
+     * @param error The reason registration failed, or std::nullopt if it succeeded.
+     */
+    void on_registered(LoadClient& client, const std::optional<std::string>& error);
+
+    /**
+     * @brief Called when a client's login is answered.
+     * @param user_uid The UUID of the user, or the reason login failed.
+     */
+    void on_logged_in(LoadClient& client, const std::variant<UUID, std::string>& user_uid);
+
+    /**
+     * @brief Called when a client is told it is a member of a new channel.
+     */
+    void on_channel_joined(LoadClient& client, const Channel& channel);
+
+    /**
+     * @brief Called when a message is delivered to a client.
+     */
+    void on_delivered(LoadClient& client, const Message& message);
+
+    /**
+     * @brief Aborts the run.
+     * @param reason What went wrong, printed before exiting.
+     */
+    void fail(const std::string& reason);
+
+   private:
+    /**
+     * @brief The phases of a run, in order.
+     */
+    enum class Phase {
+        CONNECTING,
+        LOGGING_IN,
+        CREATING_CHANNELS,
+        SENDING,
+        DRAINING,
+        DONE,
+    };
+
+    /**
+     * @brief Starts registrations and logins until the window is full.
+     */
+    void pump_handshakes();
+
+    /**
+     * @brief Groups the clients into channels and creates them.
+     */
+    void create_channels();
+
+    /**
+     * @brief Sends the messages due since sending started.
+     */
+    void send_due();
+
+    /**
+     * @brief Stops sending and waits for the deliveries still on their way.
+     */
+    void drain();
+
+    /**
+     * @brief Prints the results and exits.
+     */
+    void report();
+
+    /**
+     * @brief Exits the event loop.
+     */
+    void finish(int exit_code);
+
+    /// What to do to the server.
+    LoadConfig config;
+    /// The phase the run is in.
+    Phase phase = Phase::CONNECTING;
+    /// The simulated users, owned as children of the generator.
+    std::vector<LoadClient*> clients;
+    /// The clients waiting to register, or to register again after the server was busy.
+    std::deque<LoadClient*> handshakes;
+    /// The number of registrations and logins in flight.
+    size_t handshakes_in_flight = 0;
+    /// The number of clients that have completed the current phase.
+    size_t num_ready = 0;
+    /// The number of members of each channel.
+    std::unordered_map<UUID, size_t> channel_sizes;
+    /// The client sending the next message.
+    size_t next_sender = 0;
+    /// Sends the messages that are due.
+    QTimer send_timer;
+    /// Ends sending, then ends waiting for the last deliveries.
+    QTimer deadline;
+    /// When sending started.
+    std::chrono::steady_clock::time_point send_start;
+    /// When sending stopped.
+    std::chrono::steady_clock::time_point send_end;
+    /// The number of messages sent.
+    uint64_t num_sent = 0;
+    /// The number of deliveries expected, to every member of a channel but the sender.
+    uint64_t num_expected = 0;
+    /// The number of deliveries received.
+    uint64_t num_delivered = 0;
+    /// The time from each message being sent to its delivery, in nanoseconds.
+    std::vector<int64_t> latencies;
+};
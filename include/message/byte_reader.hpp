@@ -0,0 +1,226 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#include "constants.hpp"
+
+/**
+ * @class ByteReader
+ * @brief A bounds-checked cursor over a borrowed byte buffer.
+ *
+ * Fields are read in place: fixed-size fields are copied straight out of the buffer and
+ * variable-length fields are handed out as spans or string_views into it, so nested objects can
+ * be decoded one after the other without building intermediate vectors. Every view returned by a
+ * reader is only valid for as long as the underlying buffer is.
+ *
+ * A reader also knows the protocol version its buffer was encoded with, which decides how wide
+ * the lengths and counts read by read_length() are.
+ *
+ * Reading past the end of the buffer throws std::out_of_range and leaves the cursor untouched.
+ */
+class ByteReader {
+   public:
+    /**
+     * @brief The most bytes a varint holding a 64-bit integer takes.
+     */
+    static constexpr size_t MAX_VARINT_SIZE = 10;
+
+    /**
+     * @brief Constructs a reader positioned at the start of a buffer.
+     * @param buf The buffer to read from; it must outlive the reader.
+     * @param version The protocol version the buffer was encoded with.
+     */
+    explicit ByteReader(std::span<const uint8_t> buf, uint8_t version = PROTOCOL_VERSION)
+        : buf(buf), version(version) {}
+
+    /**
+     * @brief Reads a single byte.
+     * @return The byte.
+     */
+    uint8_t read_u8() {
+        require(1);
+        return this->buf[this->offset++];
+    }
+
+    /**
+     * @brief Reads a 16-bit unsigned integer in network byte order.
+     * @return The integer in host byte order.
+     */
+    uint16_t read_u16_be() {
+        require(2);
+        uint16_t value = (this->buf[this->offset] << 8) | this->buf[this->offset + 1];
+        this->offset += 2;
+        return value;
+    }
+
+    /**
+     * @brief Reads a 32-bit unsigned integer in network byte order.
+     * @return The integer in host byte order.
+     */
+    uint32_t read_u32_be() {
+        require(4);
+        uint32_t value = 0;
+        for (size_t i = 0; i < 4; i++) {
+            value = (value << 8) | this->buf[this->offset + i];
+        }
+        this->offset += 4;
+        return value;
+    }
+
+    /**
+     * @brief Reads a 64-bit unsigned integer in network byte order.
+     * @return The integer in host byte order.
+     */
+    uint64_t read_u64_be() {
+        require(8);
+        uint64_t value = 0;
+        for (size_t i = 0; i < 8; i++) {
+            value = (value << 8) | this->buf[this->offset + i];
+        }
+        this->offset += 8;
+        return value;
+    }
+
+    /**
+     * @brief Reads a 64-bit unsigned integer stored in host byte order.
+     * @return The integer.
+     */
+    uint64_t read_u64_native() {
+        require(8);
+        uint64_t value;
+        std::memcpy(&value, this->buf.data() + this->offset, sizeof(value));
+        this->offset += sizeof(value);
+        return value;
+    }
+
+    /**
+     * @brief Reads an unsigned LEB128 varint: seven bits per byte, least significant first, with
+     * the high bit set on every byte but the last.
+     * @return The integer.
+     */
+    uint64_t read_varint() {
+        uint64_t value = 0;
+        for (size_t i = 0; i < MAX_VARINT_SIZE; i++) {
+            require(i + 1);
+            uint8_t byte = this->buf[this->offset + i];
+            value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+            if ((byte & 0x80) == 0) {
+                this->offset += i + 1;
+                return value;
+            }
+        }
+        throw std::out_of_range("ByteReader: varint longer than 64 bits");
+    }
+
+    /**
+     * @brief Reads the length of a string or the number of entries in a list.
+     *
+     * The varint protocol encodes it as a varint; older versions use a big-endian integer of a
+     * fixed width. Every entry takes at least one byte, so a length exceeding the bytes left is
+     * rejected before anything is allocated for it.
+     *
+     * @param legacy_width The width of the field in bytes, in versions without varints.
+     * @return The length.
+     */
+    size_t read_length(size_t legacy_width = 1) {
+        size_t start = this->offset;
+        uint64_t length = 0;
+        if (this->version == PROTOCOL_VERSION_VARINT) {
+            length = read_varint();
+        } else {
+            require(legacy_width);
+            for (size_t i = 0; i < legacy_width; i++) {
+                length = (length << 8) | this->buf[this->offset++];
+            }
+        }
+        if (length > remaining()) {
+            this->offset = start;
+            throw std::out_of_range("ByteReader: length exceeds the rest of the buffer");
+        }
+        return length;
+    }
+
+    /**
+     * @brief Reads a run of bytes without copying them.
+     * @param length The number of bytes to read.
+     * @return A view of the bytes inside the buffer.
+     */
+    std::span<const uint8_t> read_bytes(size_t length) {
+        require(length);
+        std::span<const uint8_t> bytes = this->buf.subspan(this->offset, length);
+        this->offset += length;
+        return bytes;
+    }
+
+    /**
+     * @brief Reads a run of bytes as text without copying them.
+     * @param length The number of bytes to read.
+     * @return A view of the text inside the buffer.
+     */
+    std::string_view read_string_view(size_t length) {
+        std::span<const uint8_t> bytes = read_bytes(length);
+        return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    /**
+     * @brief Reads text prefixed by its length, the encoding used for every string in the binary
+     * protocol.
+     * @return A view of the text inside the buffer.
+     */
+    std::string_view read_prefixed_string() {
+        return read_string_view(read_length());
+    }
+
+    /**
+     * @brief Reads every byte left in the buffer.
+     * @return A view of the remaining bytes.
+     */
+    std::span<const uint8_t> read_remaining() {
+        return read_bytes(remaining());
+    }
+
+    /**
+     * @brief Gets the number of bytes left to read.
+     * @return The number of unread bytes.
+     */
+    [[nodiscard]] size_t remaining() const {
+        return this->buf.size() - this->offset;
+    }
+
+    /**
+     * @brief Gets the position of the cursor.
+     * @return The number of bytes read so far.
+     */
+    [[nodiscard]] size_t get_offset() const {
+        return this->offset;
+    }
+
+    /**
+     * @brief Gets the protocol version the buffer was encoded with.
+     * @return The protocol version.
+     */
+    [[nodiscard]] uint8_t get_version() const {
+        return this->version;
+    }
+
+   private:
+    /**
+     * @brief Throws if fewer than the given number of bytes are left.
+     */
+    void require(size_t length) const {
+        if (length > remaining()) {
+            throw std::out_of_range("ByteReader: read past the end of the buffer");
+        }
+    }
+
+    /// The buffer being read.
+    std::span<const uint8_t> buf;
+    /// The position of the next byte to read.
+    size_t offset = 0;
+    /// The protocol version the buffer was encoded with.
+    uint8_t version;
+};
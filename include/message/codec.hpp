@@ -0,0 +1,136 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/byte_reader.hpp"
+
+class Payload;
+enum Operation : uint8_t;
+
+/**
+ * @class Codec
+ * @brief Encodes and decodes the payloads of frames in one protocol version.
+ *
+ * Every connection speaks the version of the first frame it sends, so the codec is picked at
+ * runtime from the version in a header rather than when the binaries are built: a single server
+ * serves binary and JSON clients side by side. There is one codec per supported version, shared
+ * by every connection and thread; codecs hold no state besides their version.
+ *
+ * The binary codecs write the fields of a payload one after the other, in the layout its version
+ * prescribes. The JSON codec writes the payload as a JSON object, in which nested objects are
+ * embedded as escaped JSON strings.
+ */
+class Codec {
+   public:
+    virtual ~Codec() = default;
+
+    /**
+     * @brief Gets the codec of a protocol version.
+     * @param version The protocol version.
+     * @return The codec, which lives as long as the program.
+     * @throws std::out_of_range if the version is not supported.
+     */
+    [[nodiscard]] static const Codec& for_version(uint8_t version);
+
+    /**
+     * @brief Gets the protocol version the codec speaks.
+     * @return The protocol version.
+     */
+    [[nodiscard]] uint8_t get_version() const { return this->version; }
+
+    /**
+     * @brief Appends the encoding of a payload to a buffer.
+     * @param payload The payload.
+     * @param buf The buffer to append to.
+     */
+    virtual void encode(const Payload& payload, std::vector<uint8_t>& buf) const = 0;
+
+    /**
+     * @brief Appends a complete frame, header and payload, to a buffer.
+     * @param operation The operation of the frame.
+     * @param payload The payload of the frame.
+     * @param buf The buffer to append to.
+     */
+    virtual void encode_frame(enum Operation operation, const Payload& payload,
+                              std::vector<uint8_t>& buf) const = 0;
+
+    /**
+     * @brief Restores a payload from its encoding.
+     * @param payload The payload to restore.
+     * @param reader The reader positioned at the encoding.
+     * @throws std::out_of_range if the encoding is malformed.
+     */
+    virtual void decode(Payload& payload, ByteReader& reader) const = 0;
+
+    /**
+     * @brief Gets the number of bytes encode() appends.
+     * @param payload The payload.
+     * @return The size of the encoding in bytes.
+     */
+    [[nodiscard]] virtual size_t size(const Payload& payload) const = 0;
+
+    /**
+     * @brief Gets the number of bytes an object adds to a list nested in a payload.
+     * @param entry The object.
+     * @return The size of the entry in bytes, including any separator.
+     */
+    [[nodiscard]] virtual size_t entry_size(const Payload& entry) const = 0;
+
+   protected:
+    /**
+     * @brief Constructs a codec for a protocol version.
+     * @param version The protocol version.
+     */
+    constexpr explicit Codec(uint8_t version) : version(version) {}
+
+   private:
+    /// The protocol version the codec speaks.
+    uint8_t version;
+};
+
+/**
+ * @class BinaryCodec
+ * @brief Encodes payloads in one of the custom binary protocols.
+ *
+ * Since their size is known before they are encoded, frames grow their buffer at most once.
+ */
+class BinaryCodec final : public Codec {
+   public:
+    /**
+     * @brief Constructs a codec for a binary protocol version.
+     * @param version PROTOCOL_VERSION_VARINT or PROTOCOL_VERSION_CUSTOM.
+     */
+    constexpr explicit BinaryCodec(uint8_t version) : Codec(version) {}
+
+    void encode(const Payload& payload, std::vector<uint8_t>& buf) const override;
+    void encode_frame(enum Operation operation, const Payload& payload,
+                      std::vector<uint8_t>& buf) const override;
+    void decode(Payload& payload, ByteReader& reader) const override;
+    [[nodiscard]] size_t size(const Payload& payload) const override;
+    [[nodiscard]] size_t entry_size(const Payload& entry) const override;
+};
+
+/**
+ * @class JsonCodec
+ * @brief Encodes payloads in the JSON protocol.
+ *
+ * The size of a JSON payload is only known once it has been encoded, so frames are encoded
+ * exactly once and their length is patched into the header afterwards. Payloads that are not
+ * valid JSON, or lack a field, are rejected like truncated binary payloads.
+ */
+class JsonCodec final : public Codec {
+   public:
+    /**
+     * @brief Constructs the codec of the JSON protocol.
+     */
+    constexpr JsonCodec() : Codec(PROTOCOL_VERSION_JSON) {}
+
+    void encode(const Payload& payload, std::vector<uint8_t>& buf) const override;
+    void encode_frame(enum Operation operation, const Payload& payload,
+                      std::vector<uint8_t>& buf) const override;
+    void decode(Payload& payload, ByteReader& reader) const override;
+    [[nodiscard]] size_t size(const Payload& payload) const override;
+    [[nodiscard]] size_t entry_size(const Payload& entry) const override;
+};
@@ -2,7 +2,7 @@
 #include <stdint.h>
 #include <string>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 
 /**
  * @class DeleteAccountMessage
@@ -12,7 +12,7 @@
  * including the username and password. It supports serialization, deserialization, 
  * and JSON conversion.
  */
-class DeleteAccountMessage : public Serializable {
+class DeleteAccountMessage : public Payload {
    public:
    /**
      * @brief Default constructor.
@@ -27,40 +27,43 @@ class DeleteAccountMessage : public Serializable {
     DeleteAccountMessage(std::string username, std::string password);
 
     /**
-     * @brief Serializes the message into a byte buffer.
+     * @brief Serializes the message into a byte buffer in the binary protocol.
      * @param buf The vector to store the serialized data.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes only the message-specific data into a byte buffer.
      * @param buf The vector to store the serialized message data.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the message from a byte buffer.
-     * @param buf The vector containing the serialized data.
+     * @brief Deserializes the message from a reader in the binary protocol.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the message into a JSON string representation.
      * @return A JSON string representing the message.
      */
-    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string to_json() const override;
 
     /**
      * @brief Populates the message object from a JSON string.
      * @param json The JSON string containing the message data.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
-     * @brief Gets the size of the serialized message.
+     * @brief Gets the size of the serialized message in the binary protocol.
+     * @param version The protocol version to encode with.
      * @return The size of the serialized message in bytes.
      */
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     /**
      * @brief Retrieves the username associated with the account deletion request.
@@ -1,8 +1,9 @@
+#pragma once
 #include <optional>
 #include <string>
 #include <variant>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 #include "models/user.hpp"
 
 /**
@@ -13,7 +14,7 @@
  * can either be successful (returning a User object) or unsuccessful (returning 
  * an error message). It supports serialization, deserialization, and JSON conversion.
  */
-class DeleteAccountResponse : public Serializable {
+class DeleteAccountResponse : public Payload {
    public:
    /**
      * @brief Default constructor.
@@ -27,40 +28,43 @@ class DeleteAccountResponse : public Serializable {
     DeleteAccountResponse(std::variant<User::SharedPtr, std::string> data);
 
     /**
-     * @brief Serializes the response into a byte buffer.
+     * @brief Serializes the response into a byte buffer in the binary protocol.
      * @param buf The vector to store the serialized data.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes the header and message into a byte buffer.
      * @param buf The vector to store the serialized message data.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the response from a byte buffer.
-     * @param buf The vector containing the serialized data.
+     * @brief Deserializes the response from a reader in the binary protocol.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf);
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the response into a JSON string representation.
      * @return A JSON string representing the response.
      */
-    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string to_json() const override;
 
     /**
      * @brief Populates the response object from a JSON string.
      * @param json The JSON string containing the response data.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
-     * @brief Gets the size of the serialized response.
+     * @brief Gets the size of the serialized response in the binary protocol.
+     * @param version The protocol version to encode with.
      * @return The size of the serialized response in bytes.
      */
-    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     /**
      * @brief Checks if the account deletion was successful.
@@ -1,7 +1,7 @@
 #pragma once
 #include <stdint.h>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 #include "models/uuid.hpp"
 
 /**
@@ -12,7 +12,7 @@
  * message, including the channel UUID and the unique message identifier (snowflake). 
  * It supports serialization, deserialization, and JSON conversion.
  */
-class DeleteMessageMessage : public Serializable {
+class DeleteMessageMessage : public Payload {
    public:
    /**
      * @brief Default constructor.
@@ -27,34 +27,36 @@ class DeleteMessageMessage : public Serializable {
     DeleteMessageMessage(UUID channel_uid, uint64_t message_snowflake);
 
     /**
-     * @brief Serializes the message into a byte buffer.
+     * @brief Serializes the message into a byte buffer in the binary protocol.
      * @param buf The vector to store the serialized data.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes only the message-specific data into a byte buffer.
      * @param buf The vector to store the serialized message data.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the message from a byte buffer.
-     * @param buf The vector containing the serialized data.
+     * @brief Deserializes the message from a reader in the binary protocol.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the message into a JSON string representation.
      * @return A JSON string representing the message.
      */
-    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string to_json() const override;
 
     /**
      * @brief Populates the message object from a JSON string.
      * @param json The JSON string containing the message data.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
      * @brief Retrieves the unique identifier (snowflake) of the message to be deleted.
@@ -63,10 +65,11 @@ class DeleteMessageMessage : public Serializable {
     [[nodiscard]] uint64_t get_message_snowflake() const;
 
     /**
-     * @brief Gets the size of the serialized message.
+     * @brief Gets the size of the serialized message in the binary protocol.
+     * @param version The protocol version to encode with.
      * @return The size of the serialized message in bytes.
      */
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
    private:
    /**
@@ -0,0 +1,125 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+#include "message/payload.hpp"
+#include "models/uuid.hpp"
+
+/**
+ * @class FetchHistoryMessage
+ * @brief Represents a request for one page of the history of a channel.
+ *
+ * The page is bounded by snowflakes on either side. Without bounds it holds the newest messages
+ * of the channel; passing the oldest snowflake the client holds as before pulls the page that
+ * precedes it, and passing the newest as after pulls the page that follows it.
+ */
+class FetchHistoryMessage : public Payload {
+   public:
+    /**
+     * @brief The number of messages returned when the request does not set a limit.
+     */
+    static constexpr uint16_t DEFAULT_LIMIT = 50;
+
+    /**
+     * @brief The most messages a single response will carry.
+     */
+    static constexpr uint16_t MAX_LIMIT = 1024;
+
+    /**
+     * @brief Default constructor.
+     */
+    FetchHistoryMessage() = default;
+
+    /**
+     * @brief Constructs a request for one page of the history of a channel.
+     * @param channel_uid The UUID of the channel.
+     * @param before The snowflake before which the page ends, or 0 for no bound.
+     * @param after The snowflake after which the page starts, or 0 for no bound.
+     * @param limit The maximum number of messages to return, or 0 for the server's default.
+     */
+    FetchHistoryMessage(UUID channel_uid, uint64_t before, uint64_t after, uint16_t limit = 0);
+
+    /**
+     * @brief Serializes the message into a byte buffer in the binary protocol.
+     * @param buf The vector to store the serialized data.
+     * @param version The protocol version to encode with.
+     */
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
+
+    /**
+     * @brief Serializes both the message and its header into a byte buffer.
+     * @param buf The vector to store the serialized header and message data.
+     * @param version The protocol version to encode with.
+     */
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
+
+    /**
+     * @brief Deserializes the message from a reader in the binary protocol.
+     * @param reader The reader positioned at the serialized data.
+     */
+    void deserialize_binary(ByteReader& reader) override;
+
+    /**
+     * @brief Converts the message to a JSON string representation.
+     * @return A JSON string representing the message.
+     */
+    [[nodiscard]] std::string to_json() const override;
+
+    /**
+     * @brief Populates the message from a JSON string.
+     * @param json The JSON string to deserialize.
+     */
+    void from_json(const std::string& json) override;
+
+    /**
+     * @brief Retrieves the size of the serialized message in the binary protocol.
+     * @param version The protocol version to encode with.
+     * @return The size of the serialized message in bytes.
+     */
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
+
+    /**
+     * @brief Retrieves the channel whose history is requested.
+     * @return The UUID of the channel.
+     */
+    [[nodiscard]] UUID get_channel_uid() const;
+
+    /**
+     * @brief Retrieves the snowflake before which the page ends.
+     * @return The snowflake, or 0 for no bound.
+     */
+    [[nodiscard]] uint64_t get_before() const;
+
+    /**
+     * @brief Retrieves the snowflake after which the page starts.
+     * @return The snowflake, or 0 for no bound.
+     */
+    [[nodiscard]] uint64_t get_after() const;
+
+    /**
+     * @brief Retrieves the maximum number of messages to return.
+     * @return The requested limit, or 0 if the server's default applies.
+     */
+    [[nodiscard]] uint16_t get_limit() const;
+
+   private:
+    /**
+     * @brief The channel whose history is requested.
+     */
+    UUID channel_uid;
+
+    /**
+     * @brief The snowflake before which the page ends; 0 for no bound.
+     */
+    uint64_t before = 0;
+
+    /**
+     * @brief The snowflake after which the page starts; 0 for no bound.
+     */
+    uint64_t after = 0;
+
+    /**
+     * @brief The maximum number of messages to return; 0 selects the server's default.
+     */
+    uint16_t limit = 0;
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <stdint.h>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "message/payload.hpp"
+#include "models/message.hpp"
+#include "models/uuid.hpp"
+
+/**
+ * @brief One page of the history of a channel returned to a FetchHistoryMessage.
+ */
+struct HistoryPage {
+    /// The channel the messages belong to.
+    UUID channel_uid;
+    /// The messages of the page, oldest first.
+    std::vector<Message::SharedPtr> messages;
+    /// Whether the channel holds more messages beyond the page, in the direction it was read.
+    bool has_more = false;
+};
+
+/**
+ * @class FetchHistoryResponse
+ * @brief Represents one page of the history of a channel, or the reason it cannot be read.
+ */
+class FetchHistoryResponse : public Payload {
+   public:
+    /**
+     * @brief Default constructor.
+     */
+    FetchHistoryResponse() = default;
+
+    /**
+     * @brief Constructs a response that can contain either a page or an error message.
+     * @param data A variant that holds either a page of history or an error message.
+     */
+    FetchHistoryResponse(std::variant<HistoryPage, std::string> data);
+
+    /**
+     * @brief Serializes the response into a byte buffer in the binary protocol.
+     * @param buf The vector to store the serialized data.
+     * @param version The protocol version to encode with.
+     */
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
+
+    /**
+     * @brief Serializes the message and the header together.
+     * @param buf The vector to store the serialized message data.
+     * @param version The protocol version to encode with.
+     */
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
+
+    /**
+     * @brief Deserializes the response from a reader in the binary protocol.
+     * @param reader The reader positioned at the serialized data.
+     */
+    void deserialize_binary(ByteReader& reader) override;
+
+    /**
+     * @brief Converts the response to a JSON string representation.
+     * @return A JSON string representing the response.
+     */
+    [[nodiscard]] std::string to_json() const override;
+
+    /**
+     * @brief Populates the response from a JSON string.
+     * @param json The JSON string to deserialize.
+     */
+    void from_json(const std::string& json) override;
+
+    /**
+     * @brief Retrieves the size of the serialized response in the binary protocol.
+     * @param version The protocol version to encode with.
+     * @return The size of the serialized response in bytes.
+     */
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
+
+    /**
+     * @brief Gets the largest response that fits in a frame.
+     * @param version The protocol version to encode with.
+     * @return The largest size of a response in bytes.
+     */
+    [[nodiscard]] static size_t max_size(uint8_t version = PROTOCOL_VERSION);
+
+    /**
+     * @brief Gets the size of a successful response with no messages.
+     * @param version The protocol version to encode with.
+     * @return An upper bound on the size of an empty page.
+     */
+    [[nodiscard]] static size_t empty_size(uint8_t version = PROTOCOL_VERSION);
+
+    /**
+     * @brief Gets the number of bytes a message adds to a response.
+     * @param message The message.
+     * @param version The protocol version to encode with.
+     * @return The size of the message in the response.
+     */
+    [[nodiscard]] static size_t entry_size(const Message::SharedPtr& message,
+                                           uint8_t version = PROTOCOL_VERSION);
+
+    /**
+     * @brief Checks whether the response holds a page.
+     * @return True if the response holds a page, false if it contains an error message.
+     */
+    [[nodiscard]] bool is_success() const;
+
+    /**
+     * @brief Retrieves the error message if the response indicates a failure.
+     * @return An optional string containing the error message, or std::nullopt if successful.
+     */
+    [[nodiscard]] std::optional<std::string> get_error_message() const;
+
+    /**
+     * @brief Retrieves the page if the response is successful.
+     * @return An optional containing the page, or std::nullopt if an error occurred.
+     */
+    [[nodiscard]] std::optional<HistoryPage> get_page() const;
+
+   private:
+    /**
+     * @brief Holds either a page on success or an error message on failure.
+     */
+    std::variant<HistoryPage, std::string> data;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+/**
+ * @class FrameCompressor
+ * @brief Compresses and decompresses the payloads of frames.
+ *
+ * Payloads are compressed with raw deflate, primed with a preset dictionary of the strings that
+ * recur in every payload: the keys of the JSON protocol, escaped as they are when objects are
+ * nested, and the default profile picture. Since every frame starts from the dictionary instead of
+ * an empty window, even frames of a few hundred bytes shrink noticeably. Changing the dictionary
+ * breaks compatibility with every deployed peer.
+ *
+ * A compressed payload is the length of the original payload as a big-endian 32-bit integer,
+ * followed by the deflate stream. The header of a compressed frame has Header::COMPRESSED_FLAG set
+ * and carries the length of the compressed payload.
+ *
+ * Both directions keep one deflate and one inflate stream per thread, so compressing a frame does
+ * not allocate once the scratch buffers have grown.
+ */
+class FrameCompressor {
+   public:
+    /**
+     * @brief Payloads shorter than this are never compressed, since they gain too little to pay
+     * for the work.
+     */
+    static constexpr size_t THRESHOLD = 256;
+
+    /**
+     * @brief Compresses a serialized frame in place, if it is worth it.
+     *
+     * Frames whose payload is shorter than THRESHOLD, or would not shrink, are left untouched.
+     *
+     * @param buf The buffer holding the frame.
+     * @param start The offset of the frame's header in the buffer; the frame runs to the end.
+     * @return True if the frame was compressed.
+     */
+    static bool compress_frame(std::vector<uint8_t>& buf, size_t start = 0);
+
+    /**
+     * @brief Restores the original payload of a compressed frame.
+     *
+     * @param payload The compressed payload.
+     * @param max_length The longest original payload to accept.
+     * @return The original payload.
+     * @throws std::out_of_range if the payload is corrupt or would inflate beyond max_length.
+     */
+    [[nodiscard]] static std::vector<uint8_t> decompress(std::span<const uint8_t> payload,
+                                                         size_t max_length);
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "message/header.hpp"
+
+/**
+ * @class FrameDecoder
+ * @brief Incrementally reassembles frames from a byte stream.
+ *
+ * A frame is a serialized Header followed by a payload of the length given in the header. Bytes
+ * are fed to the decoder as they arrive from the socket, in chunks of any size, and are kept in a
+ * growable ring buffer. The header of the next frame is parsed only once, as soon as enough bytes
+ * are buffered, and complete frames are then handed out one at a time. A single chunk may complete
+ * any number of frames, so callers should drain the decoder after every feed.
+ *
+ * The decoder never blocks; a partially received frame simply stays buffered until the next feed.
+ * Compressed frames are decompressed before they are handed out, so callers only ever see the
+ * original payload.
+ */
+class FrameDecoder {
+   public:
+    /**
+     * @brief A complete frame.
+     */
+    struct Frame {
+        /// The header describing the frame.
+        Header header;
+        /// The payload of the frame, exactly header.get_packet_length() bytes long.
+        std::vector<uint8_t> payload;
+    };
+
+    /**
+     * @brief Constructs an empty decoder.
+     * @param initial_capacity The initial size of the ring buffer in bytes, rounded up to a power of two.
+     */
+    explicit FrameDecoder(size_t initial_capacity = 4096);
+
+    /**
+     * @brief Appends received bytes to the decoder.
+     *
+     * @param data Pointer to the received bytes.
+     * @param length The number of received bytes.
+     */
+    void feed(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Pops the next complete frame, if one is buffered.
+     *
+     * @return The next frame, or std::nullopt if more bytes are needed.
+     * @throws std::out_of_range if a header announces a packet longer than its version allows, or
+     * a compressed payload is corrupt. The stream cannot be resynchronized after that and the
+     * connection should be closed.
+     */
+    [[nodiscard]] std::optional<Frame> next();
+
+    /**
+     * @brief Gets the number of bytes buffered but not yet returned in a frame.
+     *
+     * Bytes belonging to an already parsed header are not counted.
+     *
+     * @return The number of buffered bytes.
+     */
+    [[nodiscard]] size_t buffered() const;
+
+    /**
+     * @brief Discards all buffered bytes, including any partially received frame.
+     */
+    void reset();
+
+   private:
+    /**
+     * @brief Copies bytes out of the front of the ring buffer and releases them.
+     */
+    void pop(uint8_t* out, size_t length);
+
+    /**
+     * @brief Grows the ring buffer so that it can hold at least the given number of bytes.
+     */
+    void reserve(size_t capacity);
+
+    /// The ring buffer; its size is always a power of two.
+    std::vector<uint8_t> ring;
+    /// The index of the first buffered byte.
+    size_t head = 0;
+    /// The number of buffered bytes.
+    size_t count = 0;
+    /// The header of the frame currently being received, once it has been parsed.
+    std::optional<Header> header;
+};
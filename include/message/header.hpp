@@ -4,6 +4,8 @@
 
 #include "message/serialize.hpp"
 
+class Payload;
+
 /**
  * @enum Operation
  * @brief Defines various operations that can be performed in the system.
@@ -27,6 +29,9 @@ enum Operation : uint8_t {
     UPDATE_DISPLAY_NAME,
     UPDATE_PROFILE_PICTURE,
     RESET_PASSWORD,
+    SYNC,
+    FETCH_HISTORY,
+    HELLO,
 };
 
 /**
@@ -36,9 +41,31 @@ enum Operation : uint8_t {
  * This class encapsulates metadata for a packet, including its protocol 
  * version, the type of operation being performed, and the total length 
  * of the packet. It supports serialization and deserialization.
+ *
+ * The first byte holds the version in its high nibble and the size of the header in the low three
+ * bits; the remaining bit flags a compressed payload. The layout of the rest follows from the
+ * version: the varint protocol carries a 32-bit packet length, older versions a 16-bit one.
  */
 class Header : public Serializable {
    public:
+    /**
+     * @brief The size of the largest header of any version.
+     */
+    static constexpr size_t MAX_SIZE = 6;
+
+    /**
+     * @brief The largest packet accepted in the varint protocol.
+     *
+     * Its length field could describe packets of up to 4 GiB, but a peer is not allowed to make the
+     * other side buffer that much for a single frame.
+     */
+    static constexpr uint32_t MAX_PACKET_LENGTH = 16 * 1024 * 1024;
+
+    /**
+     * @brief The bit of the first byte set on frames whose payload is compressed.
+     */
+    static constexpr uint8_t COMPRESSED_FLAG = 0x08;
+
    /**
      * @brief Default constructor.
      */
@@ -50,25 +77,64 @@ class Header : public Serializable {
      * @param operation The operation type (e.g., LOGIN, SEND_MESSAGE).
      * @param packet_length The total length of the packet in bytes.
      */
-    Header(uint8_t version, enum Operation operation, uint16_t packet_length);
+    Header(uint8_t version, enum Operation operation, uint32_t packet_length);
+
+    /**
+     * @brief Gets the size of the headers of a protocol version.
+     * @param version The protocol version.
+     * @return The size of the header in bytes.
+     */
+    [[nodiscard]] static size_t size_for_version(uint8_t version);
+
+    /**
+     * @brief Gets the largest packet a protocol version can carry in one frame.
+     * @param version The protocol version.
+     * @return The maximum packet length in bytes.
+     */
+    [[nodiscard]] static size_t max_packet_length(uint8_t version);
 
     /**
      * @brief Serializes the header into a byte buffer.
+     *
+     * A header is always encoded in the layout of its own version.
+     *
      * @param buf The vector to store the serialized data.
+     * @param version Ignored; the header's own version is used.
+     */
+    void serialize(std::vector<uint8_t>& buf, uint8_t version) const override;
+
+    /**
+     * @brief Serializes a complete frame, header and body, in a single pass.
+     *
+     * The frame is appended to the buffer by the Codec of the version, which grows the buffer at
+     * most once. Callers that keep the buffer around and clear it between frames therefore stop
+     * allocating once it has reached the size of their largest frame.
+     *
+     * @param operation The operation of the frame.
+     * @param body The body of the frame.
+     * @param buf The vector to append the frame to.
+     * @param version The protocol version to encode the frame with.
+     * @throws std::out_of_range if the version is not supported.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    static void serialize_frame(enum Operation operation, const Payload& body,
+                                std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION);
+
+    using Serializable::deserialize;
+    using Serializable::serialize;
+    using Serializable::size;
 
     /**
-     * @brief Deserializes the header from a byte buffer.
-     * @param buf The vector containing the serialized data.
+     * @brief Deserializes the header from a reader.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize(ByteReader& reader) override;
 
     /**
      * @brief Retrieves the size of the serialized header.
+     * @param version Ignored; the header's own version is used.
      * @return The size of the serialized header in bytes.
      */
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t size(uint8_t version) const override;
 
     /**
      * @brief Gets the protocol version of the packet.
@@ -86,7 +152,13 @@ class Header : public Serializable {
      * @brief Gets the total packet length.
      * @return The length of the packet in bytes.
      */
-    [[nodiscard]] uint16_t get_packet_length() const;
+    [[nodiscard]] uint32_t get_packet_length() const;
+
+    /**
+     * @brief Checks whether the payload of the packet is compressed.
+     * @return True if the payload must be decompressed before it is deserialized.
+     */
+    [[nodiscard]] bool is_compressed() const;
 
     /**
      * @brief Sets the protocol version of the header.
@@ -104,13 +176,19 @@ class Header : public Serializable {
      * @brief Sets the packet length.
      * @param packet_length The total length of the packet in bytes.
      */
-    void set_packet_length(uint16_t packet_length);
+    void set_packet_length(uint32_t packet_length);
+
+    /**
+     * @brief Marks the payload of the packet as compressed or not.
+     * @param compressed Whether the payload is compressed.
+     */
+    void set_compressed(bool compressed);
 
    private:
    /**
-     * @brief The protocol version.
+     * @brief The protocol version, which also decides the layout of the header.
      */
-    uint8_t version;
+    uint8_t version = PROTOCOL_VERSION;
 
     /**
      * @brief The operation associated with this packet.
@@ -120,5 +198,10 @@ class Header : public Serializable {
     /**
      * @brief The total packet length in bytes.
      */
-    uint16_t packet_length;
+    uint32_t packet_length = 0;
+
+    /**
+     * @brief Whether the payload is compressed.
+     */
+    bool compressed = false;
 };
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+#include "message/payload.hpp"
+
+/**
+ * @class HelloMessage
+ * @brief Negotiates optional protocol features right after connecting.
+ *
+ * The client sends the features it supports as its first frame, and the server answers with the
+ * subset it agrees to use on the connection. Servers that predate the message ignore it, so the
+ * client never receives an answer and both sides keep to the base protocol.
+ */
+class HelloMessage : public Payload {
+   public:
+    /**
+     * @brief The peer accepts frames with compressed payloads.
+     */
+    static constexpr uint8_t FEATURE_COMPRESSION = 0x01;
+
+    /**
+     * @brief Default constructor.
+     */
+    HelloMessage() = default;
+
+    /**
+     * @brief Constructs a message offering or accepting a set of features.
+     * @param features A bitmask of FEATURE_ flags.
+     */
+    explicit HelloMessage(uint8_t features);
+
+    /**
+     * @brief Serializes the message into a byte buffer in the binary protocol.
+     * @param buf The vector to store the serialized data.
+     * @param version The protocol version to encode with.
+     */
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
+
+    /**
+     * @brief Serializes both the message and its header into a byte buffer.
+     * @param buf The vector to store the serialized header and message data.
+     * @param version The protocol version to encode with.
+     */
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
+
+    /**
+     * @brief Deserializes the message from a reader in the binary protocol.
+     * @param reader The reader positioned at the serialized data.
+     */
+    void deserialize_binary(ByteReader& reader) override;
+
+    /**
+     * @brief Converts the message to a JSON string representation.
+     * @return A JSON string representing the message.
+     */
+    [[nodiscard]] std::string to_json() const override;
+
+    /**
+     * @brief Populates the message from a JSON string.
+     * @param json The JSON string to deserialize.
+     */
+    void from_json(const std::string& json) override;
+
+    /**
+     * @brief Retrieves the size of the serialized message in the binary protocol.
+     * @param version The protocol version to encode with.
+     * @return The size of the serialized message in bytes.
+     */
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
+
+    /**
+     * @brief Retrieves the features offered or accepted.
+     * @return A bitmask of FEATURE_ flags.
+     */
+    [[nodiscard]] uint8_t get_features() const;
+
+    /**
+     * @brief Checks whether a feature is offered or accepted.
+     * @param feature One of the FEATURE_ flags.
+     * @return True if the feature is set.
+     */
+    [[nodiscard]] bool has_feature(uint8_t feature) const;
+
+   private:
+    /**
+     * @brief A bitmask of FEATURE_ flags.
+     */
+    uint8_t features = 0;
+};
@@ -2,7 +2,7 @@
 #include <stdint.h>
 #include <string>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 
 /**
  * @class ListAccountsMessage
@@ -11,9 +11,19 @@
  * This class is used to construct and process a request for listing user accounts.
  * It allows specifying a regular expression to filter the accounts and supports 
  * serialization and deserialization.
+ *
+ * Results are paginated: the request may cap the number of accounts returned and pass the
+ * cursor of the previous response to continue after it. Both fields follow the regex on the
+ * wire and may be omitted, in which case the first page of the default size is requested.
  */
-class ListAccountsMessage : public Serializable {
+class ListAccountsMessage : public Payload {
    public:
+    /**
+     * @brief The number of accounts returned when the request does not set a limit; it is also
+     * the most a single response can carry.
+     */
+    static constexpr uint8_t MAX_LIMIT = UINT8_MAX;
+
    /**
      * @brief Default constructor.
      */
@@ -26,10 +36,19 @@ class ListAccountsMessage : public Serializable {
     ListAccountsMessage(std::string regex);
 
     /**
-     * @brief Serializes the message into a byte buffer.
+     * @brief Constructs a message requesting one page of the accounts matching a regex pattern.
+     * @param regex A string representing the regex pattern to filter user accounts.
+     * @param limit The maximum number of accounts to return, or 0 for the server's default.
+     * @param cursor The cursor of the previous response, or an empty string for the first page.
+     */
+    ListAccountsMessage(std::string regex, uint8_t limit, std::string cursor);
+
+    /**
+     * @brief Serializes the message into a byte buffer in the binary protocol.
      * @param buf The vector to store the serialized data.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes both the message and its header into a byte buffer.
@@ -38,26 +57,27 @@ class ListAccountsMessage : public Serializable {
      * into a single byte buffer for transmission.
      *
      * @param buf The vector to store the serialized header and message data.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the message from a byte buffer.
-     * @param buf The vector containing the serialized data.
+     * @brief Deserializes the message from a reader in the binary protocol.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the message to a JSON string representation.
      * @return A JSON string representing the message.
      */
-    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string to_json() const override;
 
     /**
      * @brief Populates the message from a JSON string.
      * @param json The JSON string to deserialize.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
      * @brief Retrieves the regex pattern used for filtering accounts.
@@ -66,10 +86,23 @@ class ListAccountsMessage : public Serializable {
     [[nodiscard]] std::string get_regex() const;
 
     /**
-     * @brief Retrieves the size of the serialized message.
+     * @brief Retrieves the maximum number of accounts to return.
+     * @return The requested limit, or 0 if the server's default applies.
+     */
+    [[nodiscard]] uint8_t get_limit() const;
+
+    /**
+     * @brief Retrieves the cursor from which the results continue.
+     * @return The cursor of the previous response, or an empty string for the first page.
+     */
+    [[nodiscard]] std::string get_cursor() const;
+
+    /**
+     * @brief Retrieves the size of the serialized message in the binary protocol.
+     * @param version The protocol version to encode with.
      * @return The size of the serialized message in bytes.
      */
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     /**
      * @brief Sets a new regex pattern for filtering accounts.
@@ -77,9 +110,31 @@ class ListAccountsMessage : public Serializable {
      */
     void set_regex(std::string regex);
 
+    /**
+     * @brief Sets the maximum number of accounts to return.
+     * @param limit The maximum number of accounts, or 0 for the server's default.
+     */
+    void set_limit(uint8_t limit);
+
+    /**
+     * @brief Sets the cursor from which the results continue.
+     * @param cursor The cursor of the previous response, or an empty string for the first page.
+     */
+    void set_cursor(std::string cursor);
+
    private:
    /**
      * @brief The regex pattern used to filter user accounts.
      */
     std::string regex;
+
+    /**
+     * @brief The maximum number of accounts to return; 0 selects the server's default.
+     */
+    uint8_t limit = 0;
+
+    /**
+     * @brief The username after which the results continue; empty for the first page.
+     */
+    std::string cursor;
 };
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include <string>
 #include <variant>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 #include "models/user.hpp"
 
 /**
@@ -14,8 +14,11 @@
  * This class handles the response for a request to list user accounts. 
  * It stores either a list of user accounts on success or an error message 
  * on failure. The class supports serialization and deserialization.
+ *
+ * A successful response is one page of the results; unless it is the last page, it carries
+ * the cursor from which the next request continues.
  */
-class ListAccountsResponse : public Serializable {
+class ListAccountsResponse : public Payload {
    public:
    /**
      * @brief Default constructor.
@@ -28,6 +31,13 @@ class ListAccountsResponse : public Serializable {
      */
     ListAccountsResponse(std::vector<User::SharedPtr> data);
 
+    /**
+     * @brief Constructs a successful response containing one page of user accounts.
+     * @param data A vector of shared pointers to User objects.
+     * @param next_cursor The cursor of the next page, or std::nullopt if this is the last page.
+     */
+    ListAccountsResponse(std::vector<User::SharedPtr> data, std::optional<std::string> next_cursor);
+
     /**
      * @brief Constructs a response that can contain either user accounts or an error message.
      * @param data A variant that holds either a list of user accounts or an error message.
@@ -35,41 +45,44 @@ class ListAccountsResponse : public Serializable {
     ListAccountsResponse(std::variant<std::vector<User::SharedPtr>, std::string> data);
 
     /**
-     * @brief Serializes the response into a byte buffer.
+     * @brief Serializes the response into a byte buffer in the binary protocol.
      * @param buf The vector to store the serialized data.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes the message and the header together.
      * @param buf The vector to store the serialized message data.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the response from a byte buffer.
-     * @param buf The vector containing the serialized data.
+     * @brief Deserializes the response from a reader in the binary protocol.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the response to a JSON string representation.
      * @return A JSON string representing the response.
      */
-    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string to_json() const override;
 
     /**
      * @brief Populates the response from a JSON string.
      * @param json The JSON string to deserialize.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
-     * @brief Retrieves the size of the serialized response.
+     * @brief Retrieves the size of the serialized response in the binary protocol.
+     * @param version The protocol version to encode with.
      * @return The size of the serialized response in bytes.
      */
 
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     /**
      * @brief Checks whether the response indicates a successful account retrieval.
@@ -89,9 +102,20 @@ class ListAccountsResponse : public Serializable {
      */
     [[nodiscard]] std::optional<std::vector<User::SharedPtr>> get_users();
 
+    /**
+     * @brief Retrieves the cursor from which the next page of accounts continues.
+     * @return An optional string containing the cursor, or std::nullopt if this is the last page.
+     */
+    [[nodiscard]] std::optional<std::string> get_next_cursor() const;
+
    private:
    /**
      * @brief Holds either a list of user accounts on success or an error message on failure.
      */
     std::variant<std::vector<User::SharedPtr>, std::string> data;
+
+    /**
+     * @brief The cursor of the next page; empty on the last page.
+     */
+    std::string next_cursor;
 };
\ No newline at end of file
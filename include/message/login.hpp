@@ -3,7 +3,7 @@
 #include <string>
 #include <vector>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 
 /**
  * @class LoginMessage
@@ -12,7 +12,7 @@
  * This class encapsulates the username and password required for logging in.
  * It provides functionality to serialize/deserialize the data into both binary and JSON formats.
  */
-class LoginMessage : public Serializable {
+class LoginMessage : public Payload {
    public:
     /**
      * @brief Default constructor.
@@ -30,14 +30,15 @@ class LoginMessage : public Serializable {
     LoginMessage(std::string username, std::string password);
 
     /**
-     * @brief Serializes the LoginMessage into a binary buffer.
+     * @brief Serializes the LoginMessage into a byte buffer in the binary protocol.
      *
      * Converts the complete LoginMessage (including metadata if any) into a binary format
      * and appends it to the provided buffer.
      *
      * @param buf The buffer to which the serialized data is appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes the core message payload into a binary buffer.
@@ -46,17 +47,18 @@ class LoginMessage : public Serializable {
      * into a binary format and appends it to the provided buffer.
      *
      * @param buf The buffer to which the serialized message payload is appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the LoginMessage from a binary buffer.
+     * @brief Deserializes the LoginMessage from a reader in the binary protocol.
      *
-     * Reads the binary data from the provided buffer to reconstruct the LoginMessage object.
+     * Reads the binary data from the provided reader to reconstruct the LoginMessage object.
      *
-     * @param buf The buffer containing the serialized LoginMessage.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the LoginMessage to a JSON string.
@@ -65,7 +67,7 @@ class LoginMessage : public Serializable {
      *
      * @return A JSON string representing the LoginMessage.
      */
-    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string to_json() const override;
 
     /**
      * @brief Populates the LoginMessage from a JSON string.
@@ -75,16 +77,17 @@ class LoginMessage : public Serializable {
      *
      * @param json A JSON string representing the LoginMessage.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
-     * @brief Retrieves the size in bytes of the serialized LoginMessage.
+     * @brief Retrieves the size in bytes of the serialized LoginMessage in the binary protocol.
      *
      * Calculates the size of the LoginMessage when it is serialized into a binary format.
      *
+     * @param version The protocol version to encode with.
      * @return The size in bytes of the serialized LoginMessage.
      */
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     /**
      * @brief Retrieves the username.
@@ -4,7 +4,7 @@
 #include <string>
 #include <variant>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 #include "models/user.hpp"
 
 /**
@@ -15,7 +15,7 @@
  * (on success) or an error message string (on failure). It implements the Serializable interface
  * for converting the response to/from binary and JSON formats.
  */
-class LoginResponse : public Serializable {
+class LoginResponse : public Payload {
     public:
         /**
          * @brief Default constructor.
@@ -32,14 +32,15 @@ class LoginResponse : public Serializable {
         LoginResponse(std::variant<User::SharedPtr, std::string> data);
     
         /**
-         * @brief Serializes the LoginResponse into a binary buffer.
+         * @brief Serializes the LoginResponse into a byte buffer in the binary protocol.
          *
          * Converts the internal state of the LoginResponse into a binary representation and appends it to
          * the provided buffer.
          *
          * @param buf The buffer to which the serialized data is appended.
+         * @param version The protocol version to encode with.
          */
-        void serialize(std::vector<uint8_t>& buf) const override;
+        void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
     
         /**
          * @brief Serializes the core message payload into a binary buffer.
@@ -49,18 +50,19 @@ class LoginResponse : public Serializable {
          * serialization performed by serialize().
          *
          * @param buf The buffer to which the serialized message is appended.
+         * @param version The protocol version to encode with.
          */
-        void serialize_msg(std::vector<uint8_t>& buf) const;
+        void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
     
         /**
-         * @brief Deserializes the LoginResponse from a binary buffer.
+         * @brief Deserializes the LoginResponse from a reader in the binary protocol.
          *
-         * Reads the binary representation from the provided buffer to reconstruct the state of the
+         * Reads the binary representation from the provided reader to reconstruct the state of the
          * LoginResponse.
          *
-         * @param buf The binary buffer containing the serialized LoginResponse.
+         * @param reader The reader positioned at the serialized data.
          */
-        void deserialize(const std::vector<uint8_t>& buf) override;
+        void deserialize_binary(ByteReader& reader) override;
     
         /**
          * @brief Converts the LoginResponse to a JSON string.
@@ -69,7 +71,7 @@ class LoginResponse : public Serializable {
          *
          * @return A JSON string representing the LoginResponse.
          */
-        [[nodiscard]] std::string to_json() const;
+        [[nodiscard]] std::string to_json() const override;
     
         /**
          * @brief Populates the LoginResponse from a JSON string.
@@ -78,16 +80,17 @@ class LoginResponse : public Serializable {
          *
          * @param json A JSON string representing the LoginResponse.
          */
-        void from_json(const std::string& json);
+        void from_json(const std::string& json) override;
     
         /**
-         * @brief Retrieves the size of the serialized LoginResponse.
+         * @brief Retrieves the size of the serialized LoginResponse in the binary protocol.
          *
          * Computes and returns the size in bytes of the LoginResponse when it is serialized.
          *
+         * @param version The protocol version to encode with.
          * @return The size in bytes of the serialized LoginResponse.
          */
-        [[nodiscard]] size_t size() const;
+        [[nodiscard]] size_t binary_size(uint8_t version) const override;
     
         /**
          * @brief Indicates whether the login attempt was successful.
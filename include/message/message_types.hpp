@@ -0,0 +1,85 @@
+#pragma once
+#include <optional>
+#include <tuple>
+#include <type_traits>
+
+#include "message/create_channel.hpp"
+#include "message/create_channel_response.hpp"
+#include "message/delete_account.hpp"
+#include "message/delete_account_response.hpp"
+#include "message/delete_message.hpp"
+#include "message/delete_message_response.hpp"
+#include "message/fetch_history.hpp"
+#include "message/fetch_history_response.hpp"
+#include "message/header.hpp"
+#include "message/hello.hpp"
+#include "message/list_accounts.hpp"
+#include "message/list_accounts_response.hpp"
+#include "message/login.hpp"
+#include "message/login_response.hpp"
+#include "message/register_account.hpp"
+#include "message/register_account_response.hpp"
+#include "message/send_message.hpp"
+#include "message/send_message_response.hpp"
+#include "message/sync.hpp"
+#include "message/sync_response.hpp"
+
+/**
+ * @brief The number of operations, one past the last value of the Operation enum.
+ */
+constexpr size_t NUM_OPERATIONS = Operation::HELLO + 1;
+
+/**
+ * @brief Ties an operation to the payload a client sends and the one the server answers with.
+ *
+ * @tparam OP The operation in the header of both frames.
+ * @tparam REQUEST The payload sent by the client.
+ * @tparam RESPONSE The payload sent by the server.
+ */
+template <Operation OP, typename REQUEST, typename RESPONSE>
+struct MessageType {
+    static constexpr Operation OPERATION = OP;
+    using Request = REQUEST;
+    using Response = RESPONSE;
+};
+
+/**
+ * @brief Every operation that is implemented, with its payloads.
+ *
+ * The client and the server build their dispatch tables from this list, so adding an operation
+ * here is all it takes for its frames to be decoded on both sides.
+ */
+using MessageTypes =
+    std::tuple<MessageType<REGISTER_ACCOUNT, RegisterAccountMessage, RegisterAccountResponse>,
+               MessageType<LOGIN, LoginMessage, LoginResponse>,
+               MessageType<LIST_ACCOUNTS, ListAccountsMessage, ListAccountsResponse>,
+               MessageType<DELETE_ACCOUNT, DeleteAccountMessage, DeleteAccountResponse>,
+               MessageType<SEND_MESSAGE, SendMessageMessage, SendMessageResponse>,
+               MessageType<DELETE_MESSAGE, DeleteMessageMessage, DeleteMessageResponse>,
+               MessageType<CREATE_CHANNEL, CreateChannelMessage, CreateChannelResponse>,
+               MessageType<SYNC, SyncMessage, SyncResponse>,
+               MessageType<FETCH_HISTORY, FetchHistoryMessage, FetchHistoryResponse>,
+               MessageType<HELLO, HelloMessage, HelloMessage>>;
+
+namespace message_types {
+
+template <typename T, typename... Types>
+constexpr std::optional<Operation> find_operation(const std::tuple<Types...>*) {
+    std::optional<Operation> operation;
+    ((std::is_same_v<T, typename Types::Request> || std::is_same_v<T, typename Types::Response>
+          ? void(operation = Types::OPERATION)
+          : void()),
+     ...);
+    return operation;
+}
+
+}  // namespace message_types
+
+/**
+ * @brief The operation a request or response payload is sent with, if it is in MessageTypes.
+ *
+ * @tparam T The payload type.
+ */
+template <typename T>
+inline constexpr std::optional<Operation> OPERATION_OF =
+    message_types::find_operation<T>(static_cast<const MessageTypes*>(nullptr));
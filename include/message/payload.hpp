@@ -0,0 +1,87 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "message/codec.hpp"
+#include "message/serialize.hpp"
+
+/**
+ * @class Payload
+ * @brief A Serializable that can be carried in a frame in every protocol version.
+ *
+ * Payloads describe themselves twice: as a sequence of binary fields and as a JSON object. Which
+ * of the two ends up on the wire is up to the Codec of the version being spoken, so serialize(),
+ * deserialize() and size() take the version and leave the choice to Codec::for_version().
+ * Derived classes implement the binary layout and the JSON conversion.
+ *
+ * Objects nested in a binary payload are encoded in binary as well, so derived classes call the
+ * binary methods of their members directly.
+ */
+class Payload : public Serializable {
+   public:
+    using Serializable::deserialize;
+    using Serializable::serialize;
+    using Serializable::size;
+
+    /**
+     * @brief Serializes the payload with the codec of a protocol version.
+     * @param buf The byte buffer where the serialized data will be appended.
+     * @param version The protocol version to encode with.
+     */
+    void serialize(std::vector<uint8_t>& buf, uint8_t version) const final {
+        Codec::for_version(version).encode(*this, buf);
+    }
+
+    /**
+     * @brief Deserializes the payload with the codec of the reader's protocol version.
+     * @param reader The reader positioned at the serialized data.
+     */
+    void deserialize(ByteReader& reader) final {
+        Codec::for_version(reader.get_version()).decode(*this, reader);
+    }
+
+    /**
+     * @brief Gets the size of the payload serialized with the codec of a protocol version.
+     * @param version The protocol version to encode with.
+     * @return The size in bytes of the serialized payload.
+     */
+    [[nodiscard]] size_t size(uint8_t version) const final {
+        return Codec::for_version(version).size(*this);
+    }
+
+    /**
+     * @brief Appends the fields of the payload in a binary protocol.
+     * @param buf The byte buffer where the serialized data will be appended.
+     * @param version The binary protocol version to encode with.
+     */
+    virtual void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const = 0;
+
+    /**
+     * @brief Reads the fields of the payload in a binary protocol.
+     *
+     * Reads exactly the bytes produced by serialize_binary() and advances the reader past them.
+     *
+     * @param reader The reader positioned at the serialized data.
+     */
+    virtual void deserialize_binary(ByteReader& reader) = 0;
+
+    /**
+     * @brief Gets the number of bytes serialize_binary() appends.
+     * @param version The binary protocol version to encode with.
+     * @return The size in bytes of the serialized payload.
+     */
+    [[nodiscard]] virtual size_t binary_size(uint8_t version) const = 0;
+
+    /**
+     * @brief Converts the payload to a JSON string.
+     * @return A JSON string representing the payload.
+     */
+    [[nodiscard]] virtual std::string to_json() const = 0;
+
+    /**
+     * @brief Populates the payload from a JSON string.
+     * @param json A JSON string representing the payload.
+     */
+    virtual void from_json(const std::string& json) = 0;
+};
@@ -3,7 +3,7 @@
 #include <string>
 #include <vector>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 
 /**
  * @brief Represents a registration account message.
@@ -11,7 +11,7 @@
  * This class encapsulates the information required to register a new account.
  * It includes methods for serialization, deserialization, and conversion to/from JSON.
  */
-class RegisterAccountMessage : public Serializable {
+class RegisterAccountMessage : public Payload {
    public:
     /**
      * @brief Default constructor.
@@ -30,13 +30,14 @@ class RegisterAccountMessage : public Serializable {
     RegisterAccountMessage(std::string username, std::string password, std::string display_name);
 
     /**
-     * @brief Serializes the object into a byte buffer.
+     * @brief Serializes the object into a byte buffer in the binary protocol.
      *
      * Converts the current state of the object into a sequence of bytes and appends them to the provided buffer.
      *
      * @param buf The byte buffer where the serialized data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes the message-specific data into a byte buffer.
@@ -44,17 +45,18 @@ class RegisterAccountMessage : public Serializable {
      * Converts the registration fields into a sequence of bytes and appends them to the provided buffer.
      *
      * @param buf The byte buffer where the serialized message data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the object from a byte buffer.
+     * @brief Deserializes the object from a reader in the binary protocol.
      *
-     * Reads data from the provided byte buffer to restore the object's state.
+     * Reads data from the provided reader to restore the object's state.
      *
-     * @param buf The byte buffer containing the serialized data.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the object to a JSON string.
@@ -63,7 +65,7 @@ class RegisterAccountMessage : public Serializable {
      *
      * @return A JSON string representing the object.
      */
-    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string to_json() const override;
 
     /**
      * @brief Updates the object's state from a JSON string.
@@ -72,16 +74,17 @@ class RegisterAccountMessage : public Serializable {
      *
      * @param json A JSON string representing the object.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
-     * @brief Gets the size of the serialized object.
+     * @brief Gets the size of the serialized object in the binary protocol.
      *
      * Calculates and returns the number of bytes that would be produced by serializing the object.
      *
+     * @param version The protocol version to encode with.
      * @return The size in bytes of the serialized object.
      */
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     /**
      * @brief Retrieves the username.
@@ -4,7 +4,7 @@
 #include <string>
 #include <variant>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 
 /**
  * @brief Represents the response to a register account request.
@@ -13,7 +13,7 @@
  * registration was successful (when no error message is set) or failed (when an error message is present).
  * The class supports serialization to and from both a byte buffer and JSON format.
  */
-class RegisterAccountResponse : public Serializable {
+class RegisterAccountResponse : public Payload {
    public:
     /**
      * @brief Default constructor.
@@ -32,14 +32,15 @@ class RegisterAccountResponse : public Serializable {
     RegisterAccountResponse(std::variant<std::monostate, std::string> error_message);
 
     /**
-     * @brief Serializes the object into a byte buffer.
+     * @brief Serializes the object into a byte buffer in the binary protocol.
      *
      * This method overrides the base class serialize method and writes the current state of the 
      * object into the provided buffer.
      *
      * @param buf The byte buffer where the serialized data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes the message into a byte buffer.
@@ -47,17 +48,18 @@ class RegisterAccountResponse : public Serializable {
      * This function specifically serializes the message part of the object into the provided buffer.
      *
      * @param buf The byte buffer where the serialized message will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the object from a byte buffer.
+     * @brief Deserializes the object from a reader in the binary protocol.
      *
      * Reads the object's state from the provided buffer, restoring its previous state.
      *
-     * @param buf The byte buffer containing the serialized object data.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the object to a JSON string.
@@ -66,7 +68,7 @@ class RegisterAccountResponse : public Serializable {
      *
      * @return A string containing the JSON representation.
      */
-    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string to_json() const override;
 
     /**
      * @brief Sets the object's state from a JSON string.
@@ -75,16 +77,17 @@ class RegisterAccountResponse : public Serializable {
      *
      * @param json A string containing the JSON representation of a RegisterAccountResponse.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
-     * @brief Gets the size of the serialized object.
+     * @brief Gets the size of the serialized object in the binary protocol.
      *
      * Calculates and returns the number of bytes that would be produced by serializing the object.
      *
+     * @param version The protocol version to encode with.
      * @return The size in bytes of the serialized object.
      */
-    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     /**
      * @brief Checks if the registration was successful.
@@ -3,7 +3,7 @@
 #include <string>
 #include <vector>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 #include "models/uuid.hpp"
 
 /**
@@ -13,7 +13,7 @@
  * of both the channel and the sender, as well as the message text. It supports serialization to
  * and from byte buffers as well as conversion to and from JSON.
  */
-class SendMessageMessage : public Serializable {
+class SendMessageMessage : public Payload {
    public:
     /**
      * @brief Default constructor.
@@ -32,14 +32,15 @@ class SendMessageMessage : public Serializable {
     SendMessageMessage(UUID channel_uid, UUID sender_uid, std::string text);
 
     /**
-     * @brief Serializes the object into a byte buffer.
+     * @brief Serializes the object into a byte buffer in the binary protocol.
      *
      * Serializes the current state of the object and appends the resulting bytes
      * to the provided buffer.
      *
      * @param buf The byte buffer where the serialized data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes the message-specific data into a byte buffer.
@@ -48,17 +49,18 @@ class SendMessageMessage : public Serializable {
      * into the provided byte buffer.
      *
      * @param buf The byte buffer where the serialized message data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the object from a byte buffer.
+     * @brief Deserializes the object from a reader in the binary protocol.
      *
-     * Reads data from the provided byte buffer to restore the object's state.
+     * Reads data from the provided reader to restore the object's state.
      *
-     * @param buf The byte buffer containing the serialized data.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the object to a JSON string.
@@ -67,7 +69,7 @@ class SendMessageMessage : public Serializable {
      *
      * @return A JSON string representing the object.
      */
-    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string to_json() const override;
 
     /**
      * @brief Updates the object's state from a JSON string.
@@ -76,7 +78,7 @@ class SendMessageMessage : public Serializable {
      *
      * @param json A JSON string representing the object.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
      * @brief Retrieves the text content of the message.
@@ -100,13 +102,14 @@ class SendMessageMessage : public Serializable {
     [[nodiscard]] UUID get_channel_uid() const;
 
     /**
-     * @brief Gets the size of the serialized object.
+     * @brief Gets the size of the serialized object in the binary protocol.
      *
      * Calculates and returns the number of bytes that would be produced by serializing the object.
      *
+     * @param version The protocol version to encode with.
      * @return The size in bytes of the serialized object.
      */
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     /**
      * @brief Sets a regular expression pattern.
@@ -1,9 +1,10 @@
+#pragma once
 #include <optional>
 #include <string>
 #include <variant>
 #include <vector>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 #include "models/message.hpp"
 
 /**
@@ -14,7 +15,7 @@
  * an error message (indicating failure). The class provides functionality for serialization
  * and deserialization to/from byte buffers as well as conversion to/from JSON.
  */
-class SendMessageResponse : public Serializable {
+class SendMessageResponse : public Payload {
    public:
     /**
      * @brief Default constructor.
@@ -32,14 +33,15 @@ class SendMessageResponse : public Serializable {
     SendMessageResponse(std::variant<Message::SharedPtr, std::string> data);
 
     /**
-     * @brief Serializes the object into a byte buffer.
+     * @brief Serializes the object into a byte buffer in the binary protocol.
      *
      * Serializes the current state of the object and appends the resulting bytes
      * to the provided buffer.
      *
      * @param buf The byte buffer where the serialized data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes the message-specific data into a byte buffer.
@@ -47,17 +49,18 @@ class SendMessageResponse : public Serializable {
      * Serializes only the message-related portion of the object into the provided byte buffer.
      *
      * @param buf The byte buffer where the serialized message data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the object from a byte buffer.
+     * @brief Deserializes the object from a reader in the binary protocol.
      *
-     * Reads data from the provided byte buffer to restore the object's state.
+     * Reads data from the provided reader to restore the object's state.
      *
-     * @param buf The byte buffer containing the serialized data.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf);
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the object to a JSON string.
@@ -66,7 +69,7 @@ class SendMessageResponse : public Serializable {
      *
      * @return A JSON string representing the object.
      */
-    [[nodiscard]] std::string to_json() const;
+    [[nodiscard]] std::string to_json() const override;
 
     /**
      * @brief Updates the object's state from a JSON string.
@@ -75,16 +78,17 @@ class SendMessageResponse : public Serializable {
      *
      * @param json A JSON string representing the object.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
-     * @brief Gets the size of the serialized object.
+     * @brief Gets the size of the serialized object in the binary protocol.
      *
      * Calculates and returns the number of bytes that would be produced by serializing the object.
      *
+     * @param version The protocol version to encode with.
      * @return The size in bytes of the serialized object.
      */
-    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     /**
      * @brief Determines if the send message operation was successful.
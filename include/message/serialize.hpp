@@ -1,14 +1,26 @@
 #pragma once
 #include <stdint.h>
 #include <cstddef>
+#include <span>
 #include <vector>
 
+#include "constants.hpp"
+#include "message/byte_reader.hpp"
+
 /**
  * @brief An abstract interface for serializable objects.
  *
  * This class defines the interface for objects that can be serialized to and deserialized from a byte buffer.
  * All classes inheriting from Serializable must implement methods for serialization, deserialization,
  * and for obtaining the size of the serialized data.
+ *
+ * Encodings may differ between protocol versions, so serialization and size take the version to
+ * encode with, and readers carry the version they decode. The overloads without a version use the
+ * default PROTOCOL_VERSION; derived classes bring them into scope with
+ * `using Serializable::serialize` and `using Serializable::size`.
+ *
+ * Objects carried in the body of a frame derive from Payload, which leaves the choice between the
+ * binary and the JSON encoding to the Codec of the version.
  */
 class Serializable {
    public:
@@ -26,24 +38,60 @@ class Serializable {
      * Converts the current state of the object into a sequence of bytes and appends the data to the provided buffer.
      *
      * @param buf The byte buffer where the serialized data will be appended.
+     * @param version The protocol version to encode with.
      */
-    virtual void serialize(std::vector<uint8_t>& buf) const = 0;
+    virtual void serialize(std::vector<uint8_t>& buf, uint8_t version) const = 0;
+
+    /**
+     * @brief Serializes the object into a byte buffer with the default protocol version.
+     *
+     * @param buf The byte buffer where the serialized data will be appended.
+     */
+    void serialize(std::vector<uint8_t>& buf) const {
+        serialize(buf, PROTOCOL_VERSION);
+    }
 
     /**
      * @brief Deserializes the object from a byte buffer.
      *
-     * Reads data from the provided byte buffer and restores the object's state.
+     * Reads data from the provided byte buffer and restores the object's state. This is a
+     * convenience wrapper around deserialize(ByteReader&); derived classes bring it into scope with
+     * `using Serializable::deserialize`.
      *
      * @param buf The byte buffer containing the serialized data.
+     * @param version The protocol version the buffer was encoded with.
+     */
+    void deserialize(std::span<const uint8_t> buf, uint8_t version = PROTOCOL_VERSION) {
+        ByteReader reader(buf, version);
+        deserialize(reader);
+    }
+
+    /**
+     * @brief Deserializes the object in place from a reader.
+     *
+     * Reads exactly the bytes produced by serialize() and advances the reader past them, so that
+     * objects nested in a larger buffer can be decoded one after the other without copying.
+     *
+     * @param reader The reader positioned at the serialized data.
      */
-    virtual void deserialize(const std::vector<uint8_t>& buf) = 0;
+    virtual void deserialize(ByteReader& reader) = 0;
 
     /**
      * @brief Gets the size of the serialized object.
      *
      * Calculates and returns the number of bytes that would be produced by serializing the object.
      *
+     * @param version The protocol version to encode with.
+     * @return The size in bytes of the serialized object.
+     */
+    virtual size_t size(uint8_t version) const = 0;
+
+    /**
+     * @brief Gets the size of the object serialized with the default protocol version.
+     *
      * @return The size in bytes of the serialized object.
      */
-    virtual size_t size() const = 0;
+    size_t size() const {
+        return size(PROTOCOL_VERSION);
+    }
 };
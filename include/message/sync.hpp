@@ -0,0 +1,109 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+#include "message/payload.hpp"
+
+/**
+ * @class SyncMessage
+ * @brief Represents a request for the channels and message history of the logged-in user.
+ *
+ * History is downloaded in pages. The first request of a sync starts at channel offset 0 and at
+ * the newest snowflake the client already holds, or 0 if it holds none; every response carries
+ * the offset and watermark from which the next request continues. A reconnecting client
+ * therefore only downloads the messages sent while it was away.
+ */
+class SyncMessage : public Payload {
+   public:
+    /**
+     * @brief The number of messages returned when the request does not set a limit; it is also
+     * the most a single response will carry.
+     */
+    static constexpr uint16_t MAX_LIMIT = 1024;
+
+    /**
+     * @brief Default constructor.
+     */
+    SyncMessage() = default;
+
+    /**
+     * @brief Constructs a request for one page of channels and messages.
+     * @param since The snowflake after which messages are returned; 0 requests the whole history.
+     * @param channel_offset The number of the user's channels already received.
+     * @param limit The maximum number of messages to return, or 0 for the server's default.
+     */
+    SyncMessage(uint64_t since, uint32_t channel_offset, uint16_t limit = 0);
+
+    /**
+     * @brief Serializes the message into a byte buffer in the binary protocol.
+     * @param buf The vector to store the serialized data.
+     * @param version The protocol version to encode with.
+     */
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
+
+    /**
+     * @brief Serializes both the message and its header into a byte buffer.
+     * @param buf The vector to store the serialized header and message data.
+     * @param version The protocol version to encode with.
+     */
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
+
+    /**
+     * @brief Deserializes the message from a reader in the binary protocol.
+     * @param reader The reader positioned at the serialized data.
+     */
+    void deserialize_binary(ByteReader& reader) override;
+
+    /**
+     * @brief Converts the message to a JSON string representation.
+     * @return A JSON string representing the message.
+     */
+    [[nodiscard]] std::string to_json() const override;
+
+    /**
+     * @brief Populates the message from a JSON string.
+     * @param json The JSON string to deserialize.
+     */
+    void from_json(const std::string& json) override;
+
+    /**
+     * @brief Retrieves the size of the serialized message in the binary protocol.
+     * @param version The protocol version to encode with.
+     * @return The size of the serialized message in bytes.
+     */
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
+
+    /**
+     * @brief Retrieves the watermark after which messages are returned.
+     * @return The snowflake of the newest message the client holds, or 0.
+     */
+    [[nodiscard]] uint64_t get_since() const;
+
+    /**
+     * @brief Retrieves the number of the user's channels already received.
+     * @return The channel offset.
+     */
+    [[nodiscard]] uint32_t get_channel_offset() const;
+
+    /**
+     * @brief Retrieves the maximum number of messages to return.
+     * @return The requested limit, or 0 if the server's default applies.
+     */
+    [[nodiscard]] uint16_t get_limit() const;
+
+   private:
+    /**
+     * @brief The snowflake after which messages are returned.
+     */
+    uint64_t since = 0;
+
+    /**
+     * @brief The number of the user's channels already received.
+     */
+    uint32_t channel_offset = 0;
+
+    /**
+     * @brief The maximum number of messages to return; 0 selects the server's default.
+     */
+    uint16_t limit = 0;
+};
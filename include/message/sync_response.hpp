@@ -0,0 +1,153 @@
+#pragma once
+#include <stdint.h>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "message/payload.hpp"
+#include "models/channel.hpp"
+#include "models/message.hpp"
+
+/**
+ * @brief One page of channels and messages returned to a SyncMessage.
+ */
+struct SyncBatch {
+    /// The channels of the page, without their message lists.
+    std::vector<Channel::SharedPtr> channels;
+    /// The messages of the page, in snowflake order.
+    std::vector<Message::SharedPtr> messages;
+    /// The watermark from which the next page continues.
+    uint64_t next_since = 0;
+    /// The channel offset from which the next page continues.
+    uint32_t next_channel_offset = 0;
+    /// Whether another page follows.
+    bool has_more = false;
+};
+
+/**
+ * @class SyncResponse
+ * @brief Represents one page of the channels and message history of the logged-in user.
+ *
+ * A page packs as many channels and messages as fit in a single frame. Channels come first, so
+ * the client knows every channel before any of its messages arrive; they carry only their
+ * metadata, since the messages follow. Unless it is the last page, the response carries the
+ * channel offset and watermark from which the next SyncMessage continues.
+ */
+class SyncResponse : public Payload {
+   public:
+    /**
+     * @brief The contents of a successful response.
+     */
+    using Batch = SyncBatch;
+
+    /**
+     * @brief Default constructor.
+     */
+    SyncResponse() = default;
+
+    /**
+     * @brief Constructs a response that can contain either a page or an error message.
+     * @param data A variant that holds either a page or an error message.
+     */
+    SyncResponse(std::variant<Batch, std::string> data);
+
+    /**
+     * @brief Serializes the response into a byte buffer in the binary protocol.
+     * @param buf The vector to store the serialized data.
+     * @param version The protocol version to encode with.
+     */
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
+
+    /**
+     * @brief Serializes the message and the header together.
+     * @param buf The vector to store the serialized message data.
+     * @param version The protocol version to encode with.
+     */
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
+
+    /**
+     * @brief Deserializes the response from a reader in the binary protocol.
+     * @param reader The reader positioned at the serialized data.
+     */
+    void deserialize_binary(ByteReader& reader) override;
+
+    /**
+     * @brief Converts the response to a JSON string representation.
+     * @return A JSON string representing the response.
+     */
+    [[nodiscard]] std::string to_json() const override;
+
+    /**
+     * @brief Populates the response from a JSON string.
+     * @param json The JSON string to deserialize.
+     */
+    void from_json(const std::string& json) override;
+
+    /**
+     * @brief Retrieves the size of the serialized response in the binary protocol.
+     * @param version The protocol version to encode with.
+     * @return The size of the serialized response in bytes.
+     */
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
+
+    /**
+     * @brief Gets the largest response that fits in a frame.
+     * @param version The protocol version to encode with.
+     * @return The largest size of a response in bytes.
+     */
+    [[nodiscard]] static size_t max_size(uint8_t version = PROTOCOL_VERSION);
+
+    /**
+     * @brief Gets the size of a successful response with no channels or messages.
+     *
+     * Together with entry_size, this lets a page be filled up to max_size without serializing
+     * it more than once.
+     *
+     * @param version The protocol version to encode with.
+     * @return An upper bound on the size of an empty page.
+     */
+    [[nodiscard]] static size_t empty_size(uint8_t version = PROTOCOL_VERSION);
+
+    /**
+     * @brief Gets the number of bytes a channel adds to a response.
+     * @param channel The channel.
+     * @param version The protocol version to encode with.
+     * @return The size of the channel in the response.
+     */
+    [[nodiscard]] static size_t entry_size(const Channel::SharedPtr& channel,
+                                           uint8_t version = PROTOCOL_VERSION);
+
+    /**
+     * @brief Gets the number of bytes a message adds to a response.
+     * @param message The message.
+     * @param version The protocol version to encode with.
+     * @return The size of the message in the response.
+     */
+    [[nodiscard]] static size_t entry_size(const Message::SharedPtr& message,
+                                           uint8_t version = PROTOCOL_VERSION);
+
+    /**
+     * @brief Checks whether the response holds a page.
+     * @return True if the response holds a page, false if it contains an error message.
+     */
+    [[nodiscard]] bool is_success() const;
+
+    /**
+     * @brief Retrieves the error message if the response indicates a failure.
+     * @return An optional string containing the error message, or std::nullopt if successful.
+     */
+    [[nodiscard]] std::optional<std::string> get_error_message() const;
+
+    /**
+     * @brief Retrieves the page if the response is successful.
+     * @return An optional containing the page, or std::nullopt if an error occurred.
+     */
+    [[nodiscard]] std::optional<Batch> get_batch() const;
+
+   private:
+    /**
+     * @brief Holds either a page on success or an error message on failure.
+     */
+    std::variant<Batch, std::string> data;
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "constants.hpp"
+
+/**
+ * @file wire_format.hpp
+ * @brief Writers for the fields whose encoding depends on the protocol version.
+ *
+ * The original binary protocol prefixes strings and lists with a fixed-width length, usually a
+ * single byte, which silently wraps around for anything longer. The varint protocol prefixes them
+ * with a LEB128 varint instead, which takes a single byte below 128 and grows as needed. These
+ * functions are the writing counterparts of ByteReader::read_length() and
+ * ByteReader::read_prefixed_string().
+ */
+
+/**
+ * @brief Gets the number of bytes a varint takes.
+ * @param value The integer.
+ * @return The size of its encoding, between 1 and 10 bytes.
+ */
+inline size_t varint_size(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+/**
+ * @brief Appends an unsigned LEB128 varint: seven bits per byte, least significant first, with the
+ * high bit set on every byte but the last.
+ * @param buf The buffer to append to.
+ * @param value The integer.
+ */
+inline void write_varint(std::vector<uint8_t>& buf, uint64_t value) {
+    while (value >= 0x80) {
+        buf.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buf.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+ * @brief Appends a 64-bit integer in network byte order.
+ * @param buf The buffer to append to.
+ * @param value The integer.
+ */
+inline void write_u64_be(std::vector<uint8_t>& buf, uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        buf.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+/**
+ * @brief Appends the length of a string or the number of entries in a list.
+ *
+ * Versions without varints truncate the length to its legacy width, as they always have.
+ *
+ * @param buf The buffer to append to.
+ * @param length The length.
+ * @param version The protocol version to encode with.
+ * @param legacy_width The width of the field in bytes, in versions without varints.
+ */
+inline void write_length(std::vector<uint8_t>& buf, uint64_t length, uint8_t version,
+                         size_t legacy_width = 1) {
+    if (version == PROTOCOL_VERSION_VARINT) {
+        write_varint(buf, length);
+        return;
+    }
+    for (size_t i = legacy_width; i > 0; i--) {
+        buf.push_back(static_cast<uint8_t>(length >> (8 * (i - 1))));
+    }
+}
+
+/**
+ * @brief Gets the number of bytes write_length() appends.
+ * @param length The length.
+ * @param version The protocol version to encode with.
+ * @param legacy_width The width of the field in bytes, in versions without varints.
+ * @return The size of the encoded length.
+ */
+inline size_t length_size(uint64_t length, uint8_t version, size_t legacy_width = 1) {
+    return version == PROTOCOL_VERSION_VARINT ? varint_size(length) : legacy_width;
+}
+
+/**
+ * @brief Appends text prefixed by its length.
+ * @param buf The buffer to append to.
+ * @param text The text.
+ * @param version The protocol version to encode with.
+ */
+inline void write_prefixed_string(std::vector<uint8_t>& buf, std::string_view text,
+                                  uint8_t version) {
+    write_length(buf, text.size(), version);
+    buf.insert(buf.end(), text.begin(), text.end());
+}
+
+/**
+ * @brief Gets the number of bytes write_prefixed_string() appends.
+ * @param text The text.
+ * @param version The protocol version to encode with.
+ * @return The size of the encoded text.
+ */
+inline size_t prefixed_string_size(std::string_view text, uint8_t version) {
+    return length_size(text.size(), version) + text.size();
+}
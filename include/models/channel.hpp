@@ -5,7 +5,8 @@
 #include <string>
 #include <vector>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
+#include "models/published.hpp"
 #include "models/uuid.hpp"
 
 /**
@@ -14,8 +15,13 @@
  * The Channel class encapsulates information about a communication channel, including its unique identifier,
  * name, associated user IDs, and message identifiers (snowflakes). It provides functionality for serialization,
  * JSON conversion, and thread-safe updates.
+ *
+ * The UUID never changes once the channel is shared. The name and members are published as one
+ * immutable version, so reading them takes no lock and sees a consistent pair. The message index
+ * changes with every message sent to the channel, which would make copying it on each write too
+ * costly, so it is guarded by a mutex instead and read through copies.
  */
-class Channel : public Serializable {
+class Channel : public Payload {
    public:
     /**
      * @brief Shared pointer type for Channel.
@@ -38,22 +44,34 @@ class Channel : public Serializable {
     Channel(std::string name, std::vector<UUID> user_uids);
 
     /**
-     * @brief Serializes the Channel object into a byte buffer.
+     * @brief Reconstructs a Channel that was created earlier, such as one read back from disk.
+     *
+     * @param uid The unique identifier of the channel.
+     * @param name The name of the channel.
+     * @param user_uids A vector of UUIDs representing the users associated with the channel.
+     * @param message_snowflakes The identifiers of the messages in the channel, oldest first.
+     */
+    Channel(UUID uid, std::string name, std::vector<UUID> user_uids,
+            std::vector<uint64_t> message_snowflakes = {});
+
+    /**
+     * @brief Serializes the Channel object into a byte buffer in the binary protocol.
      *
      * Converts the current state of the Channel into a sequence of bytes and appends the data to the provided buffer.
      *
      * @param buf The byte buffer where the serialized data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
-     * @brief Deserializes the Channel object from a byte buffer.
+     * @brief Deserializes the Channel object from a reader in the binary protocol.
      *
      * Restores the state of the Channel from the provided byte buffer.
      *
-     * @param buf The byte buffer containing the serialized channel data.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the Channel object to a JSON string.
@@ -62,7 +80,7 @@ class Channel : public Serializable {
      *
      * @return A JSON string representing the Channel.
      */
-    std::string to_json() const;
+    std::string to_json() const override;
 
     /**
      * @brief Updates the Channel's state from a JSON string.
@@ -71,16 +89,17 @@ class Channel : public Serializable {
      *
      * @param json A JSON string representing the Channel.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
-     * @brief Gets the size of the serialized Channel object.
+     * @brief Gets the size of the serialized Channel object in the binary protocol.
      *
      * Calculates and returns the number of bytes required to serialize the Channel.
      *
+     * @param version The protocol version to encode with.
      * @return The size in bytes of the serialized Channel.
      */
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     // Getters
     /**
@@ -88,28 +107,55 @@ class Channel : public Serializable {
      *
      * @return A constant reference to the channel's UUID.
      */
-    [[nodiscard]] const UUID& get_uid();
+    [[nodiscard]] const UUID& get_uid() const;
 
     /**
      * @brief Retrieves the name of the channel.
      *
-     * @return A constant reference to the channel's name.
+     * @return A copy of the channel's name.
      */
-    [[nodiscard]] const std::string& get_name();
+    [[nodiscard]] std::string get_name() const;
 
     /**
      * @brief Retrieves the list of user UUIDs associated with the channel.
      *
-     * @return A constant reference to the vector of user UUIDs.
+     * @return A copy of the vector of user UUIDs.
+     */
+    [[nodiscard]] std::vector<UUID> get_user_uids() const;
+
+    /**
+     * @brief Checks whether a user is a member of the channel.
+     *
+     * @param user_uid The UUID of the user.
+     * @return true if the user is a member; false otherwise.
      */
-    [[nodiscard]] const std::vector<UUID>& get_user_uids();
+    [[nodiscard]] bool has_user(const UUID& user_uid) const;
 
     /**
      * @brief Retrieves the list of message identifiers (snowflakes) associated with the channel.
      *
-     * @return A constant reference to the vector of message snowflakes.
+     * @return A copy of the vector of message snowflakes.
      */
-    [[nodiscard]] const std::vector<uint64_t>& get_message_snowflakes();
+    [[nodiscard]] std::vector<uint64_t> get_message_snowflakes();
+
+    /**
+     * @brief Retrieves the oldest message snowflakes of the channel newer than a given one.
+     *
+     * @param since The snowflake after which to start; 0 starts at the first message.
+     * @param limit The maximum number of snowflakes to return.
+     * @return A copy of at most limit snowflakes greater than since, in ascending order.
+     */
+    [[nodiscard]] std::vector<uint64_t> get_message_snowflakes_after(uint64_t since, size_t limit);
+
+    /**
+     * @brief Retrieves the newest message snowflakes of the channel older than a given one.
+     *
+     * @param before The snowflake before which to stop; 0 ends at the newest message.
+     * @param limit The maximum number of snowflakes to return.
+     * @return A copy of at most limit snowflakes smaller than before, in ascending order.
+     */
+    [[nodiscard]] std::vector<uint64_t> get_message_snowflakes_before(uint64_t before,
+                                                                      size_t limit);
 
     // Setters
     /**
@@ -129,6 +175,9 @@ class Channel : public Serializable {
     /**
      * @brief Adds a message identifier (snowflake) to the channel.
      *
+     * The snowflake is inserted in order; adding a snowflake the channel already holds does
+     * nothing.
+     *
      * @param message_snowflake The message snowflake to add.
      */
     void add_message(const uint64_t& message_snowflake);
@@ -148,14 +197,23 @@ class Channel : public Serializable {
     void remove_message(const uint64_t& message_snowflake);
 
    private:
+    /**
+     * @brief The part of the channel that changes rarely and is read often.
+     */
+    struct State {
+        /// The name of the channel.
+        std::string name;
+        /// A vector of UUIDs representing the users associated with the channel.
+        std::vector<UUID> user_uids;
+    };
+
     /// The unique identifier for the channel.
     UUID uid;
-    /// The name of the channel.
-    std::string name;
-    /// A vector of UUIDs representing the users associated with the channel.
-    std::vector<UUID> user_uids;
-    /// A vector of message identifiers (snowflakes) associated with the channel.
+    /// The name and members of the channel.
+    Published<State> state;
+    /// The message identifiers (snowflakes) of the channel, kept sorted so that a page of history
+    /// is found with a binary search.
     std::vector<uint64_t> message_snowflakes;
-    /// Mutex for thread-safe access and modification of channel data.
-    std::mutex mutex;
+    /// Mutex guarding message_snowflakes.
+    mutable std::mutex mutex;
 };
@@ -0,0 +1,286 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @enum LogLevel
+ * @brief The severity of a log record, from the most verbose to the most severe.
+ */
+enum class LogLevel : uint8_t {
+    TRACE,
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR,
+    OFF,
+};
+
+#ifndef LOG_LEVEL_COMPILED
+#define LOG_LEVEL_COMPILED DEBUG
+#endif
+
+/**
+ * @brief The lowest level compiled in; statements below it compile to nothing.
+ *
+ * Set with the LOG_LEVEL_COMPILED CMake cache variable. Per-frame tracing sits below the default.
+ */
+constexpr LogLevel COMPILED_LOG_LEVEL = LogLevel::LOG_LEVEL_COMPILED;
+
+/**
+ * @brief A log statement, kept as fields until the writer thread formats it.
+ */
+struct LogEntry {
+    LogLevel level;
+    std::chrono::system_clock::time_point time;
+    std::thread::id thread;
+    std::string message;
+};
+
+/**
+ * @class Logger
+ * @brief Writes log records from a bounded ring buffer on a thread of its own.
+ *
+ * Threads that log only render their message and copy it into the ring; the writer thread
+ * formats the records and writes them out in batches, so a slow terminal or disk never stalls a
+ * connection. When the ring is full, records are dropped rather than waited for, and the number
+ * dropped is written once there is room again.
+ *
+ * Use the LOG_* macros rather than the logger directly: they skip rendering the message, and
+ * evaluating its arguments, when the level is disabled.
+ */
+class Logger {
+   public:
+    /// The number of records the ring of the shared logger holds.
+    static constexpr size_t DEFAULT_CAPACITY = 8192;
+
+    /**
+     * @brief Retrieves the logger shared by the program, writing to stderr.
+     *
+     * Its level is read from the LOG_LEVEL environment variable and defaults to INFO.
+     *
+     * @return Reference to the singleton Logger instance.
+     */
+    static Logger& get_instance();
+
+    /**
+     * @brief Starts a logger and its writer thread.
+     *
+     * @param out The file to write to, which must outlive the logger.
+     * @param capacity The number of records the ring holds.
+     * @param level The lowest level written.
+     */
+    Logger(FILE* out, size_t capacity, LogLevel level);
+
+    /**
+     * @brief Writes the records still in the ring and joins the writer thread.
+     */
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /**
+     * @brief Checks whether records of a level are written.
+     * @param level The level to check.
+     * @return true if the level is at or above the level of the logger.
+     */
+    [[nodiscard]] bool is_enabled(LogLevel level) const {
+        return level >= this->level.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets the lowest level written; levels below COMPILED_LOG_LEVEL stay off regardless.
+     * @param level The new level.
+     */
+    void set_level(LogLevel level);
+
+    /**
+     * @brief Gets the lowest level written.
+     * @return The level of the logger.
+     */
+    [[nodiscard]] LogLevel get_level() const;
+
+    /**
+     * @brief Queues a record for the writer thread, or drops it if the ring is full.
+     * @param record The record to write.
+     */
+    void submit(LogEntry record);
+
+    /**
+     * @brief Blocks until every record submitted so far has been written and flushed.
+     */
+    void flush();
+
+    /**
+     * @brief Gets the number of records dropped because the ring was full.
+     * @return The number of dropped records.
+     */
+    [[nodiscard]] size_t get_num_dropped() const;
+
+    /**
+     * @brief Parses the name of a level, such as "debug" or "WARN".
+     * @param name The name of the level, in any case.
+     * @return The level, or std::nullopt if the name is unknown.
+     */
+    [[nodiscard]] static std::optional<LogLevel> parse_level(std::string_view name);
+
+    /**
+     * @brief Gets the name a level is written with.
+     * @param level The level.
+     * @return The upper-case name of the level.
+     */
+    [[nodiscard]] static const char* level_name(LogLevel level);
+
+   private:
+    /**
+     * @brief Writes batches of records until the logger stops.
+     */
+    void run();
+
+    /**
+     * @brief Appends a record to a buffer as one line.
+     */
+    static void format(const LogEntry& record, std::string& line);
+
+    /// The file records are written to.
+    FILE* out;
+    /// The lowest level written.
+    std::atomic<LogLevel> level;
+    /// The ring of records waiting for the writer, count of them starting at head.
+    std::vector<LogEntry> ring;
+    /// The index of the oldest record in the ring.
+    size_t head = 0;
+    /// The number of records in the ring.
+    size_t count = 0;
+    /// The number of records dropped since the writer last reported them.
+    size_t unreported_drops = 0;
+    /// The number of records dropped in total.
+    size_t dropped = 0;
+    /// The number of records queued in total.
+    uint64_t submitted = 0;
+    /// The number of records written in total.
+    uint64_t written = 0;
+    /// Set when the writer must drain the ring and stop.
+    bool stopping = false;
+    /// Guards the ring and the counters.
+    mutable std::mutex mutex;
+    /// Signalled when a record is queued or the logger stops.
+    std::condition_variable record_ready;
+    /// Signalled when the writer has written a batch.
+    std::condition_variable batch_written;
+    /// The writer thread.
+    std::thread writer;
+};
+
+/**
+ * @class LogLine
+ * @brief Renders one log statement and submits it to a logger when it goes out of scope.
+ *
+ * Values are separated by spaces, as with qDebug(). Strings, numbers and anything with a
+ * to_string() or toStdString() method are rendered without going through iostreams.
+ */
+class LogLine {
+   public:
+    /**
+     * @brief Starts a record.
+     * @param logger The logger to submit the record to.
+     * @param level The level of the record.
+     */
+    LogLine(Logger& logger, LogLevel level) : logger(logger), level(level) {}
+
+    /**
+     * @brief Submits the record.
+     */
+    ~LogLine() {
+        this->logger.submit({this->level, std::chrono::system_clock::now(),
+                             std::this_thread::get_id(), std::move(this->message)});
+    }
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(std::string_view value) {
+        separate();
+        this->message.append(value);
+        return *this;
+    }
+
+    LogLine& operator<<(const char* value) { return *this << std::string_view(value); }
+
+    LogLine& operator<<(const std::string& value) { return *this << std::string_view(value); }
+
+    LogLine& operator<<(bool value) { return *this << (value ? "true" : "false"); }
+
+    LogLine& operator<<(char value) { return *this << std::string_view(&value, 1); }
+
+    template <typename T>
+        requires std::is_arithmetic_v<T>
+    LogLine& operator<<(T value) {
+        char buf[32];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+        return *this << std::string_view(buf, end - buf);
+    }
+
+    template <typename T>
+        requires requires(const T& value) {
+            { value.to_string() } -> std::convertible_to<std::string>;
+        }
+    LogLine& operator<<(const T& value) {
+        return *this << std::string(value.to_string());
+    }
+
+    template <typename T>
+        requires requires(const T& value) {
+            { value.toStdString() } -> std::convertible_to<std::string>;
+        }
+    LogLine& operator<<(const T& value) {
+        return *this << std::string(value.toStdString());
+    }
+
+   private:
+    /**
+     * @brief Separates the next value from the previous one.
+     */
+    void separate() {
+        if (!this->message.empty()) {
+            this->message.push_back(' ');
+        }
+    }
+
+    /// The logger the record is submitted to.
+    Logger& logger;
+    /// The level of the record.
+    LogLevel level;
+    /// The message rendered so far.
+    std::string message;
+};
+
+/**
+ * @brief Starts a log statement at a level, streamed into like qDebug().
+ *
+ * Nothing after the macro is evaluated unless the level is enabled, and statements below
+ * COMPILED_LOG_LEVEL are discarded at compile time. Use it as a statement of its own.
+ */
+#define LOG_AT(lvl)                                                 \
+    if constexpr ((lvl) < COMPILED_LOG_LEVEL) {                     \
+    } else if (!Logger::get_instance().is_enabled(lvl)) {           \
+    } else                                                          \
+        LogLine(Logger::get_instance(), lvl)
+
+#define LOG_TRACE LOG_AT(LogLevel::TRACE)
+#define LOG_DEBUG LOG_AT(LogLevel::DEBUG)
+#define LOG_INFO LOG_AT(LogLevel::INFO)
+#define LOG_WARN LOG_AT(LogLevel::WARN)
+#define LOG_ERROR LOG_AT(LogLevel::ERROR)
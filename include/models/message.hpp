@@ -2,11 +2,11 @@
 #include <stdint.h>
 #include <cstdint>
 #include <memory>
-#include <mutex>
 #include <string>
 #include <vector>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
+#include "models/published.hpp"
 #include "models/uuid.hpp"
 
 /**
@@ -16,8 +16,12 @@
  * It includes information such as the sender, the channel, timestamps for creation and modification,
  * a unique snowflake identifier, a list of users who have read the message, and the message text.
  * The class supports serialization to and from byte buffers as well as conversion to and from JSON.
+ *
+ * The snowflake, sender, channel and creation time never change once the message is shared, and
+ * are read without synchronization. The text, modification time and readers are published as one
+ * immutable version, so reading them takes no lock and an edit is never seen half-applied.
  */
-class Message : public Serializable {
+class Message : public Payload {
    public:
     /**
      * @brief Shared pointer type for Message.
@@ -37,6 +41,21 @@ class Message : public Serializable {
      */
     Message(UUID sender_id, UUID channel_id, std::string text);
 
+    /**
+     * @brief Reconstructs a Message that was created earlier, such as one read back from disk.
+     *
+     * The message is marked as read by its sender only.
+     *
+     * @param snowflake The unique identifier of the message.
+     * @param sender_id The UUID of the sender.
+     * @param channel_id The UUID of the channel.
+     * @param created_at The timestamp when the message was created.
+     * @param modified_at The timestamp when the message was last modified.
+     * @param text The text content of the message.
+     */
+    Message(uint64_t snowflake, UUID sender_id, UUID channel_id, uint64_t created_at,
+            uint64_t modified_at, std::string text);
+
     /**
      * @brief Default constructor.
      *
@@ -45,14 +64,15 @@ class Message : public Serializable {
     Message() = default;
 
     /**
-     * @brief Serializes the Message object into a byte buffer.
+     * @brief Serializes the Message object into a byte buffer in the binary protocol.
      *
      * Converts the current state of the Message into a sequence of bytes and appends the data
      * to the provided buffer.
      *
      * @param buf The byte buffer where the serialized data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
      * @brief Serializes the message-specific fields into a byte buffer.
@@ -61,26 +81,28 @@ class Message : public Serializable {
      * into a sequence of bytes and appends them to the provided buffer.
      *
      * @param buf The byte buffer where the serialized message data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize_msg(std::vector<uint8_t>& buf) const;
+    void serialize_msg(std::vector<uint8_t>& buf, uint8_t version = PROTOCOL_VERSION) const;
 
     /**
-     * @brief Deserializes the Message object from a byte buffer.
+     * @brief Deserializes the Message object from a reader in the binary protocol.
      *
-     * Reads data from the provided byte buffer and restores the state of the Message object.
+     * Reads data from the provided reader and restores the state of the Message object.
      *
-     * @param buf The byte buffer containing the serialized message data.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
-     * @brief Gets the size of the serialized Message object.
+     * @brief Gets the size of the serialized Message object in the binary protocol.
      *
      * Calculates and returns the number of bytes required to serialize the Message.
      *
+     * @param version The protocol version to encode with.
      * @return The size in bytes of the serialized Message.
      */
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t binary_size(uint8_t version) const override;
 
     /**
      * @brief Converts the Message object to a JSON string.
@@ -89,7 +111,7 @@ class Message : public Serializable {
      *
      * @return A JSON string representing the Message.
      */
-    std::string to_json() const;
+    std::string to_json() const override;
 
     /**
      * @brief Updates the Message's state from a JSON string.
@@ -98,7 +120,7 @@ class Message : public Serializable {
      *
      * @param json A JSON string representing the Message.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     // Getters
 
@@ -107,49 +129,49 @@ class Message : public Serializable {
      *
      * @return The snowflake identifier as a uint64_t.
      */
-    [[nodiscard]] const uint64_t get_snowflake();
+    [[nodiscard]] uint64_t get_snowflake() const;
 
     /**
      * @brief Retrieves the sender's unique identifier.
      *
      * @return A constant reference to the sender's UUID.
      */
-    [[nodiscard]] const UUID& get_sender_id();
+    [[nodiscard]] const UUID& get_sender_id() const;
 
     /**
      * @brief Retrieves the channel's unique identifier.
      *
      * @return A constant reference to the channel's UUID.
      */
-    [[nodiscard]] const UUID& get_channel_id();
+    [[nodiscard]] const UUID& get_channel_id() const;
 
     /**
      * @brief Retrieves the creation timestamp of the Message.
      *
      * @return The creation timestamp as a uint64_t.
      */
-    [[nodiscard]] const uint64_t get_created_at();
+    [[nodiscard]] uint64_t get_created_at() const;
 
     /**
      * @brief Retrieves the modification timestamp of the Message.
      *
      * @return The modification timestamp as a uint64_t.
      */
-    [[nodiscard]] const uint64_t get_modified_at();
+    [[nodiscard]] uint64_t get_modified_at() const;
 
     /**
      * @brief Retrieves the list of user UUIDs who have read the Message.
      *
-     * @return A constant reference to the vector containing the UUIDs of users who have read the Message.
+     * @return A copy of the vector containing the UUIDs of users who have read the Message.
      */
-    [[nodiscard]] const std::vector<UUID>& get_read_by();
+    [[nodiscard]] std::vector<UUID> get_read_by() const;
 
     /**
      * @brief Retrieves the text content of the Message.
      *
-     * @return A constant reference to the text content of the Message.
+     * @return A copy of the text content of the Message.
      */
-    [[nodiscard]] const std::string& get_text();
+    [[nodiscard]] std::string get_text() const;
 
     // Setters
 
@@ -172,20 +194,26 @@ class Message : public Serializable {
     void set_read_by(UUID& user_id);
 
    private:
+    /**
+     * @brief The part of the Message that may change after it was sent.
+     */
+    struct State {
+        /// The timestamp when the Message was last modified.
+        uint64_t modified_at = 0;
+        /// A vector of UUIDs representing users who have read the Message.
+        std::vector<UUID> read_by;
+        /// The text content of the Message.
+        std::string text;
+    };
+
     /// A unique identifier for the Message (commonly referred to as a snowflake).
-    uint64_t snowflake;
+    uint64_t snowflake = 0;
     /// The unique identifier of the sender.
     UUID sender_id;
     /// The unique identifier of the channel to which the Message belongs.
     UUID channel_id;
     /// The timestamp when the Message was created.
-    uint64_t created_at;
-    /// The timestamp when the Message was last modified.
-    uint64_t modified_at;
-    /// A vector of UUIDs representing users who have read the Message.
-    std::vector<UUID> read_by;
-    /// The text content of the Message.
-    std::string text;
-    /// Mutex to ensure thread-safe access to the Message's data.
-    std::mutex mutex;
+    uint64_t created_at = 0;
+    /// The text, modification time and readers of the Message.
+    Published<State> state;
 };
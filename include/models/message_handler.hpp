@@ -1,41 +1,47 @@
+#pragma once
 #include <QTcpSocket>
-#include <functional>
-#include <iostream>
-#include <typeindex>
-#include <unordered_map>
+#include <array>
+#include <span>
 
+#include "message/header.hpp"
+#include "message/message_types.hpp"
 #include "models/message_handlers.hpp"
 
 /**
  * @brief Handles registration and dispatching of message handlers.
  *
  * The MessageHandler class is responsible for registering handler functions for various message types
- * and dispatching messages to the appropriate handler based on their type. It follows a singleton pattern,
- * providing a thread-local instance. Additionally, it emits a Qt signal to write data.
+ * and dispatching frames to the appropriate handler based on their operation. It follows a singleton pattern,
+ * providing a thread-local instance.
+ *
+ * Handlers are indexed directly by the operation of the frame. Each entry of the table is a function,
+ * instantiated for one handler, that decodes the payload type the handler takes and calls the handler
+ * directly, so a frame reaches its handler through a single indirect call. The operation a payload type
+ * belongs to comes from MessageTypes, the list shared by the client and the server.
  */
 class MessageHandler : public QObject {
     Q_OBJECT
    public:
     /**
-     * @brief Alias for the handler function type.
+     * @brief Alias for the entries of the dispatch table.
      *
-     * The HandlerFunction is a std::function that accepts two void pointers:
-     * one for a QTcpSocket pointer and one for a message pointer.
+     * A Dispatcher decodes a payload in the given protocol version and passes it, along with the
+     * QTcpSocket it arrived on, to the handler it was instantiated for.
      */
-    using HandlerFunction = std::function<void(void*, void*)>;
+    using Dispatcher = void (*)(QTcpSocket*, std::span<const uint8_t>, uint8_t);
 
     /**
      * @brief Default constructor.
      *
-     * Initializes a new instance of the MessageHandler class.
+     * Initializes a new instance of the MessageHandler class, with no handler registered.
      */
     MessageHandler() = default;
 
     /**
      * @brief Retrieves the singleton instance of the MessageHandler.
      *
-     * Returns a thread-local instance of MessageHandler. If the handlers have not yet been initialized,
-     * they are initialized via the external function init_message_handlers.
+     * Returns a thread-local instance of MessageHandler. The first call on each thread initializes the
+     * handlers via the external function init_message_handlers.
      *
      * @return Reference to the singleton MessageHandler instance.
      */
@@ -43,61 +49,69 @@ class MessageHandler : public QObject {
         thread_local MessageHandler instance;
         if (!instance.handlers_initialized) {
             init_message_handlers(instance);
+            instance.handlers_initialized = true;
         }
         return instance;
     }
 
     /**
-     * @brief Registers a handler for a specific message type.
+     * @brief Registers a handler for the operation of the message type it takes.
      *
-     * Associates a handler function with the message type T. The provided handler should accept
-     * a QTcpSocket pointer and a reference to a message of type T.
+     * The handler must be a function accepting a QTcpSocket pointer and a reference to a message
+     * type listed in MessageTypes.
      *
-     * @tparam T The type of the message to be handled.
-     * @param handler The function to be invoked when a message of type T is dispatched.
+     * @tparam HANDLER The function to be invoked when a frame of its message type is dispatched.
      */
-    template <typename T>
-    void register_handler(std::function<void(QTcpSocket*, T&)> handler) {
-        handlers[typeid(T)] = [handler](void* socket, void* message) {
-            handler(static_cast<QTcpSocket*>(socket), *static_cast<T*>(message));
-        };
+    template <auto HANDLER>
+    void register_handler() {
+        using T = typename HandlerTraits<decltype(HANDLER)>::Message;
+        static_assert(OPERATION_OF<T>.has_value(), "The message type is missing from MessageTypes");
+        this->dispatchers[OPERATION_OF<T>.value()] = &decode_and_handle<T, HANDLER>;
     }
 
     /**
-     * @brief Dispatches a message to the appropriate handler.
+     * @brief Decodes a frame and dispatches it to the handler of its operation.
      *
-     * Attempts to find and invoke the registered handler for the message type T. If a handler is found,
-     * it is called with the provided QTcpSocket pointer and message data. If no handler is registered for
-     * the message type, an error message is printed to std::cerr.
-     *
-     * @tparam T The type of the message.
-     * @param socket Pointer to the QTcpSocket associated with the message.
-     * @param data Reference to the message data.
+     * @param socket Pointer to the QTcpSocket the frame arrived on.
+     * @param header The header of the frame.
+     * @param payload The payload of the frame.
+     * @return true if a handler is registered for the operation; false otherwise.
+     * @throws std::out_of_range if the payload is malformed.
      */
-    template <typename T>
-    void dispatch(QTcpSocket* socket, T& data) {
-        qDebug() << "Trying to dispatch handler for: " << typeid(T).name();
-        auto it = handlers.find(typeid(T));
-        if (it != handlers.end()) {
-            it->second(socket, &data);  // Call the stored function, passing data as void*
-        } else {
-            std::cerr << "No handler registered for type: " << typeid(T).name() << std::endl;
+    bool dispatch(QTcpSocket* socket, const Header& header, std::span<const uint8_t> payload) const {
+        size_t operation = header.get_operation();
+        if (operation >= NUM_OPERATIONS || this->dispatchers[operation] == nullptr) {
+            return false;
         }
+        this->dispatchers[operation](socket, payload, header.get_version());
+        return true;
     }
 
-   signals:
+   private:
     /**
-     * @brief Signal emitted to write data.
-     *
-     * This signal is emitted with a vector of bytes that represent data to be written.
-     *
-     * @param data A vector of uint8_t containing the data.
+     * @brief Extracts the message type from the signature of a handler.
      */
-    void write_data(std::vector<uint8_t> data);
+    template <typename F>
+    struct HandlerTraits;
 
-   private:
-    /// Maps message type indices to their corresponding handler functions.
-    std::unordered_map<std::type_index, HandlerFunction> handlers;
+    template <typename T>
+    struct HandlerTraits<void (*)(QTcpSocket*, T&)> {
+        using Message = T;
+    };
+
+    /**
+     * @brief Decodes a message of type T and hands it to HANDLER.
+     */
+    template <typename T, auto HANDLER>
+    static void decode_and_handle(QTcpSocket* socket, std::span<const uint8_t> payload,
+                                  uint8_t version) {
+        T message;
+        message.deserialize(payload, version);
+        HANDLER(socket, message);
+    }
+
+    /// The dispatcher of each operation, or nullptr if no handler is registered for it.
+    std::array<Dispatcher, NUM_OPERATIONS> dispatchers = {};
     /// Indicates whether the message handlers have been initialized.
     bool handlers_initialized = false;
 };
@@ -0,0 +1,136 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+/**
+ * @class Epoch
+ * @brief Defers freeing objects until no reader can still be looking at them.
+ *
+ * Readers enter a read section by holding a Guard, which announces the current global epoch in a
+ * slot owned by their thread; entering and leaving touch no memory shared with other readers.
+ * Writers first unpublish an object, then retire it: the global epoch advances, and the object is
+ * freed by the first retire() that finds every reader in a read section announced a later epoch,
+ * that is, entered after the object was unpublished.
+ */
+class Epoch {
+   public:
+    /**
+     * @class Guard
+     * @brief Keeps the calling thread in a read section for as long as it lives.
+     *
+     * Guards nest; the read section ends with the outermost one.
+     */
+    class Guard {
+       public:
+        Guard();
+        ~Guard();
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    /**
+     * @brief Frees an unpublished object once no read section can still reach it.
+     *
+     * @param object The object, which no reader may find from now on.
+     */
+    template <typename T>
+    static void retire(const T* object) {
+        retire(const_cast<T*>(object), [](void* retired) { delete static_cast<T*>(retired); });
+    }
+
+    /**
+     * @brief Gets the number of retired objects that have not been freed yet.
+     * @return The number of objects waiting for readers to leave.
+     */
+    [[nodiscard]] static size_t get_num_pending();
+
+   private:
+    /**
+     * @brief Frees an unpublished object with a deleter once no read section can still reach it.
+     */
+    static void retire(void* object, void (*deleter)(void*));
+};
+
+/**
+ * @class Published
+ * @brief A value that readers see without taking a lock, replaced as a whole by writers.
+ *
+ * The value is immutable once published. Readers get the current version with read(), which runs
+ * in a read section and so may never observe a version being freed under it; every read sees one
+ * consistent version. Writers copy the current version, change the copy and publish it, one at a
+ * time, and the version they replaced is retired to Epoch.
+ *
+ * Fit for state that is read far more often than it changes; each write copies the whole value.
+ *
+ * @tparam T The type of the value.
+ */
+template <typename T>
+class Published {
+   public:
+    /**
+     * @brief Publishes an initial value.
+     * @param value The initial value.
+     */
+    explicit Published(T value = T()) : current(new T(std::move(value))) {}
+
+    /**
+     * @brief Frees the current version; the owner must no longer be reachable by readers.
+     */
+    ~Published() { delete this->current.load(std::memory_order_relaxed); }
+
+    Published(const Published&) = delete;
+    Published& operator=(const Published&) = delete;
+
+    /**
+     * @brief Calls a function with the current version.
+     *
+     * @param read Called with a const reference to the version, which stays valid until it
+     *        returns. It must not return a reference into the version.
+     * @return What read returns.
+     */
+    template <typename F>
+    auto read(F&& read) const {
+        Epoch::Guard guard;
+        return read(*this->current.load(std::memory_order_seq_cst));
+    }
+
+    /**
+     * @brief Publishes a changed copy of the current version.
+     *
+     * @param update Called with a mutable copy of the current version, which is then published.
+     */
+    template <typename F>
+    void update(F&& update) {
+        std::lock_guard<std::mutex> lock(this->writer_mutex);
+        T* next = new T(*this->current.load(std::memory_order_relaxed));
+        update(*next);
+        publish(next);
+    }
+
+    /**
+     * @brief Gets the current version to change in place.
+     *
+     * Only for owners that no reader can reach yet, such as one being constructed or
+     * deserialized; this spares them the cost of publishing.
+     *
+     * @return The current version.
+     */
+    T& unshared() { return *const_cast<T*>(this->current.load(std::memory_order_relaxed)); }
+
+   private:
+    /**
+     * @brief Replaces the current version and retires it. Must be called with the writer mutex held.
+     */
+    void publish(T* next) {
+        const T* previous = this->current.exchange(next, std::memory_order_seq_cst);
+        Epoch::retire(previous);
+    }
+
+    /// The current version.
+    std::atomic<const T*> current;
+    /// Held by writers, so that no write is lost to a concurrent one.
+    std::mutex writer_mutex;
+};
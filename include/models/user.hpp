@@ -2,13 +2,13 @@
 #include <stdint.h>
 #include <QObject>
 #include <memory>
-#include <mutex>
 #include <string>
 #include <vector>
 
-#include "message/serialize.hpp"
+#include "message/payload.hpp"
 #include "models/channel.hpp"
 #include "models/message.hpp"
+#include "models/published.hpp"
 #include "models/uuid.hpp"
 
 /**
@@ -17,8 +17,11 @@
  * The User class encapsulates user-related information such as username, display name, profile picture,
  * public key, and associated channels. It supports serialization to/from byte buffers and JSON, and integrates
  * with Qt's signal-slot mechanism to notify about events such as channel addition/removal and message reception/deletion.
+ *
+ * The UUID never changes once the user is shared. The rest of the profile and the channels are
+ * published as one immutable version, so reading them takes no lock.
  */
-class User : public QObject, public Serializable {
+class User : public QObject, public Payload {
     Q_OBJECT
    public:
     /**
@@ -52,22 +55,23 @@ class User : public QObject, public Serializable {
     User() = default;
 
     /**
-     * @brief Serializes the User object into a byte buffer.
+     * @brief Serializes the User object into a byte buffer in the binary protocol.
      *
      * Converts the current state of the User into a sequence of bytes and appends it to the provided buffer.
      *
      * @param buf The byte buffer where the serialized data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const override;
 
     /**
-     * @brief Deserializes the User object from a byte buffer.
+     * @brief Deserializes the User object from a reader in the binary protocol.
      *
      * Restores the User's state from the provided byte buffer.
      *
-     * @param buf The byte buffer containing the serialized user data.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize_binary(ByteReader& reader) override;
 
     /**
      * @brief Converts the User object to a JSON string.
@@ -76,7 +80,7 @@ class User : public QObject, public Serializable {
      *
      * @return A JSON string representing the User.
      */
-    std::string to_json() const;
+    std::string to_json() const override;
 
     /**
      * @brief Updates the User's state from a JSON string.
@@ -85,16 +89,17 @@ class User : public QObject, public Serializable {
      *
      * @param json A JSON string representing the User.
      */
-    void from_json(const std::string& json);
+    void from_json(const std::string& json) override;
 
     /**
-     * @brief Gets the size of the serialized User object.
+     * @brief Gets the size of the serialized User object in the binary protocol.
      *
      * Calculates and returns the number of bytes required to serialize the User.
      *
+     * @param version The protocol version to encode with.
      * @return The size in bytes of the serialized User.
      */
-    size_t size() const override;
+    size_t binary_size(uint8_t version) const override;
 
     // Getters
 
@@ -103,35 +108,35 @@ class User : public QObject, public Serializable {
      *
      * @return A constant reference to the user's UUID.
      */
-    [[nodiscard]] const UUID& get_uid();
+    [[nodiscard]] const UUID& get_uid() const;
 
     /**
      * @brief Retrieves the user's username.
      *
-     * @return A constant reference to the username.
+     * @return A copy of the username.
      */
-    [[nodiscard]] const std::string& get_username();
+    [[nodiscard]] std::string get_username() const;
 
     /**
      * @brief Retrieves the user's display name.
      *
-     * @return A constant reference to the display name.
+     * @return A copy of the display name.
      */
-    [[nodiscard]] const std::string& get_display_name();
+    [[nodiscard]] std::string get_display_name() const;
 
     /**
      * @brief Retrieves the user's profile picture URL.
      *
-     * @return A constant reference to the profile picture URL.
+     * @return A copy of the profile picture URL.
      */
-    [[nodiscard]] const std::string& get_profile_pic();
+    [[nodiscard]] std::string get_profile_pic() const;
 
     /**
      * @brief Retrieves the list of channel IDs associated with the user.
      *
-     * @return A constant reference to a vector of UUIDs representing the user's channels.
+     * @return A copy of the vector of UUIDs representing the user's channels.
      */
-    [[nodiscard]] const std::vector<UUID>& get_channels();
+    [[nodiscard]] std::vector<UUID> get_channels() const;
 
     // Setters
 
@@ -200,18 +205,24 @@ class User : public QObject, public Serializable {
     void message_deleted(Message::SharedPtr message);
 
    private:
+    /**
+     * @brief The part of the user that may change after the user was shared.
+     */
+    struct State {
+        /// The user's username.
+        std::string username;
+        /// The user's display name.
+        std::string display_name;
+        /// The URL to the user's profile picture.
+        std::string profile_pic;
+        /// A vector of channel UUIDs associated with the user.
+        std::vector<UUID> channels;
+    };
+
     /// The unique identifier for the user.
     UUID uid;
-    /// The user's username.
-    std::string username;
-    /// The user's display name.
-    std::string display_name;
-    /// The URL to the user's profile picture.
-    std::string profile_pic;
     /// The public key used for encryption.
     std::string public_key;
-    /// A vector of channel UUIDs associated with the user.
-    std::vector<UUID> channels;
-    /// Mutex to ensure thread-safe access to the user's data.
-    std::mutex mutex;
+    /// The profile and channels of the user.
+    Published<State> state;
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include <stdint.h>
 #include <array>
+#include <cstring>
 #include <string>
 #include "message/serialize.hpp"
 
@@ -43,24 +44,30 @@ class UUID : public Serializable {
      * Appends the 16-byte UUID representation to the provided buffer.
      *
      * @param buf The byte buffer where the UUID data will be appended.
+     * @param version The protocol version to encode with.
      */
-    void serialize(std::vector<uint8_t>& buf) const override;
+    void serialize(std::vector<uint8_t>& buf, uint8_t version) const override;
+
+    using Serializable::deserialize;
+    using Serializable::serialize;
+    using Serializable::size;
 
     /**
-     * @brief Deserializes the UUID from a byte buffer.
+     * @brief Deserializes the UUID from a reader.
      *
-     * Reads 16 bytes from the provided buffer to set the UUID value.
+     * Reads 16 bytes from the provided reader to set the UUID value.
      *
-     * @param buf The byte buffer containing the serialized UUID data.
+     * @param reader The reader positioned at the serialized data.
      */
-    void deserialize(const std::vector<uint8_t>& buf) override;
+    void deserialize(ByteReader& reader) override;
 
     /**
      * @brief Gets the size of the serialized UUID.
      *
+     * @param version The protocol version to encode with.
      * @return The size in bytes of the serialized UUID (always 16).
      */
-    [[nodiscard]] size_t size() const override;
+    [[nodiscard]] size_t size(uint8_t version) const override;
 
     /**
      * @brief Converts the UUID to its string representation.
@@ -79,6 +86,33 @@ class UUID : public Serializable {
      */
     static UUID from_string(const std::string& str);
 
+    /**
+     * @brief Reads a UUID in place from a reader.
+     *
+     * Unlike default-constructing a UUID and deserializing into it, this never generates a random
+     * value that is immediately overwritten.
+     *
+     * @param reader The reader positioned at the serialized UUID.
+     * @return The UUID read from the reader.
+     */
+    static UUID from_reader(ByteReader& reader);
+
+    /**
+     * @brief Hashes the UUID.
+     *
+     * The bytes of a UUID are already uniformly random, so they are folded into a word directly
+     * rather than formatted first.
+     *
+     * @return A hash of the UUID's bytes.
+     */
+    [[nodiscard]] size_t hash() const {
+        uint64_t low;
+        uint64_t high;
+        std::memcpy(&low, this->value.data(), sizeof(low));
+        std::memcpy(&high, this->value.data() + sizeof(low), sizeof(high));
+        return low ^ (high * 0x9E3779B97F4A7C15ULL);
+    }
+
    private:
     /// The 16-byte array that stores the UUID value.
     std::array<uint8_t, 16> value;
@@ -89,7 +123,7 @@ namespace std {
 /**
  * @brief Specialization of std::hash for UUID.
  *
- * Allows UUID objects to be used in unordered containers by hashing their string representation.
+ * Allows UUID objects to be used in unordered containers by hashing their raw bytes.
  */
 template <>
 struct hash<UUID> {
@@ -97,10 +131,10 @@ struct hash<UUID> {
      * @brief Hashes a UUID.
      *
      * @param uuid The UUID to hash.
-     * @return A hash value computed from the UUID's string representation.
+     * @return A hash value computed from the UUID's bytes.
      */
     std::size_t operator()(const UUID& uuid) const {
-        return std::hash<std::string>{}(uuid.to_string());
+        return uuid.hash();
     }
 };
 
@@ -0,0 +1,272 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "models/uuid.hpp"
+
+/**
+ * @class UUIDMap
+ * @brief An open-addressing hash map keyed by UUID.
+ *
+ * Entries are stored inline in a single flat array, so a lookup touches one or two adjacent
+ * cache lines instead of chasing a pointer to a heap-allocated node as std::unordered_map does.
+ * Collisions are resolved by linear probing, and erasure shifts the following entries back
+ * instead of leaving tombstones, so probe sequences never degrade over time.
+ *
+ * The map is not thread-safe; the tables using it guard it with their own mutex. Pointers and
+ * iterators are invalidated by any insertion or erasure.
+ *
+ * @tparam V The type of the mapped values.
+ */
+template <typename V>
+class UUIDMap {
+   public:
+    /**
+     * @brief An entry of the map.
+     */
+    using Entry = std::pair<UUID, V>;
+
+    /**
+     * @brief Forward iterator over the entries of the map, in no particular order.
+     */
+    template <typename MapT, typename EntryT>
+    class Iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = EntryT*;
+        using reference = EntryT&;
+
+        Iterator(MapT* map, size_t index) : map(map), index(index) {
+            skip_empty();
+        }
+
+        reference operator*() const {
+            return *this->map->table[this->index];
+        }
+
+        pointer operator->() const {
+            return &*this->map->table[this->index];
+        }
+
+        Iterator& operator++() {
+            this->index++;
+            skip_empty();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return this->index == other.index;
+        }
+
+       private:
+        void skip_empty() {
+            while (this->index < this->map->table.size() &&
+                   !this->map->table[this->index].has_value()) {
+                this->index++;
+            }
+        }
+
+        MapT* map;
+        size_t index;
+    };
+
+    using iterator = Iterator<UUIDMap, Entry>;
+    using const_iterator = Iterator<const UUIDMap, const Entry>;
+
+    /**
+     * @brief Constructs an empty map.
+     */
+    UUIDMap() = default;
+
+    /**
+     * @brief Finds the value mapped to a key.
+     *
+     * @param key The key to look up.
+     * @return A pointer to the value, or nullptr if the key is absent.
+     */
+    [[nodiscard]] V* find(const UUID& key) {
+        std::optional<size_t> index = find_index(key);
+        return index.has_value() ? &this->table[index.value()]->second : nullptr;
+    }
+
+    /**
+     * @brief Finds the value mapped to a key (read-only).
+     *
+     * @param key The key to look up.
+     * @return A pointer to the value, or nullptr if the key is absent.
+     */
+    [[nodiscard]] const V* find(const UUID& key) const {
+        std::optional<size_t> index = find_index(key);
+        return index.has_value() ? &this->table[index.value()]->second : nullptr;
+    }
+
+    /**
+     * @brief Checks whether a key is present.
+     *
+     * @param key The key to look up.
+     * @return true if the key is present; false otherwise.
+     */
+    [[nodiscard]] bool contains(const UUID& key) const {
+        return find_index(key).has_value();
+    }
+
+    /**
+     * @brief Inserts an entry unless the key is already present.
+     *
+     * @param key The key to insert.
+     * @param value The value to map the key to.
+     * @return true if the entry was inserted; false if the key was already present.
+     */
+    bool insert(const UUID& key, V value) {
+        if (contains(key)) {
+            return false;
+        }
+        if ((this->count + 1) * 4 > this->table.size() * 3) {
+            rehash(this->table.empty() ? 16 : this->table.size() * 2);
+        }
+        place(Entry(key, std::move(value)));
+        this->count++;
+        return true;
+    }
+
+    /**
+     * @brief Removes the entry with the given key, if any.
+     *
+     * @param key The key to remove.
+     * @return true if an entry was removed; false if the key was absent.
+     */
+    bool erase(const UUID& key) {
+        std::optional<size_t> found = find_index(key);
+        if (!found.has_value()) {
+            return false;
+        }
+
+        // Shift back every following entry that would otherwise become unreachable
+        size_t mask = this->table.size() - 1;
+        size_t hole = found.value();
+        size_t next = (hole + 1) & mask;
+        while (this->table[next].has_value()) {
+            size_t home = home_index(this->table[next]->first);
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                this->table[hole] = std::move(this->table[next]);
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        this->table[hole].reset();
+        this->count--;
+        return true;
+    }
+
+    /**
+     * @brief Gets the number of entries.
+     * @return The number of entries in the map.
+     */
+    [[nodiscard]] size_t size() const {
+        return this->count;
+    }
+
+    /**
+     * @brief Checks whether the map is empty.
+     * @return true if the map has no entries; false otherwise.
+     */
+    [[nodiscard]] bool empty() const {
+        return this->count == 0;
+    }
+
+    /**
+     * @brief Removes every entry, keeping the allocated slots.
+     */
+    void clear() {
+        for (std::optional<Entry>& slot : this->table) {
+            slot.reset();
+        }
+        this->count = 0;
+    }
+
+    iterator begin() {
+        return iterator(this, 0);
+    }
+
+    iterator end() {
+        return iterator(this, this->table.size());
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, this->table.size());
+    }
+
+   private:
+    /**
+     * @brief Gets the slot a key would occupy if there were no collisions.
+     */
+    size_t home_index(const UUID& key) const {
+        // Fibonacci hashing spreads the hash over the top bits, which become the slot index
+        return (key.hash() * 0x9E3779B97F4A7C15ULL) >> this->shift;
+    }
+
+    /**
+     * @brief Gets the slot holding a key, if present.
+     */
+    std::optional<size_t> find_index(const UUID& key) const {
+        if (this->count == 0) {
+            return std::nullopt;
+        }
+        size_t mask = this->table.size() - 1;
+        for (size_t index = home_index(key);; index = (index + 1) & mask) {
+            if (!this->table[index].has_value()) {
+                return std::nullopt;
+            }
+            if (this->table[index]->first == key) {
+                return index;
+            }
+        }
+    }
+
+    /**
+     * @brief Places an entry whose key is known to be absent into the first free slot.
+     */
+    void place(Entry&& entry) {
+        size_t mask = this->table.size() - 1;
+        size_t index = home_index(entry.first);
+        while (this->table[index].has_value()) {
+            index = (index + 1) & mask;
+        }
+        this->table[index].emplace(std::move(entry));
+    }
+
+    /**
+     * @brief Moves every entry into a new array of the given power-of-two size.
+     */
+    void rehash(size_t capacity) {
+        std::vector<std::optional<Entry>> old = std::move(this->table);
+        this->table = std::vector<std::optional<Entry>>(capacity);
+        this->shift = 64;
+        while (capacity > 1) {
+            capacity >>= 1;
+            this->shift--;
+        }
+        for (std::optional<Entry>& slot : old) {
+            if (slot.has_value()) {
+                place(std::move(slot.value()));
+            }
+        }
+    }
+
+    /// The slots of the map; their number is zero or a power of two.
+    std::vector<std::optional<Entry>> table;
+    /// The number of occupied slots.
+    size_t count = 0;
+    /// 64 minus the base-2 logarithm of the number of slots.
+    unsigned shift = 64;
+};
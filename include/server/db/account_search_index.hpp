@@ -0,0 +1,151 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "models/uuid.hpp"
+
+/**
+ * @class AccountSearchIndex
+ * @brief Answers username searches without scanning every account.
+ *
+ * Searches take a regular expression that must match a whole username, as std::regex_match
+ * does. Before matching, the pattern is inspected for literal text it requires:
+ * - a leading literal ("alice.*") restricts the search to a range of the sorted username index;
+ * - a literal of three or more characters anywhere (".*lice.*") restricts it to the usernames
+ *   containing all of its trigrams, found by intersecting the trigram posting lists;
+ * - patterns without such a literal (for instance top-level alternations) scan every username.
+ * Exact, prefix and substring patterns are answered by plain string comparisons; any other
+ * candidate is confirmed with std::regex_match.
+ *
+ * Results are returned in username order, a page at a time. A page holds at most the requested
+ * number of accounts, and the username of its last account is the cursor from which the next
+ * page continues.
+ *
+ * The index has its own mutex, which searches only hold while they copy candidates out of the
+ * index. Scans read an immutable snapshot of the sorted usernames, shared between them, and
+ * copy only the changes made since it was published; once there are enough of them, the writer
+ * that makes the last one merges them into a new snapshot with the mutex released. Trigram
+ * searches copy the intersection of their posting lists. Regular expressions are matched with
+ * the mutex released, so a slow search never holds up registrations.
+ */
+class AccountSearchIndex {
+   public:
+    /**
+     * @brief One page of search results.
+     */
+    struct Page {
+        /// The UUIDs of the matching accounts, in username order.
+        std::vector<UUID> uids;
+        /// The cursor to pass to get the next page, or std::nullopt if this is the last page.
+        std::optional<std::string> next_cursor;
+    };
+
+    /**
+     * @brief Constructs an empty index.
+     */
+    AccountSearchIndex() = default;
+
+    /**
+     * @brief Indexes an account under its username.
+     *
+     * @param username The username of the account; it must not already be indexed.
+     * @param uid The UUID of the account.
+     */
+    void add(const std::string& username, UUID uid);
+
+    /**
+     * @brief Removes the account indexed under a username, if any.
+     *
+     * @param username The username of the account.
+     */
+    void remove(const std::string& username);
+
+    /**
+     * @brief Finds the accounts whose whole username matches a regular expression.
+     *
+     * @param regex The ECMAScript regular expression to match.
+     * @param limit The maximum number of accounts to return.
+     * @param cursor The cursor returned with the previous page, or an empty string for the first.
+     * @return A variant containing the page on success, or an error message string if the
+     *         regular expression is invalid.
+     */
+    [[nodiscard]] std::variant<Page, std::string> search(const std::string& regex, size_t limit,
+                                                        const std::string& cursor = "") const;
+
+    /**
+     * @brief Gets the number of indexed accounts.
+     * @return The number of indexed accounts.
+     */
+    [[nodiscard]] size_t size() const;
+
+   private:
+    /**
+     * @brief The position of an account in the sorted index.
+     */
+    struct Account {
+        UUID uid;
+        /// The account's slot in entries, which the trigram postings refer to.
+        uint32_t id;
+    };
+
+    /**
+     * @brief An account as referenced by the trigram postings.
+     */
+    struct Entry {
+        std::string username;
+        UUID uid;
+        /// Cleared when the account is removed; its postings are dropped on the next compaction.
+        bool live;
+    };
+
+    /**
+     * @brief Gives every live account a new id and rebuilds the postings without removed ones.
+     */
+    void compact();
+
+    /// Usernames and the accounts they index, sorted by username.
+    using SortedAccounts = std::vector<std::pair<std::string, UUID>>;
+    /// The account added, or std::nullopt if it was removed, under each changed username.
+    using ChangeMap = std::map<std::string, std::optional<UUID>>;
+
+    /**
+     * @brief Records a change for scans, merging the pending changes into a new snapshot once
+     *        there are enough of them.
+     *
+     * @param lock The lock holding the mutex; it is released if the changes are merged.
+     * @param username The username that changed.
+     * @param uid The account now indexed under it, or std::nullopt if it was removed.
+     */
+    void record_change(std::unique_lock<std::mutex>& lock, const std::string& username,
+                       std::optional<UUID> uid);
+
+    /**
+     * @brief Adds the postings of an entry; the caller holds the mutex.
+     */
+    void index_trigrams(uint32_t id);
+
+    /// Live accounts, sorted by username.
+    std::map<std::string, Account> by_username;
+    /// The live accounts as of the last merge of changes; never modified once published.
+    std::shared_ptr<const SortedAccounts> sorted = std::make_shared<SortedAccounts>();
+    /// The changes being merged into the next snapshot by a writer, if any.
+    std::shared_ptr<const ChangeMap> merging;
+    /// The changes made since, which override them.
+    ChangeMap changes;
+    /// Every account added since the last compaction, indexed by id.
+    std::vector<Entry> entries;
+    /// For each trigram, the ascending ids of the entries whose username contains it.
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams;
+    /// The number of removed entries still referenced by the postings.
+    size_t removed = 0;
+    /// Guards the index; never held while a regular expression runs.
+    mutable std::mutex mutex;
+};
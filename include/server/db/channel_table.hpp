@@ -1,20 +1,22 @@
 #pragma once
 #include <stdint.h>
-#include <mutex>
 #include <optional>
-#include <unordered_map>
 #include <variant>
 #include <vector>
 #include <string>
 
 #include "models/channel.hpp"
 #include "models/uuid.hpp"
+#include "models/uuid_map.hpp"
+#include "server/db/sharded_map.hpp"
 
 /**
  * @brief Manages a collection of channels.
  *
  * The ChannelTable class provides a thread-safe interface for storing and managing channels identified by their unique UUIDs.
  * It offers methods for retrieving channels in both read-only and mutable forms, as well as methods for adding and removing channels.
+ *
+ * The channels are kept in a ShardedMap, so lookups only take a shared lock on one shard.
  */
 class ChannelTable {
    public:
@@ -71,9 +73,22 @@ class ChannelTable {
      */
     std::variant<std::monostate, std::string> remove_channel(UUID channel_uid);
 
+    /**
+     * @brief Stores an existing channel, such as one read back from disk.
+     *
+     * @param channel A shared pointer to the channel to store.
+     * @return A variant containing std::monostate on success or an error message string if a
+     *         channel with the same UUID is already stored.
+     */
+    std::variant<std::monostate, std::string> insert_channel(Channel::SharedPtr channel);
+
+    /**
+     * @brief Gets every channel, in no particular order.
+     * @return The channels.
+     */
+    [[nodiscard]] std::vector<Channel::SharedPtr> get_all();
+
    private:
     /// Maps channel UUIDs to their corresponding shared pointers.
-    std::unordered_map<UUID, Channel::SharedPtr> data;
-    /// Mutex to ensure thread-safe access to the channel table.
-    std::mutex mutex;
+    ShardedMap<UUID, Channel::SharedPtr, UUIDMap<Channel::SharedPtr>> data;
 };
@@ -1,17 +1,28 @@
 #pragma once
 #include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <thread>
 #include <variant>
+#include <vector>
 
 #include "models/channel.hpp"
 #include "models/message.hpp"
 #include "models/user.hpp"
 #include "models/uuid.hpp"
 #include "server/db/channel_table.hpp"
+#include "server/db/database_observer.hpp"
 #include "server/db/message_table.hpp"
+#include "server/db/password_hasher.hpp"
 #include "server/db/password_table.hpp"
+#include "server/db/snapshot.hpp"
 #include "server/db/user_table.hpp"
+#include "server/db/write_ahead_log.hpp"
 
 /**
  * @brief Provides a unified interface for interacting with the application's database.
@@ -19,9 +30,40 @@
  * The Database class encapsulates various tables (users, messages, channels, and passwords)
  * and provides methods for retrieving, adding, and removing records. It follows the singleton
  * pattern to ensure that only one instance of the Database exists.
+ *
+ * The tables live in memory. Once open_log has been called, every change is also recorded in
+ * a write-ahead log, from which the next open_log rebuilds the tables after a restart. Changes
+ * that span several tables are applied and logged under a single lock. Other changes only take
+ * it while they are logged, and not at all without a log, so that sends never wait for each
+ * other; each is logged before any change that can see it. Waiting for the log to reach the
+ * disk happens after the lock is released. Failing to write the log stops the server, so that
+ * no change is ever visible without being logged.
+ *
+ * Snapshots keep restarts fast. A snapshot is built from the previous snapshot and the log up
+ * to a point in it, in a separate Database that nothing else uses, so writers are never paused
+ * while one is taken; the log records it covers are then discarded. A restart loads the latest
+ * snapshot with load_snapshot and replays only the log records that follow it.
+ *
+ * Changes that every member of a channel must hear about are reported to a DatabaseObserver,
+ * once per change, after they have been committed.
+ *
+ * Changes that span several tables, such as removing a user along with their messages and
+ * memberships, are applied as one: readers that go through read() see either all of such a
+ * change or none of it, without ever making writers wait for them. Other changes are ordered so
+ * that every table they touch stays consistent with the others at each step.
  */
 class Database {
    public:
+    /**
+     * @brief One page of the history of a channel.
+     */
+    struct ChannelHistory {
+        /// The messages of the page, oldest first.
+        std::vector<Message::SharedPtr> messages;
+        /// Whether the channel holds more messages beyond the page, in the direction it was read.
+        bool has_more = false;
+    };
+
     /**
      * @brief Constructs a new Database instance.
      *
@@ -36,6 +78,108 @@ class Database {
      */
     static Database& get_instance();
 
+    /**
+     * @brief Stops taking snapshots and closes the write-ahead log.
+     */
+    ~Database();
+
+    Database(const Database&) = delete;
+    Database& operator=(const Database&) = delete;
+
+    /**
+     * @brief Fills the tables from a snapshot.
+     *
+     * Must be called before open_log, which then replays only the log records that follow the
+     * snapshot. The messages are left in the mapped snapshot file until they are first used.
+     *
+     * @param path The path of the snapshot file; a missing file is an empty snapshot.
+     * @return A variant containing std::monostate on success, or an error message string on
+     *         failure.
+     */
+    std::variant<std::monostate, std::string> load_snapshot(const std::string& path);
+
+    /**
+     * @brief Writes a snapshot of every change logged so far and discards those log records.
+     *
+     * @param path The path of the snapshot file, which must be the one passed to load_snapshot.
+     * @return A variant containing std::monostate on success, or an error message string on
+     *         failure, including when the write-ahead log is not open.
+     */
+    std::variant<std::monostate, std::string> write_snapshot(const std::string& path);
+
+    /**
+     * @brief Writes a snapshot periodically from a background thread.
+     *
+     * @param path The path of the snapshot file, which must be the one passed to load_snapshot.
+     * @param interval The time between snapshots.
+     */
+    void start_snapshots(const std::string& path, std::chrono::seconds interval);
+
+    /**
+     * @brief Rebuilds the tables from a write-ahead log and records every later change in it.
+     *
+     * Must be called once, before the database is used.
+     *
+     * @param path The path of the log file; it is created if it does not exist.
+     * @param policy When logged changes are synced to disk.
+     * @param sync_delay How long to gather commits before syncing, or the interval between
+     *        syncs; see WriteAheadLog.
+     * @return A variant containing the number of replayed records on success, or an error
+     *         message string on failure.
+     */
+    std::variant<size_t, std::string> open_log(
+        const std::string& path, SyncPolicy policy,
+        std::chrono::microseconds sync_delay = std::chrono::microseconds(0));
+
+    /**
+     * @brief Sets the observer that is told about new and deleted messages and new channels.
+     *
+     * Must be called before the database is shared between threads.
+     *
+     * @param observer The observer, which must outlive the database, or nullptr for none.
+     */
+    void set_observer(DatabaseObserver* observer);
+
+    /**
+     * @brief Runs a read of several tables against a single committed state.
+     *
+     * Changes that span several tables mark themselves as in progress in a commit version, which
+     * is checked before and after the read runs; if such a change was applied meanwhile, the read
+     * runs again. After MAX_READ_ATTEMPTS attempts it runs under the log mutex instead, so that a
+     * burst of such changes cannot starve it; every writer then waits for it. A read must
+     * therefore be bounded, such as resolving one page of results: searches and scans that may
+     * visit the whole database run before it, and it only looks up what they found.
+     *
+     * Sending and deleting messages does not make reads run again: each only adds or removes a
+     * snowflake from the index of one channel, and a channel never lists a message that is
+     * missing from the message table.
+     *
+     * @param read Called without arguments, possibly more than once; it must only read the
+     *        database, and return its result by value.
+     * @return What read returns.
+     */
+    template <typename F>
+    auto read(F&& read) {
+        for (size_t attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+            uint64_t version = this->commit_version.load();
+            if (version % 2 == 1) {
+                // A change is being applied; let its thread finish it
+                std::this_thread::yield();
+                continue;
+            }
+            auto result = read();
+            // The loads of the tables, through shard locks and published pointers, may otherwise
+            // be ordered after the second load of the version, which would then miss a change
+            // that overlapped them
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (this->commit_version.load(std::memory_order_relaxed) == version) {
+                return result;
+            }
+        }
+        std::lock_guard<std::mutex> lock(this->log_mutex);
+        return read();
+    }
+
     // Getters
 
     /**
@@ -99,6 +243,50 @@ class Database {
      */
     [[nodiscard]] std::variant<std::vector<UUID>, std::string> get_uuids_matching_regex(std::string regex) const;
 
+    /**
+     * @brief Retrieves one page of the UUIDs of users whose username matches a regular expression.
+     *
+     * @param regex The regular expression to match.
+     * @param limit The maximum number of UUIDs to return.
+     * @param cursor The cursor returned with the previous page, or an empty string for the first.
+     * @return A variant containing the page on success, or an error message string on failure.
+     */
+    [[nodiscard]] std::variant<AccountSearchIndex::Page, std::string> search_users(
+        const std::string& regex, size_t limit, const std::string& cursor) const;
+
+    /**
+     * @brief Retrieves the oldest messages of a set of channels that are newer than a watermark.
+     *
+     * Messages from all the channels are merged in snowflake order, so a client can page through
+     * its whole history by passing the snowflake of the last message it received as the next
+     * watermark.
+     *
+     * @param channel_uids The channels to read; unknown channels are skipped.
+     * @param since The snowflake after which to start; 0 starts at the first message.
+     * @param limit The maximum number of messages to return.
+     * @return At most limit messages with a snowflake greater than since, in ascending order.
+     */
+    [[nodiscard]] std::vector<Message::SharedPtr> get_messages_since(
+        const std::vector<UUID>& channel_uids, uint64_t since, size_t limit) const;
+
+    /**
+     * @brief Retrieves one page of the history of a channel.
+     *
+     * The page is read from the channel's snowflake-ordered index. With only an after bound it
+     * holds the oldest messages following it, as when catching up; otherwise it holds the newest
+     * messages preceding before, or the newest of the channel if before is 0, as when scrolling
+     * back.
+     *
+     * @param channel_uid The channel to read.
+     * @param before The snowflake before which the page ends, or 0 for no bound.
+     * @param after The snowflake after which the page starts, or 0 for no bound.
+     * @param limit The maximum number of messages in the page.
+     * @return A variant containing the page on success, or an error message string if the
+     *         channel does not exist.
+     */
+    [[nodiscard]] std::variant<ChannelHistory, std::string> get_channel_history(
+        UUID channel_uid, uint64_t before, uint64_t after, size_t limit) const;
+
     /**
      * @brief Retrieves a user's UUID by their username.
      *
@@ -110,7 +298,9 @@ class Database {
     /**
      * @brief Verifies a user's password.
      *
-     * Checks if the provided password is valid for the user with the given UUID.
+     * Checks if the provided password is valid for the user with the given UUID. Verifying is
+     * slow by design and runs on the calling thread, so handlers call it from the PasswordHasher
+     * pool.
      *
      * @param user_uid A reference to the user's UUID.
      * @param password The password to verify.
@@ -123,7 +313,11 @@ class Database {
     /**
      * @brief Adds a new user to the database.
      *
-     * Stores the user along with their password.
+     * Stores the user along with their password. Fails without side effects if the username is
+     * already taken. The password is stored first, so that the user is never found without it.
+     *
+     * The password is hashed on the calling thread; handlers hash it on the PasswordHasher pool
+     * instead, and add the user with the resulting credentials.
      *
      * @param user A shared pointer to the User to add.
      * @param password The password associated with the user.
@@ -131,6 +325,16 @@ class Database {
      */
     std::variant<std::monostate, std::string> add_user(User::SharedPtr user, std::string password);
 
+    /**
+     * @brief Adds a new user to the database, with a password hashed beforehand.
+     *
+     * @param user A shared pointer to the User to add.
+     * @param credentials The hash of the user's password and its salt, from PasswordHasher.
+     * @return A variant containing std::monostate on success or an error message string on failure.
+     */
+    std::variant<std::monostate, std::string> add_user(User::SharedPtr user,
+                                                       PasswordHasher::Credentials credentials);
+
     /**
      * @brief Adds a new message to the database.
      *
@@ -168,12 +372,24 @@ class Database {
      */
     std::variant<std::monostate, std::string> add_user_to_channel(UUID user_uid, UUID channel_uid);
 
+    // Setters -- Update
+
+    /**
+     * @brief Changes a user's username.
+     *
+     * @param user_uid The UUID of the user to rename.
+     * @param username The new username.
+     * @return A variant containing std::monostate on success or an error message string on failure.
+     */
+    std::variant<std::monostate, std::string> set_username(UUID user_uid, std::string username);
+
     // Setters -- Remove
 
     /**
      * @brief Removes a user from the database.
      *
-     * Deletes the user with the specified UUID.
+     * Deletes the user with the specified UUID, along with their password, their memberships and
+     * the messages they sent, as a single change.
      *
      * @param user_uid The UUID of the user to remove.
      * @return A variant containing a shared pointer to the removed User on success, or an error message string on failure.
@@ -193,7 +409,8 @@ class Database {
     /**
      * @brief Removes a channel from the database.
      *
-     * Deletes the channel with the specified UUID.
+     * Deletes the channel with the specified UUID, along with its messages and memberships, as a
+     * single change.
      *
      * @param channel_uid The UUID of the channel to remove.
      * @return A variant containing std::monostate on success or an error message string on failure.
@@ -201,6 +418,73 @@ class Database {
     std::variant<std::monostate, std::string> remove_channel(UUID channel_uid);
 
    private:
+    /// The number of times read() runs optimistically before taking the log mutex.
+    static constexpr size_t MAX_READ_ATTEMPTS = 8;
+
+    /**
+     * @class MultiTableChange
+     * @brief Marks a change that spans several tables as in progress for as long as it lives.
+     *
+     * Only created with the log mutex held, so that changes never overlap.
+     */
+    class MultiTableChange {
+       public:
+        explicit MultiTableChange(std::atomic<uint64_t>& commit_version)
+            : commit_version(commit_version) {
+            this->commit_version.fetch_add(1);
+        }
+
+        ~MultiTableChange() { this->commit_version.fetch_add(1); }
+
+        MultiTableChange(const MultiTableChange&) = delete;
+        MultiTableChange& operator=(const MultiTableChange&) = delete;
+
+       private:
+        std::atomic<uint64_t>& commit_version;
+    };
+
+    /**
+     * @brief Applies a change read back from the write-ahead log.
+     *
+     * @param type The kind of change.
+     * @param reader A reader over the fields of the record.
+     * @throws std::out_of_range if the record is truncated, or std::runtime_error if its type
+     *         is unknown.
+     */
+    void apply_log_record(LogRecordType type, ByteReader& reader);
+
+    /**
+     * @brief Writes the contents of the tables as a snapshot.
+     *
+     * @param path The path of the snapshot file.
+     * @param lsn The log sequence number of the last change the tables include.
+     * @throws std::runtime_error if the snapshot cannot be written.
+     */
+    void save_snapshot(const std::string& path, uint64_t lsn);
+
+    /**
+     * @brief Appends a change to the write-ahead log, if there is one. The caller holds the log
+     *        mutex.
+     *
+     * @param make_record Returns the record of the change; only called if there is a log.
+     * @return The log sequence number of the change, or 0 if there is no log.
+     */
+    template <typename F>
+    uint64_t append_to_log(F&& make_record);
+
+    /**
+     * @brief Takes the log mutex if there is a log.
+     * @return A lock holding the log mutex, or holding nothing if there is no log.
+     */
+    std::unique_lock<std::mutex> lock_log();
+
+    /**
+     * @brief Waits until a logged change is durable; does nothing if there is no log.
+     *
+     * @param lsn The log sequence number of the change.
+     */
+    void commit(uint64_t lsn);
+
     /// Pointer to the user table.
     std::unique_ptr<UserTable> users;
     /// Pointer to the message table.
@@ -209,4 +493,28 @@ class Database {
     std::unique_ptr<ChannelTable> channels;
     /// Pointer to the password table.
     std::unique_ptr<PasswordTable> passwords;
+    /// Told about the changes every member of a channel must hear about, if set.
+    DatabaseObserver* observer = nullptr;
+    /// The write-ahead log, if one has been opened; set before the database is shared.
+    std::unique_ptr<WriteAheadLog> wal;
+    /// Held throughout changes that span several tables, and by other changes while they are
+    /// logged, so that the log follows the order of changes.
+    std::mutex log_mutex;
+    /// Odd while a change spanning several tables is being applied; see read().
+    std::atomic<uint64_t> commit_version = 0;
+    /// The path of the write-ahead log, once it is open.
+    std::string log_path;
+    /// The log sequence number of the last change in the loaded snapshot.
+    uint64_t snapshot_lsn = 0;
+
+    /// Held while a snapshot is written, so that only one is written at a time.
+    std::mutex snapshot_mutex;
+    /// Takes snapshots periodically, once started.
+    std::thread snapshot_thread;
+    /// Guards snapshots_stopping.
+    std::mutex snapshot_thread_mutex;
+    /// Signalled when the snapshot thread must stop.
+    std::condition_variable snapshot_stop;
+    /// Set when the snapshot thread must stop.
+    bool snapshots_stopping = false;
 };
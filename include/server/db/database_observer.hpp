@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/uuid.hpp"
+
+/**
+ * @class DatabaseObserver
+ * @brief Receives the changes to the database that concern every member of a channel.
+ *
+ * Each change is reported once, with all of its recipients, rather than once per recipient, so
+ * that the observer can encode it a single time however large the channel is. Changes are
+ * reported after they have been committed, without any database lock held, from the thread that
+ * made them.
+ */
+class DatabaseObserver {
+   public:
+    virtual ~DatabaseObserver() = default;
+
+    /**
+     * @brief Called when a message has been sent to a channel.
+     *
+     * @param message The new message.
+     * @param user_uids The members of the channel.
+     */
+    virtual void on_message_added(const Message::SharedPtr& message,
+                                  const std::vector<UUID>& user_uids) = 0;
+
+    /**
+     * @brief Called when a message has been deleted from a channel.
+     *
+     * @param message The deleted message.
+     * @param user_uids The members of the channel.
+     */
+    virtual void on_message_removed(const Message::SharedPtr& message,
+                                    const std::vector<UUID>& user_uids) = 0;
+
+    /**
+     * @brief Called when a channel has been created.
+     *
+     * @param channel The new channel.
+     * @param user_uids The members of the channel.
+     */
+    virtual void on_channel_added(const Channel::SharedPtr& channel,
+                                  const std::vector<UUID>& user_uids) = 0;
+};
@@ -1,11 +1,15 @@
 #pragma once
 #include <stdint.h>
-#include <mutex>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <variant>
 
 #include "models/message.hpp"
+#include "server/db/sharded_map.hpp"
+#include "server/db/snapshot.hpp"
 
 /**
  * @brief Manages a collection of messages.
@@ -13,6 +17,13 @@
  * The MessageTable class provides a thread-safe interface for storing, retrieving, and managing
  * messages identified by their unique snowflake identifiers. It supports both read-only and mutable
  * access, as well as methods to add and remove messages.
+ *
+ * After a restart, the messages of the loaded snapshot stay in the mapped snapshot file and are
+ * only decoded, and moved into the table, the first time they are looked up.
+ *
+ * The messages are kept in a ShardedMap, so lookups only take a shared lock on one shard. A
+ * message of the snapshot that has been removed stays in the map as a null pointer, so that
+ * lookups do not find it in the snapshot again.
  */
 class MessageTable {
    public:
@@ -62,16 +73,59 @@ class MessageTable {
      * @brief Removes a message from the table.
      *
      * Deletes the message identified by the given snowflake identifier from the table.
-     * On success, returns std::monostate; on failure, returns an error message string.
+     * On success, returns std::monostate; on failure, returns an error message string. Of
+     * several threads removing the same message, only one succeeds.
      *
      * @param message_snowflake The unique snowflake identifier of the message to remove.
      * @return A variant containing std::monostate on success or an error message string on failure.
      */
     std::variant<std::monostate, std::string> remove_message(uint64_t message_snowflake);
 
+    /**
+     * @brief Stores an existing message, such as one read back from disk.
+     *
+     * @param message A shared pointer to the message to store.
+     * @return A variant containing std::monostate on success or an error message string if a
+     *         message with the same snowflake is already stored.
+     */
+    std::variant<std::monostate, std::string> insert_message(Message::SharedPtr message);
+
+    /**
+     * @brief Makes the messages of a snapshot available without decoding them.
+     *
+     * Must be called before the table is shared with other threads.
+     *
+     * @param snapshot The messages of the snapshot the table is loaded from.
+     */
+    void attach_snapshot(std::shared_ptr<const SnapshotMessages> snapshot);
+
+    /**
+     * @brief Visits every message in snowflake order, in its serialized form.
+     *
+     * Messages still in the attached snapshot are passed as they are stored there, without
+     * being decoded. Each shard is only locked while its messages are collected.
+     *
+     * @param visit Called with the snowflake and the bytes written by Message::serialize of
+     *        each message.
+     */
+    void for_each_serialized(
+        const std::function<void(uint64_t, std::span<const uint8_t>)>& visit);
+
    private:
-    /// Maps message snowflake identifiers to their corresponding shared pointers.
-    std::unordered_map<uint64_t, Message::SharedPtr> data;
-    /// Mutex to ensure thread-safe access to the message table.
-    std::mutex mutex;
+    /**
+     * @brief Looks a message up, decoding it from the attached snapshot on the first lookup.
+     * @return The message, or std::nullopt if neither the table nor the snapshot holds it.
+     */
+    std::optional<Message::SharedPtr> find(uint64_t message_snowflake);
+
+    /**
+     * @brief Checks whether the attached snapshot holds a message.
+     */
+    bool in_snapshot(uint64_t message_snowflake) const;
+
+    /// Maps message snowflake identifiers to their corresponding shared pointers, or to nullptr
+    /// for messages of the snapshot that have been removed.
+    ShardedMap<uint64_t, Message::SharedPtr> data;
+    /// The messages of the snapshot the table was loaded from, if any.
+    std::shared_ptr<const SnapshotMessages> snapshot;
 };
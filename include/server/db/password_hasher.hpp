@@ -0,0 +1,147 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @class PasswordHasher
+ * @brief Derives password hashes with scrypt, on a bounded pool of worker threads.
+ *
+ * scrypt is deliberately slow and memory-hard, so that stolen hashes are expensive to attack;
+ * a hash at the default cost takes tens of milliseconds and 16 MiB of memory. Handlers must not
+ * spend that on the thread serving their connections, so they submit the work to the pool, and
+ * the job posts its result back to the connection once it is done. The queue of the pool is
+ * bounded: a login storm is answered with "busy" errors instead of growing the backlog, and
+ * memory, without limit.
+ *
+ * Hashes are stored as raw bytes: a format byte, the scrypt parameters, then the derived key.
+ * Hashes written before scrypt was adopted, the hex SHA-256 of the password and its salt, are
+ * still verified.
+ */
+class PasswordHasher {
+   public:
+    /**
+     * @brief A password hash and the salt it was derived with.
+     */
+    using Credentials = std::pair<std::string, std::string>;
+
+    /// The base-2 logarithm of the scrypt cost parameter N used for new hashes by default.
+    static constexpr uint8_t DEFAULT_COST = 14;
+    /// The number of jobs that may wait for a worker before submit() refuses more.
+    static constexpr size_t MAX_QUEUED = 1024;
+
+    /**
+     * @brief Retrieves the pool shared by the server, with one worker per core.
+     *
+     * @return Reference to the singleton PasswordHasher instance.
+     */
+    static PasswordHasher& get_instance();
+
+    /**
+     * @brief Starts a pool of workers.
+     *
+     * @param num_threads The number of worker threads, at least one.
+     * @param max_queued The number of jobs that may wait for a worker.
+     */
+    PasswordHasher(size_t num_threads, size_t max_queued);
+
+    /**
+     * @brief Drops the jobs still waiting and joins the workers once their current jobs finish.
+     */
+    ~PasswordHasher();
+
+    PasswordHasher(const PasswordHasher&) = delete;
+    PasswordHasher& operator=(const PasswordHasher&) = delete;
+
+    /**
+     * @brief Sets the cost of the hashes made without an explicit cost.
+     *
+     * Hashes already stored keep the cost they were made with, which verify() reads from them.
+     * Tests lower the cost so that creating users does not dominate their run time.
+     *
+     * @param cost The base-2 logarithm of the scrypt cost parameter N.
+     * @throws std::invalid_argument if the cost is 0 or higher than scrypt is allowed to use.
+     */
+    static void set_cost(uint8_t cost);
+
+    /**
+     * @brief Gets the cost of the hashes made without an explicit cost.
+     * @return The base-2 logarithm of the scrypt cost parameter N, DEFAULT_COST unless set.
+     */
+    [[nodiscard]] static uint8_t get_cost();
+
+    /**
+     * @brief Hashes a password with a fresh random salt at the cost set by set_cost(), on the
+     *        calling thread.
+     *
+     * @param password The password to hash.
+     * @return The hash and its salt.
+     * @throws std::runtime_error if OpenSSL fails to derive the hash.
+     */
+    [[nodiscard]] static Credentials hash(const std::string& password);
+
+    /**
+     * @brief Hashes a password with a fresh random salt, on the calling thread.
+     *
+     * @param password The password to hash.
+     * @param cost The base-2 logarithm of the scrypt cost parameter N.
+     * @return The hash and its salt.
+     * @throws std::runtime_error if OpenSSL fails to derive the hash.
+     */
+    [[nodiscard]] static Credentials hash(const std::string& password, uint8_t cost);
+
+    /**
+     * @brief Checks a password against stored credentials, on the calling thread.
+     *
+     * The derived keys are compared in constant time.
+     *
+     * @param password The password to check.
+     * @param credentials The stored hash and salt.
+     * @return true if the password matches; false otherwise, including if the hash is malformed.
+     */
+    [[nodiscard]] static bool verify(const std::string& password, const Credentials& credentials);
+
+    /**
+     * @brief Queues a job for the next free worker.
+     *
+     * @param job The job, which hashes or verifies a password and reports the result itself.
+     * @return true if the job was queued; false if the queue is full.
+     */
+    bool submit(std::function<void()> job);
+
+    /**
+     * @brief Gets the number of jobs waiting for a worker.
+     * @return The number of queued jobs.
+     */
+    [[nodiscard]] size_t get_num_queued();
+
+   private:
+    /**
+     * @brief Runs queued jobs until the pool stops.
+     */
+    void run();
+
+    /// The cost of the hashes made without an explicit cost.
+    static inline std::atomic<uint8_t> current_cost = DEFAULT_COST;
+
+    /// The jobs waiting for a worker, oldest first.
+    std::deque<std::function<void()>> jobs;
+    /// The number of jobs that may wait for a worker.
+    size_t max_queued;
+    /// Guards jobs and stopping.
+    std::mutex mutex;
+    /// Signalled when a job is queued or the pool stops.
+    std::condition_variable job_ready;
+    /// Set when the workers must stop.
+    bool stopping = false;
+    /// The worker threads.
+    std::vector<std::thread> workers;
+};
@@ -1,19 +1,21 @@
 #pragma once
 #include <stdint.h>
-#include <mutex>
+#include <optional>
 #include <string>
-#include <unordered_map>
 #include <utility>
 #include <variant>
 
 #include "models/uuid.hpp"
+#include "models/uuid_map.hpp"
+#include "server/db/sharded_map.hpp"
 
 /**
  * @brief Manages user passwords with secure storage and verification.
  *
  * The PasswordTable class is responsible for storing and managing passwords associated with user UUIDs.
- * It provides methods to verify, add, and remove passwords. Passwords are stored in a hashed form along
- * with a salt for added security. The class ensures thread-safe access using a mutex.
+ * It provides methods to verify, add, and remove passwords. Passwords are stored hashed by a
+ * PasswordHasher, as raw bytes, along with a salt for added security. The class ensures thread-safe access by sharding the
+ * passwords behind reader/writer locks; passwords are hashed outside of any lock.
  */
 class PasswordTable {
    public:
@@ -28,6 +30,7 @@ class PasswordTable {
      * @brief Verifies the password for a given user.
      *
      * Checks if the provided password, when hashed with the stored salt, matches the stored hashed password.
+     * Hashing is slow by design and runs on the calling thread, without holding any lock.
      *
      * @param user_uid A reference to the UUID of the user.
      * @param password The password to verify.
@@ -36,16 +39,27 @@ class PasswordTable {
      */
     std::variant<bool, std::string> verify_password(UUID& user_uid, std::string password);
 
+    /**
+     * @brief Retrieves the stored hash and salt of a user's password.
+     *
+     * @param user_uid A reference to the UUID of the user.
+     * @return An optional containing the hashed password and its salt, or std::nullopt if the
+     *         user has no password.
+     */
+    [[nodiscard]] std::optional<std::pair<std::string, std::string>> get_credentials(UUID& user_uid);
+
     // Setters
 
     /**
      * @brief Adds a password for a user.
      *
-     * Hashes the provided password with a generated salt and stores the result in the table.
+     * Hashes the provided password with a generated salt, on the calling thread, and stores the
+     * result in the table.
      *
      * @param user_uid A reference to the UUID of the user.
      * @param password The password to add.
-     * @return A variant containing std::monostate on success, or an error message string on failure.
+     * @return A variant containing std::monostate on success, or an error message string if the
+     *         user already has a password.
      */
     std::variant<std::monostate, std::string> add_password(UUID& user_uid, std::string password);
 
@@ -59,24 +73,21 @@ class PasswordTable {
      */
     std::variant<std::monostate, std::string> remove_password(UUID& user_uid);
 
-   private:
-    /// Maps a user's UUID to a pair containing the hashed password and its associated salt.
-    std::unordered_map<UUID, std::pair<std::string, std::string>> data;
-    /// Mutex to ensure thread-safe access to the password table.
-    std::mutex mutex;
-
     /**
-     * @brief Computes the SHA-256 hash of a given string.
+     * @brief Stores a password that was hashed earlier, such as one read back from disk.
      *
-     * @param str The input string to hash.
-     * @return The resulting SHA-256 hash as a string.
+     * @param user_uid A reference to the UUID of the user.
+     * @param hash The hashed password.
+     * @param salt The salt the password was hashed with.
+     * @return A variant containing std::monostate on success, or an error message string on failure.
      */
-    std::string sha256(const std::string& str);
+    std::variant<std::monostate, std::string> restore_password(UUID& user_uid, std::string hash,
+                                                               std::string salt);
 
-    /**
-     * @brief Generates a random salt for password hashing.
-     *
-     * @return A randomly generated salt string.
-     */
-    std::string generate_salt();
+   private:
+    /// Maps a user's UUID to a pair containing the hashed password and its associated salt.
+    ShardedMap<UUID,
+               std::pair<std::string, std::string>,
+               UUIDMap<std::pair<std::string, std::string>>>
+        data;
 };
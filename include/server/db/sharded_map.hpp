@@ -0,0 +1,212 @@
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "models/uuid.hpp"
+#include "models/uuid_map.hpp"
+
+namespace sharded_map {
+
+template <typename V>
+V* find(UUIDMap<V>& map, const UUID& key) {
+    return map.find(key);
+}
+
+template <typename V>
+const V* find(const UUIDMap<V>& map, const UUID& key) {
+    return map.find(key);
+}
+
+template <typename V>
+bool insert(UUIDMap<V>& map, const UUID& key, V value) {
+    return map.insert(key, std::move(value));
+}
+
+template <typename K, typename V>
+V* find(std::unordered_map<K, V>& map, const K& key) {
+    auto it = map.find(key);
+    return it != map.end() ? &it->second : nullptr;
+}
+
+template <typename K, typename V>
+const V* find(const std::unordered_map<K, V>& map, const K& key) {
+    auto it = map.find(key);
+    return it != map.end() ? &it->second : nullptr;
+}
+
+template <typename K, typename V>
+bool insert(std::unordered_map<K, V>& map, const K& key, V value) {
+    return map.emplace(key, std::move(value)).second;
+}
+
+}  // namespace sharded_map
+
+/**
+ * @class ShardedMap
+ * @brief A hash map split into independently locked shards.
+ *
+ * Each key belongs to one shard, picked from a mix of the bits of its hash, and each shard holds
+ * its own map behind its own reader/writer lock. Lookups take a shared lock on a single shard, so
+ * readers never wait for each other, and writers only wait for the readers and writers of the
+ * same shard. Shards are aligned to cache lines, so that threads working on different shards do
+ * not share the lines their locks live on.
+ *
+ * Values are copied out of the map, never referenced, since a reference would outlive the lock
+ * that protects it.
+ *
+ * @tparam K The type of the keys.
+ * @tparam V The type of the mapped values; cheap to copy, such as a shared pointer.
+ * @tparam Map The map each shard holds: std::unordered_map<K, V> or UUIDMap<V>.
+ * @tparam NUM_SHARDS The number of shards, a power of two.
+ */
+template <typename K, typename V, typename Map = std::unordered_map<K, V>, size_t NUM_SHARDS = 64>
+class ShardedMap {
+    static_assert((NUM_SHARDS & (NUM_SHARDS - 1)) == 0, "NUM_SHARDS must be a power of two");
+
+   public:
+    /**
+     * @brief Constructs an empty map.
+     */
+    ShardedMap() = default;
+
+    /**
+     * @brief Finds the value mapped to a key.
+     *
+     * @param key The key to look up.
+     * @return A copy of the value, or std::nullopt if the key is absent.
+     */
+    [[nodiscard]] std::optional<V> find(const K& key) const {
+        const Shard& shard = shard_for(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const V* value = sharded_map::find(shard.map, key);
+        return value != nullptr ? std::optional<V>(*value) : std::nullopt;
+    }
+
+    /**
+     * @brief Checks whether a key is present.
+     *
+     * @param key The key to look up.
+     * @return true if the key is present; false otherwise.
+     */
+    [[nodiscard]] bool contains(const K& key) const {
+        const Shard& shard = shard_for(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return sharded_map::find(shard.map, key) != nullptr;
+    }
+
+    /**
+     * @brief Inserts an entry unless the key is already present.
+     *
+     * @param key The key to insert.
+     * @param value The value to map the key to.
+     * @return true if the entry was inserted; false if the key was already present.
+     */
+    bool insert(const K& key, V value) {
+        Shard& shard = shard_for(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return sharded_map::insert(shard.map, key, std::move(value));
+    }
+
+    /**
+     * @brief Removes the entry with the given key, if any.
+     *
+     * @param key The key to remove.
+     * @return The removed value, or std::nullopt if the key was absent.
+     */
+    std::optional<V> erase(const K& key) {
+        Shard& shard = shard_for(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        V* value = sharded_map::find(shard.map, key);
+        if (value == nullptr) {
+            return std::nullopt;
+        }
+        std::optional<V> removed(std::move(*value));
+        shard.map.erase(key);
+        return removed;
+    }
+
+    /**
+     * @brief Runs a function on the shard of a key while holding its lock exclusively.
+     *
+     * For changes that must look up and update an entry in one step.
+     *
+     * @param key The key whose shard to lock.
+     * @param update Called with the map of the shard.
+     * @return What update returns.
+     */
+    template <typename F>
+    auto with_shard(const K& key, F&& update) {
+        Shard& shard = shard_for(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return update(shard.map);
+    }
+
+    /**
+     * @brief Visits every entry, one shard at a time.
+     *
+     * Each shard is locked while its entries are visited, so the visit sees every shard in a
+     * consistent state but not the whole map at a single point in time.
+     *
+     * @param visit Called with the key and the value of every entry; it must not use the map.
+     */
+    template <typename F>
+    void for_each(F&& visit) const {
+        for (const Shard& shard : this->shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (const auto& [key, value] : shard.map) {
+                visit(key, value);
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the number of entries.
+     * @return The number of entries, summed over the shards one at a time.
+     */
+    [[nodiscard]] size_t size() const {
+        size_t size = 0;
+        for (const Shard& shard : this->shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            size += shard.map.size();
+        }
+        return size;
+    }
+
+   private:
+    /**
+     * @brief A lock and the entries it guards, on cache lines of their own.
+     */
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        Map map;
+    };
+
+    /**
+     * @brief Gets the shard a key belongs to.
+     */
+    size_t shard_index(const K& key) const {
+        if constexpr (NUM_SHARDS == 1) {
+            return 0;
+        } else {
+            // Integer hashes are the identity and snowflakes keep a sequence number in their low
+            // bits, so mix every bit of the hash into the shard index
+            uint64_t hash = std::hash<K>{}(key) * 0x9E3779B97F4A7C15ULL;
+            return hash >> (64 - std::countr_zero(NUM_SHARDS));
+        }
+    }
+
+    Shard& shard_for(const K& key) { return this->shards[shard_index(key)]; }
+
+    const Shard& shard_for(const K& key) const { return this->shards[shard_index(key)]; }
+
+    /// The shards of the map.
+    std::array<Shard, NUM_SHARDS> shards;
+};
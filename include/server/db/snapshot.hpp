@@ -0,0 +1,261 @@
+#pragma once
+#include <stdint.h>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+
+/**
+ * @class MappedFile
+ * @brief A whole file mapped read-only into memory.
+ */
+class MappedFile {
+   public:
+    /**
+     * @brief Maps a file.
+     *
+     * @param path The path of the file.
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string& path);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Gets the contents of the file.
+     * @return A view of the mapped bytes, valid for as long as the MappedFile.
+     */
+    [[nodiscard]] std::span<const uint8_t> bytes() const;
+
+   private:
+    /// The start of the mapping, or nullptr for an empty file.
+    const uint8_t* data = nullptr;
+    /// The size of the file.
+    size_t length = 0;
+};
+
+/**
+ * @class SnapshotMessages
+ * @brief The messages of a snapshot, decoded on demand from the mapped file.
+ *
+ * The snapshot stores an index of (snowflake, offset) pairs sorted by snowflake, so a message
+ * is found with a binary search over the mapping and nothing has to be built when the snapshot
+ * is loaded.
+ */
+class SnapshotMessages {
+   public:
+    /**
+     * @brief Wraps the message index of a mapped snapshot.
+     *
+     * @param file The mapped snapshot, kept alive by the SnapshotMessages.
+     * @param index_offset The offset of the message index in the file.
+     * @param count The number of messages.
+     * @throws std::out_of_range if the index extends past the end of the file.
+     */
+    SnapshotMessages(std::shared_ptr<const MappedFile> file, uint64_t index_offset,
+                     uint64_t count);
+
+    /**
+     * @brief Gets the number of messages.
+     * @return The number of messages in the snapshot.
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * @brief Gets the snowflake of the i-th message in snowflake order.
+     * @param i The position of the message.
+     * @return The snowflake.
+     */
+    [[nodiscard]] uint64_t snowflake_at(size_t i) const;
+
+    /**
+     * @brief Gets the serialized form of the i-th message in snowflake order.
+     *
+     * @param i The position of the message.
+     * @return A view of the bytes written by Message::serialize.
+     * @throws std::out_of_range if the record extends past the end of the file.
+     */
+    [[nodiscard]] std::span<const uint8_t> record_at(size_t i) const;
+
+    /**
+     * @brief Finds a message by its snowflake.
+     *
+     * @param snowflake The snowflake of the message.
+     * @return The position of the message, or std::nullopt if the snapshot does not hold it.
+     */
+    [[nodiscard]] std::optional<size_t> find(uint64_t snowflake) const;
+
+    /**
+     * @brief Decodes the i-th message in snowflake order.
+     *
+     * @param i The position of the message.
+     * @return A new Message.
+     * @throws std::out_of_range if the record is truncated.
+     */
+    [[nodiscard]] Message::SharedPtr load(size_t i) const;
+
+   private:
+    /// The mapped snapshot.
+    std::shared_ptr<const MappedFile> file;
+    /// The message index inside the mapping.
+    std::span<const uint8_t> index;
+};
+
+/**
+ * @class Snapshot
+ * @brief The contents of a snapshot file, a point-in-time copy of the database.
+ *
+ * A snapshot is written next to the write-ahead log: it holds the state the database had after
+ * the log record ending at lsn, so a restart loads it and replays only the records that follow.
+ *
+ * Users and messages are stored in their binary serialize formats; channels, passwords and the
+ * channels of each user, which those formats do not carry in full, are stored alongside them.
+ */
+class Snapshot {
+   public:
+    /**
+     * @brief A user read back from a snapshot, with its password.
+     */
+    struct UserRecord {
+        /// The user, including the channels it belongs to.
+        User::SharedPtr user;
+        /// The hashed password.
+        std::string hash;
+        /// The salt the password was hashed with.
+        std::string salt;
+    };
+
+    /**
+     * @brief Maps and reads a snapshot file.
+     *
+     * Users and channels are decoded eagerly; messages are left in the mapping.
+     *
+     * @param path The path of the snapshot file.
+     * @return A variant containing the snapshot on success, or an error message string if the
+     *         file cannot be read or is corrupt. A missing file is an empty snapshot at lsn 0.
+     */
+    static std::variant<Snapshot, std::string> load(const std::string& path);
+
+    /// The log sequence number of the last change the snapshot includes.
+    uint64_t lsn = 0;
+    /// The users and their passwords.
+    std::vector<UserRecord> users;
+    /// The channels.
+    std::vector<Channel::SharedPtr> channels;
+    /// The messages, or nullptr if the snapshot holds none.
+    std::shared_ptr<const SnapshotMessages> messages;
+};
+
+/**
+ * @class SnapshotWriter
+ * @brief Writes a snapshot file.
+ *
+ * The snapshot is written to a temporary file next to its destination and only renamed over it
+ * once it has been synced, so a crash while writing leaves the previous snapshot in place.
+ * Users must be added first, then channels, then messages in snowflake order.
+ */
+class SnapshotWriter {
+   public:
+    /**
+     * @brief Starts writing a snapshot.
+     *
+     * @param path The path the finished snapshot is renamed to.
+     * @throws std::runtime_error if the temporary file cannot be created.
+     */
+    explicit SnapshotWriter(const std::string& path);
+
+    /**
+     * @brief Closes the writer, removing the temporary file unless the snapshot was finished.
+     */
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    /**
+     * @brief Adds a user with its password.
+     *
+     * @param user The user.
+     * @param hash The hashed password.
+     * @param salt The salt the password was hashed with.
+     * @throws std::runtime_error if writing fails.
+     */
+    void add_user(const User::SharedPtr& user, const std::string& hash, const std::string& salt);
+
+    /**
+     * @brief Adds a channel.
+     *
+     * @param channel The channel.
+     * @throws std::runtime_error if writing fails.
+     */
+    void add_channel(const Channel::SharedPtr& channel);
+
+    /**
+     * @brief Adds a message in its serialized form.
+     *
+     * @param snowflake The snowflake of the message; it must be greater than the previous one.
+     * @param serialized The bytes written by Message::serialize.
+     * @throws std::runtime_error if writing fails.
+     */
+    void add_message(uint64_t snowflake, std::span<const uint8_t> serialized);
+
+    /**
+     * @brief Writes the message index, syncs the file and renames it over the destination.
+     *
+     * @param lsn The log sequence number of the last change the snapshot includes.
+     * @throws std::runtime_error if writing, syncing or renaming fails.
+     */
+    void finish(uint64_t lsn);
+
+   private:
+    /// Appends a 32-bit unsigned integer in network byte order.
+    void put_u32(uint32_t value);
+    /// Appends a 64-bit unsigned integer in network byte order.
+    void put_u64(uint64_t value);
+    /// Appends a string prefixed with its 32-bit length.
+    void put_string(const std::string& value);
+    /// Appends a list of UUIDs prefixed with its 32-bit length.
+    void put_uuids(const std::vector<UUID>& uuids);
+    /// Writes the buffer to the file once it is large enough, or always if forced.
+    void flush(bool force = false);
+    /// Gets the offset in the file of the next byte appended.
+    [[nodiscard]] uint64_t offset() const;
+    /// Records where the channels start, once the last user has been added.
+    void end_users();
+
+    /// The path of the finished snapshot.
+    std::string path;
+    /// The path of the file being written.
+    std::string tmp_path;
+    /// The descriptor of the file being written.
+    int fd = -1;
+    /// Bytes not yet written to the file.
+    std::vector<uint8_t> buf;
+    /// The number of bytes written to the file so far.
+    uint64_t written = 0;
+    /// Scratch space for serializing users.
+    std::vector<uint8_t> scratch;
+
+    /// The number of users added.
+    uint64_t user_count = 0;
+    /// The offset of the first channel, or 0 while users are still being added.
+    uint64_t channels_offset = 0;
+    /// The number of channels added.
+    uint64_t channel_count = 0;
+    /// The snowflakes and offsets of the messages added.
+    std::vector<std::pair<uint64_t, uint64_t>> message_index;
+    /// Set once the snapshot has been renamed into place.
+    bool finished = false;
+};
@@ -1,13 +1,16 @@
 #pragma once
+#include <atomic>
 #include <mutex>
 #include <optional>
-#include <unordered_map>
 #include <variant>
 #include <vector>
 #include <string>
 
 #include "models/user.hpp"
 #include "models/uuid.hpp"
+#include "models/uuid_map.hpp"
+#include "server/db/account_search_index.hpp"
+#include "server/db/sharded_map.hpp"
 
 /**
  * @brief Manages a collection of users.
@@ -15,6 +18,20 @@
  * The UserTable class provides a thread-safe interface for storing and managing users
  * identified by their unique UUIDs. It supports retrieving users (both read-only and mutable),
  * searching for user UUIDs that match a regular expression, and adding or removing users.
+ * Searches are answered by an AccountSearchIndex and do not take the table's lock.
+ *
+ * Users and usernames are kept in ShardedMaps, so lookups by UUID or username only take a shared
+ * lock on one shard and never wait for writers elsewhere in the table. Writers are serialized by
+ * the table's writer mutex, which keeps the two maps and the search index consistent with each
+ * other.
+ *
+ * Usernames are unique. A secondary index maps each username to its user's UUID and is updated
+ * together with the users themselves, so username lookups take constant time and a username can
+ * be claimed atomically. Usernames must only be changed through set_username so that the index
+ * stays consistent.
+ *
+ * Users loaded in bulk from a snapshot are only added to the search index by the first search,
+ * so a restart does not pay for indexing accounts nobody searches for.
  */
 class UserTable {
    public:
@@ -48,18 +65,29 @@ class UserTable {
     /**
      * @brief Retrieves UUIDs of users matching a given regular expression.
      *
-     * Searches the user table and returns a vector of UUIDs for users whose associated
-     * data matches the specified regex.
+     * Searches the user table and returns a vector of UUIDs for users whose username
+     * matches the specified regex, in username order.
      *
      * @param regex The regular expression to match against.
      * @return A variant containing a vector of matching UUIDs on success, or an error message string on failure.
      */
     [[nodiscard]] std::variant<std::vector<UUID>, std::string> get_uuids_matching_regex(std::string regex);
 
+    /**
+     * @brief Retrieves one page of the UUIDs of users whose username matches a regular expression.
+     *
+     * @param regex The regular expression to match against.
+     * @param limit The maximum number of UUIDs to return.
+     * @param cursor The cursor returned with the previous page, or an empty string for the first.
+     * @return A variant containing the page on success, or an error message string on failure.
+     */
+    [[nodiscard]] std::variant<AccountSearchIndex::Page, std::string> search(
+        const std::string& regex, size_t limit, const std::string& cursor = "");
+
     /**
      * @brief Retrieves a user's UUID from their username.
      *
-     * Searches the user table for a user with the specified username and returns their UUID.
+     * Looks the username up in the username index.
      *
      * @param username The username of the user.
      * @return An optional containing the user's UUID if found, or std::nullopt otherwise.
@@ -69,7 +97,9 @@ class UserTable {
     /**
      * @brief Adds a new user to the table.
      *
-     * Inserts the provided user into the table.
+     * Inserts the provided user into the table, unless the username is already taken. Checking
+     * and claiming the username happen under the writer mutex, so concurrent registrations of the
+     * same username cannot both succeed.
      *
      * @param user A shared pointer to the User to add.
      * @return A variant containing std::monostate on success, or an error message string on failure.
@@ -86,9 +116,48 @@ class UserTable {
      */
     std::variant<User::SharedPtr, std::string> remove_user(UUID user_uid);
 
+    /**
+     * @brief Changes a user's username.
+     *
+     * Updates the user and the username index together, failing if the new username is taken.
+     *
+     * @param user_uid The UUID of the user to rename.
+     * @param username The new username.
+     * @return A variant containing std::monostate on success, or an error message string on failure.
+     */
+    std::variant<std::monostate, std::string> set_username(UUID user_uid, std::string username);
+
+    /**
+     * @brief Adds users read back from a snapshot, deferring their search indexing.
+     *
+     * Users whose UUID or username is already taken are skipped.
+     *
+     * @param users The users to add.
+     */
+    void load(const std::vector<User::SharedPtr>& users);
+
+    /**
+     * @brief Gets every user, in no particular order.
+     * @return The users.
+     */
+    [[nodiscard]] std::vector<User::SharedPtr> get_all();
+
    private:
+    /**
+     * @brief Adds the users loaded by load to the search index, if that has not happened yet.
+     */
+    void index_loaded_users();
+
     /// Maps user UUIDs to their corresponding shared pointers.
-    std::unordered_map<UUID, User::SharedPtr> data;
-    /// Mutex to ensure thread-safe access to the user table.
-    std::mutex mutex;
+    ShardedMap<UUID, User::SharedPtr, UUIDMap<User::SharedPtr>> data;
+    /// Maps usernames to the UUIDs of their users.
+    ShardedMap<std::string, UUID> username_index;
+    /// Answers username searches; it has its own lock.
+    AccountSearchIndex search_index;
+    /// Users loaded but not yet added to the search index.
+    std::vector<User::SharedPtr> unindexed;
+    /// Set while unindexed is not empty, so searches only take the lock when it is.
+    std::atomic<bool> has_unindexed = false;
+    /// Serializes the writers of the user table; readers do not take it.
+    std::mutex writer_mutex;
 };
@@ -0,0 +1,260 @@
+#pragma once
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "message/byte_reader.hpp"
+#include "models/uuid.hpp"
+
+/**
+ * @brief The kinds of changes recorded in the write-ahead log.
+ *
+ * The values are stored in the log, so existing ones must never be renumbered.
+ */
+enum class LogRecordType : uint8_t {
+    ADD_USER = 1,
+    REMOVE_USER = 2,
+    SET_USERNAME = 3,
+    ADD_MESSAGE = 4,
+    REMOVE_MESSAGE = 5,
+    ADD_CHANNEL = 6,
+    ADD_USER_TO_CHANNEL = 7,
+    REMOVE_CHANNEL = 8,
+};
+
+/**
+ * @brief When the write-ahead log forces appended records to disk.
+ */
+enum class SyncPolicy {
+    /// Every commit waits until its record is on disk. Commits arriving while the log is being
+    /// synced are written and synced together with a single fsync (group commit).
+    COMMIT,
+    /// Commits return as soon as their record is appended; the log is synced periodically, so
+    /// a power failure may lose the commits of the last interval.
+    INTERVAL,
+    /// Records are handed to the operating system but only synced when the log is closed; they
+    /// survive a crash of the server but not of the machine.
+    NONE,
+};
+
+/**
+ * @class LogRecord
+ * @brief A record being encoded for the write-ahead log.
+ *
+ * Fields are encoded in a fixed binary layout that does not depend on the wire protocol:
+ * integers in network byte order, strings and lists prefixed with their 32-bit length. The
+ * static read functions decode them, throwing std::out_of_range if the record is too short.
+ */
+class LogRecord {
+   public:
+    /**
+     * @brief Starts a record of the given type.
+     * @param type The kind of change the record describes.
+     */
+    explicit LogRecord(LogRecordType type);
+
+    /**
+     * @brief Appends a 64-bit unsigned integer.
+     * @param value The integer to append.
+     * @return The record, for chaining.
+     */
+    LogRecord& put_u64(uint64_t value);
+
+    /**
+     * @brief Appends a UUID.
+     * @param uuid The UUID to append.
+     * @return The record, for chaining.
+     */
+    LogRecord& put_uuid(const UUID& uuid);
+
+    /**
+     * @brief Appends a length-prefixed string.
+     * @param value The string to append.
+     * @return The record, for chaining.
+     */
+    LogRecord& put_string(const std::string& value);
+
+    /**
+     * @brief Appends a length-prefixed list of UUIDs.
+     * @param uuids The UUIDs to append.
+     * @return The record, for chaining.
+     */
+    LogRecord& put_uuids(const std::vector<UUID>& uuids);
+
+    /**
+     * @brief Gets the encoded record, starting with its type.
+     * @return The encoded record.
+     */
+    [[nodiscard]] const std::vector<uint8_t>& bytes() const;
+
+    /**
+     * @brief Reads a UUID written by put_uuid.
+     * @param reader The reader positioned at the field.
+     * @return The UUID.
+     */
+    static UUID read_uuid(ByteReader& reader);
+
+    /**
+     * @brief Reads a string written by put_string.
+     * @param reader The reader positioned at the field.
+     * @return The string.
+     */
+    static std::string read_string(ByteReader& reader);
+
+    /**
+     * @brief Reads a list of UUIDs written by put_uuids.
+     * @param reader The reader positioned at the field.
+     * @return The UUIDs.
+     */
+    static std::vector<UUID> read_uuids(ByteReader& reader);
+
+   private:
+    /// Appends a 32-bit unsigned integer in network byte order.
+    void put_u32(uint32_t value);
+
+    /// The encoded record.
+    std::vector<uint8_t> buf;
+};
+
+/**
+ * @class WriteAheadLog
+ * @brief An append-only file of the changes made to the database.
+ *
+ * The file starts with a header recording where the records it still holds start, and each
+ * record is framed with its length and a CRC-32 of its contents, so that replay can tell a
+ * record torn by a crash from a complete one. Appending only copies the record into an
+ * in-memory buffer; a background thread writes the buffer to the file and syncs it according
+ * to the SyncPolicy. Records are written in the order they were appended.
+ *
+ * Appending returns a log sequence number, the offset in the file at which the record ends.
+ * Waiting for it with wait_durable blocks until the record is as durable as the policy
+ * promises, which lets callers append under their own locks and wait after releasing them.
+ *
+ * Failing to write or sync the log is fatal: the writer thread logs the error and aborts the
+ * process. Callers have already applied the changes they appended, and could neither keep them
+ * without losing them on restart nor take them back once others have seen them.
+ */
+class WriteAheadLog {
+   public:
+    /**
+     * @brief Opens a log for appending, creating the file if needed.
+     *
+     * @param path The path of the log file.
+     * @param policy When appended records are synced to disk.
+     * @param sync_delay With SyncPolicy::COMMIT, how long the writer waits for more commits to
+     *        join a group before syncing; with SyncPolicy::INTERVAL, the interval between syncs.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    WriteAheadLog(const std::string& path, SyncPolicy policy,
+                  std::chrono::microseconds sync_delay = std::chrono::microseconds(0));
+
+    /**
+     * @brief Writes and syncs every appended record, then closes the log.
+     */
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief Appends a record without waiting for it to be written.
+     *
+     * @param record The record to append.
+     * @return The log sequence number of the record.
+     */
+    uint64_t append(const LogRecord& record);
+
+    /**
+     * @brief Waits until a record is as durable as the sync policy promises.
+     *
+     * With SyncPolicy::COMMIT, blocks until the record has been synced to disk; with the other
+     * policies, returns immediately.
+     *
+     * @param lsn The log sequence number returned by append.
+     */
+    void wait_durable(uint64_t lsn);
+
+    /**
+     * @brief Writes and syncs every record appended so far, whatever the policy.
+     * @return The log sequence number of the last record synced.
+     */
+    uint64_t sync();
+
+    /**
+     * @brief Frees the disk space of the records before a log sequence number.
+     *
+     * The new start of the log is synced to its header first, so that replay refuses to start
+     * before it rather than read the freed range. Offsets in the file, and so sequence numbers,
+     * are unchanged. The space is not freed if the file system cannot free part of a file, nor
+     * if the header cannot be written.
+     *
+     * @param lsn The log sequence number up to which records are no longer needed.
+     */
+    void discard_before(uint64_t lsn);
+
+    /**
+     * @brief Reads a log and passes each complete record to a callback, in order.
+     *
+     * Without an end, the whole log from the start offset is read. A last record that was only
+     * partly written, or whose checksum does not match, or zeros following the last complete
+     * record, are left by a crash: they are discarded by truncating the file to the last complete
+     * record, so that new records are appended after it. A record that is not valid but is
+     * followed by more of the log is corruption, and the file is left as it is. A missing file
+     * is an empty log.
+     *
+     * With an end, such as a sequence number returned by sync, the records up to it are read
+     * from a log that may still be appended to, and must all be complete.
+     *
+     * @param path The path of the log file.
+     * @param apply Called with the type of each record and a reader over its fields.
+     * @param from The sequence number to start after, which must be a record boundary; records
+     *        before it must not have been discarded.
+     * @param to The sequence number to stop at, if any.
+     * @return A variant containing the number of records replayed on success, or an error
+     *         message string if the file cannot be read, is corrupt, no longer holds the records
+     *         after from, or a record cannot be decoded.
+     */
+    static std::variant<size_t, std::string> replay(
+        const std::string& path, const std::function<void(LogRecordType, ByteReader&)>& apply,
+        uint64_t from = 0, std::optional<uint64_t> to = std::nullopt);
+
+   private:
+    /**
+     * @brief Writes the appended records to the file and syncs them until the log is closed.
+     */
+    void run();
+
+    /// The descriptor of the log file.
+    int fd;
+    /// When appended records are synced.
+    SyncPolicy policy;
+    /// How long to gather commits before syncing, or the interval between syncs.
+    std::chrono::microseconds sync_delay;
+
+    /// Records appended but not yet handed to the writer thread.
+    std::vector<uint8_t> pending;
+    /// The log sequence number of the last appended record.
+    uint64_t appended_lsn = 0;
+    /// The log sequence number up to which records have been synced.
+    uint64_t durable_lsn = 0;
+    /// The log sequence number up to which a caller of sync() needs records synced.
+    uint64_t sync_requested_lsn = 0;
+    /// Set when the log is closing.
+    bool stopping = false;
+
+    /// Guards the fields above.
+    std::mutex mutex;
+    /// Signalled when records are appended or the log is closing.
+    std::condition_variable appended;
+    /// Signalled when records have been synced.
+    std::condition_variable synced;
+    /// Writes the appended records to the file.
+    std::thread writer;
+};
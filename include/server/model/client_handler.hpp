@@ -1,19 +1,23 @@
 #pragma once
 #include <QTcpSocket>
+#include <chrono>
 #include <optional>
 #include <vector>
 #include <variant>
 #include <string>
 
+#include "message/frame_compression.hpp"
+#include "message/frame_decoder.hpp"
 #include "models/user.hpp"
+#include "server/model/connection_registry.hpp"
 
 /**
  * @brief Handles communication with a connected client.
  *
  * The ClientHandler class is responsible for managing a client's connection using a socket descriptor.
- * It uses Qt's signals and slots to asynchronously handle client events such as reading data,
- * writing data, disconnection, and message/channel events. The handler also maintains an optional
- * authenticated user associated with the client.
+ * It uses Qt's signals and slots to asynchronously handle client events such as reading data
+ * and disconnection. The handler registers itself with the ConnectionRegistry, which routes data
+ * addressed to this connection (or to its authenticated user) back to it.
  */
 class ClientHandler : public QObject {
     Q_OBJECT
@@ -38,79 +42,165 @@ class ClientHandler : public QObject {
      */
     void set_authenticated_user(const User::SharedPtr user);
 
-   private:
-    /// Pointer to the client's QTcpSocket.
-    QTcpSocket* socket;
-    /// The socket descriptor associated with the client.
-    qintptr socket_descriptor;
-    /// Optionally holds the authenticated user for this client.
-    std::optional<User::SharedPtr> authenticated_user;
+    /**
+     * @brief Retrieves the authenticated user of the client.
+     * @return The user the client logged in as, or std::nullopt if it has not logged in.
+     */
+    [[nodiscard]] std::optional<User::SharedPtr> get_authenticated_user() const;
 
-   public slots:
     /**
-     * @brief Initiates handling of the client's connection.
+     * @brief Removes the connection from the ConnectionRegistry.
+     */
+    ~ClientHandler() override;
+
+    /**
+     * @brief Retrieves the ClientHandler owning a socket.
      *
-     * This slot is responsible for starting the event loop for the client, handling incoming data,
-     * and coordinating the processing of client-related events.
+     * @param socket The socket passed to a message handler.
+     * @return The owning ClientHandler, or nullptr if the socket is not owned by one.
      */
-    void handle_client();
+    static ClientHandler* from_socket(QTcpSocket* socket);
 
-   private slots:
     /**
-     * @brief Writes data to the client's socket.
+     * @brief Gets the id under which this connection is registered in the ConnectionRegistry.
+     * @return The connection id.
+     */
+    [[nodiscard]] ConnectionRegistry::ConnectionId get_connection_id() const;
+
+    /**
+     * @brief Gets the protocol version the client speaks.
      *
-     * Called when there is data to be sent to the client.
+     * The version is taken from the first supported frame the client sends, and every response
+     * on the connection is encoded with it.
      *
-     * @param data A vector of bytes representing the data to be written.
+     * @return The protocol version of the connection.
      */
-    void on_write_data(std::vector<uint8_t> data);
+    [[nodiscard]] uint8_t get_version() const;
 
     /**
-     * @brief Reads incoming data from the client's socket.
+     * @brief Enables or disables compression of the frames sent to the client.
      *
-     * Called when data is available on the socket. Processes the received data accordingly.
+     * Compression is only enabled for clients that offered it in a HelloMessage.
+     *
+     * @param compression Whether large frames are compressed.
      */
-    void on_read_data();
+    void set_compression(bool compression);
 
     /**
-     * @brief Handles the client's disconnection event.
+     * @brief Writes data to the client's socket.
      *
-     * Called when the client disconnects from the server.
+     * Must be called from the thread owning the handler. To write from any other thread, go
+     * through the ConnectionRegistry.
+     *
+     * @param data A vector of bytes representing the data to be written.
      */
-    void on_disconnected();
+    void write(const std::vector<uint8_t>& data);
+
+    /**
+     * @brief Marks the request being dispatched as answered later, from another thread.
+     *
+     * Its latency is then recorded when the next frame of its operation is written to the
+     * connection, rather than when its handler returns.
+     */
+    void defer_response();
 
     /**
-     * @brief Handles an incoming message event.
+     * @brief Serializes a message into the connection's reusable output buffer and writes it.
      *
-     * Called when a message is received from the client. The message can either be a valid message
-     * pointer or an error string.
+     * The buffer keeps its capacity between calls, so serializing a response does not allocate
+     * once the buffer has grown to fit the largest response seen on this connection. Large frames
+     * are compressed if the client accepts that. Must be called from the thread owning the
+     * handler.
      *
-     * @param message A variant containing either a Message::SharedPtr or an error message string.
+     * @param message Any message or response providing serialize_msg.
      */
-    void on_message_received(std::variant<Message::SharedPtr, std::string> message);
+    template <typename T>
+    void send(const T& message) {
+        this->write_buffer.clear();
+        message.serialize_msg(this->write_buffer, this->version);
+        if (this->compression) {
+            FrameCompressor::compress_frame(this->write_buffer);
+        }
+        write(this->write_buffer);
+    }
 
+   private:
     /**
-     * @brief Handles a message deletion event.
+     * @brief A request whose latency has yet to be recorded.
+     */
+    struct PendingRequest {
+        /// The operation of the request.
+        Operation operation;
+        /// When the frame of the request was complete.
+        std::chrono::steady_clock::time_point received;
+    };
+
+    /// The most requests awaiting a deferred response that are timed; older ones are forgotten.
+    static constexpr size_t MAX_DEFERRED_REQUESTS = 16;
+
+    /// Pointer to the client's QTcpSocket.
+    QTcpSocket* socket;
+    /// The socket descriptor associated with the client.
+    qintptr socket_descriptor;
+    /// The id of this connection in the ConnectionRegistry.
+    ConnectionRegistry::ConnectionId connection_id;
+    /// Optionally holds the authenticated user for this client.
+    std::optional<User::SharedPtr> authenticated_user;
+    /// Reassembles frames from the bytes received on the socket.
+    FrameDecoder decoder;
+    /// The protocol version of the connection, fixed by the first supported frame.
+    uint8_t version = PROTOCOL_VERSION;
+    /// Whether the client has sent a supported frame yet.
+    bool version_negotiated = false;
+    /// Whether the client accepts compressed frames.
+    bool compression = false;
+    /// Reusable output buffer for frames serialized by send().
+    std::vector<uint8_t> write_buffer;
+    /// The request being dispatched, until its response is written or its handler returns.
+    std::optional<PendingRequest> dispatching;
+    /// The requests answered later, oldest first.
+    std::vector<PendingRequest> deferred;
+
+    /**
+     * @brief Records a frame written to the client, and the latency of the request it answers.
      *
-     * Called when a message deletion event occurs. The message parameter contains either a valid message
-     * pointer or an error message string.
+     * @param operation The operation of the frame.
+     * @param bytes The size of the frame.
+     */
+    void record_written(Operation operation, size_t bytes);
+
+    /**
+     * @brief Deserializes a complete frame and dispatches it to its message handler.
      *
-     * @param message A variant containing either a Message::SharedPtr or an error message string.
+     * @param header The header of the frame.
+     * @param msg The payload of the frame.
      */
-    void on_message_deleted(std::variant<Message::SharedPtr, std::string> message);
+    void dispatch_frame(const Header& header, const std::vector<uint8_t>& msg);
 
+   public slots:
     /**
-     * @brief Handles the event when a channel is added.
+     * @brief Initiates handling of the client's connection.
      *
-     * Called when a new channel is added and relevant to the client. The channel parameter contains either a valid channel
-     * pointer or an error message string.
+     * This slot is responsible for starting the event loop for the client, handling incoming data,
+     * and coordinating the processing of client-related events.
+     */
+    void handle_client();
+
+   private slots:
+    /**
+     * @brief Reads incoming data from the client's socket.
      *
-     * @param channel A variant containing either a Channel::SharedPtr or an error message string.
+     * Called when data is available on the socket. Feeds everything available to the frame decoder
+     * and dispatches every frame it completes, without ever blocking on a partial frame.
      */
-    void on_channel_added(std::variant<Channel::SharedPtr, std::string> channel);
+    void on_read_data();
 
-    // Note: The on_channel_removed slot is commented out in the current implementation.
-    // void on_channel_removed(std::variant<Channel::SharedPtr, std::string> channel);
+    /**
+     * @brief Handles the client's disconnection event.
+     *
+     * Called when the client disconnects from the server.
+     */
+    void on_disconnected();
 
    signals:
     /**
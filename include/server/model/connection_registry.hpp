@@ -0,0 +1,281 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "constants.hpp"
+#include "models/user.hpp"
+#include "models/uuid.hpp"
+#include "server/db/database_observer.hpp"
+
+class ClientHandler;
+class QThread;
+
+/**
+ * @brief Tracks every live connection on the server and delivers data to them.
+ *
+ * Connections are indexed both by a server-assigned connection id and by the UUID of the user
+ * authenticated on them. All writes go through the registry, which hands the data to the worker
+ * thread owning the target connection, so that handlers never need to know which thread a
+ * connection lives on.
+ *
+ * As the observer of the database, the registry forwards new and deleted messages and new
+ * channels to every online session of the channel's members. Each event is encoded once per
+ * codec into an immutable Frame that every recipient shares, so a write to one more session costs
+ * a reference count and a queued write rather than another encoding.
+ */
+class ConnectionRegistry : public DatabaseObserver {
+   public:
+    /**
+     * @brief Identifies a single connection for the lifetime of the server.
+     */
+    using ConnectionId = uint64_t;
+
+    /**
+     * @brief An encoded frame, shared by every connection it is written to until the last write.
+     */
+    using Frame = std::shared_ptr<const std::vector<uint8_t>>;
+
+    /**
+     * @brief Appends a frame, encoded with the given protocol version, to a buffer.
+     */
+    using Encoder = std::function<void(uint8_t, std::vector<uint8_t>&)>;
+
+    /**
+     * @brief Default constructor.
+     */
+    ConnectionRegistry() = default;
+
+    /**
+     * @brief Retrieves the singleton instance of the ConnectionRegistry.
+     *
+     * @return Reference to the singleton ConnectionRegistry instance.
+     */
+    static ConnectionRegistry& get_instance();
+
+    /**
+     * @brief Registers a new connection.
+     *
+     * @param handler The handler owning the connection.
+     * @return The id assigned to the connection.
+     */
+    ConnectionId add_connection(ClientHandler* handler);
+
+    /**
+     * @brief Removes a connection, unbinding it from its user if necessary.
+     *
+     * Must be called before the handler is destroyed. Removing an unknown id is a no-op.
+     *
+     * @param connection_id The id of the connection to remove.
+     */
+    void remove_connection(ConnectionId connection_id);
+
+    /**
+     * @brief Associates an authenticated user with a connection.
+     *
+     * Any user previously bound to the connection is unbound first.
+     *
+     * @param connection_id The id of the connection.
+     * @param user The user authenticated on the connection.
+     */
+    void bind_user(ConnectionId connection_id, const User::SharedPtr& user);
+
+    /**
+     * @brief Records the protocol version a connection speaks.
+     *
+     * Connections speak PROTOCOL_VERSION until told otherwise.
+     *
+     * @param connection_id The id of the connection.
+     * @param version The protocol version negotiated on the connection.
+     */
+    void set_version(ConnectionId connection_id, uint8_t version);
+
+    /**
+     * @brief Records whether a connection accepts compressed frames.
+     *
+     * @param connection_id The id of the connection.
+     * @param compression Whether large frames to the connection are compressed.
+     */
+    void set_compression(ConnectionId connection_id, bool compression);
+
+    /**
+     * @brief Removes the user association from a connection, if any.
+     *
+     * @param connection_id The id of the connection.
+     */
+    void unbind_user(ConnectionId connection_id);
+
+    /**
+     * @brief Retrieves the ids of every connection on which a user is authenticated.
+     *
+     * @param user_uid The UUID of the user.
+     * @return The ids of the user's sessions (empty if the user is offline).
+     */
+    [[nodiscard]] std::vector<ConnectionId> get_connections_for_user(const UUID& user_uid);
+
+    /**
+     * @brief Retrieves the user authenticated on a connection.
+     *
+     * @param connection_id The id of the connection.
+     * @return The UUID of the user, or std::nullopt if the connection is unknown or anonymous.
+     */
+    [[nodiscard]] std::optional<UUID> get_user_for_connection(ConnectionId connection_id);
+
+    /**
+     * @brief Gets the number of live connections.
+     * @return The number of registered connections.
+     */
+    [[nodiscard]] size_t get_num_connections();
+
+    /**
+     * @brief Gets the number of users with at least one authenticated session.
+     * @return The number of online users.
+     */
+    [[nodiscard]] size_t get_num_users();
+
+    /**
+     * @brief Gets the number of connections on which a user is authenticated.
+     * @return The number of authenticated sessions.
+     */
+    [[nodiscard]] size_t get_num_sessions();
+
+    /**
+     * @brief Writes data to a single connection.
+     *
+     * @param connection_id The id of the target connection.
+     * @param data The bytes to write.
+     * @return true if the connection exists; false otherwise.
+     */
+    bool send(ConnectionId connection_id, std::vector<uint8_t> data);
+
+    /**
+     * @brief Runs a task with the handler of a connection, on the thread owning it.
+     *
+     * For work finished on another thread, such as hashing a password, whose outcome must be
+     * sent to or recorded on the connection. The task is dropped if the handler is destroyed
+     * before it runs.
+     *
+     * @param connection_id The id of the target connection.
+     * @param task Called with the handler of the connection.
+     * @return true if the connection exists; false otherwise.
+     */
+    bool post(ConnectionId connection_id, std::function<void(ClientHandler&)> task);
+
+    /**
+     * @brief Writes data to every session of a user.
+     *
+     * @param user_uid The UUID of the target user.
+     * @param data The bytes to write.
+     * @return The number of sessions the data was delivered to.
+     */
+    size_t send_to_user(const UUID& user_uid, const std::vector<uint8_t>& data);
+
+    /**
+     * @brief Encodes a frame for every session of a user, in the version each session speaks.
+     *
+     * @param user_uid The UUID of the target user.
+     * @param encode Appends the frame, encoded with the given protocol version, to the buffer.
+     * @return The number of sessions the frame was delivered to.
+     */
+    size_t send_to_user(const UUID& user_uid, const Encoder& encode);
+
+    /**
+     * @brief Encodes a frame for every session of a set of users, in the version each speaks.
+     *
+     * The frame is encoded, and compressed for the sessions that accept it, at most once per
+     * codec however many users and sessions it goes to, and the sessions sharing a codec share
+     * the encoded bytes. Offline users are skipped.
+     *
+     * @param user_uids The UUIDs of the target users.
+     * @param encode Appends the frame, encoded with the given protocol version, to the buffer.
+     * @return The number of sessions the frame was delivered to.
+     */
+    size_t send_to_users(const std::vector<UUID>& user_uids, const Encoder& encode);
+
+    void on_message_added(const Message::SharedPtr& message,
+                          const std::vector<UUID>& user_uids) override;
+    void on_message_removed(const Message::SharedPtr& message,
+                            const std::vector<UUID>& user_uids) override;
+    void on_channel_added(const Channel::SharedPtr& channel,
+                          const std::vector<UUID>& user_uids) override;
+
+   private:
+    /**
+     * @brief A registered connection.
+     */
+    struct Connection {
+        /// The handler owning the connection.
+        ClientHandler* handler;
+        /// The user authenticated on the connection, if any.
+        std::optional<UUID> user_uid;
+        /// The protocol version the connection speaks.
+        uint8_t version = PROTOCOL_VERSION;
+        /// Whether the connection accepts compressed frames.
+        bool compression = false;
+    };
+
+    /**
+     * @brief The sessions of a single online user.
+     */
+    struct Session {
+        /// The connections on which the user is authenticated.
+        std::vector<ConnectionId> connections;
+    };
+
+    /**
+     * @brief A frame on its way to a connection, captured so that it is encoded and written
+     *        without the mutex held.
+     */
+    struct Delivery {
+        /// The id of the target connection.
+        ConnectionId connection_id;
+        /// The handler owning the connection.
+        ClientHandler* handler;
+        /// The thread the handler lives on.
+        QThread* thread;
+        /// The protocol version the connection speaks.
+        uint8_t version;
+        /// Whether the connection accepts compressed frames.
+        bool compression;
+        /// The frame to write, filled in once encoded.
+        Frame frame;
+    };
+
+    /**
+     * @brief Captures a connection as the target of a delivery. Must be called with the mutex
+     *        held.
+     */
+    static Delivery delivery_to(ConnectionId connection_id, const Connection& connection);
+
+    /**
+     * @brief Captures every session of a set of users as the targets of a delivery.
+     */
+    std::vector<Delivery> deliveries_to(const std::vector<UUID>& user_uids);
+
+    /**
+     * @brief Writes each delivery's frame to its handler from any thread. Must be called without
+     *        the mutex held.
+     *
+     * Handlers on the calling thread are written to directly, and the others are handed their
+     * frame through their event loop, unless their connection was removed in the meantime.
+     */
+    void deliver(const std::vector<Delivery>& deliveries);
+
+    /**
+     * @brief Unbinds a connection from its user. Must be called with the mutex held.
+     */
+    void unbind_user_locked(Connection& connection, ConnectionId connection_id);
+
+    /// Maps connection ids to their connections.
+    std::unordered_map<ConnectionId, Connection> connections;
+    /// Maps user UUIDs to their authenticated sessions.
+    std::unordered_map<UUID, Session> sessions;
+    /// The id handed to the next connection.
+    ConnectionId next_connection_id = 0;
+    /// Mutex to ensure thread-safe access to the registry.
+    std::mutex mutex;
+};
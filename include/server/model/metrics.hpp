@@ -0,0 +1,238 @@
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "message/header.hpp"
+#include "message/message_types.hpp"
+
+/**
+ * @class Histogram
+ * @brief Counts recorded values in log-linear buckets, as HdrHistogram does.
+ *
+ * Each power of two is split into SUB_BUCKETS equal buckets, so every value is counted within
+ * 1/SUB_BUCKETS of its magnitude whatever the range: nanoseconds and seconds alike. Values below
+ * SUB_BUCKETS get a bucket each. Recording is a few relaxed atomic increments and never blocks.
+ */
+class Histogram {
+   public:
+    /// The base-2 logarithm of the number of buckets per power of two.
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    /// The number of buckets per power of two.
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    /// The number of buckets needed to cover every uint64_t.
+    static constexpr size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    /**
+     * @brief Counts a value.
+     * @param value The value to count.
+     */
+    void record(uint64_t value) {
+        this->buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+        this->count.fetch_add(1, std::memory_order_relaxed);
+        this->sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets the number of values counted.
+     * @return The number of values.
+     */
+    [[nodiscard]] uint64_t get_count() const { return this->count.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets the sum of the values counted.
+     * @return The sum of the values.
+     */
+    [[nodiscard]] uint64_t get_sum() const { return this->sum.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets the number of values counted that are at most a bound.
+     *
+     * Exact when bound + 1 is a power of two or below SUB_BUCKETS; otherwise the bucket holding the
+     * bound is counted only if the bound is its last value.
+     *
+     * @param bound The largest value to count.
+     * @return The number of values at most bound.
+     */
+    [[nodiscard]] uint64_t count_at_most(uint64_t bound) const;
+
+    /**
+     * @brief Gets the value below which a fraction of the counted values lie.
+     * @param quantile The fraction, between 0 and 1.
+     * @return The largest value of the bucket holding the quantile, or 0 if nothing was counted.
+     */
+    [[nodiscard]] uint64_t value_at_quantile(double quantile) const;
+
+    /**
+     * @brief Gets the bucket a value is counted in.
+     */
+    static constexpr size_t bucket_of(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return value;
+        }
+        unsigned shift = std::bit_width(value) - 1 - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+    }
+
+    /**
+     * @brief Gets the largest value counted in a bucket.
+     */
+    static constexpr uint64_t last_value_of(size_t bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+        unsigned shift = bucket / SUB_BUCKETS - 1;
+        uint64_t first = uint64_t(bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+        return first + ((uint64_t(1) << shift) - 1);
+    }
+
+   private:
+    /// The number of values counted in each bucket.
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets = {};
+    /// The number of values counted.
+    std::atomic<uint64_t> count = 0;
+    /// The sum of the values counted.
+    std::atomic<uint64_t> sum = 0;
+};
+
+/**
+ * @class Metrics
+ * @brief Counts what the server does, for a Prometheus scraper to collect.
+ *
+ * Connections record every request they decode and every frame they write, by operation: how
+ * many, how many bytes, and how long each request took from the moment its frame was complete to
+ * the moment its response was written. The registry records how many sessions each message is
+ * fanned out to. Quantities that already live elsewhere, such as the number of connections, are
+ * registered as gauges and read when the metrics are rendered.
+ *
+ * Counters are relaxed atomics, each operation on cache lines of its own, so that recording adds
+ * a few uncontended increments to a request.
+ */
+class Metrics {
+   public:
+    /**
+     * @brief Retrieves the metrics of the server.
+     *
+     * @return Reference to the singleton Metrics instance.
+     */
+    static Metrics& get_instance();
+
+    /**
+     * @brief Constructs empty metrics, with no gauges.
+     */
+    Metrics() = default;
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    /**
+     * @brief Records a request decoded from a frame.
+     *
+     * @param operation The operation of the frame.
+     * @param bytes The size of the frame on the wire, header included.
+     */
+    void record_request(Operation operation, size_t bytes);
+
+    /**
+     * @brief Records a frame written to a connection.
+     *
+     * @param operation The operation of the frame.
+     * @param bytes The size of the frame on the wire, header included.
+     */
+    void record_response(Operation operation, size_t bytes);
+
+    /**
+     * @brief Records how long a request took to answer.
+     *
+     * @param operation The operation of the request.
+     * @param latency The time from its frame being complete to its response being written.
+     */
+    void record_latency(Operation operation, std::chrono::nanoseconds latency);
+
+    /**
+     * @brief Records the number of sessions a new message was delivered to.
+     * @param sessions The number of sessions.
+     */
+    void record_fanout(size_t sessions);
+
+    /**
+     * @brief Registers a quantity read whenever the metrics are rendered.
+     *
+     * @param name The name of the metric.
+     * @param help What the metric measures.
+     * @param read Returns the current value; called from the thread rendering the metrics.
+     */
+    void add_gauge(std::string name, std::string help, std::function<double()> read);
+
+    /**
+     * @brief Gets the number of requests recorded for an operation.
+     * @param operation The operation.
+     * @return The number of requests.
+     */
+    [[nodiscard]] uint64_t get_num_requests(Operation operation) const;
+
+    /**
+     * @brief Gets the latencies recorded for an operation, in nanoseconds.
+     * @param operation The operation.
+     * @return The histogram of latencies.
+     */
+    [[nodiscard]] const Histogram& get_latency(Operation operation) const;
+
+    /**
+     * @brief Gets the fan-out sizes recorded for new messages.
+     * @return The histogram of the number of sessions each message was delivered to.
+     */
+    [[nodiscard]] const Histogram& get_fanout() const;
+
+    /**
+     * @brief Renders every metric in the Prometheus text exposition format.
+     * @return The metrics, one sample per line.
+     */
+    [[nodiscard]] std::string render() const;
+
+   private:
+    /**
+     * @brief The counters of one operation, on cache lines of their own.
+     */
+    struct alignas(64) OperationMetrics {
+        std::atomic<uint64_t> requests = 0;
+        std::atomic<uint64_t> bytes_in = 0;
+        std::atomic<uint64_t> responses = 0;
+        std::atomic<uint64_t> bytes_out = 0;
+        Histogram latency;
+    };
+
+    /**
+     * @brief A quantity read when the metrics are rendered.
+     */
+    struct Gauge {
+        std::string name;
+        std::string help;
+        std::function<double()> read;
+    };
+
+    /// The counters of each operation, indexed by operation.
+    std::array<OperationMetrics, NUM_OPERATIONS> operations;
+    /// The counters of frames whose operation is unknown.
+    OperationMetrics unknown;
+    /// The number of sessions each new message was delivered to.
+    Histogram fanout;
+    /// Guards gauges.
+    mutable std::mutex gauges_mutex;
+    /// The registered gauges.
+    std::vector<Gauge> gauges;
+
+    OperationMetrics& metrics_for(Operation operation) {
+        return operation < NUM_OPERATIONS ? this->operations[operation] : this->unknown;
+    }
+
+    const OperationMetrics& metrics_for(Operation operation) const {
+        return operation < NUM_OPERATIONS ? this->operations[operation] : this->unknown;
+    }
+};
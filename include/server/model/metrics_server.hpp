@@ -0,0 +1,40 @@
+#pragma once
+#include <QTcpServer>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Serves the server's Metrics over HTTP, for a Prometheus scraper.
+ *
+ * Answers GET /metrics with Metrics::render() in the text exposition format and closes the
+ * connection. Meant for an admin port bound to the loopback interface: it runs on the main thread,
+ * apart from the workers serving clients, and does no authentication.
+ */
+class MetricsServer : public QTcpServer {
+    Q_OBJECT
+
+   public:
+    /// The largest request accepted; scrapers send a few hundred bytes of headers.
+    static constexpr size_t MAX_REQUEST_SIZE = 8192;
+
+    /**
+     * @brief Constructs a MetricsServer; call listen() to start serving.
+     * @param parent The parent QObject (default is nullptr).
+     */
+    explicit MetricsServer(QObject* parent = nullptr);
+
+    /**
+     * @brief Builds the HTTP response to a request.
+     *
+     * @param request The request line and headers, up to the blank line ending them.
+     * @return The full response: the metrics, or an error status.
+     */
+    [[nodiscard]] static std::string respond(std::string_view request);
+
+   protected:
+    /**
+     * @brief Reads the request on a new connection and answers it once its headers are complete.
+     * @param socket_descriptor The descriptor of the accepted socket.
+     */
+    void incomingConnection(qintptr socket_descriptor) override;
+};
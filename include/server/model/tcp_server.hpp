@@ -1,12 +1,29 @@
 #pragma once
 #include <QTcpServer>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * @enum SchedulingPolicy
+ * @brief Strategy used to assign accepted connections to worker threads.
+ */
+enum class SchedulingPolicy {
+    /// Hand out workers in a fixed rotating order.
+    ROUND_ROBIN,
+    /// Hand each connection to the worker currently serving the fewest connections.
+    LEAST_LOADED,
+};
 
 /**
  * @brief A TCP server that handles incoming connections.
  *
  * The TcpServer class inherits from QTcpServer and overrides the incomingConnection()
- * method to handle new client connections. This class can be extended to provide custom
- * logic for managing incoming connections.
+ * method to handle new client connections. Rather than spawning a thread per client, the server
+ * owns a fixed pool of worker threads, each running its own event loop. Accepted connections are
+ * assigned to a worker according to the configured SchedulingPolicy, and every worker multiplexes
+ * all of the ClientHandlers assigned to it.
  */
 class TcpServer : public QTcpServer {
     Q_OBJECT
@@ -15,21 +32,75 @@ class TcpServer : public QTcpServer {
     /**
      * @brief Constructs a new TcpServer instance.
      *
-     * Initializes the TcpServer with an optional parent QObject.
+     * Initializes the TcpServer and starts its worker threads.
      *
+     * @param num_workers The number of worker threads (defaults to the number of cores).
+     * @param policy The policy used to assign new connections to workers.
      * @param parent The parent QObject (default is nullptr).
      */
-    explicit TcpServer(QObject* parent = nullptr);
+    explicit TcpServer(int num_workers = QThread::idealThreadCount(),
+                       SchedulingPolicy policy = SchedulingPolicy::ROUND_ROBIN,
+                       QObject* parent = nullptr);
+
+    /**
+     * @brief Stops every worker thread and waits for it to finish.
+     *
+     * The handlers still connected are deleted by their worker as it finishes, along with their
+     * sockets.
+     */
+    ~TcpServer() override;
+
+    /**
+     * @brief Gets the number of worker threads owned by the server.
+     * @return The size of the worker pool.
+     */
+    [[nodiscard]] size_t get_num_workers() const;
+
+    /**
+     * @brief Gets the number of connections currently served by a worker.
+     * @param worker The index of the worker.
+     * @return The number of live connections assigned to that worker.
+     */
+    [[nodiscard]] size_t get_connection_count(size_t worker) const;
+
+    /**
+     * @brief Gets the total number of live connections across all workers.
+     * @return The number of live connections.
+     */
+    [[nodiscard]] size_t get_connection_count() const;
 
    protected:
     /**
      * @brief Handles incoming connections.
      *
-     * This method is called by QTcpServer when a new connection is available.
-     * It receives the socket descriptor for the new connection, allowing derived classes
-     * to implement custom logic for handling client connections.
+     * This method is called by QTcpServer when a new connection is available. A ClientHandler is
+     * created for the socket descriptor and moved onto the worker selected by the scheduling policy.
      *
      * @param socketDescriptor The socket descriptor for the incoming connection.
      */
     void incomingConnection(qintptr socketDescriptor) override;
+
+   private:
+    /**
+     * @brief An event-loop thread along with the number of connections it is serving.
+     */
+    struct Worker {
+        /// The thread running this worker's event loop.
+        QThread* thread;
+        /// The number of connections currently assigned to this worker.
+        std::atomic<size_t> connections = 0;
+    };
+
+    /**
+     * @brief Picks the worker that should receive the next connection.
+     * @return The index of the selected worker.
+     */
+    size_t next_worker();
+
+    /// The fixed pool of worker threads.
+    std::vector<std::unique_ptr<Worker>> workers;
+    /// The policy used to assign connections to workers.
+    SchedulingPolicy policy;
+    /// The worker that will receive the next connection under ROUND_ROBIN scheduling.
+    size_t next_round_robin = 0;
 };
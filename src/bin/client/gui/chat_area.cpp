@@ -60,6 +60,10 @@ ChatArea::ChatArea(QWidget* parent) : QWidget(parent) {
             &ChatArea::onDeleteMessageSuccess);
     connect(session.tcp_client, &TcpClient::deleteMessageFailure, this,
             &ChatArea::onDeleteMessageFailure);
+    connect(session.tcp_client, &TcpClient::fetchHistorySuccess, this,
+            &ChatArea::onFetchHistorySuccess);
+    connect(messageScrollArea->verticalScrollBar(), &QScrollBar::valueChanged, this,
+            &ChatArea::onScrolled);
 }
 
 void ChatArea::validateMessage() {
@@ -85,15 +89,11 @@ void ChatArea::onActiveChannelChanged() {
         chatTitle->setText(
             QString::fromStdString(session.get_active_channel().value()->get_name()));
 
-        // Clear existing messages
-        QLayoutItem* child;
-        while ((child = messageLayout->takeAt(0)) != nullptr) {
-            delete child->widget();
-            delete child;
-        }
+        redrawMessages();
 
-        for (auto& message : session.get_active_channel_messages()) {
-            addMessageToLayout(message);
+        // Only the newest messages are synced, older ones are fetched on demand
+        if (session.get_active_channel_messages().empty()) {
+            session.request_older_messages(session.get_active_channel().value()->get_uid());
         }
 
         // Auto-scroll to the bottom
@@ -106,6 +106,21 @@ void ChatArea::onActiveChannelChanged() {
     }
 }
 
+void ChatArea::redrawMessages() {
+    Session& session = Session::get_instance();
+
+    // Clear existing messages
+    QLayoutItem* child;
+    while ((child = messageLayout->takeAt(0)) != nullptr) {
+        delete child->widget();
+        delete child;
+    }
+
+    for (auto& message : session.get_active_channel_messages()) {
+        addMessageToLayout(message);
+    }
+}
+
 void ChatArea::addMessageToLayout(Message::SharedPtr message) {
     Session& session = Session::get_instance();
     MessageWidget* messageWidget = new MessageWidget(message, messageContainer);
@@ -155,6 +170,31 @@ void ChatArea::onDeleteMessageFailure(const QString& error) {
     qDebug() << "Failed to delete message: " << error;
 }
 
+void ChatArea::onScrolled(int value) {
+    Session& session = Session::get_instance();
+    if (value == messageScrollArea->verticalScrollBar()->minimum() &&
+        session.get_active_channel().has_value()) {
+        session.request_older_messages(session.get_active_channel().value()->get_uid());
+    }
+}
+
+void ChatArea::onFetchHistorySuccess(Channel::SharedPtr channel) {
+    Session& session = Session::get_instance();
+    if (!session.get_active_channel().has_value() ||
+        session.get_active_channel().value()->get_uid() != channel->get_uid()) {
+        return;
+    }
+
+    // Older messages are inserted above, keep the visible ones in place
+    QScrollBar* scrollBar = messageScrollArea->verticalScrollBar();
+    int fromBottom = scrollBar->maximum() - scrollBar->value();
+    redrawMessages();
+    QTimer::singleShot(50, [this, fromBottom]() {
+        QScrollBar* scrollBar = messageScrollArea->verticalScrollBar();
+        scrollBar->setValue(scrollBar->maximum() - fromBottom);
+    });
+}
+
 void ChatArea::reset() {
     messageInput->setEnabled(false);
     messageInput->clear();
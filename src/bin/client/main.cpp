@@ -1,10 +1,27 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QStackedLayout>
 
 #include "client/model/session.hpp"
+#include "constants.hpp"
 
 int main(int argc, char* argv[]) {
     QApplication app(argc, argv);
-    Session::get_instance();
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("Sock-et Out");
+    parser.addHelpOption();
+
+    // Define command-line option for the JSON protocol
+    QCommandLineOption jsonOption("json", "Speak the JSON protocol instead of the binary one");
+    parser.addOption(jsonOption);
+
+    // Parse command-line arguments
+    parser.process(app);
+
+    Session& session = Session::get_instance();
+    if (parser.isSet(jsonOption)) {
+        session.tcp_client->set_version(PROTOCOL_VERSION_JSON);
+    }
     return app.exec();
 }
@@ -3,10 +3,14 @@
 #include "message/create_channel_response.hpp"
 #include "message/delete_account_response.hpp"
 #include "message/delete_message_response.hpp"
+#include "message/fetch_history_response.hpp"
+#include "message/hello.hpp"
 #include "message/list_accounts_response.hpp"
 #include "message/login_response.hpp"
 #include "message/register_account_response.hpp"
 #include "message/send_message_response.hpp"
+#include "message/sync_response.hpp"
+#include "models/logger.hpp"
 #include "models/message_handler.hpp"
 
 void on_register_account_response(QTcpSocket* socket, RegisterAccountResponse& msg) {
@@ -24,12 +28,14 @@ void on_login_response(QTcpSocket* socket, LoginResponse& msg) {
     if (msg.is_success()) {
         User::SharedPtr usr = msg.get_data().value();
         session.authenticated_user = usr;
-        qDebug() << "Authenticated user: " << QString::fromStdString(usr->get_username());
-        qDebug() << "Authenticated display name: "
-                 << QString::fromStdString(usr->get_display_name());
-        qDebug() << "Authenticated profile pic: " << QString::fromStdString(usr->get_profile_pic());
+        LOG_INFO << "Authenticated user:" << usr->get_username();
+        LOG_DEBUG << "Authenticated display name:" << usr->get_display_name();
+        LOG_DEBUG << "Authenticated profile pic:" << usr->get_profile_pic();
 
         emit session.tcp_client->loginSuccess();
+
+        // Only the history sent since the last sync is downloaded again after a reconnect
+        session.tcp_client->sync(session.get_sync_watermark(), 0);
     } else {
         emit session.tcp_client->loginFailure(
             QString::fromStdString(msg.get_error_message().value()));
@@ -84,6 +90,57 @@ void on_send_message_response(QTcpSocket* socket, SendMessageResponse& msg) {
     }
 };
 
+void on_sync_response(QTcpSocket* socket, SyncResponse& msg) {
+    Session& session = Session::get_instance();
+    if (!msg.is_success()) {
+        LOG_WARN << "Sync failed:" << msg.get_error_message().value();
+        return;
+    }
+
+    SyncResponse::Batch batch = msg.get_batch().value();
+    for (const Channel::SharedPtr& channel : batch.channels) {
+        bool known = session.has_channel(channel->get_uid());
+        session.add_channel(channel);
+        if (!known) {
+            emit session.tcp_client->createChannelSuccess(channel);
+        }
+    }
+    std::optional<Channel::SharedPtr> active_channel = session.get_active_channel();
+    if (!active_channel.has_value() && !batch.channels.empty()) {
+        active_channel = batch.channels.back();
+    }
+
+    bool active_channel_changed = false;
+    for (const Message::SharedPtr& message : batch.messages) {
+        session.add_message(message);
+        active_channel_changed |= active_channel.has_value() &&
+                                  message->get_channel_id() == active_channel.value()->get_uid();
+    }
+    // Redraw the open channel once per page rather than once per message
+    if (active_channel.has_value() &&
+        (active_channel_changed || !session.get_active_channel().has_value())) {
+        session.set_active_channel(active_channel.value());
+    }
+
+    if (batch.has_more) {
+        session.tcp_client->sync(batch.next_since, batch.next_channel_offset);
+    }
+};
+
+void on_fetch_history_response(QTcpSocket* socket, FetchHistoryResponse& msg) {
+    Session& session = Session::get_instance();
+    if (!msg.is_success()) {
+        LOG_WARN << "Fetching history failed:" << msg.get_error_message().value();
+        return;
+    }
+
+    HistoryPage page = msg.get_page().value();
+    std::optional<Channel::SharedPtr> channel = session.add_history(page);
+    if (channel.has_value()) {
+        emit session.tcp_client->fetchHistorySuccess(channel.value());
+    }
+};
+
 void on_delete_message_response(QTcpSocket* socket, DeleteMessageResponse& msg) {
     Session& session = Session::get_instance();
     if (msg.is_success()) {
@@ -95,12 +152,20 @@ void on_delete_message_response(QTcpSocket* socket, DeleteMessageResponse& msg)
     }
 };
 
+void on_hello(QTcpSocket* socket, HelloMessage& msg) {
+    Session& session = Session::get_instance();
+    session.tcp_client->set_compression(msg.has_feature(HelloMessage::FEATURE_COMPRESSION));
+};
+
 void init_message_handlers(MessageHandler& messageHandler) {
-    messageHandler.register_handler<RegisterAccountResponse>(&on_register_account_response);
-    messageHandler.register_handler<LoginResponse>(&on_login_response);
-    messageHandler.register_handler<ListAccountsResponse>(&on_list_accounts_response);
-    messageHandler.register_handler<DeleteAccountResponse>(&on_delete_account_response);
-    messageHandler.register_handler<DeleteMessageResponse>(&on_delete_message_response);
-    messageHandler.register_handler<CreateChannelResponse>(&on_create_channel_response);
-    messageHandler.register_handler<SendMessageResponse>(&on_send_message_response);
+    messageHandler.register_handler<&on_register_account_response>();
+    messageHandler.register_handler<&on_login_response>();
+    messageHandler.register_handler<&on_list_accounts_response>();
+    messageHandler.register_handler<&on_delete_account_response>();
+    messageHandler.register_handler<&on_delete_message_response>();
+    messageHandler.register_handler<&on_create_channel_response>();
+    messageHandler.register_handler<&on_send_message_response>();
+    messageHandler.register_handler<&on_sync_response>();
+    messageHandler.register_handler<&on_fetch_history_response>();
+    messageHandler.register_handler<&on_hello>();
 }
\ No newline at end of file
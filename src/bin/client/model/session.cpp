@@ -1,10 +1,13 @@
 #include <QWidget>
+#include <algorithm>
 #include <optional>
 #include "client/gui/authentication_window.hpp"
 #include "client/gui/chat_window.hpp"
 #include "client/gui/connection_window.hpp"
 
 #include "client/model/session.hpp"
+#include "message/fetch_history.hpp"
+#include "message/fetch_history_response.hpp"
 
 Session& Session::get_instance() {
     static Session instance;
@@ -29,6 +32,9 @@ void Session::reset() {
     authenticated_user = std::nullopt;
     channels.clear();
     channel_messages.clear();
+    sync_watermark = 0;
+    history_requested.clear();
+    history_complete.clear();
     open_channel = std::nullopt;
     main_window->reset();
 }
@@ -38,8 +44,22 @@ void Session::add_message(const Message::SharedPtr& message) {
         return;
     }
 
-    channel_messages[message->get_channel_id()].push_back(message);
+    // Pages of older history arrive after newer messages, so keep each channel in order
+    auto& messages = channel_messages[message->get_channel_id()];
+    auto it = std::lower_bound(messages.begin(), messages.end(), message->get_snowflake(),
+                               [](const Message::SharedPtr& held, uint64_t snowflake) {
+                                   return held->get_snowflake() < snowflake;
+                               });
+    if (it != messages.end() && (*it)->get_snowflake() == message->get_snowflake()) {
+        return;
+    }
+    messages.insert(it, message);
     channels[message->get_channel_id()]->add_message(message->get_snowflake());
+    sync_watermark = std::max(sync_watermark, message->get_snowflake());
+}
+
+uint64_t Session::get_sync_watermark() const {
+    return sync_watermark;
 }
 
 const std::vector<Message::SharedPtr>& Session::get_active_channel_messages() const {
@@ -57,8 +77,49 @@ void Session::set_active_channel(const Channel::SharedPtr& channel) {
 }
 
 void Session::add_channel(const Channel::SharedPtr& channel) {
+    auto it = channel_messages.find(channel->get_uid());
+    if (it != channel_messages.end()) {
+        // A sync after a reconnect sends the channel again; keep the messages already received
+        for (const Message::SharedPtr& message : it->second) {
+            channel->add_message(message->get_snowflake());
+        }
+        if (open_channel && open_channel.value()->get_uid() == channel->get_uid()) {
+            open_channel = channel;
+        }
+    } else {
+        channel_messages[channel->get_uid()] = {};
+    }
     channels[channel->get_uid()] = channel;
-    channel_messages[channel->get_uid()] = {};
+}
+
+void Session::request_older_messages(const UUID& channel_uid) {
+    auto it = channel_messages.find(channel_uid);
+    if (it == channel_messages.end() || history_requested.contains(channel_uid) ||
+        history_complete.contains(channel_uid)) {
+        return;
+    }
+    uint64_t before = it->second.empty() ? 0 : it->second.front()->get_snowflake();
+    history_requested.insert(channel_uid);
+    tcp_client->fetch_history(channel_uid, before, 0, FetchHistoryMessage::DEFAULT_LIMIT);
+}
+
+std::optional<Channel::SharedPtr> Session::add_history(const HistoryPage& page) {
+    history_requested.erase(page.channel_uid);
+    auto it = channels.find(page.channel_uid);
+    if (it == channels.end()) {
+        return std::nullopt;
+    }
+    if (!page.has_more) {
+        history_complete.insert(page.channel_uid);
+    }
+    for (const Message::SharedPtr& message : page.messages) {
+        add_message(message);
+    }
+    return it->second;
+}
+
+bool Session::has_channel(const UUID& channel_uid) const {
+    return channels.contains(channel_uid);
 }
 
 void Session::remove_message(const Message::SharedPtr& message) {
@@ -1,5 +1,3 @@
-#include <QThread>
-
 #include "client/model/session.hpp"
 #include "client/model/tcp_client.hpp"
 #include "constants.hpp"
@@ -9,6 +7,10 @@
 #include "message/delete_account_response.hpp"
 #include "message/delete_message.hpp"
 #include "message/delete_message_response.hpp"
+#include "message/fetch_history.hpp"
+#include "message/fetch_history_response.hpp"
+#include "message/frame_decoder.hpp"
+#include "message/hello.hpp"
 #include "message/header.hpp"
 #include "message/list_accounts.hpp"
 #include "message/list_accounts_response.hpp"
@@ -18,6 +20,9 @@
 #include "message/register_account_response.hpp"
 #include "message/send_message.hpp"
 #include "message/send_message_response.hpp"
+#include "message/sync.hpp"
+#include "message/sync_response.hpp"
+#include "models/logger.hpp"
 #include "models/message_handler.hpp"
 
 TcpClient::TcpClient(QObject* parent) : QObject(parent) {
@@ -31,16 +36,16 @@ TcpClient::TcpClient(QObject* parent) : QObject(parent) {
 
 void TcpClient::connectToServer(const QString& host, quint16 port) {
     if (socket->state() == QAbstractSocket::ConnectedState) {
-        qDebug() << "Already connected to the server.";
+        LOG_WARN << "Already connected to the server.";
         return;
     }
 
     if (socket->state() == QAbstractSocket::ConnectingState) {
-        qDebug() << "Connection is already in progress.";
+        LOG_WARN << "Connection is already in progress.";
         return;
     }
 
-    qDebug() << "Connecting to server at" << host << ":" << port;
+    LOG_INFO << "Connecting to server at" << host << port;
     socket->connectToHost(host, port);
 }
 
@@ -48,151 +53,82 @@ void TcpClient::register_user(const std::string& username,
                               const std::string& displayName,
                               const std::string& password) {
     RegisterAccountMessage message(username, password, displayName);
-    std::vector<uint8_t> data;
-    message.serialize_msg(data);
-    socket->write(reinterpret_cast<const char*>(data.data()), data.size());
-    socket->flush();
+    send(message);
 }
 
 void TcpClient::login_user(const std::string& username, const std::string& password) {
     LoginMessage message(username, password);
-    std::vector<uint8_t> data;
-    message.serialize_msg(data);
-    socket->write(reinterpret_cast<const char*>(data.data()), data.size());
-    socket->flush();
+    send(message);
 }
 
 void TcpClient::search_accounts(const std::string& regex) {
     ListAccountsMessage message(regex);
-    std::vector<uint8_t> data;
-    message.serialize_msg(data);
-    socket->write(reinterpret_cast<const char*>(data.data()), data.size());
-    socket->flush();
+    send(message);
 }
 
 void TcpClient::delete_account(const std::string& username, const std::string& password) {
     DeleteAccountMessage message(username, password);
-    std::vector<uint8_t> data;
-    message.serialize_msg(data);
-    socket->write(reinterpret_cast<const char*>(data.data()), data.size());
-    socket->flush();
+    send(message);
 }
 
 void TcpClient::create_channel(const std::string& channelName, const std::vector<UUID>& members) {
     CreateChannelMessage message(channelName, members);
-    std::vector<uint8_t> data;
-    message.serialize_msg(data);
-    socket->write(reinterpret_cast<const char*>(data.data()), data.size());
-    socket->flush();
+    send(message);
 }
 
 void TcpClient::send_text_message(const UUID& channel_uid,
                                   const UUID& sender_uid,
                                   const std::string& text) {
     SendMessageMessage message(channel_uid, sender_uid, text);
-    std::vector<uint8_t> data;
-    message.serialize_msg(data);
-    socket->write(reinterpret_cast<const char*>(data.data()), data.size());
-    socket->flush();
+    send(message);
 }
 
 void TcpClient::delete_message(Message::SharedPtr message) {
     Session& session = Session::get_instance();
     DeleteMessageMessage msg(message->get_channel_id(), message->get_snowflake());
-    std::vector<uint8_t> data;
-    msg.serialize_msg(data);
-    socket->write(reinterpret_cast<const char*>(data.data()), data.size());
-    socket->flush();
+    send(msg);
+}
+
+void TcpClient::sync(uint64_t since, uint32_t channel_offset) {
+    SyncMessage message(since, channel_offset);
+    send(message);
+}
+
+void TcpClient::fetch_history(const UUID& channel_uid, uint64_t before, uint64_t after,
+                              uint16_t limit) {
+    FetchHistoryMessage message(channel_uid, before, after, limit);
+    send(message);
 }
 
 void TcpClient::onReadyRead() {
+    QByteArray data = socket->readAll();
+    decoder.feed(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+
     while (true) {
-        Header header;
-        if (socket->bytesAvailable() < header.size()) {
+        std::optional<FrameDecoder::Frame> frame;
+        try {
+            frame = decoder.next();
+        } catch (const std::out_of_range& e) {
+            // Nothing after a frame that was never read can be trusted
+            LOG_WARN << "Malformed stream:" << e.what();
+            decoder.reset();
             return;
         }
-        QByteArray headerData = socket->read(header.size());
-        std::vector<uint8_t> vec(headerData.size());
-        std::transform(headerData.begin(), headerData.end(), vec.begin(),
-                       [](char c) { return static_cast<uint8_t>(c); });
-        header.deserialize(vec);
-        qDebug() << "Received header: " << header.get_version() << " " << header.get_operation()
-                 << " " << header.get_packet_length();
-
-        if (header.get_version() != PROTOCOL_VERSION) {
-            qDebug() << "Protocol version mismatch";
-            return;
+        if (!frame.has_value()) {
+            break;
         }
 
-        static constexpr uint8_t MAX_RETRIES = 100;
-        uint8_t retries = 0;
-        while (socket->bytesAvailable() < header.get_packet_length()) {
-            if (++retries > MAX_RETRIES) {
-                qDebug() << "Timeout waiting for message data";
-                return;
-            }
-            QThread::msleep(100);
+        const Header& header = frame->header;
+        LOG_TRACE << "Received header:" << header.get_version()
+                  << static_cast<int>(header.get_operation()) << header.get_packet_length();
+
+        if (header.get_version() != this->version) {
+            LOG_WARN << "Protocol version mismatch";
+            continue;
         }
 
-        QByteArray data = socket->read(header.get_packet_length());
-        std::vector<uint8_t> msg(header.get_packet_length());
-        std::transform(data.begin(), data.end(), msg.begin(),
-                       [](char c) { return static_cast<uint8_t>(c); });
-
-        MessageHandler& messageHandler = MessageHandler::get_instance();
-        switch (header.get_operation()) {
-            case Operation::REGISTER_ACCOUNT: {
-                RegisterAccountResponse response;
-                response.deserialize(msg);
-                qDebug() << response.to_json().c_str();
-                messageHandler.dispatch(socket, response);
-                break;
-            }
-            case Operation::LOGIN: {
-                LoginResponse response;
-                response.deserialize(msg);
-                qDebug() << response.to_json().c_str();
-                messageHandler.dispatch(socket, response);
-                break;
-            }
-            case Operation::LIST_ACCOUNTS: {
-                ListAccountsResponse response;
-                response.deserialize(msg);
-                qDebug() << response.to_json().c_str();
-                messageHandler.dispatch(socket, response);
-                break;
-            }
-            case Operation::DELETE_ACCOUNT: {
-                DeleteAccountResponse response;
-                response.deserialize(msg);
-                qDebug() << response.to_json().c_str();
-                messageHandler.dispatch(socket, response);
-                break;
-            }
-            case Operation::DELETE_MESSAGE: {
-                DeleteMessageResponse response;
-                response.deserialize(msg);
-                qDebug() << response.to_json().c_str();
-                messageHandler.dispatch(socket, response);
-                break;
-            }
-            case Operation::CREATE_CHANNEL: {
-                CreateChannelResponse response;
-                response.deserialize(msg);
-                qDebug() << response.to_json().c_str();
-                messageHandler.dispatch(socket, response);
-                break;
-            }
-            case Operation::SEND_MESSAGE: {
-                SendMessageResponse response;
-                response.deserialize(msg);
-                qDebug() << response.to_json().c_str();
-                messageHandler.dispatch(socket, response);
-                break;
-            }
-            default:
-                qDebug() << "Unknown operation";
-                break;
+        if (!MessageHandler::get_instance().dispatch(socket, header, frame->payload)) {
+            LOG_WARN << "Unknown operation";
         }
     }
 }
@@ -205,17 +141,30 @@ QAbstractSocket::SocketState TcpClient::getConnectionStatus() const {
     return socket->state();
 }
 
+void TcpClient::set_compression(bool compression) {
+    this->compression = compression;
+}
+
+void TcpClient::set_version(uint8_t version) {
+    this->version = version;
+}
+
 void TcpClient::onConnected() {
     Session& session = Session::get_instance();
-    qDebug() << "Connected to server";
+    decoder.reset();
+    LOG_INFO << "Connected to server";
+
+    // Frames stay uncompressed until the server accepts compression
+    this->compression = false;
+    send(HelloMessage(HelloMessage::FEATURE_COMPRESSION));
     session.main_window->animatePageTransition(Window::AUTHENTICATION);
 }
 void TcpClient::onDisconnected() {
     Session& session = Session::get_instance();
-    qDebug() << "Disconnected from server";
+    LOG_INFO << "Disconnected from server";
     session.main_window->animatePageTransition(Window::CONNECTION);
 }
 
 void TcpClient::onErrorOccurred(QAbstractSocket::SocketError socketError) {
-    qDebug() << "Socket error:" << socket->errorString();
+    LOG_WARN << "Socket error:" << socket->errorString();
 }
@@ -0,0 +1,138 @@
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+
+#include "loadgen/load_client.hpp"
+#include "loadgen/load_generator.hpp"
+#include "message/create_channel.hpp"
+#include "message/login.hpp"
+#include "message/register_account.hpp"
+#include "message/send_message.hpp"
+#include "models/logger.hpp"
+#include "models/message_handler.hpp"
+
+namespace {
+
+/// Starts the text of every message the load generator sends, followed by the time it was sent.
+constexpr std::string_view TEXT_PREFIX = "loadgen ";
+
+}  // namespace
+
+LoadClient::LoadClient(LoadGenerator& generator, std::string username, uint8_t version,
+                       QObject* parent)
+    : QObject(parent),
+      generator(generator),
+      socket(new QTcpSocket(this)),
+      version(version),
+      username(std::move(username)) {
+    connect(this->socket, &QTcpSocket::connected, this, &LoadClient::on_connected);
+    connect(this->socket, &QTcpSocket::readyRead, this, &LoadClient::on_read_data);
+    connect(this->socket, &QTcpSocket::errorOccurred, this, &LoadClient::on_error);
+}
+
+LoadClient* LoadClient::from_socket(QTcpSocket* socket) {
+    return qobject_cast<LoadClient*>(socket->parent());
+}
+
+void LoadClient::connect_to_server(const QString& host, quint16 port) {
+    this->socket->connectToHost(host, port);
+}
+
+void LoadClient::register_account() {
+    send(RegisterAccountMessage(this->username, PASSWORD, this->username));
+}
+
+void LoadClient::login() {
+    send(LoginMessage(this->username, PASSWORD));
+}
+
+void LoadClient::create_channel(const std::vector<UUID>& members) {
+    send(CreateChannelMessage(this->username, members));
+}
+
+void LoadClient::send_message() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    std::string text(TEXT_PREFIX);
+    text.append(std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()));
+    send(SendMessageMessage(this->channel_uid.value(), this->user_uid.value(), std::move(text)));
+}
+
+std::optional<std::chrono::nanoseconds> LoadClient::parse_sent_time(const std::string& text) {
+    if (text.rfind(TEXT_PREFIX, 0) != 0) {
+        return std::nullopt;
+    }
+    int64_t nanoseconds = 0;
+    const char* begin = text.data() + TEXT_PREFIX.size();
+    const char* end = text.data() + text.size();
+    auto [parsed, ec] = std::from_chars(begin, end, nanoseconds);
+    if (ec != std::errc() || parsed != end) {
+        return std::nullopt;
+    }
+    return std::chrono::nanoseconds(nanoseconds);
+}
+
+LoadGenerator& LoadClient::get_generator() const {
+    return this->generator;
+}
+
+const std::string& LoadClient::get_username() const {
+    return this->username;
+}
+
+const std::optional<UUID>& LoadClient::get_user_uid() const {
+    return this->user_uid;
+}
+
+void LoadClient::set_user_uid(const UUID& user_uid) {
+    this->user_uid = user_uid;
+}
+
+const std::optional<UUID>& LoadClient::get_channel_uid() const {
+    return this->channel_uid;
+}
+
+void LoadClient::set_channel_uid(const UUID& channel_uid) {
+    this->channel_uid = channel_uid;
+}
+
+void LoadClient::on_connected() {
+    // Requests are answered without delay, however small
+    this->socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    this->generator.on_connected(*this);
+}
+
+void LoadClient::on_read_data() {
+    QByteArray data = this->socket->readAll();
+    this->decoder.feed(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+
+    while (true) {
+        std::optional<FrameDecoder::Frame> frame;
+        try {
+            frame = this->decoder.next();
+        } catch (const std::out_of_range& e) {
+            this->generator.fail(this->username + ": malformed stream: " + e.what());
+            return;
+        }
+        if (!frame.has_value()) {
+            break;
+        }
+
+        const Header& header = frame->header;
+        if (header.get_version() != this->version) {
+            LOG_WARN << "Protocol version mismatch";
+            continue;
+        }
+        try {
+            if (!MessageHandler::get_instance().dispatch(this->socket, header, frame->payload)) {
+                LOG_WARN << "Unknown operation" << static_cast<int>(header.get_operation());
+            }
+        } catch (const std::out_of_range& e) {
+            this->generator.fail(this->username + ": malformed frame: " + e.what());
+            return;
+        }
+    }
+}
+
+void LoadClient::on_error(QAbstractSocket::SocketError error) {
+    this->generator.fail(this->username + ": " + this->socket->errorString().toStdString());
+}
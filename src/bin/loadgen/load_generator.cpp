@@ -0,0 +1,238 @@
+#include <QCoreApplication>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <string_view>
+
+#include "loadgen/load_generator.hpp"
+
+namespace {
+
+/// The error the server answers with when its password hashing queue is full.
+constexpr std::string_view SERVER_BUSY = "Server is busy, try again later";
+/// How long to wait before asking a busy server again.
+constexpr int RETRY_DELAY_MS = 50;
+/// How often due messages are sent. Messages due in between go out together.
+constexpr int SEND_INTERVAL_MS = 1;
+
+/**
+ * @brief Returns a percentile (0-100) of sorted samples.
+ */
+int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * sorted.size()));
+    return sorted[index];
+}
+
+}  // namespace
+
+LoadGenerator::LoadGenerator(LoadConfig config, QObject* parent)
+    : QObject(parent), config(std::move(config)) {
+    this->config.connections = std::max<size_t>(this->config.connections, 1);
+    this->config.fanout = std::clamp<size_t>(this->config.fanout, 1, this->config.connections);
+    this->config.handshake_window = std::max<size_t>(this->config.handshake_window, 1);
+
+    this->send_timer.setTimerType(Qt::PreciseTimer);
+    this->send_timer.setInterval(SEND_INTERVAL_MS);
+    connect(&this->send_timer, &QTimer::timeout, this, &LoadGenerator::send_due);
+    this->deadline.setSingleShot(true);
+    connect(&this->deadline, &QTimer::timeout, this, [this]() {
+        if (this->phase == Phase::SENDING) {
+            drain();
+        } else {
+            report();
+        }
+    });
+}
+
+void LoadGenerator::start() {
+    // Usernames are unique to the run, so that runs against the same server do not collide
+    std::string prefix = "load" + UUID().to_string().substr(0, 8) + "_";
+    this->clients.reserve(this->config.connections);
+    for (size_t i = 0; i < this->config.connections; i++) {
+        this->clients.push_back(
+            new LoadClient(*this, prefix + std::to_string(i), this->config.version, this));
+    }
+
+    std::cout << "Connecting " << this->config.connections << " clients to "
+              << this->config.host.toStdString() << ":" << this->config.port << std::endl;
+    for (LoadClient* client : this->clients) {
+        client->connect_to_server(this->config.host, this->config.port);
+    }
+}
+
+void LoadGenerator::on_connected(LoadClient& client) {
+    this->handshakes.push_back(&client);
+    if (++this->num_ready < this->clients.size()) {
+        return;
+    }
+
+    std::cout << "Registering and logging in " << this->clients.size() << " users" << std::endl;
+    this->phase = Phase::LOGGING_IN;
+    this->num_ready = 0;
+    pump_handshakes();
+}
+
+void LoadGenerator::pump_handshakes() {
+    while (this->handshakes_in_flight < this->config.handshake_window &&
+           !this->handshakes.empty()) {
+        LoadClient* client = this->handshakes.front();
+        this->handshakes.pop_front();
+        this->handshakes_in_flight++;
+        client->register_account();
+    }
+}
+
+void LoadGenerator::on_registered(LoadClient& client, const std::optional<std::string>& error) {
+    if (error.has_value() && error.value() == SERVER_BUSY) {
+        QTimer::singleShot(RETRY_DELAY_MS, &client, [&client]() { client.register_account(); });
+        return;
+    }
+    if (error.has_value()) {
+        fail(client.get_username() + ": registration failed: " + error.value());
+        return;
+    }
+    client.login();
+}
+
+void LoadGenerator::on_logged_in(LoadClient& client,
+                                 const std::variant<UUID, std::string>& user_uid) {
+    if (std::holds_alternative<std::string>(user_uid)) {
+        const std::string& error = std::get<std::string>(user_uid);
+        if (error == SERVER_BUSY) {
+            QTimer::singleShot(RETRY_DELAY_MS, &client, [&client]() { client.login(); });
+            return;
+        }
+        fail(client.get_username() + ": login failed: " + error);
+        return;
+    }
+
+    client.set_user_uid(std::get<UUID>(user_uid));
+    this->handshakes_in_flight--;
+    if (++this->num_ready < this->clients.size()) {
+        pump_handshakes();
+        return;
+    }
+
+    this->phase = Phase::CREATING_CHANNELS;
+    this->num_ready = 0;
+    create_channels();
+}
+
+void LoadGenerator::create_channels() {
+    size_t num_channels = (this->clients.size() + this->config.fanout - 1) / this->config.fanout;
+    std::cout << "Creating " << num_channels << " channels of up to " << this->config.fanout
+              << " members" << std::endl;
+    for (size_t first = 0; first < this->clients.size(); first += this->config.fanout) {
+        size_t last = std::min(first + this->config.fanout, this->clients.size());
+        std::vector<UUID> members;
+        for (size_t i = first; i < last; i++) {
+            members.push_back(this->clients[i]->get_user_uid().value());
+        }
+        this->clients[first]->create_channel(members);
+    }
+}
+
+void LoadGenerator::on_channel_joined(LoadClient& client, const Channel& channel) {
+    if (this->phase != Phase::CREATING_CHANNELS || client.get_channel_uid().has_value()) {
+        return;
+    }
+    client.set_channel_uid(channel.get_uid());
+    this->channel_sizes[channel.get_uid()] = channel.get_user_uids().size();
+    if (++this->num_ready < this->clients.size()) {
+        return;
+    }
+
+    std::cout << "Sending " << this->config.rate << " messages/s for "
+              << this->config.duration.count() << "s" << std::endl;
+    this->phase = Phase::SENDING;
+    this->send_start = std::chrono::steady_clock::now();
+    this->send_timer.start();
+    this->deadline.start(
+        std::chrono::duration_cast<std::chrono::milliseconds>(this->config.duration).count());
+}
+
+void LoadGenerator::send_due() {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->send_start;
+    auto due = static_cast<uint64_t>(elapsed.count() * this->config.rate);
+    for (; this->num_sent < due; this->num_sent++) {
+        LoadClient* sender = this->clients[this->next_sender];
+        this->next_sender = (this->next_sender + 1) % this->clients.size();
+        sender->send_message();
+        this->num_expected += this->channel_sizes[sender->get_channel_uid().value()] - 1;
+    }
+}
+
+void LoadGenerator::on_delivered(LoadClient& client, const Message& message) {
+    // Senders are members of their own channels too, but only other members count as deliveries
+    if (message.get_sender_id() == client.get_user_uid()) {
+        return;
+    }
+    std::optional<std::chrono::nanoseconds> sent = LoadClient::parse_sent_time(message.get_text());
+    if (!sent.has_value()) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    this->latencies.push_back((now - sent.value()).count());
+    this->num_delivered++;
+
+    if (this->phase == Phase::DRAINING && this->num_delivered >= this->num_expected) {
+        report();
+    }
+}
+
+void LoadGenerator::drain() {
+    this->send_timer.stop();
+    send_due();
+    this->send_end = std::chrono::steady_clock::now();
+    this->phase = Phase::DRAINING;
+    if (this->num_delivered >= this->num_expected) {
+        report();
+        return;
+    }
+
+    this->deadline.start(
+        std::chrono::duration_cast<std::chrono::milliseconds>(this->config.drain_timeout)
+            .count());
+}
+
+void LoadGenerator::report() {
+    if (this->phase == Phase::DONE) {
+        return;
+    }
+    this->phase = Phase::DONE;
+    this->deadline.stop();
+
+    std::sort(this->latencies.begin(), this->latencies.end());
+    double seconds = std::chrono::duration<double>(this->send_end - this->send_start).count();
+    auto micros = [this](double p) { return percentile(this->latencies, p) / 1000.0; };
+
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "sent %" PRIu64 " messages in %.2fs: %.0f msgs/sec\n"
+                  "delivered %" PRIu64 " of %" PRIu64 ": %.0f deliveries/sec\n"
+                  "send-to-delivery latency (us): p50 %.1f p99 %.1f p999 %.1f max %.1f\n",
+                  this->num_sent, seconds, this->num_sent / seconds, this->num_delivered,
+                  this->num_expected, this->num_delivered / seconds, micros(50), micros(99),
+                  micros(99.9), micros(100));
+    std::cout << line << std::flush;
+    finish(this->num_delivered >= this->num_expected ? 0 : 1);
+}
+
+void LoadGenerator::fail(const std::string& reason) {
+    if (this->phase == Phase::DONE) {
+        return;
+    }
+    this->phase = Phase::DONE;
+    std::cerr << "Error: " << reason << std::endl;
+    finish(1);
+}
+
+void LoadGenerator::finish(int exit_code) {
+    this->send_timer.stop();
+    this->deadline.stop();
+    QCoreApplication::exit(exit_code);
+}
@@ -0,0 +1,90 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QtGlobal>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "constants.hpp"
+#include "loadgen/load_generator.hpp"
+
+namespace {
+
+/**
+ * @brief Parses a positive number given to an option.
+ * @return The number, or std::nullopt if the value is not a positive number.
+ */
+std::optional<double> parse_positive(const QString& value) {
+    bool ok = false;
+    double number = value.toDouble(&ok);
+    if (!ok || number <= 0) {
+        return std::nullopt;
+    }
+    return number;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("Sock-et Out load generator");
+    parser.addHelpOption();
+
+    QCommandLineOption hostOption("host", "Server address (default 127.0.0.1)", "host",
+                                  "127.0.0.1");
+    QCommandLineOption portOption("port", "Server port", "port");
+    QCommandLineOption connectionsOption("connections", "Number of users (default 1000)", "n",
+                                         "1000");
+    QCommandLineOption fanoutOption("fanout", "Members per channel (default 8)", "n", "8");
+    QCommandLineOption rateOption("rate", "Messages per second (default 1000)", "n", "1000");
+    QCommandLineOption durationOption("duration", "Seconds to send for (default 10)", "s", "10");
+    QCommandLineOption windowOption("window", "Logins in flight at once (default 64)", "n", "64");
+    QCommandLineOption jsonOption("json", "Speak the JSON protocol instead of the binary one");
+    parser.addOptions({hostOption, portOption, connectionsOption, fanoutOption, rateOption,
+                       durationOption, windowOption, jsonOption});
+    parser.process(app);
+
+    LoadConfig config;
+    config.host = parser.value(hostOption);
+    std::optional<double> port = parse_positive(parser.value(portOption));
+    std::optional<double> connections = parse_positive(parser.value(connectionsOption));
+    std::optional<double> fanout = parse_positive(parser.value(fanoutOption));
+    std::optional<double> rate = parse_positive(parser.value(rateOption));
+    std::optional<double> duration = parse_positive(parser.value(durationOption));
+    std::optional<double> window = parse_positive(parser.value(windowOption));
+    if (!port.has_value() || port.value() > 65535) {
+        std::cerr << "Error: --port must be a port number." << std::endl;
+        return -1;
+    }
+    if (!connections || !fanout || !rate || !duration || !window) {
+        std::cerr << "Error: --connections, --fanout, --rate, --duration and --window must be "
+                     "positive numbers."
+                  << std::endl;
+        return -1;
+    }
+    config.port = static_cast<quint16>(port.value());
+    config.connections = static_cast<size_t>(connections.value());
+    config.fanout = static_cast<size_t>(fanout.value());
+    config.rate = rate.value();
+    config.duration = std::chrono::seconds(static_cast<int64_t>(duration.value()));
+    config.handshake_window = static_cast<size_t>(window.value());
+    config.version = parser.isSet(jsonOption) ? PROTOCOL_VERSION_JSON : PROTOCOL_VERSION;
+
+#ifdef Q_OS_UNIX
+    // Every user holds a socket of its own
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+#endif
+
+    LoadGenerator generator(config);
+    generator.start();
+    return app.exec();
+}
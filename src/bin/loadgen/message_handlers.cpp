@@ -0,0 +1,49 @@
+#include "loadgen/load_client.hpp"
+#include "loadgen/load_generator.hpp"
+#include "message/create_channel_response.hpp"
+#include "message/login_response.hpp"
+#include "message/register_account_response.hpp"
+#include "message/send_message_response.hpp"
+#include "models/logger.hpp"
+#include "models/message_handler.hpp"
+#include "models/message_handlers.hpp"
+
+void on_register_account_response(QTcpSocket* socket, RegisterAccountResponse& msg) {
+    LoadClient* client = LoadClient::from_socket(socket);
+    client->get_generator().on_registered(*client, msg.get_error_message());
+}
+
+void on_login_response(QTcpSocket* socket, LoginResponse& msg) {
+    LoadClient* client = LoadClient::from_socket(socket);
+    if (msg.is_success()) {
+        client->get_generator().on_logged_in(*client, msg.get_data().value()->get_uid());
+    } else {
+        client->get_generator().on_logged_in(*client, msg.get_error_message().value());
+    }
+}
+
+void on_create_channel_response(QTcpSocket* socket, CreateChannelResponse& msg) {
+    LoadClient* client = LoadClient::from_socket(socket);
+    if (msg.is_success()) {
+        client->get_generator().on_channel_joined(*client, *msg.get_data().value());
+    } else {
+        client->get_generator().fail(client->get_username() + ": creating a channel failed: " +
+                                     msg.get_error_message().value());
+    }
+}
+
+void on_send_message_response(QTcpSocket* socket, SendMessageResponse& msg) {
+    LoadClient* client = LoadClient::from_socket(socket);
+    if (msg.is_success()) {
+        client->get_generator().on_delivered(*client, *msg.get_data().value());
+    } else {
+        LOG_WARN << client->get_username() << "failed to send:" << msg.get_error_message().value();
+    }
+}
+
+void init_message_handlers(MessageHandler& messageHandler) {
+    messageHandler.register_handler<&on_register_account_response>();
+    messageHandler.register_handler<&on_login_response>();
+    messageHandler.register_handler<&on_create_channel_response>();
+    messageHandler.register_handler<&on_send_message_response>();
+}
@@ -0,0 +1,555 @@
+#include "server/db/account_search_index.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <regex>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+/// The number of pending changes below which they are never merged into the sorted snapshot.
+constexpr size_t MERGE_THRESHOLD = 1024;
+/// Above it, changes are merged once one is pending for this many accounts in the snapshot, so
+/// that copying the snapshot costs each change a bounded number of copies.
+constexpr size_t MERGE_RATIO = 16;
+/// The number of removed entries tolerated in the postings before they are compacted.
+constexpr size_t COMPACT_THRESHOLD = 1024;
+
+/// Changes to the accounts indexed under usernames, sorted by username; std::nullopt for a
+/// removal.
+using ChangeList = std::vector<std::pair<std::string, std::optional<UUID>>>;
+
+/**
+ * @brief How the usernames selected by a query plan are confirmed.
+ */
+enum class MatchKind {
+    /// The pattern is a literal; the username must equal it.
+    EXACT,
+    /// The pattern is a literal followed by ".*".
+    PREFIX,
+    /// The pattern is a literal surrounded by ".*".
+    CONTAINS,
+    /// Anything else; candidates are confirmed with std::regex_match.
+    REGEX,
+};
+
+/**
+ * @brief The literal text a pattern requires of every username it matches.
+ */
+struct QueryPlan {
+    MatchKind kind = MatchKind::REGEX;
+    /// The literal of an exact, prefix or substring pattern.
+    std::string text;
+    /// A literal every match starts with; may be empty.
+    std::string prefix;
+    /// Literals every match contains; only those long enough to have a trigram are kept.
+    std::vector<std::string> literals;
+};
+
+bool is_special(char c) {
+    return c == '\0' || std::strchr("\\^$.|?*+()[]{}", c) != nullptr;
+}
+
+bool is_line_terminator(char c) {
+    return c == '\n' || c == '\r';
+}
+
+/**
+ * @brief Decodes a pattern that consists of literal characters only.
+ */
+std::optional<std::string> as_literal(std::string_view pattern) {
+    std::string literal;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] == '\\') {
+            // Escaped letters and digits are character classes, assertions or back-references
+            if (i + 1 == pattern.size() || std::isalnum(static_cast<unsigned char>(pattern[i + 1]))) {
+                return std::nullopt;
+            }
+            literal.push_back(pattern[++i]);
+        } else if (is_special(pattern[i])) {
+            return std::nullopt;
+        } else {
+            literal.push_back(pattern[i]);
+        }
+    }
+    return literal;
+}
+
+/**
+ * @brief Gets the index just past the bracket expression starting at begin.
+ */
+size_t skip_class(std::string_view pattern, size_t begin) {
+    size_t i = begin + 1;
+    if (i < pattern.size() && pattern[i] == '^') {
+        i++;
+    }
+    for (; i < pattern.size() && pattern[i] != ']'; i++) {
+        if (pattern[i] == '\\') {
+            i++;
+        }
+    }
+    return std::min(i + 1, pattern.size());
+}
+
+/**
+ * @brief Gets the index just past the group starting at begin.
+ */
+size_t skip_group(std::string_view pattern, size_t begin) {
+    int depth = 0;
+    size_t i = begin;
+    while (i < pattern.size()) {
+        char c = pattern[i];
+        if (c == '\\') {
+            i += 2;
+            continue;
+        }
+        if (c == '[') {
+            i = skip_class(pattern, i);
+            continue;
+        }
+        if (c == '(') {
+            depth++;
+        } else if (c == ')' && --depth == 0) {
+            return i + 1;
+        }
+        i++;
+    }
+    return pattern.size();
+}
+
+/**
+ * @brief Checks whether the pattern has an alternation outside of any group.
+ */
+bool has_top_level_alternation(std::string_view pattern) {
+    size_t i = 0;
+    while (i < pattern.size()) {
+        switch (pattern[i]) {
+            case '\\':
+                i += 2;
+                break;
+            case '[':
+                i = skip_class(pattern, i);
+                break;
+            case '(':
+                i = skip_group(pattern, i);
+                break;
+            case '|':
+                return true;
+            default:
+                i++;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Extracts the literals a pattern requires of every username it matches.
+ *
+ * The extraction is conservative: a literal is only reported when every match must contain
+ * it, so narrowing the candidates to the usernames containing it never loses a match.
+ */
+QueryPlan plan_query(std::string_view pattern) {
+    QueryPlan plan;
+
+    // regex_match already anchors the pattern at both ends
+    if (pattern.starts_with('^')) {
+        pattern.remove_prefix(1);
+    }
+    if (pattern.ends_with('$') && !pattern.ends_with("\\$")) {
+        pattern.remove_suffix(1);
+    }
+
+    if (std::optional<std::string> literal = as_literal(pattern)) {
+        plan.kind = MatchKind::EXACT;
+        plan.text = *literal;
+        plan.prefix = *literal;
+        return plan;
+    }
+    if (pattern.ends_with(".*")) {
+        if (std::optional<std::string> literal = as_literal(pattern.substr(0, pattern.size() - 2))) {
+            plan.kind = MatchKind::PREFIX;
+            plan.text = *literal;
+            plan.prefix = *literal;
+            return plan;
+        }
+    }
+    if (pattern.size() >= 4 && pattern.starts_with(".*") && pattern.ends_with(".*")) {
+        if (std::optional<std::string> literal = as_literal(pattern.substr(2, pattern.size() - 4))) {
+            plan.kind = MatchKind::CONTAINS;
+            plan.text = *literal;
+            if (literal->size() >= 3) {
+                plan.literals.push_back(*literal);
+            }
+            return plan;
+        }
+    }
+
+    // Any branch of a top-level alternation may match without the others' literals
+    if (has_top_level_alternation(pattern)) {
+        return plan;
+    }
+
+    // Split the pattern into runs of required literal characters
+    std::string run;
+    bool leading = true;
+    auto end_run = [&]() {
+        if (leading) {
+            plan.prefix = run;
+            leading = false;
+        }
+        if (run.size() >= 3) {
+            plan.literals.push_back(run);
+        }
+        run.clear();
+    };
+
+    size_t i = 0;
+    while (i < pattern.size()) {
+        std::optional<char> literal;
+        size_t next = i + 1;
+        char c = pattern[i];
+        if (c == '\\') {
+            if (i + 1 < pattern.size() && !std::isalnum(static_cast<unsigned char>(pattern[i + 1]))) {
+                literal = pattern[i + 1];
+            }
+            next = i + 2;
+        } else if (c == '[') {
+            next = skip_class(pattern, i);
+        } else if (c == '(') {
+            next = skip_group(pattern, i);
+        } else if (!is_special(c)) {
+            literal = c;
+        }
+
+        bool optional = false;
+        bool repeated = false;
+        if (next < pattern.size()) {
+            char quantifier = pattern[next];
+            if (quantifier == '*' || quantifier == '?') {
+                optional = true;
+                next++;
+            } else if (quantifier == '+') {
+                repeated = true;
+                next++;
+            } else if (quantifier == '{') {
+                optional = next + 1 < pattern.size() && pattern[next + 1] == '0';
+                repeated = true;
+                while (next < pattern.size() && pattern[next] != '}') {
+                    next++;
+                }
+                next++;
+            }
+            // Lazy quantifiers match the same strings
+            if ((optional || repeated) && next < pattern.size() && pattern[next] == '?') {
+                next++;
+            }
+        }
+
+        if (literal.has_value() && !optional) {
+            run.push_back(*literal);
+            // What follows a repeated character is not adjacent to the run
+            if (repeated) {
+                end_run();
+            }
+        } else {
+            end_run();
+        }
+        i = next;
+    }
+    end_run();
+
+    return plan;
+}
+
+uint32_t trigram_at(std::string_view text, size_t i) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(text[i])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(text[i + 1])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(text[i + 2]));
+}
+
+/**
+ * @brief Confirms that a candidate username matches the query.
+ */
+bool matches(const QueryPlan& plan, const std::regex& re, const std::string& username) {
+    // '.' does not match line terminators, which the plain string comparisons would ignore
+    bool plain = std::none_of(username.begin(), username.end(), is_line_terminator);
+    switch (plan.kind) {
+        case MatchKind::EXACT:
+            return username == plan.text;
+        case MatchKind::PREFIX:
+            if (plain) {
+                return username.starts_with(plan.text);
+            }
+            break;
+        case MatchKind::CONTAINS:
+            if (plain) {
+                return username.find(plan.text) != std::string::npos;
+            }
+            break;
+        case MatchKind::REGEX:
+            break;
+    }
+    return std::regex_match(username, re);
+}
+
+/**
+ * @brief Copies the changes to the usernames starting with a prefix, from a cursor if any.
+ */
+ChangeList changes_from(const std::map<std::string, std::optional<UUID>>& changes,
+                        const std::string& prefix, const std::string* cursor) {
+    ChangeList range;
+    auto it = cursor != nullptr ? changes.upper_bound(*cursor) : changes.lower_bound(prefix);
+    for (; it != changes.end() && it->first.starts_with(prefix); ++it) {
+        range.emplace_back(it->first, it->second);
+    }
+    return range;
+}
+
+/**
+ * @brief Combines two lists of changes; of two changes to a username, the newer one is kept.
+ */
+ChangeList overlay_changes(const ChangeList& older, const ChangeList& newer) {
+    ChangeList combined;
+    combined.reserve(older.size() + newer.size());
+    auto it = older.begin();
+    for (const auto& change : newer) {
+        for (; it != older.end() && it->first < change.first; ++it) {
+            combined.push_back(*it);
+        }
+        if (it != older.end() && it->first == change.first) {
+            ++it;
+        }
+        combined.push_back(change);
+    }
+    combined.insert(combined.end(), it, older.end());
+    return combined;
+}
+
+/**
+ * @brief Applies changes to a list of accounts sorted by username.
+ */
+std::vector<std::pair<std::string, UUID>> merge_changes(
+    const std::vector<std::pair<std::string, UUID>>& sorted,
+    const std::map<std::string, std::optional<UUID>>& changes) {
+    std::vector<std::pair<std::string, UUID>> merged;
+    merged.reserve(sorted.size() + changes.size());
+    auto it = sorted.begin();
+    for (const auto& [username, uid] : changes) {
+        for (; it != sorted.end() && it->first < username; ++it) {
+            merged.push_back(*it);
+        }
+        if (it != sorted.end() && it->first == username) {
+            ++it;
+        }
+        if (uid.has_value()) {
+            merged.emplace_back(username, uid.value());
+        }
+    }
+    merged.insert(merged.end(), it, sorted.end());
+    return merged;
+}
+
+}  // namespace
+
+void AccountSearchIndex::add(const std::string& username, UUID uid) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    uint32_t id = this->entries.size();
+    if (!this->by_username.emplace(username, Account{uid, id}).second) {
+        return;
+    }
+    this->entries.push_back(Entry{username, uid, true});
+    index_trigrams(id);
+    record_change(lock, username, uid);
+}
+
+void AccountSearchIndex::remove(const std::string& username) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto it = this->by_username.find(username);
+    if (it == this->by_username.end()) {
+        return;
+    }
+
+    Entry& entry = this->entries[it->second.id];
+    entry.live = false;
+    entry.username.clear();
+    this->by_username.erase(it);
+    this->removed++;
+
+    if (this->removed > COMPACT_THRESHOLD && this->removed > this->by_username.size()) {
+        compact();
+    }
+    record_change(lock, username, std::nullopt);
+}
+
+std::variant<AccountSearchIndex::Page, std::string> AccountSearchIndex::search(
+    const std::string& regex, size_t limit, const std::string& cursor) const {
+    std::regex re;
+    try {
+        re = std::regex(regex);
+    } catch (const std::regex_error& e) {
+        return std::string("Regex error: ") + e.what();
+    }
+
+    Page page;
+    if (limit == 0) {
+        return page;
+    }
+    QueryPlan plan = plan_query(regex);
+    std::vector<std::pair<std::string, UUID>> candidates;
+
+    if (plan.kind == MatchKind::EXACT) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->by_username.find(plan.text);
+        if (it != this->by_username.end() && (cursor.empty() || it->first > cursor)) {
+            page.uids.push_back(it->second.uid);
+        }
+        return page;
+    }
+
+    // A short prefix selects more usernames than a trigram does
+    if (plan.prefix.size() < 3 && !plan.literals.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            std::vector<const std::vector<uint32_t>*> postings;
+            for (const std::string& literal : plan.literals) {
+                for (size_t i = 0; i + 3 <= literal.size(); i++) {
+                    auto it = this->trigrams.find(trigram_at(literal, i));
+                    if (it == this->trigrams.end()) {
+                        return page;
+                    }
+                    postings.push_back(&it->second);
+                }
+            }
+
+            // Walk the shortest list and probe the others
+            std::sort(postings.begin(), postings.end(),
+                      [](const auto* a, const auto* b) { return a->size() < b->size(); });
+            for (uint32_t id : *postings.front()) {
+                bool in_all = std::all_of(postings.begin() + 1, postings.end(), [id](const auto* list) {
+                    return std::binary_search(list->begin(), list->end(), id);
+                });
+                const Entry& entry = this->entries[id];
+                if (in_all && entry.live && (cursor.empty() || entry.username > cursor)) {
+                    candidates.emplace_back(entry.username, entry.uid);
+                }
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (const auto& [username, uid] : candidates) {
+            if (matches(plan, re, username)) {
+                page.uids.push_back(uid);
+                if (page.uids.size() == limit) {
+                    page.next_cursor = username;
+                    break;
+                }
+            }
+        }
+        return page;
+    }
+
+    // Scan the sorted snapshot from the prefix, or from everywhere if there is none, merging
+    // in the changes made since it was published. Only copying the latest of them holds the
+    // mutex; those being merged into the next snapshot are shared
+    bool resume = !cursor.empty() && cursor >= plan.prefix;
+    const std::string* after = resume ? &cursor : nullptr;
+    std::shared_ptr<const SortedAccounts> snapshot;
+    std::shared_ptr<const ChangeMap> merging;
+    ChangeList changed;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        snapshot = this->sorted;
+        merging = this->merging;
+        changed = changes_from(this->changes, plan.prefix, after);
+    }
+    if (merging != nullptr) {
+        changed = overlay_changes(changes_from(*merging, plan.prefix, after), changed);
+    }
+
+    auto by_name = [](const auto& entry, const std::string& name) { return entry.first < name; };
+    auto name_after = [](const std::string& name, const auto& entry) { return name < entry.first; };
+    auto it = resume ? std::upper_bound(snapshot->begin(), snapshot->end(), cursor, name_after)
+                     : std::lower_bound(snapshot->begin(), snapshot->end(), plan.prefix, by_name);
+    auto change = changed.begin();
+    while (true) {
+        bool in_snapshot = it != snapshot->end() && it->first.starts_with(plan.prefix);
+        if (!in_snapshot && change == changed.end()) {
+            return page;
+        }
+
+        // A change to a username overrides its entry in the snapshot
+        const std::string* username;
+        std::optional<UUID> uid;
+        if (change != changed.end() && (!in_snapshot || change->first <= it->first)) {
+            if (in_snapshot && change->first == it->first) {
+                ++it;
+            }
+            username = &change->first;
+            uid = change->second;
+            ++change;
+        } else {
+            username = &it->first;
+            uid = it->second;
+            ++it;
+        }
+
+        if (uid.has_value() && matches(plan, re, *username)) {
+            page.uids.push_back(uid.value());
+            if (page.uids.size() == limit) {
+                page.next_cursor = *username;
+                return page;
+            }
+        }
+    }
+}
+
+size_t AccountSearchIndex::size() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->by_username.size();
+}
+
+void AccountSearchIndex::compact() {
+    this->entries.clear();
+    this->trigrams.clear();
+    for (auto& [username, account] : this->by_username) {
+        account.id = this->entries.size();
+        this->entries.push_back(Entry{username, account.uid, true});
+        index_trigrams(account.id);
+    }
+    this->removed = 0;
+}
+
+void AccountSearchIndex::record_change(std::unique_lock<std::mutex>& lock,
+                                       const std::string& username, std::optional<UUID> uid) {
+    this->changes.insert_or_assign(username, uid);
+    if (this->merging != nullptr ||
+        this->changes.size() <= std::max(MERGE_THRESHOLD, this->sorted->size() / MERGE_RATIO)) {
+        return;
+    }
+
+    // Merge the changes with the mutex released; until the new snapshot is published, scans
+    // read them from merging, and later changes start a new map
+    auto frozen = std::make_shared<const ChangeMap>(std::exchange(this->changes, {}));
+    this->merging = frozen;
+    std::shared_ptr<const SortedAccounts> previous = this->sorted;
+    lock.unlock();
+    auto merged = std::make_shared<const SortedAccounts>(merge_changes(*previous, *frozen));
+    lock.lock();
+    this->sorted = std::move(merged);
+    this->merging = nullptr;
+    // Free the previous snapshot, unless scans still hold it, with the mutex released
+    lock.unlock();
+}
+
+void AccountSearchIndex::index_trigrams(uint32_t id) {
+    std::string_view username = this->entries[id].username;
+    for (size_t i = 0; i + 3 <= username.size(); i++) {
+        std::vector<uint32_t>& postings = this->trigrams[trigram_at(username, i)];
+        // Ids only grow, so a repeated trigram of this username is always at the back
+        if (postings.empty() || postings.back() != id) {
+            postings.push_back(id);
+        }
+    }
+}
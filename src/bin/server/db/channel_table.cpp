@@ -1,31 +1,39 @@
 #include "server/db/channel_table.hpp"
 
 std::optional<const Channel::SharedPtr> ChannelTable::get_by_uid(UUID channel_uid) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->data.find(channel_uid) != this->data.end()
-               ? std::optional<const Channel::SharedPtr>(this->data.at(channel_uid))
-               : std::nullopt;
+    return this->data.find(channel_uid);
 }
 
 std::optional<Channel::SharedPtr> ChannelTable::get_mut_by_uid(UUID channel_uid) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->data.find(channel_uid) != this->data.end()
-               ? std::optional<Channel::SharedPtr>(this->data.at(channel_uid))
-               : std::nullopt;
+    return this->data.find(channel_uid);
 }
 
 std::variant<Channel::SharedPtr, std::string> ChannelTable::add_channel(std::string channel_name,
                                                                         std::vector<UUID> members) {
-    std::lock_guard<std::mutex> lock(this->mutex);
     Channel::SharedPtr channel = std::make_shared<Channel>(channel_name, members);
-    this->data.insert({channel->get_uid(), channel});
+    this->data.insert(channel->get_uid(), channel);
 
     return channel;
 }
 
 std::variant<std::monostate, std::string> ChannelTable::remove_channel(UUID channel_uid) {
-    std::lock_guard<std::mutex> lock(this->mutex);
     this->data.erase(channel_uid);
 
     return {};
-}
\ No newline at end of file
+}
+
+std::variant<std::monostate, std::string> ChannelTable::insert_channel(Channel::SharedPtr channel) {
+    if (!this->data.insert(channel->get_uid(), channel)) {
+        return "Channel already exists";
+    }
+
+    return {};
+}
+
+std::vector<Channel::SharedPtr> ChannelTable::get_all() {
+    std::vector<Channel::SharedPtr> channels;
+    this->data.for_each([&channels](const UUID&, const Channel::SharedPtr& channel) {
+        channels.push_back(channel);
+    });
+    return channels;
+}
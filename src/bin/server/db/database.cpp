@@ -1,6 +1,8 @@
-#include <QDebug>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
 
-#include <qtmetamacros.h>
+#include "models/logger.hpp"
 #include "models/message.hpp"
 #include "server/db/database.hpp"
 
@@ -16,6 +18,21 @@ Database& Database::get_instance() {
     return instance;
 }
 
+Database::~Database() {
+    {
+        std::lock_guard<std::mutex> lock(this->snapshot_thread_mutex);
+        this->snapshots_stopping = true;
+    }
+    this->snapshot_stop.notify_all();
+    if (this->snapshot_thread.joinable()) {
+        this->snapshot_thread.join();
+    }
+}
+
+void Database::set_observer(DatabaseObserver* observer) {
+    this->observer = observer;
+}
+
 const std::optional<const User::SharedPtr> Database::get_user_by_uid(UUID user_uid) const {
     return this->users->get_by_uid(user_uid);
 }
@@ -45,6 +62,75 @@ std::variant<std::vector<UUID>, std::string> Database::get_uuids_matching_regex(
     return this->users->get_uuids_matching_regex(regex);
 }
 
+std::variant<AccountSearchIndex::Page, std::string> Database::search_users(
+    const std::string& regex, size_t limit, const std::string& cursor) const {
+    return this->users->search(regex, limit, cursor);
+}
+
+std::vector<Message::SharedPtr> Database::get_messages_since(const std::vector<UUID>& channel_uids,
+                                                            uint64_t since, size_t limit) const {
+    // The first limit messages overall are among the first limit messages of each channel
+    std::vector<uint64_t> snowflakes;
+    for (const UUID& channel_uid : channel_uids) {
+        std::optional<Channel::SharedPtr> channel = this->channels->get_by_uid(channel_uid);
+        if (!channel.has_value()) {
+            continue;
+        }
+        std::vector<uint64_t> newer = channel.value()->get_message_snowflakes_after(since, limit);
+        snowflakes.insert(snowflakes.end(), newer.begin(), newer.end());
+    }
+    std::sort(snowflakes.begin(), snowflakes.end());
+
+    std::vector<Message::SharedPtr> messages;
+    messages.reserve(std::min(limit, snowflakes.size()));
+    for (uint64_t message_snowflake : snowflakes) {
+        if (messages.size() == limit) {
+            break;
+        }
+        std::optional<Message::SharedPtr> message = this->messages->get_by_uid(message_snowflake);
+        if (message.has_value()) {
+            messages.push_back(message.value());
+        }
+    }
+    return messages;
+}
+
+std::variant<Database::ChannelHistory, std::string> Database::get_channel_history(
+    UUID channel_uid, uint64_t before, uint64_t after, size_t limit) const {
+    std::optional<Channel::SharedPtr> channel = this->channels->get_by_uid(channel_uid);
+    if (!channel.has_value()) {
+        return "Channel does not exist";
+    }
+
+    // Read one snowflake past the limit to tell whether the page is the last one
+    bool forward = after != 0 && before == 0;
+    std::vector<uint64_t> snowflakes =
+        forward ? channel.value()->get_message_snowflakes_after(after, limit + 1)
+                : channel.value()->get_message_snowflakes_before(before, limit + 1);
+    if (!forward && after != 0) {
+        snowflakes.erase(snowflakes.begin(),
+                         std::upper_bound(snowflakes.begin(), snowflakes.end(), after));
+    }
+
+    ChannelHistory page;
+    page.has_more = snowflakes.size() > limit;
+    if (page.has_more) {
+        if (forward) {
+            snowflakes.pop_back();
+        } else {
+            snowflakes.erase(snowflakes.begin());
+        }
+    }
+    page.messages.reserve(snowflakes.size());
+    for (uint64_t message_snowflake : snowflakes) {
+        std::optional<Message::SharedPtr> message = this->messages->get_by_uid(message_snowflake);
+        if (message.has_value()) {
+            page.messages.push_back(message.value());
+        }
+    }
+    return page;
+}
+
 std::optional<UUID> Database::get_uid_from_username(std::string username) {
     return this->users->get_uid_from_username(username);
 }
@@ -53,67 +139,194 @@ std::variant<bool, std::string> Database::verify_password(UUID& user_uid, std::s
     return this->passwords->verify_password(user_uid, password);
 }
 
+template <typename F>
+uint64_t Database::append_to_log(F&& make_record) {
+    return this->wal ? this->wal->append(make_record()) : 0;
+}
+
+std::unique_lock<std::mutex> Database::lock_log() {
+    if (!this->wal) {
+        return {};
+    }
+    return std::unique_lock<std::mutex>(this->log_mutex);
+}
+
 std::variant<std::monostate, std::string> Database::add_user(User::SharedPtr user,
                                                              std::string password) {
-    // Add the password
+    // Hash before taking the log mutex, so that other writers never wait for the hash
+    return add_user(std::move(user), PasswordHasher::hash(password));
+}
+
+std::variant<std::monostate, std::string> Database::add_user(
+    User::SharedPtr user, PasswordHasher::Credentials credentials) {
+    // A change that spans several tables may add the user to a channel as soon as it is visible,
+    // so with a log the user is added and logged as one, before any such change
+    std::unique_lock<std::mutex> lock = lock_log();
+    // Add the password first; nobody looks it up before the user is found
     UUID user_uid = user->get_uid();
+    auto& [hash, salt] = credentials;
     std::variant<std::monostate, std::string> res =
-        this->passwords->add_password(user_uid, password);
+        this->passwords->restore_password(user_uid, hash, salt);
     if (std::holds_alternative<std::string>(res)) {
-        return std::get<std::string>(res);
+        return res;
     }
-    // Add the user
-    return this->users->add_user(user);
+    // Adding the user atomically claims the username, and makes the account visible
+    res = this->users->add_user(user);
+    if (std::holds_alternative<std::string>(res)) {
+        this->passwords->remove_password(user_uid);
+        return res;
+    }
+
+    // Log the hashed password, never the password itself
+    uint64_t lsn = append_to_log([&]() {
+        return LogRecord(LogRecordType::ADD_USER)
+            .put_uuid(user_uid)
+            .put_string(user->get_username())
+            .put_string(user->get_display_name())
+            .put_string(user->get_profile_pic())
+            .put_string(hash)
+            .put_string(salt);
+    });
+    lock = {};
+    commit(lsn);
+    return {};
 }
 
 std::variant<Message::SharedPtr, std::string> Database::add_message(UUID sender_uid,
                                                                     UUID channel_uid,
                                                                     std::string content) {
+    // Sends take no lock shared with other sends. Removing a channel or a user unregisters it
+    // before collecting its messages, so a send that finds its channel or sender gone once its
+    // message is listed takes the message back; otherwise the removal collects it
     std::optional<Channel::SharedPtr> channel = this->channels->get_mut_by_uid(channel_uid);
     if (!channel.has_value()) {
         return "Channel does not exist";
     }
-
-    auto res = this->messages->add_message(sender_uid, channel_uid, content);
-    if (std::holds_alternative<std::string>(res)) {
-        return std::get<std::string>(res);
+    bool sender_exists = this->users->get_by_uid(sender_uid).has_value();
+    auto removed_meanwhile = [&]() -> std::optional<std::string> {
+        if (!this->channels->get_by_uid(channel_uid).has_value()) {
+            return "Channel does not exist";
+        }
+        if (sender_exists && !this->users->get_by_uid(sender_uid).has_value()) {
+            return "User does not exist";
+        }
+        return std::nullopt;
+    };
+
+    // Creating the message assigns its snowflake. It is logged before it can be seen, so that no
+    // change made after seeing it is logged before it
+    auto message = std::make_shared<Message>(sender_uid, channel_uid, content);
+    uint64_t lsn = 0;
+    if (this->wal) {
+        // Changes that span several tables hold the log mutex throughout, so none is half done
+        std::lock_guard<std::mutex> lock(this->log_mutex);
+        if (std::optional<std::string> error = removed_meanwhile()) {
+            return error.value();
+        }
+        lsn = append_to_log([&]() {
+            return LogRecord(LogRecordType::ADD_MESSAGE)
+                .put_u64(message->get_snowflake())
+                .put_uuid(sender_uid)
+                .put_uuid(channel_uid)
+                .put_u64(message->get_created_at())
+                .put_u64(message->get_modified_at())
+                .put_string(message->get_text());
+        });
     }
-    Message::SharedPtr message = std::get<Message::SharedPtr>(res);
 
-    channel.value()->add_message(message->get_snowflake());
-    for (auto user_uid : channel.value()->get_user_uids()) {
-        std::optional<User::SharedPtr> user = this->users->get_mut_by_uid(user_uid);
-        if (!user.has_value()) {
-            continue;
-        }
-        emit user.value()->message_received(message);
+    // Store the message before listing it, so that no channel lists a missing message
+    uint64_t message_snowflake = message->get_snowflake();
+    this->messages->insert_message(message);
+    channel.value()->add_message(message_snowflake);
+    if (std::optional<std::string> error = removed_meanwhile()) {
+        // The removal is logged after the message, so a restart removes it as well
+        channel.value()->remove_message(message_snowflake);
+        this->messages->remove_message(message_snowflake);
+        return error.value();
     }
+    std::vector<UUID> recipients = channel.value()->get_user_uids();
+    commit(lsn);
 
+    if (this->observer != nullptr) {
+        this->observer->on_message_added(message, recipients);
+    }
     return message;
 }
 
 std::variant<Channel::SharedPtr, std::string> Database::add_channel(std::string channel_name,
                                                                     std::vector<UUID> members) {
-    auto res = this->channels->add_channel(channel_name, members);
-    if (std::holds_alternative<std::string>(res)) {
-        return std::get<std::string>(res);
-    }
-    Channel::SharedPtr channel = std::get<Channel::SharedPtr>(res);
+    std::unique_lock<std::mutex> lock(this->log_mutex);
+    Channel::SharedPtr channel;
+    std::vector<UUID> recipients;
+    uint64_t lsn;
+    {
+        MultiTableChange change(this->commit_version);
+        auto res = this->channels->add_channel(channel_name, members);
+        if (std::holds_alternative<std::string>(res)) {
+            return std::get<std::string>(res);
+        }
+        channel = std::get<Channel::SharedPtr>(res);
 
-    for (auto& user_uid : channel->get_user_uids()) {
-        std::optional<User::SharedPtr> user = this->users->get_mut_by_uid(user_uid);
-        if (!user.has_value()) {
-            continue;
+        recipients = channel->get_user_uids();
+        for (auto& user_uid : recipients) {
+            std::optional<User::SharedPtr> user = this->users->get_mut_by_uid(user_uid);
+            if (!user.has_value()) {
+                continue;
+            }
+            user.value()->add_channel(channel->get_uid());
         }
-        user.value()->add_channel(channel->get_uid());
-        emit user.value()->channel_added(channel);
+
+        // The UUID of the channel is only known once it is added
+        lsn = append_to_log([&]() {
+            return LogRecord(LogRecordType::ADD_CHANNEL)
+                .put_uuid(channel->get_uid())
+                .put_string(channel->get_name())
+                .put_uuids(recipients);
+        });
     }
+    lock.unlock();
+    commit(lsn);
 
+    if (this->observer != nullptr) {
+        this->observer->on_channel_added(channel, recipients);
+    }
     return channel;
 }
 
+std::variant<std::monostate, std::string> Database::set_username(UUID user_uid,
+                                                                 std::string username) {
+    if (!this->wal) {
+        // The user table claims the new username atomically
+        return this->users->set_username(user_uid, username);
+    }
+
+    // With a log, usernames are claimed and logged as one, so that the log holds the claims in
+    // the order they were made
+    std::unique_lock<std::mutex> lock(this->log_mutex);
+    std::optional<const User::SharedPtr> user = this->users->get_by_uid(user_uid);
+    if (!user.has_value()) {
+        return "User does not exist";
+    }
+    if (user.value()->get_username() == username) {
+        return {};
+    }
+    if (this->users->get_uid_from_username(username).has_value()) {
+        return "Username already exists";
+    }
+
+    uint64_t lsn = append_to_log([&]() {
+        return LogRecord(LogRecordType::SET_USERNAME).put_uuid(user_uid).put_string(username);
+    });
+    // Checked above, and only writers holding the log mutex change the tables
+    this->users->set_username(user_uid, username);
+    lock.unlock();
+    commit(lsn);
+    return {};
+}
+
 std::variant<std::monostate, std::string> Database::add_user_to_channel(UUID user_uid,
                                                                         UUID channel_uid) {
+    std::unique_lock<std::mutex> lock(this->log_mutex);
     std::optional<User::SharedPtr> user = this->users->get_mut_by_uid(user_uid);
     if (!user.has_value()) {
         return "User does not exist";
@@ -124,47 +337,79 @@ std::variant<std::monostate, std::string> Database::add_user_to_channel(UUID use
         return "Channel does not exist";
     }
 
-    user.value()->add_channel(channel_uid);
-    channel.value()->add_user(user_uid);
+    uint64_t lsn = append_to_log([&]() {
+        return LogRecord(LogRecordType::ADD_USER_TO_CHANNEL)
+            .put_uuid(user_uid)
+            .put_uuid(channel_uid);
+    });
+    {
+        MultiTableChange change(this->commit_version);
+        user.value()->add_channel(channel_uid);
+        channel.value()->add_user(user_uid);
+    }
+    lock.unlock();
+    commit(lsn);
     return {};
 }
 
 std::variant<User::SharedPtr, std::string> Database::remove_user(UUID user_uid) {
+    std::unique_lock<std::mutex> lock(this->log_mutex);
     std::optional<User::SharedPtr> user = this->users->get_mut_by_uid(user_uid);
     if (!user.has_value()) {
         return "User does not exist";
     }
 
-    for (auto& channel_uid : user.value()->get_channels()) {
-        std::optional<Channel::SharedPtr> channel_opt = this->channels->get_mut_by_uid(channel_uid);
-        if (!channel_opt.has_value()) {
-            continue;
-        }
-        Channel::SharedPtr channel = channel_opt.value();
-        channel->remove_user(user_uid);
-
-        // For each message in the channel, remove those messages from the user
-        for (auto& message_snowflake : channel->get_message_snowflakes()) {
-            std::optional<const Message::SharedPtr> message_opt =
-                this->messages->get_by_uid(message_snowflake);
-            if (!message_opt.has_value()) {
+    // The user exists, so removing them cannot fail once logged
+    uint64_t lsn = append_to_log(
+        [&]() { return LogRecord(LogRecordType::REMOVE_USER).put_uuid(user_uid); });
+
+    // The messages of the user, each with the members left in its channel
+    std::vector<std::pair<Message::SharedPtr, std::vector<UUID>>> removed;
+    std::variant<User::SharedPtr, std::string> res;
+    {
+        MultiTableChange change(this->commit_version);
+        // Remove the user before collecting their messages; a send that is listed too late to
+        // be collected finds the sender gone and takes its message back
+        res = this->users->remove_user(user_uid);
+        this->passwords->remove_password(user_uid);
+        for (auto& channel_uid : user.value()->get_channels()) {
+            std::optional<Channel::SharedPtr> channel_opt =
+                this->channels->get_mut_by_uid(channel_uid);
+            if (!channel_opt.has_value()) {
                 continue;
             }
+            Channel::SharedPtr channel = channel_opt.value();
+            channel->remove_user(user_uid);
+
+            // Remove the messages the user sent to the channel
+            for (auto& message_snowflake : channel->get_message_snowflakes()) {
+                std::optional<const Message::SharedPtr> message_opt =
+                    this->messages->get_by_uid(message_snowflake);
+                if (!message_opt.has_value()) {
+                    continue;
+                }
 
-            if (message_opt.value()->get_sender_id() == user_uid) {
+                if (message_opt.value()->get_sender_id() != user_uid) {
+                    continue;
+                }
                 channel->remove_message(message_snowflake);
-                for (auto& user_uid : channel->get_user_uids()) {
-                    std::optional<User::SharedPtr> user = this->users->get_mut_by_uid(user_uid);
-                    if (!user.has_value()) {
-                        continue;
-                    }
-                    emit user.value()->message_deleted(message_opt.value());
+                // A concurrent removal of the message reports it instead
+                if (std::holds_alternative<std::monostate>(
+                        this->messages->remove_message(message_snowflake))) {
+                    removed.emplace_back(message_opt.value(), channel->get_user_uids());
                 }
             }
         }
     }
+    lock.unlock();
+    commit(lsn);
 
-    return this->users->remove_user(user_uid);
+    if (this->observer != nullptr) {
+        for (const auto& [message, recipients] : removed) {
+            this->observer->on_message_removed(message, recipients);
+        }
+    }
+    return res;
 }
 
 std::variant<std::monostate, std::string> Database::remove_message(uint64_t message_snowflake) {
@@ -179,42 +424,273 @@ std::variant<std::monostate, std::string> Database::remove_message(uint64_t mess
         return "Channel does not exist";
     }
 
-    auto res = this->messages->remove_message(message_snowflake);
-    if (std::holds_alternative<std::string>(res)) {
-        return std::get<std::string>(res);
+    // Unlist the message before removing it, so that no channel lists a missing message. Of
+    // the threads removing it, only the one that removes it from the table goes on
+    channel.value()->remove_message(message_snowflake);
+    if (std::holds_alternative<std::string>(this->messages->remove_message(message_snowflake))) {
+        return "Message does not exist";
     }
-
-    for (auto user_uid : channel.value()->get_user_uids()) {
-        std::optional<User::SharedPtr> user = this->users->get_mut_by_uid(user_uid);
-        if (!user.has_value()) {
-            continue;
-        }
-        emit user.value()->message_deleted(message.value());
+    std::vector<UUID> recipients = channel.value()->get_user_uids();
+
+    // Nothing that is logged depends on a message being gone, so it is logged once removed
+    uint64_t lsn;
+    {
+        std::unique_lock<std::mutex> lock = lock_log();
+        lsn = append_to_log(
+            [&]() { return LogRecord(LogRecordType::REMOVE_MESSAGE).put_u64(message_snowflake); });
     }
+    commit(lsn);
 
-    channel.value()->remove_message(message_snowflake);
+    if (this->observer != nullptr) {
+        this->observer->on_message_removed(message.value(), recipients);
+    }
     return {};
 }
 
 std::variant<std::monostate, std::string> Database::remove_channel(UUID channel_uid) {
+    std::unique_lock<std::mutex> lock(this->log_mutex);
     std::optional<const Channel::SharedPtr> channel = this->channels->get_by_uid(channel_uid);
+    if (!channel.has_value()) {
+        return "Channel does not exist";
+    }
 
-    for (auto& user_uid : channel.value()->get_user_uids()) {
-        std::optional<User::SharedPtr> user = this->users->get_mut_by_uid(user_uid);
-        if (!user.has_value()) {
-            continue;
+    uint64_t lsn = append_to_log(
+        [&]() { return LogRecord(LogRecordType::REMOVE_CHANNEL).put_uuid(channel_uid); });
+    {
+        MultiTableChange change(this->commit_version);
+        this->channels->remove_channel(channel_uid);
+
+        for (auto& user_uid : channel.value()->get_user_uids()) {
+            std::optional<User::SharedPtr> user = this->users->get_mut_by_uid(user_uid);
+            if (!user.has_value()) {
+                continue;
+            }
+            user.value()->remove_channel(channel_uid);
+        }
+
+        for (auto& message_snowflake : channel.value()->get_message_snowflakes()) {
+            this->messages->remove_message(message_snowflake);
         }
-        user.value()->remove_channel(channel_uid);
     }
+    lock.unlock();
+    commit(lsn);
+    return {};
+}
 
-    for (auto& message_snowflake : channel.value()->get_message_snowflakes()) {
-        std::optional<Message::SharedPtr> message =
-            this->messages->get_mut_by_uid(message_snowflake);
-        if (!message.has_value()) {
-            continue;
+std::variant<size_t, std::string> Database::open_log(const std::string& path, SyncPolicy policy,
+                                                     std::chrono::microseconds sync_delay) {
+    if (this->wal) {
+        return "The write-ahead log is already open";
+    }
+
+    std::variant<size_t, std::string> replayed = WriteAheadLog::replay(
+        path, [this](LogRecordType type, ByteReader& reader) { apply_log_record(type, reader); },
+        this->snapshot_lsn);
+    if (std::holds_alternative<std::string>(replayed)) {
+        return replayed;
+    }
+
+    try {
+        this->wal = std::make_unique<WriteAheadLog>(path, policy, sync_delay);
+    } catch (const std::runtime_error& e) {
+        return std::string(e.what());
+    }
+    this->log_path = path;
+    return replayed;
+}
+
+std::variant<std::monostate, std::string> Database::load_snapshot(const std::string& path) {
+    if (this->wal) {
+        return "The snapshot must be loaded before the write-ahead log is opened";
+    }
+
+    std::variant<Snapshot, std::string> loaded = Snapshot::load(path);
+    if (std::holds_alternative<std::string>(loaded)) {
+        return std::get<std::string>(loaded);
+    }
+    Snapshot& snapshot = std::get<Snapshot>(loaded);
+
+    std::vector<User::SharedPtr> users;
+    users.reserve(snapshot.users.size());
+    for (Snapshot::UserRecord& record : snapshot.users) {
+        UUID user_uid = record.user->get_uid();
+        this->passwords->restore_password(user_uid, std::move(record.hash),
+                                          std::move(record.salt));
+        users.push_back(record.user);
+    }
+    this->users->load(users);
+    for (const Channel::SharedPtr& channel : snapshot.channels) {
+        this->channels->insert_channel(channel);
+    }
+    if (snapshot.messages) {
+        this->messages->attach_snapshot(snapshot.messages);
+    }
+    this->snapshot_lsn = snapshot.lsn;
+    return {};
+}
+
+std::variant<std::monostate, std::string> Database::write_snapshot(const std::string& path) {
+    std::lock_guard<std::mutex> lock(this->snapshot_mutex);
+    if (!this->wal) {
+        return "Snapshots need the write-ahead log to be open";
+    }
+
+    try {
+        uint64_t lsn = this->wal->sync();
+        if (lsn == this->snapshot_lsn) {
+            // Nothing has changed since the last snapshot
+            return {};
         }
-        this->messages->remove_message(message_snowflake);
+
+        // Rebuild the state at lsn from the previous snapshot and the log instead of copying
+        // the live tables, so that writers never wait for the snapshot
+        Database shadow;
+        std::variant<std::monostate, std::string> loaded = shadow.load_snapshot(path);
+        if (std::holds_alternative<std::string>(loaded)) {
+            return loaded;
+        }
+        std::variant<size_t, std::string> replayed = WriteAheadLog::replay(
+            this->log_path,
+            [&shadow](LogRecordType type, ByteReader& reader) {
+                shadow.apply_log_record(type, reader);
+            },
+            shadow.snapshot_lsn, lsn);
+        if (std::holds_alternative<std::string>(replayed)) {
+            return std::get<std::string>(replayed);
+        }
+        shadow.save_snapshot(path, lsn);
+
+        this->snapshot_lsn = lsn;
+        this->wal->discard_before(lsn);
+    } catch (const std::runtime_error& e) {
+        return std::string(e.what());
+    }
+    return {};
+}
+
+void Database::start_snapshots(const std::string& path, std::chrono::seconds interval) {
+    this->snapshot_thread = std::thread([this, path, interval]() {
+        std::unique_lock<std::mutex> lock(this->snapshot_thread_mutex);
+        while (!this->snapshot_stop.wait_for(lock, interval,
+                                             [this] { return this->snapshots_stopping; })) {
+            lock.unlock();
+            auto start = std::chrono::steady_clock::now();
+            std::variant<std::monostate, std::string> res = write_snapshot(path);
+            if (std::holds_alternative<std::string>(res)) {
+                LOG_ERROR << "Failed to write a snapshot:" << std::get<std::string>(res);
+            } else {
+                LOG_INFO << "Wrote a snapshot in"
+                         << std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - start)
+                                .count()
+                         << "ms";
+            }
+            lock.lock();
+        }
+    });
+}
+
+void Database::save_snapshot(const std::string& path, uint64_t lsn) {
+    SnapshotWriter writer(path);
+    for (const User::SharedPtr& user : this->users->get_all()) {
+        UUID user_uid = user->get_uid();
+        auto [hash, salt] = this->passwords->get_credentials(user_uid).value_or(
+            std::pair<std::string, std::string>());
+        writer.add_user(user, hash, salt);
+    }
+    for (const Channel::SharedPtr& channel : this->channels->get_all()) {
+        writer.add_channel(channel);
     }
+    this->messages->for_each_serialized(
+        [&writer](uint64_t message_snowflake, std::span<const uint8_t> serialized) {
+            writer.add_message(message_snowflake, serialized);
+        });
+    writer.finish(lsn);
+}
+
+void Database::apply_log_record(LogRecordType type, ByteReader& reader) {
+    // Records describe the outcome of a change, so identifiers, timestamps and password hashes
+    // are restored rather than generated anew
+    switch (type) {
+        case LogRecordType::ADD_USER: {
+            UUID user_uid = LogRecord::read_uuid(reader);
+            std::string username = LogRecord::read_string(reader);
+            std::string display_name = LogRecord::read_string(reader);
+            std::string profile_pic = LogRecord::read_string(reader);
+            std::string hash = LogRecord::read_string(reader);
+            std::string salt = LogRecord::read_string(reader);
+            this->users->add_user(
+                std::make_shared<User>(username, display_name, user_uid, profile_pic));
+            this->passwords->restore_password(user_uid, hash, salt);
+            break;
+        }
+        case LogRecordType::REMOVE_USER: {
+            remove_user(LogRecord::read_uuid(reader));
+            break;
+        }
+        case LogRecordType::SET_USERNAME: {
+            UUID user_uid = LogRecord::read_uuid(reader);
+            set_username(user_uid, LogRecord::read_string(reader));
+            break;
+        }
+        case LogRecordType::ADD_MESSAGE: {
+            uint64_t snowflake = reader.read_u64_be();
+            UUID sender_uid = LogRecord::read_uuid(reader);
+            UUID channel_uid = LogRecord::read_uuid(reader);
+            uint64_t created_at = reader.read_u64_be();
+            uint64_t modified_at = reader.read_u64_be();
+            std::string text = LogRecord::read_string(reader);
+
+            std::optional<Channel::SharedPtr> channel = this->channels->get_mut_by_uid(channel_uid);
+            if (!channel.has_value()) {
+                break;
+            }
+            auto message = std::make_shared<Message>(snowflake, sender_uid, channel_uid, created_at,
+                                                     modified_at, text);
+            if (std::holds_alternative<std::monostate>(this->messages->insert_message(message))) {
+                channel.value()->add_message(snowflake);
+            }
+            break;
+        }
+        case LogRecordType::REMOVE_MESSAGE: {
+            remove_message(reader.read_u64_be());
+            break;
+        }
+        case LogRecordType::ADD_CHANNEL: {
+            UUID channel_uid = LogRecord::read_uuid(reader);
+            std::string name = LogRecord::read_string(reader);
+            std::vector<UUID> members = LogRecord::read_uuids(reader);
+
+            auto channel = std::make_shared<Channel>(channel_uid, name, members);
+            if (std::holds_alternative<std::string>(this->channels->insert_channel(channel))) {
+                break;
+            }
+            for (const UUID& user_uid : members) {
+                std::optional<User::SharedPtr> user = this->users->get_mut_by_uid(user_uid);
+                if (user.has_value()) {
+                    user.value()->add_channel(channel_uid);
+                }
+            }
+            break;
+        }
+        case LogRecordType::ADD_USER_TO_CHANNEL: {
+            UUID user_uid = LogRecord::read_uuid(reader);
+            UUID channel_uid = LogRecord::read_uuid(reader);
+            add_user_to_channel(user_uid, channel_uid);
+            break;
+        }
+        case LogRecordType::REMOVE_CHANNEL: {
+            remove_channel(LogRecord::read_uuid(reader));
+            break;
+        }
+        default:
+            throw std::runtime_error("Unknown record type " +
+                                     std::to_string(static_cast<int>(type)));
+    }
+}
 
-    return this->channels->remove_channel(channel_uid);
+void Database::commit(uint64_t lsn) {
+    if (this->wal) {
+        this->wal->wait_durable(lsn);
+    }
 }
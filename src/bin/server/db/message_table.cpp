@@ -1,35 +1,132 @@
+#include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "server/db/message_table.hpp"
 
 std::optional<const Message::SharedPtr> MessageTable::get_by_uid(uint64_t message_snowflake) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->data.find(message_snowflake) != this->data.end()
-               ? std::optional<const Message::SharedPtr>(this->data.at(message_snowflake))
-               : std::nullopt;
+    return find(message_snowflake);
 }
 
 std::optional<Message::SharedPtr> MessageTable::get_mut_by_uid(uint64_t message_snowflake) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->data.find(message_snowflake) != this->data.end()
-               ? std::optional<Message::SharedPtr>(this->data.at(message_snowflake))
-               : std::nullopt;
+    return find(message_snowflake);
 }
 
 std::variant<Message::SharedPtr, std::string> MessageTable::add_message(UUID sender_uid,
                                                                         UUID channel_uid,
                                                                         std::string content) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-
     auto message = std::make_shared<Message>(sender_uid, channel_uid, content);
-    this->data.insert({message->get_snowflake(), message});
+    this->data.insert(message->get_snowflake(), message);
 
     return message;
 }
 
+std::variant<std::monostate, std::string> MessageTable::insert_message(Message::SharedPtr message) {
+    uint64_t message_snowflake = message->get_snowflake();
+    bool snapshot_has_message = in_snapshot(message_snowflake);
+    return this->data.with_shard(
+        message_snowflake,
+        [&](std::unordered_map<uint64_t, Message::SharedPtr>& shard)
+            -> std::variant<std::monostate, std::string> {
+            auto it = shard.find(message_snowflake);
+            if (it == shard.end() ? snapshot_has_message : it->second != nullptr) {
+                return "Message already exists";
+            }
+            shard.insert_or_assign(message_snowflake, std::move(message));
+            return {};
+        });
+}
+
 std::variant<std::monostate, std::string> MessageTable::remove_message(uint64_t message_snowflake) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    this->data.erase(message_snowflake);
+    bool removed;
+    if (in_snapshot(message_snowflake)) {
+        removed = this->data.with_shard(message_snowflake, [message_snowflake](auto& shard) {
+            auto [it, inserted] = shard.try_emplace(message_snowflake, nullptr);
+            bool was_present = inserted || it->second != nullptr;
+            it->second = nullptr;
+            return was_present;
+        });
+    } else {
+        removed = this->data.erase(message_snowflake).has_value();
+    }
 
+    if (!removed) {
+        return "Message does not exist";
+    }
     return {};
-}
\ No newline at end of file
+}
+
+void MessageTable::attach_snapshot(std::shared_ptr<const SnapshotMessages> snapshot) {
+    this->snapshot = std::move(snapshot);
+}
+
+void MessageTable::for_each_serialized(
+    const std::function<void(uint64_t, std::span<const uint8_t>)>& visit) {
+    std::vector<std::pair<uint64_t, Message::SharedPtr>> loaded;
+    std::unordered_set<uint64_t> removed;
+    this->data.for_each([&](uint64_t message_snowflake, const Message::SharedPtr& message) {
+        if (message != nullptr) {
+            loaded.emplace_back(message_snowflake, message);
+        } else {
+            removed.insert(message_snowflake);
+        }
+    });
+    std::sort(loaded.begin(), loaded.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    // Merge the decoded messages with those still in the snapshot, both in snowflake order
+    std::vector<uint8_t> buf;
+    size_t snapshot_size = this->snapshot ? this->snapshot->size() : 0;
+    size_t i = 0;
+    auto loaded_it = loaded.begin();
+    while (i < snapshot_size || loaded_it != loaded.end()) {
+        if (i < snapshot_size &&
+            (loaded_it == loaded.end() || this->snapshot->snowflake_at(i) < loaded_it->first)) {
+            uint64_t message_snowflake = this->snapshot->snowflake_at(i);
+            if (!removed.contains(message_snowflake)) {
+                visit(message_snowflake, this->snapshot->record_at(i));
+            }
+            i++;
+            continue;
+        }
+        if (i < snapshot_size && this->snapshot->snowflake_at(i) == loaded_it->first) {
+            // The snapshot copy was decoded into the table, which holds the current version
+            i++;
+        }
+        buf.clear();
+        loaded_it->second->serialize(buf);
+        visit(loaded_it->first, buf);
+        ++loaded_it;
+    }
+}
+
+std::optional<Message::SharedPtr> MessageTable::find(uint64_t message_snowflake) {
+    std::optional<Message::SharedPtr> found = this->data.find(message_snowflake);
+    if (found.has_value()) {
+        return *found != nullptr ? found : std::nullopt;
+    }
+    if (!this->snapshot) {
+        return std::nullopt;
+    }
+    std::optional<size_t> position = this->snapshot->find(message_snowflake);
+    if (!position.has_value()) {
+        return std::nullopt;
+    }
+
+    // Decode outside of the lock; if another thread decoded the message first, keep its copy
+    Message::SharedPtr message = this->snapshot->load(position.value());
+    return this->data.with_shard(
+        message_snowflake,
+        [&](std::unordered_map<uint64_t, Message::SharedPtr>& shard)
+            -> std::optional<Message::SharedPtr> {
+            auto [it, inserted] = shard.try_emplace(message_snowflake, message);
+            if (it->second == nullptr) {
+                return std::nullopt;
+            }
+            return it->second;
+        });
+}
+
+bool MessageTable::in_snapshot(uint64_t message_snowflake) const {
+    return this->snapshot && this->snapshot->find(message_snowflake).has_value();
+}
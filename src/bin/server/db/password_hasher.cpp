@@ -0,0 +1,191 @@
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "models/logger.hpp"
+#include "server/db/password_hasher.hpp"
+
+namespace {
+
+/// Identifies the layout of a scrypt hash, should it ever change.
+constexpr uint8_t SCRYPT_FORMAT = 1;
+/// The scrypt block size parameter r.
+constexpr uint8_t SCRYPT_BLOCK_SIZE = 8;
+/// The scrypt parallelization parameter p.
+constexpr uint8_t SCRYPT_PARALLELISM = 1;
+/// The size of the format byte and the three parameters preceding the derived key.
+constexpr size_t SCRYPT_HEADER_SIZE = 4;
+/// The size of the derived key.
+constexpr size_t KEY_SIZE = 32;
+/// The size of a generated salt.
+constexpr size_t SALT_SIZE = 16;
+/// The highest accepted parameters; higher ones would need gigabytes per hash.
+constexpr uint8_t MAX_COST = 20;
+constexpr uint8_t MAX_BLOCK_SIZE = 32;
+constexpr uint8_t MAX_PARALLELISM = 16;
+/// The size of the hex SHA-256 hashes stored before scrypt was adopted.
+constexpr size_t LEGACY_HASH_SIZE = 64;
+
+/**
+ * @brief Derives a scrypt key into out, which must hold KEY_SIZE bytes.
+ */
+void derive(const std::string& password, const std::string& salt, uint8_t cost,
+            uint8_t block_size, uint8_t parallelism, unsigned char* out) {
+    uint64_t n = uint64_t(1) << cost;
+    // The memory scrypt needs, plus some room, since OpenSSL rejects anything above the limit
+    uint64_t max_memory = 128 * uint64_t(block_size) * (n + parallelism + 2) + (1 << 20);
+    if (EVP_PBE_scrypt(password.data(), password.size(),
+                       reinterpret_cast<const unsigned char*>(salt.data()), salt.size(), n,
+                       block_size, parallelism, max_memory, out, KEY_SIZE) != 1) {
+        throw std::runtime_error("Failed to derive the password hash");
+    }
+}
+
+/**
+ * @brief Computes the hex SHA-256 of a string, as hashes were stored before scrypt.
+ */
+std::string legacy_sha256(const std::string& str) {
+    static const char digits[] = "0123456789abcdef";
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    if (EVP_Digest(str.data(), str.size(), digest, &length, EVP_sha256(), nullptr) != 1) {
+        throw std::runtime_error("Failed to compute SHA-256");
+    }
+
+    std::string hex(2 * length, '\0');
+    for (unsigned int i = 0; i < length; i++) {
+        hex[2 * i] = digits[digest[i] >> 4];
+        hex[2 * i + 1] = digits[digest[i] & 0x0F];
+    }
+    return hex;
+}
+
+/**
+ * @brief Compares two strings in a time that depends only on their sizes.
+ */
+bool equal_in_constant_time(const std::string& a, const unsigned char* b, size_t size) {
+    return a.size() == size && CRYPTO_memcmp(a.data(), b, size) == 0;
+}
+
+}  // namespace
+
+PasswordHasher& PasswordHasher::get_instance() {
+    static PasswordHasher instance(std::max(1u, std::thread::hardware_concurrency()), MAX_QUEUED);
+    return instance;
+}
+
+PasswordHasher::PasswordHasher(size_t num_threads, size_t max_queued) : max_queued(max_queued) {
+    this->workers.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; i++) {
+        this->workers.emplace_back([this]() { run(); });
+    }
+}
+
+PasswordHasher::~PasswordHasher() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+        this->jobs.clear();
+    }
+    this->job_ready.notify_all();
+    for (std::thread& worker : this->workers) {
+        worker.join();
+    }
+}
+
+void PasswordHasher::set_cost(uint8_t cost) {
+    if (cost == 0 || cost > MAX_COST) {
+        throw std::invalid_argument("Unsupported password hashing cost");
+    }
+    PasswordHasher::current_cost = cost;
+}
+
+uint8_t PasswordHasher::get_cost() {
+    return PasswordHasher::current_cost;
+}
+
+PasswordHasher::Credentials PasswordHasher::hash(const std::string& password) {
+    return hash(password, get_cost());
+}
+
+PasswordHasher::Credentials PasswordHasher::hash(const std::string& password, uint8_t cost) {
+    if (cost == 0 || cost > MAX_COST) {
+        throw std::runtime_error("Unsupported password hashing cost");
+    }
+    std::string salt(SALT_SIZE, '\0');
+    if (RAND_bytes(reinterpret_cast<unsigned char*>(salt.data()), salt.size()) != 1) {
+        throw std::runtime_error("Failed to generate a salt");
+    }
+
+    std::string hash(SCRYPT_HEADER_SIZE + KEY_SIZE, '\0');
+    hash[0] = SCRYPT_FORMAT;
+    hash[1] = cost;
+    hash[2] = SCRYPT_BLOCK_SIZE;
+    hash[3] = SCRYPT_PARALLELISM;
+    derive(password, salt, cost, SCRYPT_BLOCK_SIZE, SCRYPT_PARALLELISM,
+           reinterpret_cast<unsigned char*>(hash.data()) + SCRYPT_HEADER_SIZE);
+    return {std::move(hash), std::move(salt)};
+}
+
+bool PasswordHasher::verify(const std::string& password, const Credentials& credentials) {
+    const auto& [hash, salt] = credentials;
+    if (hash.size() == LEGACY_HASH_SIZE) {
+        std::string expected = legacy_sha256(password + salt);
+        return equal_in_constant_time(hash, reinterpret_cast<const unsigned char*>(expected.data()),
+                                      expected.size());
+    }
+
+    if (hash.size() != SCRYPT_HEADER_SIZE + KEY_SIZE || hash[0] != SCRYPT_FORMAT) {
+        return false;
+    }
+    uint8_t cost = hash[1];
+    uint8_t block_size = hash[2];
+    uint8_t parallelism = hash[3];
+    if (cost == 0 || cost > MAX_COST || block_size == 0 || block_size > MAX_BLOCK_SIZE ||
+        parallelism == 0 || parallelism > MAX_PARALLELISM) {
+        return false;
+    }
+    unsigned char key[KEY_SIZE];
+    derive(password, salt, cost, block_size, parallelism, key);
+    return CRYPTO_memcmp(hash.data() + SCRYPT_HEADER_SIZE, key, KEY_SIZE) == 0;
+}
+
+bool PasswordHasher::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->stopping || this->jobs.size() >= this->max_queued) {
+            return false;
+        }
+        this->jobs.push_back(std::move(job));
+    }
+    this->job_ready.notify_one();
+    return true;
+}
+
+size_t PasswordHasher::get_num_queued() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->jobs.size();
+}
+
+void PasswordHasher::run() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->job_ready.wait(lock, [this]() { return this->stopping || !this->jobs.empty(); });
+            if (this->stopping) {
+                return;
+            }
+            job = std::move(this->jobs.front());
+            this->jobs.pop_front();
+        }
+        // A job that throws must not take its worker down with it
+        try {
+            job();
+        } catch (const std::exception& e) {
+            LOG_ERROR << "Password hashing job failed:" << e.what();
+        }
+    }
+}
@@ -0,0 +1,357 @@
+#include "server/db/snapshot.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include "message/byte_reader.hpp"
+
+namespace {
+
+/// The bytes that start and end every snapshot file.
+constexpr char MAGIC[8] = {'W', 'P', 'S', 'N', 'A', 'P', '0', '2'};
+/// The size of the trailer: six 64-bit fields followed by the magic.
+constexpr size_t TRAILER_SIZE = 6 * 8 + sizeof(MAGIC);
+/// The size of an entry of the message index: a snowflake and an offset.
+constexpr size_t INDEX_ENTRY_SIZE = 16;
+/// How much the writer buffers before writing to the file.
+constexpr size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+uint64_t load_u64_be(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; i++) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+std::string read_string(ByteReader& reader) {
+    return std::string(reader.read_string_view(reader.read_u32_be()));
+}
+
+/**
+ * @brief Reads a count and checks that that many fields of a fixed size could follow it, so a
+ * corrupt count cannot request a huge allocation.
+ */
+uint32_t read_count(ByteReader& reader, size_t field_size) {
+    uint32_t count = reader.read_u32_be();
+    if (reader.remaining() / field_size < count) {
+        throw std::out_of_range("List extends past the end of the snapshot");
+    }
+    return count;
+}
+
+std::vector<UUID> read_uuids(ByteReader& reader) {
+    uint32_t count = read_count(reader, 16);
+    std::vector<UUID> uuids;
+    uuids.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uuids.push_back(UUID::from_reader(reader));
+    }
+    return uuids;
+}
+
+std::string errno_message(const std::string& action, const std::string& path) {
+    return "Failed to " + action + " " + path + ": " + std::strerror(errno);
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error(errno_message("open", path));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        std::string error = errno_message("stat", path);
+        ::close(fd);
+        throw std::runtime_error(error);
+    }
+
+    this->length = st.st_size;
+    if (this->length > 0) {
+        void* mapping = ::mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            std::string error = errno_message("map", path);
+            ::close(fd);
+            throw std::runtime_error(error);
+        }
+        this->data = static_cast<const uint8_t*>(mapping);
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (this->data != nullptr) {
+        ::munmap(const_cast<uint8_t*>(this->data), this->length);
+    }
+}
+
+std::span<const uint8_t> MappedFile::bytes() const {
+    return std::span<const uint8_t>(this->data, this->length);
+}
+
+SnapshotMessages::SnapshotMessages(std::shared_ptr<const MappedFile> file, uint64_t index_offset,
+                                   uint64_t count)
+    : file(std::move(file)) {
+    std::span<const uint8_t> bytes = this->file->bytes();
+    if (index_offset > bytes.size() || (bytes.size() - index_offset) / INDEX_ENTRY_SIZE < count) {
+        throw std::out_of_range("Message index extends past the end of the snapshot");
+    }
+    this->index = bytes.subspan(index_offset, count * INDEX_ENTRY_SIZE);
+}
+
+size_t SnapshotMessages::size() const {
+    return this->index.size() / INDEX_ENTRY_SIZE;
+}
+
+uint64_t SnapshotMessages::snowflake_at(size_t i) const {
+    return load_u64_be(this->index.data() + i * INDEX_ENTRY_SIZE);
+}
+
+std::span<const uint8_t> SnapshotMessages::record_at(size_t i) const {
+    uint64_t offset = load_u64_be(this->index.data() + i * INDEX_ENTRY_SIZE + 8);
+    std::span<const uint8_t> bytes = this->file->bytes();
+    if (offset > bytes.size()) {
+        throw std::out_of_range("Message record starts past the end of the snapshot");
+    }
+    ByteReader reader(bytes.subspan(offset));
+    return reader.read_bytes(reader.read_u32_be());
+}
+
+std::optional<size_t> SnapshotMessages::find(uint64_t snowflake) const {
+    size_t low = 0;
+    size_t high = size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (snowflake_at(mid) < snowflake) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < size() && snowflake_at(low) == snowflake) {
+        return low;
+    }
+    return std::nullopt;
+}
+
+Message::SharedPtr SnapshotMessages::load(size_t i) const {
+    ByteReader reader(record_at(i));
+    auto message = std::make_shared<Message>();
+    message->deserialize(reader);
+    return message;
+}
+
+std::variant<Snapshot, std::string> Snapshot::load(const std::string& path) {
+    if (!std::filesystem::exists(path)) {
+        // Nothing has been snapshotted yet
+        return Snapshot();
+    }
+
+    Snapshot snapshot;
+    try {
+        auto file = std::make_shared<const MappedFile>(path);
+        std::span<const uint8_t> bytes = file->bytes();
+        if (bytes.size() < sizeof(MAGIC) + TRAILER_SIZE ||
+            std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0 ||
+            std::memcmp(bytes.data() + bytes.size() - sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0) {
+            return "Not a snapshot file: " + path;
+        }
+
+        ByteReader trailer(bytes.subspan(bytes.size() - TRAILER_SIZE));
+        snapshot.lsn = trailer.read_u64_be();
+        uint64_t user_count = trailer.read_u64_be();
+        uint64_t channels_offset = trailer.read_u64_be();
+        uint64_t channel_count = trailer.read_u64_be();
+        uint64_t index_offset = trailer.read_u64_be();
+        uint64_t message_count = trailer.read_u64_be();
+        if (channels_offset < sizeof(MAGIC) || channels_offset > bytes.size()) {
+            throw std::out_of_range("Channels start outside the snapshot");
+        }
+
+        ByteReader users(bytes.subspan(sizeof(MAGIC), channels_offset - sizeof(MAGIC)));
+        for (uint64_t i = 0; i < user_count; i++) {
+            ByteReader serialized(users.read_bytes(users.read_u32_be()));
+            auto user = std::make_shared<User>();
+            user->deserialize(serialized);
+            std::string hash = read_string(users);
+            std::string salt = read_string(users);
+            for (const UUID& channel_uid : read_uuids(users)) {
+                user->add_channel(channel_uid);
+            }
+            snapshot.users.push_back(UserRecord{user, std::move(hash), std::move(salt)});
+        }
+
+        ByteReader channels(bytes.subspan(channels_offset));
+        for (uint64_t i = 0; i < channel_count; i++) {
+            UUID uid = UUID::from_reader(channels);
+            std::string name = read_string(channels);
+            std::vector<UUID> members = read_uuids(channels);
+            std::vector<uint64_t> message_snowflakes(read_count(channels, 8));
+            for (uint64_t& snowflake : message_snowflakes) {
+                snowflake = channels.read_u64_be();
+            }
+            snapshot.channels.push_back(std::make_shared<Channel>(
+                uid, std::move(name), std::move(members), std::move(message_snowflakes)));
+        }
+
+        if (message_count > 0) {
+            snapshot.messages =
+                std::make_shared<const SnapshotMessages>(file, index_offset, message_count);
+        }
+    } catch (const std::exception& e) {
+        return "Corrupt snapshot " + path + ": " + e.what();
+    }
+    return snapshot;
+}
+
+SnapshotWriter::SnapshotWriter(const std::string& path) : path(path), tmp_path(path + ".tmp") {
+    this->fd = ::open(this->tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (this->fd < 0) {
+        throw std::runtime_error(errno_message("create", this->tmp_path));
+    }
+    this->buf.reserve(WRITE_BUFFER_SIZE);
+    this->buf.insert(this->buf.end(), std::begin(MAGIC), std::end(MAGIC));
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (this->fd >= 0) {
+        ::close(this->fd);
+    }
+    if (!this->finished) {
+        ::unlink(this->tmp_path.c_str());
+    }
+}
+
+void SnapshotWriter::add_user(const User::SharedPtr& user, const std::string& hash,
+                              const std::string& salt) {
+    this->scratch.clear();
+    user->serialize(this->scratch);
+    put_u32(this->scratch.size());
+    this->buf.insert(this->buf.end(), this->scratch.begin(), this->scratch.end());
+    put_string(hash);
+    put_string(salt);
+    put_uuids(user->get_channels());
+    this->user_count++;
+    flush();
+}
+
+void SnapshotWriter::add_channel(const Channel::SharedPtr& channel) {
+    end_users();
+    channel->get_uid().serialize(this->buf);
+    put_string(channel->get_name());
+    put_uuids(channel->get_user_uids());
+    const std::vector<uint64_t>& message_snowflakes = channel->get_message_snowflakes();
+    put_u32(message_snowflakes.size());
+    for (uint64_t snowflake : message_snowflakes) {
+        put_u64(snowflake);
+        flush();
+    }
+    this->channel_count++;
+    flush();
+}
+
+void SnapshotWriter::add_message(uint64_t snowflake, std::span<const uint8_t> serialized) {
+    end_users();
+    this->message_index.emplace_back(snowflake, offset());
+    put_u32(serialized.size());
+    this->buf.insert(this->buf.end(), serialized.begin(), serialized.end());
+    flush();
+}
+
+void SnapshotWriter::finish(uint64_t lsn) {
+    end_users();
+    uint64_t index_offset = offset();
+    for (const auto& [snowflake, record_offset] : this->message_index) {
+        put_u64(snowflake);
+        put_u64(record_offset);
+        flush();
+    }
+
+    put_u64(lsn);
+    put_u64(this->user_count);
+    put_u64(this->channels_offset);
+    put_u64(this->channel_count);
+    put_u64(index_offset);
+    put_u64(this->message_index.size());
+    this->buf.insert(this->buf.end(), std::begin(MAGIC), std::end(MAGIC));
+    flush(true);
+
+    if (::fdatasync(this->fd) != 0) {
+        throw std::runtime_error(errno_message("sync", this->tmp_path));
+    }
+    ::close(this->fd);
+    this->fd = -1;
+    if (::rename(this->tmp_path.c_str(), this->path.c_str()) != 0) {
+        throw std::runtime_error(errno_message("rename", this->tmp_path));
+    }
+    this->finished = true;
+
+    // Make the rename itself durable
+    std::filesystem::path dir = std::filesystem::absolute(this->path).parent_path();
+    int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+}
+
+void SnapshotWriter::put_u32(uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        this->buf.push_back(value >> shift);
+    }
+}
+
+void SnapshotWriter::put_u64(uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        this->buf.push_back(value >> shift);
+    }
+}
+
+void SnapshotWriter::put_string(const std::string& value) {
+    put_u32(value.size());
+    this->buf.insert(this->buf.end(), value.begin(), value.end());
+}
+
+void SnapshotWriter::put_uuids(const std::vector<UUID>& uuids) {
+    put_u32(uuids.size());
+    for (const UUID& uuid : uuids) {
+        uuid.serialize(this->buf);
+    }
+}
+
+void SnapshotWriter::flush(bool force) {
+    if (this->buf.size() < WRITE_BUFFER_SIZE && !force) {
+        return;
+    }
+    size_t done = 0;
+    while (done < this->buf.size()) {
+        ssize_t n = ::write(this->fd, this->buf.data() + done, this->buf.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(errno_message("write", this->tmp_path));
+        }
+        done += n;
+    }
+    this->written += done;
+    this->buf.clear();
+}
+
+uint64_t SnapshotWriter::offset() const {
+    return this->written + this->buf.size();
+}
+
+void SnapshotWriter::end_users() {
+    if (this->channels_offset == 0) {
+        this->channels_offset = offset();
+    }
+}
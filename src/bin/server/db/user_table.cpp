@@ -1,64 +1,123 @@
 #include "server/db/user_table.hpp"
-#include <regex>
+#include <limits>
 
 std::optional<const User::SharedPtr> UserTable::get_by_uid(UUID user_uid) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->data.find(user_uid) != this->data.end()
-               ? std::optional<const User::SharedPtr>(this->data.at(user_uid))
-               : std::nullopt;
+    return this->data.find(user_uid);
 }
 
 std::optional<User::SharedPtr> UserTable::get_mut_by_uid(UUID user_uid) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->data.find(user_uid) != this->data.end()
-               ? std::optional<User::SharedPtr>(this->data.at(user_uid))
-               : std::nullopt;
+    return this->data.find(user_uid);
 }
 
 std::variant<std::vector<UUID>, std::string> UserTable::get_uuids_matching_regex(std::string regex) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    std::vector<UUID> uuids;
-    std::regex re;
-
-    try {
-        re = std::regex(regex);
-    } catch (const std::regex_error& e) {
-        return std::string("Regex error: ") + e.what();
+    index_loaded_users();
+    std::variant<AccountSearchIndex::Page, std::string> result =
+        this->search_index.search(regex, std::numeric_limits<size_t>::max());
+    if (std::holds_alternative<std::string>(result)) {
+        return std::get<std::string>(result);
     }
+    return std::move(std::get<AccountSearchIndex::Page>(result).uids);
+}
 
-    for (const auto& [uid, user] : this->data) {
-        if (std::regex_match(user->get_username(), re)) {
-            uuids.push_back(uid);
-        }
-    }
-    return uuids;
+std::variant<AccountSearchIndex::Page, std::string> UserTable::search(const std::string& regex,
+                                                                     size_t limit,
+                                                                     const std::string& cursor) {
+    index_loaded_users();
+    return this->search_index.search(regex, limit, cursor);
 }
 
 std::optional<UUID> UserTable::get_uid_from_username(std::string username) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    for (const auto& [uid, user] : this->data) {
-        if (user->get_username() == username) {
-            return uid;
-        }
-    }
-    return std::nullopt;
+    return this->username_index.find(username);
 }
 
 std::variant<std::monostate, std::string> UserTable::add_user(User::SharedPtr user) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    this->data.insert({user->get_uid(), user});
+    std::lock_guard<std::mutex> lock(this->writer_mutex);
+    if (this->username_index.contains(user->get_username())) {
+        return "Username already exists";
+    }
+    if (!this->data.insert(user->get_uid(), user)) {
+        return "User already exists";
+    }
+    this->username_index.insert(user->get_username(), user->get_uid());
+    this->search_index.add(user->get_username(), user->get_uid());
 
     return {};
 }
 
 std::variant<User::SharedPtr, std::string> UserTable::remove_user(UUID user_uid) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    if (this->data.find(user_uid) == this->data.end()) {
+    std::lock_guard<std::mutex> lock(this->writer_mutex);
+    std::optional<User::SharedPtr> found = this->data.erase(user_uid);
+    if (!found.has_value()) {
         return "User does not exist";
     }
 
-    User::SharedPtr user = this->data[user_uid];
-    this->data.erase(user_uid);
+    User::SharedPtr user = *found;
+    this->username_index.erase(user->get_username());
+    this->search_index.remove(user->get_username());
 
     return user;
-}
\ No newline at end of file
+}
+
+std::variant<std::monostate, std::string> UserTable::set_username(UUID user_uid,
+                                                                  std::string username) {
+    std::lock_guard<std::mutex> lock(this->writer_mutex);
+    std::optional<User::SharedPtr> found = this->data.find(user_uid);
+    if (!found.has_value()) {
+        return "User does not exist";
+    }
+    User::SharedPtr user = *found;
+    if (user->get_username() == username) {
+        return {};
+    }
+    if (this->username_index.contains(username)) {
+        return "Username already exists";
+    }
+
+    this->username_index.erase(user->get_username());
+    this->username_index.insert(username, user_uid);
+    this->search_index.remove(user->get_username());
+    this->search_index.add(username, user_uid);
+    user->set_username(username);
+
+    return {};
+}
+
+void UserTable::load(const std::vector<User::SharedPtr>& users) {
+    std::lock_guard<std::mutex> lock(this->writer_mutex);
+    this->unindexed.reserve(this->unindexed.size() + users.size());
+    for (const User::SharedPtr& user : users) {
+        if (this->username_index.contains(user->get_username()) ||
+            !this->data.insert(user->get_uid(), user)) {
+            continue;
+        }
+        this->username_index.insert(user->get_username(), user->get_uid());
+        this->unindexed.push_back(user);
+    }
+    this->has_unindexed = !this->unindexed.empty();
+}
+
+std::vector<User::SharedPtr> UserTable::get_all() {
+    std::vector<User::SharedPtr> users;
+    this->data.for_each([&users](const UUID&, const User::SharedPtr& user) {
+        users.push_back(user);
+    });
+    return users;
+}
+
+void UserTable::index_loaded_users() {
+    if (!this->has_unindexed) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(this->writer_mutex);
+    for (const User::SharedPtr& user : this->unindexed) {
+        // Skip users removed since they were loaded; renamed users are indexed under their
+        // current username, which is a no-op if set_username already indexed it
+        std::optional<User::SharedPtr> current = this->data.find(user->get_uid());
+        if (current.has_value() && *current == user) {
+            this->search_index.add(user->get_username(), user->get_uid());
+        }
+    }
+    this->unindexed.clear();
+    this->unindexed.shrink_to_fit();
+    this->has_unindexed = false;
+}
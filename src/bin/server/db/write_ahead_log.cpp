@@ -0,0 +1,415 @@
+#include "server/db/write_ahead_log.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "models/logger.hpp"
+
+namespace {
+
+/// The bytes that start every log file.
+constexpr char MAGIC[8] = {'W', 'P', 'W', 'A', 'L', '0', '0', '1'};
+/// The size of the file header: the magic, then the offset of the first record still held.
+constexpr uint64_t LOG_HEADER_SIZE = sizeof(MAGIC) + 8;
+/// The length and checksum that precede every record in the file.
+constexpr size_t FRAME_HEADER_SIZE = 8;
+/// The size of a serialized UUID.
+constexpr size_t UUID_SIZE = 16;
+/// How much of the log replay reads at a time.
+constexpr uint64_t REPLAY_CHUNK_SIZE = 1 << 20;
+
+/**
+ * @brief Computes the CRC-32 (IEEE 802.3) of a buffer.
+ */
+uint32_t crc32(std::span<const uint8_t> data) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+            }
+            table[i] = crc;
+        }
+        return table;
+    }();
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint8_t byte : data) {
+        crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+void push_u32_be(std::vector<uint8_t>& buf, uint32_t value) {
+    buf.push_back(value >> 24);
+    buf.push_back(value >> 16);
+    buf.push_back(value >> 8);
+    buf.push_back(value);
+}
+
+void push_u64_be(std::vector<uint8_t>& buf, uint64_t value) {
+    push_u32_be(buf, value >> 32);
+    push_u32_be(buf, value);
+}
+
+/**
+ * @brief Checks whether a file holds only zeros from an offset to its end.
+ */
+bool is_zero_from(std::ifstream& file, uint64_t offset) {
+    file.clear();
+    file.seekg(offset);
+    std::vector<char> buf(REPLAY_CHUNK_SIZE);
+    while (file.read(buf.data(), buf.size()) || file.gcount() > 0) {
+        if (std::any_of(buf.begin(), buf.begin() + file.gcount(), [](char c) { return c != 0; })) {
+            return false;
+        }
+    }
+    return !file.bad();
+}
+
+/**
+ * @brief Writes a whole buffer to a file, retrying short writes.
+ * @return An error message, or an empty string on success.
+ */
+std::string write_all(int fd, const std::vector<uint8_t>& buf) {
+    size_t written = 0;
+    while (written < buf.size()) {
+        ssize_t n = ::write(fd, buf.data() + written, buf.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return std::string("Failed to write the write-ahead log: ") + std::strerror(errno);
+        }
+        written += n;
+    }
+    return "";
+}
+
+}  // namespace
+
+LogRecord::LogRecord(LogRecordType type) {
+    this->buf.push_back(static_cast<uint8_t>(type));
+}
+
+LogRecord& LogRecord::put_u64(uint64_t value) {
+    put_u32(value >> 32);
+    put_u32(value);
+    return *this;
+}
+
+LogRecord& LogRecord::put_uuid(const UUID& uuid) {
+    uuid.serialize(this->buf);
+    return *this;
+}
+
+LogRecord& LogRecord::put_string(const std::string& value) {
+    put_u32(value.size());
+    this->buf.insert(this->buf.end(), value.begin(), value.end());
+    return *this;
+}
+
+LogRecord& LogRecord::put_uuids(const std::vector<UUID>& uuids) {
+    put_u32(uuids.size());
+    for (const UUID& uuid : uuids) {
+        uuid.serialize(this->buf);
+    }
+    return *this;
+}
+
+const std::vector<uint8_t>& LogRecord::bytes() const {
+    return this->buf;
+}
+
+UUID LogRecord::read_uuid(ByteReader& reader) {
+    return UUID::from_reader(reader);
+}
+
+std::string LogRecord::read_string(ByteReader& reader) {
+    return std::string(reader.read_string_view(reader.read_u32_be()));
+}
+
+std::vector<UUID> LogRecord::read_uuids(ByteReader& reader) {
+    uint32_t count = reader.read_u32_be();
+    // Check the length before reserving, so a corrupt count cannot request a huge allocation
+    if (reader.remaining() / UUID_SIZE < count) {
+        throw std::out_of_range("UUID list extends past the end of the record");
+    }
+    std::vector<UUID> uuids;
+    uuids.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uuids.push_back(UUID::from_reader(reader));
+    }
+    return uuids;
+}
+
+void LogRecord::put_u32(uint32_t value) {
+    push_u32_be(this->buf, value);
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& path, SyncPolicy policy,
+                             std::chrono::microseconds sync_delay)
+    : policy(policy), sync_delay(sync_delay) {
+    // Only the writer thread writes at the end of the file, and the header is rewritten in place
+    this->fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (this->fd < 0) {
+        throw std::runtime_error("Failed to open the write-ahead log " + path + ": " +
+                                 std::strerror(errno));
+    }
+
+    // Sequence numbers are offsets in the file, which may already hold replayed records
+    off_t end = ::lseek(this->fd, 0, SEEK_END);
+    this->appended_lsn = this->durable_lsn = end > 0 ? end : 0;
+    if (this->appended_lsn == 0) {
+        // A new log holds every record from the first; its header is written with them
+        this->pending.insert(this->pending.end(), std::begin(MAGIC), std::end(MAGIC));
+        push_u64_be(this->pending, LOG_HEADER_SIZE);
+        this->appended_lsn = LOG_HEADER_SIZE;
+    }
+    this->writer = std::thread(&WriteAheadLog::run, this);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->appended.notify_one();
+    this->writer.join();
+    ::close(this->fd);
+}
+
+uint64_t WriteAheadLog::append(const LogRecord& record) {
+    const std::vector<uint8_t>& payload = record.bytes();
+    uint32_t checksum = crc32(payload);
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    // The writer takes the whole buffer at once, so it only needs waking for the first record
+    bool wake_writer = this->pending.empty();
+    push_u32_be(this->pending, payload.size());
+    push_u32_be(this->pending, checksum);
+    this->pending.insert(this->pending.end(), payload.begin(), payload.end());
+    this->appended_lsn += FRAME_HEADER_SIZE + payload.size();
+    if (wake_writer) {
+        this->appended.notify_one();
+    }
+    return this->appended_lsn;
+}
+
+void WriteAheadLog::wait_durable(uint64_t lsn) {
+    if (this->policy != SyncPolicy::COMMIT) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->synced.wait(lock, [this, lsn] { return this->durable_lsn >= lsn; });
+}
+
+uint64_t WriteAheadLog::sync() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    uint64_t lsn = this->appended_lsn;
+    this->sync_requested_lsn = std::max(this->sync_requested_lsn, lsn);
+    this->appended.notify_one();
+    this->synced.wait(lock, [this, lsn] { return this->durable_lsn >= lsn; });
+    return lsn;
+}
+
+std::variant<size_t, std::string> WriteAheadLog::replay(
+    const std::string& path, const std::function<void(LogRecordType, ByteReader&)>& apply,
+    uint64_t from, std::optional<uint64_t> to) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        if (from > 0) {
+            return "The write-ahead log " + path + " is missing";
+        }
+        // Nothing has been logged yet
+        return size_t(0);
+    }
+    uint64_t size = file.tellg();
+    uint64_t end = to.value_or(size);
+    if (size < end || end < from) {
+        return "The write-ahead log " + path + " ends at offset " + std::to_string(size) +
+               ", before offset " + std::to_string(std::max(from, end));
+    }
+    if (size < LOG_HEADER_SIZE) {
+        // The header is written along with the first records, so none were written
+        if (!to.has_value() && size > 0 && ::truncate(path.c_str(), 0) != 0) {
+            return "Failed to truncate the write-ahead log " + path + ": " + std::strerror(errno);
+        }
+        return size_t(0);
+    }
+
+    std::array<uint8_t, LOG_HEADER_SIZE> header;
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(header.data()), header.size())) {
+        return "Failed to read the write-ahead log " + path;
+    }
+    if (std::memcmp(header.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return "Not a write-ahead log: " + path;
+    }
+    ByteReader header_reader(std::span<const uint8_t>(header).subspan(sizeof(MAGIC)));
+    uint64_t start = header_reader.read_u64_be();
+    if (start > LOG_HEADER_SIZE && from < start) {
+        // The records in between were discarded once a snapshot held them
+        return "The write-ahead log " + path + " starts at offset " + std::to_string(start) +
+               ", after the snapshot it follows ends at offset " + std::to_string(from) +
+               "; the snapshot holding the records before it is missing";
+    }
+    from = std::max(from, LOG_HEADER_SIZE);
+    file.seekg(from);
+
+    // Records are read in chunks, so replaying a long log does not hold all of it in memory
+    std::vector<uint8_t> buf;
+    size_t pos = 0;
+    uint64_t offset = from;
+    uint64_t read_to = from;
+    auto fill = [&](size_t needed) {
+        if (buf.size() - pos >= needed) {
+            return true;
+        }
+        buf.erase(buf.begin(), buf.begin() + pos);
+        pos = 0;
+        uint64_t want = std::min<uint64_t>(std::max(needed - buf.size(), REPLAY_CHUNK_SIZE),
+                                           end - read_to);
+        size_t filled = buf.size();
+        buf.resize(filled + want);
+        file.read(reinterpret_cast<char*>(buf.data() + filled), want);
+        buf.resize(filled + file.gcount());
+        read_to += file.gcount();
+        return buf.size() >= needed;
+    };
+
+    size_t replayed = 0;
+    // Set when the record at offset is the last one and was torn, as by a crash
+    bool torn = false;
+    while (offset < end) {
+        if (!fill(FRAME_HEADER_SIZE)) {
+            torn = true;
+            break;
+        }
+        ByteReader frame(std::span<const uint8_t>(buf).subspan(pos, FRAME_HEADER_SIZE));
+        uint32_t length = frame.read_u32_be();
+        uint32_t checksum = frame.read_u32_be();
+        if (length == 0) {
+            break;
+        }
+        if (!fill(FRAME_HEADER_SIZE + length)) {
+            torn = true;
+            break;
+        }
+        std::span<const uint8_t> payload =
+            std::span<const uint8_t>(buf).subspan(pos + FRAME_HEADER_SIZE, length);
+        if (crc32(payload) != checksum) {
+            torn = offset + FRAME_HEADER_SIZE + length == end;
+            break;
+        }
+
+        try {
+            ByteReader reader(payload);
+            LogRecordType type = static_cast<LogRecordType>(reader.read_u8());
+            apply(type, reader);
+        } catch (const std::exception& e) {
+            return "Corrupt write-ahead log record at offset " + std::to_string(offset) + ": " +
+                   e.what();
+        }
+        pos += FRAME_HEADER_SIZE + length;
+        offset += FRAME_HEADER_SIZE + length;
+        replayed++;
+    }
+    if (file.bad()) {
+        return "Failed to read the write-ahead log " + path;
+    }
+
+    if (offset < end) {
+        if (to.has_value()) {
+            return "Incomplete write-ahead log record at offset " + std::to_string(offset);
+        }
+        // A file may also be extended before its data reaches the disk, which leaves zeros
+        if (!torn && !is_zero_from(file, offset)) {
+            return "Corrupt write-ahead log record at offset " + std::to_string(offset) +
+                   ", before the end of the log at offset " + std::to_string(end);
+        }
+        LOG_WARN << "Discarding" << end - offset
+                 << "bytes of incomplete records at the end of the write-ahead log";
+        if (::truncate(path.c_str(), offset) != 0) {
+            return "Failed to truncate the write-ahead log " + path + ": " + std::strerror(errno);
+        }
+    }
+    return replayed;
+}
+
+void WriteAheadLog::discard_before(uint64_t lsn) {
+    // A freed range reads back as zeros, so the header must say it is gone before it is freed
+    std::vector<uint8_t> start;
+    push_u64_be(start, lsn);
+    if (::pwrite(this->fd, start.data(), start.size(), sizeof(MAGIC)) !=
+            static_cast<ssize_t>(start.size()) ||
+        ::fdatasync(this->fd) != 0) {
+        LOG_WARN << "Could not record the start of the write-ahead log:" << std::strerror(errno);
+        return;
+    }
+
+    // Punching a hole frees the space but keeps the offsets, which are the sequence numbers
+    if (lsn > LOG_HEADER_SIZE && ::fallocate(this->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                                             LOG_HEADER_SIZE, lsn - LOG_HEADER_SIZE) != 0) {
+        LOG_WARN << "Could not free the start of the write-ahead log:" << std::strerror(errno);
+    }
+}
+
+void WriteAheadLog::run() {
+    std::vector<uint8_t> batch;
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true) {
+        this->appended.wait(lock, [this] {
+            return !this->pending.empty() || this->stopping ||
+                   this->sync_requested_lsn > this->durable_lsn;
+        });
+
+        // Give more commits the chance to join this group, or wait out the sync interval
+        bool sync_requested = this->sync_requested_lsn > this->durable_lsn;
+        if (this->policy != SyncPolicy::NONE && this->sync_delay.count() > 0 && !this->stopping &&
+            !sync_requested) {
+            this->appended.wait_for(lock, this->sync_delay, [this] {
+                return this->stopping || this->sync_requested_lsn > this->durable_lsn;
+            });
+        }
+
+        // Keep the capacity of both buffers by swapping them
+        std::swap(batch, this->pending);
+        uint64_t lsn = this->appended_lsn;
+        bool sync = this->policy != SyncPolicy::NONE || this->stopping ||
+                    this->sync_requested_lsn > this->durable_lsn;
+        bool stop = this->stopping;
+        lock.unlock();
+
+        std::string failure = write_all(this->fd, batch);
+        if (failure.empty() && sync && ::fdatasync(this->fd) != 0) {
+            failure = std::string("Failed to sync the write-ahead log: ") + std::strerror(errno);
+        }
+        batch.clear();
+
+        if (!failure.empty()) {
+            // Whether any of the batch reached the disk is unknown, and the changes it holds are
+            // already visible, so neither they nor later changes can be made durable
+            LOG_ERROR << failure;
+            Logger::get_instance().flush();
+            std::abort();
+        }
+
+        lock.lock();
+        if (sync) {
+            this->durable_lsn = lsn;
+            this->synced.notify_all();
+        }
+        if (stop && this->pending.empty()) {
+            return;
+        }
+    }
+}
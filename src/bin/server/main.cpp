@@ -1,12 +1,19 @@
 #include <QCommandLineParser>
 #include <QCoreApplication>
-#include <QDebug>
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QThread>
+#include <chrono>
 #include <iostream>
 
+#include "models/logger.hpp"
 #include "models/message_handler.hpp"
+#include "server/db/database.hpp"
+#include "server/db/password_hasher.hpp"
+#include "server/model/connection_registry.hpp"
+#include "server/model/metrics.hpp"
+#include "server/model/metrics_server.hpp"
 #include "server/model/tcp_server.hpp"
 
 int main(int argc, char* argv[]) {
@@ -26,7 +33,7 @@ int main(int argc, char* argv[]) {
     QString configFilePath;
     if (parser.isSet(configOption)) {
         configFilePath = parser.value(configOption);
-        qDebug() << "Using config file:" << configFilePath;
+        LOG_INFO << "Using config file:" << configFilePath;
     } else {
         std::cerr << "Error: No config file provided. Use --config <file_path>" << std::endl;
         return -1;
@@ -56,14 +63,168 @@ int main(int argc, char* argv[]) {
 
     int port = jsonObj["port"].toInt();
 
+    // Extract the optional "workers" field, defaulting to one worker per core
+    int workers = QThread::idealThreadCount();
+    if (jsonObj.contains("workers")) {
+        if (!jsonObj["workers"].isDouble() || jsonObj["workers"].toInt() < 1) {
+            std::cerr << "Error: 'workers' field must be a positive integer." << std::endl;
+            return -1;
+        }
+        workers = jsonObj["workers"].toInt();
+    }
+
+    // Extract the optional "log_level" field; the LOG_LEVEL environment variable is the default
+    if (jsonObj.contains("log_level")) {
+        std::optional<LogLevel> level =
+            Logger::parse_level(jsonObj["log_level"].toString().toStdString());
+        if (!level.has_value()) {
+            std::cerr << "Error: 'log_level' must be one of 'trace', 'debug', 'info', 'warn', "
+                         "'error' or 'off'."
+                      << std::endl;
+            return -1;
+        }
+        Logger::get_instance().set_level(level.value());
+    }
+
+    // Extract the optional "metrics_port" field; metrics are only served when it is set
+    int metrics_port = 0;
+    if (jsonObj.contains("metrics_port")) {
+        metrics_port = jsonObj["metrics_port"].toInt();
+        if (!jsonObj["metrics_port"].isDouble() || metrics_port < 1 || metrics_port > 65535) {
+            std::cerr << "Error: 'metrics_port' field must be a port number." << std::endl;
+            return -1;
+        }
+    }
+
+    // Extract the optional "scheduling" field
+    SchedulingPolicy policy = SchedulingPolicy::ROUND_ROBIN;
+    if (jsonObj.contains("scheduling")) {
+        std::string scheduling = jsonObj["scheduling"].toString().toStdString();
+        if (scheduling == "round_robin") {
+            policy = SchedulingPolicy::ROUND_ROBIN;
+        } else if (scheduling == "least_loaded") {
+            policy = SchedulingPolicy::LEAST_LOADED;
+        } else {
+            std::cerr << "Error: 'scheduling' must be one of 'round_robin' or 'least_loaded'."
+                      << std::endl;
+            return -1;
+        }
+    }
+
+    // Extract the optional "snapshot" object, which needs the write-ahead log, and load the
+    // latest snapshot before replaying the log
+    if (jsonObj.contains("snapshot")) {
+        QJsonObject snapshotObj = jsonObj["snapshot"].toObject();
+        if (!jsonObj.contains("wal")) {
+            std::cerr << "Error: 'snapshot' needs the 'wal' field." << std::endl;
+            return -1;
+        }
+        if (!snapshotObj.contains("path") || !snapshotObj["path"].isString()) {
+            std::cerr << "Error: 'snapshot.path' field missing or invalid in JSON." << std::endl;
+            return -1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto loaded =
+            Database::get_instance().load_snapshot(snapshotObj["path"].toString().toStdString());
+        if (std::holds_alternative<std::string>(loaded)) {
+            std::cerr << "Error: " << std::get<std::string>(loaded) << std::endl;
+            return -1;
+        }
+        std::cout << "Loaded the snapshot in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count()
+                  << "ms" << std::endl;
+    }
+
+    // Extract the optional "wal" object and rebuild the database from the log before serving
+    if (jsonObj.contains("wal")) {
+        QJsonObject walObj = jsonObj["wal"].toObject();
+        if (!walObj.contains("path") || !walObj["path"].isString()) {
+            std::cerr << "Error: 'wal.path' field missing or invalid in JSON." << std::endl;
+            return -1;
+        }
+
+        SyncPolicy sync = SyncPolicy::COMMIT;
+        std::string sync_name = walObj["sync"].toString("commit").toStdString();
+        if (sync_name == "commit") {
+            sync = SyncPolicy::COMMIT;
+        } else if (sync_name == "interval") {
+            sync = SyncPolicy::INTERVAL;
+        } else if (sync_name == "none") {
+            sync = SyncPolicy::NONE;
+        } else {
+            std::cerr << "Error: 'wal.sync' must be one of 'commit', 'interval' or 'none'."
+                      << std::endl;
+            return -1;
+        }
+
+        // Syncing every interval needs an interval; default to 10ms
+        int sync_delay_us =
+            walObj["sync_delay_us"].toInt(sync == SyncPolicy::INTERVAL ? 10000 : 0);
+        if (sync_delay_us < 0) {
+            std::cerr << "Error: 'wal.sync_delay_us' must not be negative." << std::endl;
+            return -1;
+        }
+
+        auto replayed = Database::get_instance().open_log(
+            walObj["path"].toString().toStdString(), sync,
+            std::chrono::microseconds(sync_delay_us));
+        if (std::holds_alternative<std::string>(replayed)) {
+            std::cerr << "Error: " << std::get<std::string>(replayed) << std::endl;
+            return -1;
+        }
+        std::cout << "Replayed " << std::get<size_t>(replayed)
+                  << " records from the write-ahead log" << std::endl;
+    }
+
+    if (jsonObj.contains("snapshot")) {
+        QJsonObject snapshotObj = jsonObj["snapshot"].toObject();
+        int interval = snapshotObj["interval_s"].toInt(300);
+        if (interval < 1) {
+            std::cerr << "Error: 'snapshot.interval_s' must be a positive integer." << std::endl;
+            return -1;
+        }
+        Database::get_instance().start_snapshots(snapshotObj["path"].toString().toStdString(),
+                                                 std::chrono::seconds(interval));
+    }
+
+    // Fan new messages and channels out to the online members of their channels
+    Database::get_instance().set_observer(&ConnectionRegistry::get_instance());
+
     // Start the TCP server
-    TcpServer server;
+    TcpServer server(workers, policy);
     if (!server.listen(QHostAddress::Any, port)) {
         std::cerr << "TCP Server failed to start: " << server.errorString().toStdString()
                   << std::endl;
         return -1;
     }
 
-    std::cout << "Server started on port " << port << std::endl;
+    std::cout << "Server started on port " << port << " with " << server.get_num_workers()
+              << " workers" << std::endl;
+
+    // Serve metrics to local scrapers only
+    Metrics& metrics = Metrics::get_instance();
+    metrics.add_gauge("sockout_connections", "Open client connections.", []() {
+        return ConnectionRegistry::get_instance().get_num_connections();
+    });
+    metrics.add_gauge("sockout_sessions", "Connections with an authenticated user.", []() {
+        return ConnectionRegistry::get_instance().get_num_sessions();
+    });
+    metrics.add_gauge("sockout_online_users", "Users with at least one session.", []() {
+        return ConnectionRegistry::get_instance().get_num_users();
+    });
+    metrics.add_gauge("sockout_password_queue_depth", "Requests waiting for a password hash.",
+                      []() { return PasswordHasher::get_instance().get_num_queued(); });
+    MetricsServer metrics_server;
+    if (metrics_port != 0) {
+        if (!metrics_server.listen(QHostAddress::LocalHost, metrics_port)) {
+            std::cerr << "Metrics server failed to start: "
+                      << metrics_server.errorString().toStdString() << std::endl;
+            return -1;
+        }
+        std::cout << "Serving metrics on 127.0.0.1:" << metrics_port << "/metrics" << std::endl;
+    }
     return app.exec();
 }
@@ -1,41 +1,50 @@
-#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
 #include <vector>
 
 #include "constants.hpp"
-#include "message/create_channel.hpp"
-#include "message/create_channel_response.hpp"
-#include "message/delete_account.hpp"
-#include "message/delete_message.hpp"
-#include "message/delete_message_response.hpp"
+#include "message/frame_decoder.hpp"
 #include "message/header.hpp"
-#include "message/list_accounts.hpp"
-#include "message/login.hpp"
-#include "message/register_account.hpp"
-#include "message/send_message.hpp"
-#include "message/send_message_response.hpp"
+#include "models/logger.hpp"
 #include "models/message_handler.hpp"
 #include "server/model/client_handler.hpp"
+#include "server/model/connection_registry.hpp"
+#include "server/model/metrics.hpp"
 
 ClientHandler::ClientHandler(qintptr socketDescriptor, QObject* parent)
-    : QObject(parent), socket_descriptor(socketDescriptor) {}
+    : QObject(parent), socket(nullptr), socket_descriptor(socketDescriptor) {
+    this->connection_id = ConnectionRegistry::get_instance().add_connection(this);
+}
 
-void ClientHandler::set_authenticated_user(const User::SharedPtr user) {
-    if (authenticated_user.has_value()) {
-        disconnect(authenticated_user.value().get(), &User::channel_added, this,
-                   &ClientHandler::on_channel_added);
-        // disconnect(authenticated_user.value().get(), &User::channel_removed, this,
-        //            &on_channel_removed);
-        disconnect(authenticated_user.value().get(), &User::message_received, this,
-                   &ClientHandler::on_message_received);
-        disconnect(authenticated_user.value().get(), &User::message_deleted, this,
-                   &ClientHandler::on_message_deleted);
-    }
+ClientHandler::~ClientHandler() {
+    ConnectionRegistry::get_instance().remove_connection(this->connection_id);
+}
 
+ClientHandler* ClientHandler::from_socket(QTcpSocket* socket) {
+    return qobject_cast<ClientHandler*>(socket->parent());
+}
+
+ConnectionRegistry::ConnectionId ClientHandler::get_connection_id() const {
+    return this->connection_id;
+}
+
+uint8_t ClientHandler::get_version() const {
+    return this->version;
+}
+
+void ClientHandler::set_compression(bool compression) {
+    this->compression = compression;
+    ConnectionRegistry::get_instance().set_compression(this->connection_id, compression);
+}
+
+void ClientHandler::set_authenticated_user(const User::SharedPtr user) {
     authenticated_user = user;
-    connect(user.get(), &User::channel_added, this, &ClientHandler::on_channel_added);
-    // connect(user.get(), &User::channel_removed, this, &on_channel_removed);
-    connect(user.get(), &User::message_received, this, &ClientHandler::on_message_received);
-    connect(user.get(), &User::message_deleted, this, &ClientHandler::on_message_deleted);
+    ConnectionRegistry::get_instance().bind_user(this->connection_id, user);
+}
+
+std::optional<User::SharedPtr> ClientHandler::get_authenticated_user() const {
+    return authenticated_user;
 }
 
 void ClientHandler::handle_client() {
@@ -43,141 +52,120 @@ void ClientHandler::handle_client() {
     socket->setSocketDescriptor(socket_descriptor);
     authenticated_user = std::nullopt;
 
-    connect(&MessageHandler::get_instance(), &MessageHandler::write_data, this,
-            &ClientHandler::on_write_data);
     connect(socket, &QTcpSocket::readyRead, this, &ClientHandler::on_read_data);
     connect(socket, &QTcpSocket::disconnected, this, &ClientHandler::on_disconnected);
 
-    qDebug() << "New Client: " << socket->peerAddress() << ":" << socket->peerPort();
+    LOG_INFO << "New client:" << socket->peerAddress().toString() << socket->peerPort();
 }
 
-void ClientHandler::on_write_data(std::vector<uint8_t> data) {
+void ClientHandler::write(const std::vector<uint8_t>& data) {
+    if (socket == nullptr) {
+        return;
+    }
     socket->write(reinterpret_cast<const char*>(data.data()), data.size());
     socket->flush();
+
+    // Every frame carries its operation in the second byte, whatever its version
+    if (data.size() > 1) {
+        record_written(static_cast<Operation>(data[1]), data.size());
+    }
 }
 
-void ClientHandler::on_read_data() {
-    Header header;
-    if (socket->bytesAvailable() < header.size())
+void ClientHandler::defer_response() {
+    if (!this->dispatching.has_value()) {
         return;
+    }
+    if (this->deferred.size() == MAX_DEFERRED_REQUESTS) {
+        this->deferred.erase(this->deferred.begin());
+    }
+    this->deferred.push_back(*this->dispatching);
+    this->dispatching.reset();
+}
 
-    QByteArray headerData = socket->read(header.size());
-    std::vector<uint8_t> vec(headerData.size());
-    std::transform(headerData.begin(), headerData.end(), vec.begin(),
-                   [](char c) { return static_cast<uint8_t>(c); });
-    header.deserialize(vec);
-    qDebug() << "Received header: " << header.get_version() << " " << header.get_operation() << " "
-             << header.get_packet_length();
+void ClientHandler::record_written(Operation operation, size_t bytes) {
+    Metrics& metrics = Metrics::get_instance();
+    metrics.record_response(operation, bytes);
 
-    if (header.get_version() != PROTOCOL_VERSION) {
+    // Frames pushed to the client, such as new messages, answer no request
+    if (this->dispatching.has_value() && this->dispatching->operation == operation) {
+        metrics.record_latency(operation,
+                               std::chrono::steady_clock::now() - this->dispatching->received);
+        this->dispatching.reset();
         return;
     }
-
-    static constexpr uint8_t MAX_RETRIES = 100;
-    uint8_t retries = 0;
-    while (socket->bytesAvailable() < header.get_packet_length()) {
-        if (++retries > MAX_RETRIES) {
-            qDebug() << "Too many retries";
-            return;
-        }
-        QThread::msleep(100);
+    auto request = std::find_if(this->deferred.begin(), this->deferred.end(),
+                                [operation](const PendingRequest& pending) {
+                                    return pending.operation == operation;
+                                });
+    if (request != this->deferred.end()) {
+        metrics.record_latency(operation, std::chrono::steady_clock::now() - request->received);
+        this->deferred.erase(request);
     }
+}
 
-    QByteArray data = socket->read(header.get_packet_length());
-    std::vector<uint8_t> msg(header.get_packet_length());
-    std::transform(data.begin(), data.end(), msg.begin(),
-                   [](char c) { return static_cast<uint8_t>(c); });
-
-    MessageHandler& messageHandler = MessageHandler::get_instance();
-    switch (header.get_operation()) {
-        case Operation::REGISTER_ACCOUNT: {
-            RegisterAccountMessage registerAccount;
-            registerAccount.deserialize(msg);
-            qDebug() << registerAccount.to_json().c_str();
-            messageHandler.dispatch(socket, registerAccount);
-            break;
-        }
-        case Operation::LOGIN: {
-            LoginMessage login;
-            login.deserialize(msg);
-            qDebug() << login.to_json().c_str();
-            messageHandler.dispatch(socket, login);
-            break;
+void ClientHandler::on_read_data() {
+    QByteArray data = socket->readAll();
+    decoder.feed(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+    // Every frame this read completes was complete as of now
+    auto received = std::chrono::steady_clock::now();
+
+    // A single read may complete any number of pipelined frames
+    while (true) {
+        std::optional<FrameDecoder::Frame> frame;
+        try {
+            frame = decoder.next();
+        } catch (const std::out_of_range& e) {
+            // The stream cannot be resynchronized past a frame that was never read
+            LOG_WARN << "Malformed stream:" << e.what();
+            socket->abort();
+            return;
         }
-        case Operation::DELETE_ACCOUNT: {
-            DeleteAccountMessage deleteAccount;
-            deleteAccount.deserialize(msg);
-            qDebug() << deleteAccount.to_json().c_str();
-            messageHandler.dispatch(socket, deleteAccount);
+        if (!frame.has_value()) {
             break;
         }
-        case Operation::LIST_ACCOUNTS: {
-            ListAccountsMessage listAccounts;
-            listAccounts.deserialize(msg);
-            qDebug() << listAccounts.to_json().c_str();
-            messageHandler.dispatch(socket, listAccounts);
-            break;
+
+        const Header& header = frame->header;
+        LOG_TRACE << "Received header:" << header.get_version()
+                  << static_cast<int>(header.get_operation()) << header.get_packet_length();
+        Metrics::get_instance().record_request(
+            header.get_operation(),
+            header.size(header.get_version()) + header.get_packet_length());
+
+        // The first supported frame fixes the version the connection speaks from then on
+        if (!this->version_negotiated && is_supported_version(header.get_version())) {
+            this->version = header.get_version();
+            this->version_negotiated = true;
+            ConnectionRegistry::get_instance().set_version(this->connection_id, this->version);
         }
-        case Operation::CREATE_CHANNEL: {
-            CreateChannelMessage createChannel;
-            createChannel.deserialize(msg);
-            qDebug() << createChannel.to_json().c_str();
-            messageHandler.dispatch(socket, createChannel);
-            break;
+        if (header.get_version() != this->version) {
+            LOG_WARN << "Protocol version mismatch";
+            continue;
         }
-        case Operation::SEND_MESSAGE: {
-            SendMessageMessage sendMessage;
-            sendMessage.deserialize(msg);
-            qDebug() << sendMessage.to_json().c_str();
-            messageHandler.dispatch(socket, sendMessage);
-            break;
+
+        // Requests the handler neither answered nor deferred are timed to its return
+        this->dispatching = PendingRequest{header.get_operation(), received};
+        try {
+            dispatch_frame(header, frame->payload);
+        } catch (const std::out_of_range& e) {
+            LOG_WARN << "Malformed frame:" << e.what();
         }
-        case Operation::DELETE_MESSAGE: {
-            DeleteMessageMessage deleteMessage;
-            deleteMessage.deserialize(msg);
-            qDebug() << deleteMessage.to_json().c_str();
-            messageHandler.dispatch(socket, deleteMessage);
-            break;
+        if (this->dispatching.has_value()) {
+            Metrics::get_instance().record_latency(
+                header.get_operation(), std::chrono::steady_clock::now() - received);
+            this->dispatching.reset();
         }
-        default:
-            qDebug() << "Unknown operation";
-            break;
+    }
+}
+
+void ClientHandler::dispatch_frame(const Header& header, const std::vector<uint8_t>& msg) {
+    if (!MessageHandler::get_instance().dispatch(socket, header, msg)) {
+        LOG_WARN << "Unknown operation";
     }
 }
 
 void ClientHandler::on_disconnected() {
-    qDebug() << "Client disconnected";
+    LOG_INFO << "Client disconnected";
+    ConnectionRegistry::get_instance().remove_connection(this->connection_id);
     socket->deleteLater();
     emit finished();
 }
-
-void ClientHandler::on_message_received(std::variant<Message::SharedPtr, std::string> message) {
-    SendMessageResponse response(message);
-    qDebug() << "Message received" << response.to_json().c_str();
-    std::vector<uint8_t> buf;
-    response.serialize_msg(buf);
-    emit MessageHandler::get_instance().write_data(buf);
-}
-
-void ClientHandler::on_message_deleted(std::variant<Message::SharedPtr, std::string> message) {
-    DeleteMessageResponse response(message);
-    qDebug() << "Message deleted" << response.to_json().c_str();
-    std::vector<uint8_t> buf;
-    response.serialize_msg(buf);
-    emit MessageHandler::get_instance().write_data(buf);
-}
-
-void ClientHandler::on_channel_added(std::variant<Channel::SharedPtr, std::string> channel) {
-    CreateChannelResponse response(channel);
-    qDebug() << "Channel added" << response.to_json().c_str();
-    std::vector<uint8_t> buf;
-    response.serialize_msg(buf);
-    emit MessageHandler::get_instance().write_data(buf);
-}
-
-// void ClientHandler::on_channel_removed(std::variant<Channel::SharedPtr, std::string> channel) {
-//     DeleteChannelResponse response(channel);
-//     std::vector<uint8_t> buf;
-//     response.serialize_msg(buf);
-//     emit MessageHandler::get_instance().write_data(buf);
-// }
@@ -0,0 +1,282 @@
+#include <QThread>
+#include <algorithm>
+#include <array>
+
+#include "message/create_channel_response.hpp"
+#include "message/delete_message_response.hpp"
+#include "message/frame_compression.hpp"
+#include "message/send_message_response.hpp"
+#include "models/logger.hpp"
+#include "server/model/client_handler.hpp"
+#include "server/model/connection_registry.hpp"
+#include "server/model/metrics.hpp"
+
+ConnectionRegistry& ConnectionRegistry::get_instance() {
+    static ConnectionRegistry instance;
+    return instance;
+}
+
+ConnectionRegistry::ConnectionId ConnectionRegistry::add_connection(ClientHandler* handler) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    ConnectionId connection_id = this->next_connection_id++;
+    this->connections.insert({connection_id, Connection{handler, std::nullopt}});
+    return connection_id;
+}
+
+void ConnectionRegistry::remove_connection(ConnectionId connection_id) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->connections.find(connection_id);
+    if (it == this->connections.end()) {
+        return;
+    }
+    unbind_user_locked(it->second, connection_id);
+    this->connections.erase(it);
+}
+
+void ConnectionRegistry::bind_user(ConnectionId connection_id, const User::SharedPtr& user) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->connections.find(connection_id);
+    if (it == this->connections.end()) {
+        return;
+    }
+    unbind_user_locked(it->second, connection_id);
+
+    UUID user_uid = user->get_uid();
+    it->second.user_uid = user_uid;
+
+    this->sessions[user_uid].connections.push_back(connection_id);
+}
+
+void ConnectionRegistry::set_version(ConnectionId connection_id, uint8_t version) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->connections.find(connection_id);
+    if (it == this->connections.end()) {
+        return;
+    }
+    it->second.version = version;
+}
+
+void ConnectionRegistry::set_compression(ConnectionId connection_id, bool compression) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->connections.find(connection_id);
+    if (it == this->connections.end()) {
+        return;
+    }
+    it->second.compression = compression;
+}
+
+void ConnectionRegistry::unbind_user(ConnectionId connection_id) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->connections.find(connection_id);
+    if (it == this->connections.end()) {
+        return;
+    }
+    unbind_user_locked(it->second, connection_id);
+}
+
+void ConnectionRegistry::unbind_user_locked(Connection& connection, ConnectionId connection_id) {
+    if (!connection.user_uid.has_value()) {
+        return;
+    }
+
+    auto session = this->sessions.find(connection.user_uid.value());
+    connection.user_uid = std::nullopt;
+    if (session == this->sessions.end()) {
+        return;
+    }
+
+    std::vector<ConnectionId>& ids = session->second.connections;
+    ids.erase(std::remove(ids.begin(), ids.end(), connection_id), ids.end());
+    if (ids.empty()) {
+        this->sessions.erase(session);
+    }
+}
+
+std::vector<ConnectionRegistry::ConnectionId> ConnectionRegistry::get_connections_for_user(
+    const UUID& user_uid) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto session = this->sessions.find(user_uid);
+    if (session == this->sessions.end()) {
+        return {};
+    }
+    return session->second.connections;
+}
+
+std::optional<UUID> ConnectionRegistry::get_user_for_connection(ConnectionId connection_id) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->connections.find(connection_id);
+    if (it == this->connections.end()) {
+        return std::nullopt;
+    }
+    return it->second.user_uid;
+}
+
+size_t ConnectionRegistry::get_num_connections() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->connections.size();
+}
+
+size_t ConnectionRegistry::get_num_users() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->sessions.size();
+}
+
+size_t ConnectionRegistry::get_num_sessions() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    size_t num_sessions = 0;
+    for (const auto& [user_uid, session] : this->sessions) {
+        num_sessions += session.connections.size();
+    }
+    return num_sessions;
+}
+
+bool ConnectionRegistry::send(ConnectionId connection_id, std::vector<uint8_t> data) {
+    std::vector<Delivery> deliveries;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->connections.find(connection_id);
+        if (it == this->connections.end()) {
+            return false;
+        }
+        deliveries.push_back(delivery_to(connection_id, it->second));
+    }
+    deliveries.front().frame = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+    deliver(deliveries);
+    return true;
+}
+
+bool ConnectionRegistry::post(ConnectionId connection_id,
+                              std::function<void(ClientHandler&)> task) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->connections.find(connection_id);
+    if (it == this->connections.end()) {
+        return false;
+    }
+    // Queued even from the owning thread, so that the task never runs inside its caller
+    ClientHandler* handler = it->second.handler;
+    QMetaObject::invokeMethod(
+        handler, [handler, task = std::move(task)]() { task(*handler); }, Qt::QueuedConnection);
+    return true;
+}
+
+size_t ConnectionRegistry::send_to_user(const UUID& user_uid, const std::vector<uint8_t>& data) {
+    std::vector<Delivery> deliveries = deliveries_to({user_uid});
+    if (deliveries.empty()) {
+        return 0;
+    }
+    Frame frame = std::make_shared<const std::vector<uint8_t>>(data);
+    for (Delivery& delivery : deliveries) {
+        delivery.frame = frame;
+    }
+    deliver(deliveries);
+    return deliveries.size();
+}
+
+size_t ConnectionRegistry::send_to_user(const UUID& user_uid, const Encoder& encode) {
+    return send_to_users({user_uid}, encode);
+}
+
+size_t ConnectionRegistry::send_to_users(const std::vector<UUID>& user_uids,
+                                         const Encoder& encode) {
+    std::vector<Delivery> deliveries = deliveries_to(user_uids);
+
+    // One frame per codec, indexed by its version, which takes four bits of the header, both
+    // plain and compressed. Encoding happens outside the mutex, so fan-outs on different workers
+    // run side by side.
+    std::array<Frame, 32> frames;
+    for (Delivery& delivery : deliveries) {
+        size_t slot = (delivery.version & 0x0F) | (delivery.compression ? 0x10 : 0);
+        if (!frames[slot]) {
+            std::vector<uint8_t> frame;
+            encode(delivery.version, frame);
+            if (delivery.compression) {
+                FrameCompressor::compress_frame(frame);
+            }
+            frames[slot] = std::make_shared<const std::vector<uint8_t>>(std::move(frame));
+        }
+        delivery.frame = frames[slot];
+    }
+    deliver(deliveries);
+    return deliveries.size();
+}
+
+void ConnectionRegistry::on_message_added(const Message::SharedPtr& message,
+                                          const std::vector<UUID>& user_uids) {
+    SendMessageResponse response(message);
+    size_t sent = send_to_users(user_uids, [&response](uint8_t version, std::vector<uint8_t>& buf) {
+        response.serialize_msg(buf, version);
+    });
+    Metrics::get_instance().record_fanout(sent);
+    LOG_DEBUG << "Message" << message->get_snowflake() << "sent to" << sent << "sessions";
+}
+
+void ConnectionRegistry::on_message_removed(const Message::SharedPtr& message,
+                                            const std::vector<UUID>& user_uids) {
+    DeleteMessageResponse response(message);
+    size_t sent = send_to_users(user_uids, [&response](uint8_t version, std::vector<uint8_t>& buf) {
+        response.serialize_msg(buf, version);
+    });
+    LOG_DEBUG << "Message" << message->get_snowflake() << "deleted for" << sent << "sessions";
+}
+
+void ConnectionRegistry::on_channel_added(const Channel::SharedPtr& channel,
+                                          const std::vector<UUID>& user_uids) {
+    CreateChannelResponse response(channel);
+    size_t sent = send_to_users(user_uids, [&response](uint8_t version, std::vector<uint8_t>& buf) {
+        response.serialize_msg(buf, version);
+    });
+    LOG_DEBUG << "Channel" << channel->get_name() << "sent to" << sent << "sessions";
+}
+
+ConnectionRegistry::Delivery ConnectionRegistry::delivery_to(ConnectionId connection_id,
+                                                             const Connection& connection) {
+    return Delivery{connection_id, connection.handler, connection.handler->thread(),
+                    connection.version, connection.compression, nullptr};
+}
+
+std::vector<ConnectionRegistry::Delivery> ConnectionRegistry::deliveries_to(
+    const std::vector<UUID>& user_uids) {
+    std::vector<Delivery> deliveries;
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (const UUID& user_uid : user_uids) {
+        auto session = this->sessions.find(user_uid);
+        if (session == this->sessions.end()) {
+            continue;
+        }
+        for (ConnectionId connection_id : session->second.connections) {
+            deliveries.push_back(delivery_to(connection_id, this->connections.at(connection_id)));
+        }
+    }
+    return deliveries;
+}
+
+void ConnectionRegistry::deliver(const std::vector<Delivery>& deliveries) {
+    // Handlers are destroyed by their own thread once it is back in its event loop, so those on
+    // this thread outlive the call. They are written to directly and without the mutex, since a
+    // write that fails can disconnect the handler, which removes its connection.
+    QThread* current = QThread::currentThread();
+    bool queued = false;
+    for (const Delivery& delivery : deliveries) {
+        if (delivery.thread == current) {
+            delivery.handler->write(*delivery.frame);
+        } else {
+            queued = true;
+        }
+    }
+    if (!queued) {
+        return;
+    }
+
+    // A handler on another thread may be destroyed at any time, but not before it has removed its
+    // connection, so the handlers still registered stay alive while the mutex is held
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (const Delivery& delivery : deliveries) {
+        if (delivery.thread == current || !this->connections.contains(delivery.connection_id)) {
+            continue;
+        }
+        ClientHandler* handler = delivery.handler;
+        QMetaObject::invokeMethod(
+            handler, [handler, frame = delivery.frame]() { handler->write(*frame); },
+            Qt::QueuedConnection);
+    }
+}
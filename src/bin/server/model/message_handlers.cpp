@@ -1,12 +1,15 @@
 #include <QTcpSocket>
+#include <algorithm>
 #include <string>
 
-#include <qdebug.h>
 #include "message/create_channel.hpp"
 #include "message/create_channel_response.hpp"
 #include "message/delete_account.hpp"
 #include "message/delete_account_response.hpp"
 #include "message/delete_message.hpp"
+#include "message/fetch_history.hpp"
+#include "message/fetch_history_response.hpp"
+#include "message/hello.hpp"
 #include "message/list_accounts.hpp"
 #include "message/list_accounts_response.hpp"
 #include "message/login.hpp"
@@ -15,146 +18,328 @@
 #include "message/register_account_response.hpp"
 #include "message/send_message.hpp"
 #include "message/send_message_response.hpp"
+#include "message/sync.hpp"
+#include "message/sync_response.hpp"
+#include "models/logger.hpp"
 #include "models/message_handler.hpp"
 #include "models/message_handlers.hpp"
 #include "server/db/database.hpp"
+#include "server/db/password_hasher.hpp"
 #include "server/model/client_handler.hpp"
+#include "server/model/connection_registry.hpp"
+
+namespace {
+
+/// The error sent when the password hashing pool has no room for another request.
+constexpr const char* SERVER_BUSY = "Server is busy, try again later";
+
+}  // namespace
+
+void on_hello(QTcpSocket* socket, HelloMessage& msg) {
+    ClientHandler* client = ClientHandler::from_socket(socket);
+    if (client == nullptr) {
+        LOG_ERROR << "ClientHandler is null";
+        return;
+    }
+
+    // Accept every offered feature the server supports; the answer itself is never compressed
+    bool compression = msg.has_feature(HelloMessage::FEATURE_COMPRESSION);
+    client->send(HelloMessage(compression ? HelloMessage::FEATURE_COMPRESSION : 0));
+    client->set_compression(compression);
+}
 
 void on_register_account(QTcpSocket* socket, RegisterAccountMessage& msg) {
+    ClientHandler* client = ClientHandler::from_socket(socket);
+    if (client == nullptr) {
+        LOG_ERROR << "ClientHandler is null";
+        return;
+    }
     Database& db = Database::get_instance();
 
-    std::optional<UUID> user_id = db.get_uid_from_username(msg.get_username());
-
-    RegisterAccountResponse response;
+    // Refuse taken usernames before paying for a hash; adding the user checks again atomically
+    if (db.get_uid_from_username(msg.get_username()).has_value()) {
+        client->send(RegisterAccountResponse(std::string("Username already exists")));
+        return;
+    }
 
-    // If username exists, return
-    if (user_id.has_value()) {
-        // Make error response
-        response = RegisterAccountResponse("Username already exists");
+    // Hash the password on the hashing pool, which adds the user and answers from there
+    User::SharedPtr user = std::make_shared<User>(msg.get_username(), msg.get_display_name());
+    ConnectionRegistry::ConnectionId connection_id = client->get_connection_id();
+    bool queued = PasswordHasher::get_instance().submit(
+        [user, password = msg.get_password(), connection_id]() {
+            RegisterAccountResponse response(
+                Database::get_instance().add_user(user, PasswordHasher::hash(password)));
+            ConnectionRegistry::get_instance().post(
+                connection_id, [response](ClientHandler& client) {
+                    LOG_DEBUG << "RegisterAccountResponse:" << response.to_json();
+                    client.send(response);
+                });
+        });
+    if (queued) {
+        client->defer_response();
     } else {
-        // Try to add the password to the password table
-        User::SharedPtr user = std::make_shared<User>(msg.get_username(), msg.get_display_name());
-        response = RegisterAccountResponse(db.add_user(user, msg.get_password()));
+        client->send(RegisterAccountResponse(std::string(SERVER_BUSY)));
     }
-
-    std::vector<uint8_t> buf;
-    response.serialize_msg(buf);
-    qDebug() << "RegisterAccountResponse: " << response.to_json().c_str();
-    emit MessageHandler::get_instance().write_data(buf);
 }
 
 void on_login(QTcpSocket* socket, LoginMessage& msg) {
     Database& db = Database::get_instance();
-    ClientHandler* client = qobject_cast<ClientHandler*>(socket->parent());
+    ClientHandler* client = ClientHandler::from_socket(socket);
     if (client == nullptr) {
-        qDebug() << "ClientHandler is null";
+        LOG_ERROR << "ClientHandler is null";
         return;
     }
 
-    LoginResponse response;
-    std::optional<UUID> user_uid = db.get_uid_from_username(msg.get_username());
-    qDebug() << "User uid: " << user_uid.value().to_string().c_str();
-    if (!user_uid.has_value()) {
-        response = LoginResponse("Username does not exist");
-    } else {
-        std::variant<bool, std::string> res =
-            db.verify_password(user_uid.value(), msg.get_password());
-        if (std::holds_alternative<std::string>(res)) {
-            response = LoginResponse(std::get<std::string>(res));
-        } else if (!std::get<bool>(res)) {
-            response = LoginResponse("Incorrect password");
-        } else {
-            User::SharedPtr user = db.get_user_by_uid(user_uid.value()).value();
-            client->set_authenticated_user(user);
-            qDebug() << "User uid: " << user->get_uid().to_string().c_str();
-            response = LoginResponse(user);
+    // Read the account in one go, so that a concurrent deletion is seen entirely or not at all
+    std::optional<User::SharedPtr> user = db.read([&]() -> std::optional<User::SharedPtr> {
+        std::optional<UUID> user_uid = db.get_uid_from_username(msg.get_username());
+        if (!user_uid.has_value()) {
+            return std::nullopt;
         }
+        return db.get_user_by_uid(user_uid.value());
+    });
+    if (!user.has_value()) {
+        client->send(LoginResponse(std::string("Username does not exist")));
+        return;
     }
 
-    std::vector<uint8_t> buf;
-    response.serialize_msg(buf);
-    qDebug() << "LoginResponse: " << response.to_json().c_str();
-    emit MessageHandler::get_instance().write_data(buf);
+    // Verify the password on the hashing pool, then log the connection in from its own thread
+    ConnectionRegistry::ConnectionId connection_id = client->get_connection_id();
+    bool queued = PasswordHasher::get_instance().submit(
+        [user = user.value(), password = msg.get_password(), connection_id]() {
+            UUID user_uid = user->get_uid();
+            std::variant<bool, std::string> res =
+                Database::get_instance().verify_password(user_uid, password);
+            LoginResponse response;
+            if (std::holds_alternative<std::string>(res)) {
+                response = LoginResponse(std::get<std::string>(res));
+            } else if (!std::get<bool>(res)) {
+                response = LoginResponse(std::string("Incorrect password"));
+            } else {
+                response = LoginResponse(user);
+            }
+            bool verified = std::holds_alternative<bool>(res) && std::get<bool>(res);
+            ConnectionRegistry::get_instance().post(
+                connection_id, [user, response, verified](ClientHandler& client) {
+                    if (verified) {
+                        client.set_authenticated_user(user);
+                        LOG_DEBUG << "User uid:" << user->get_uid();
+                    }
+                    LOG_DEBUG << "LoginResponse:" << response.to_json();
+                    client.send(response);
+                });
+        });
+    if (queued) {
+        client->defer_response();
+    } else {
+        client->send(LoginResponse(std::string(SERVER_BUSY)));
+    }
+}
 
-    if (!response.is_success()) {
+void on_sync(QTcpSocket* socket, SyncMessage& msg) {
+    ClientHandler* client = ClientHandler::from_socket(socket);
+    if (client == nullptr) {
+        LOG_ERROR << "ClientHandler is null";
+        return;
+    }
+    std::optional<User::SharedPtr> user = client->get_authenticated_user();
+    if (!user.has_value()) {
+        client->send(SyncResponse("Not logged in"));
         return;
     }
+    Database& db = Database::get_instance();
+    uint8_t version = client->get_version();
 
-    User::SharedPtr user = response.get_data().value();
-    for (auto channel_uid : user->get_channels()) {
-        std::optional<Channel::SharedPtr> channel = db.get_channel_by_uid(channel_uid);
-        if (!channel.has_value()) {
-            continue;
-        }
-        CreateChannelResponse create_channel_response(channel.value());
-        std::vector<uint8_t> buf;
-        create_channel_response.serialize_msg(buf);
-        qDebug() << "CreateChannelResponse: " << create_channel_response.to_json().c_str();
-        emit MessageHandler::get_instance().write_data(buf);
-
-        for (auto message_snowflake : channel.value()->get_message_snowflakes()) {
-            std::optional<Message::SharedPtr> message = db.get_message_by_uid(message_snowflake);
-            if (!message.has_value()) {
+    // Read the channels in one go, so that the batch never lists a channel half-way through being
+    // created or removed. The read stops at a full page; the messages are read after it
+    std::vector<UUID> channel_uids;
+    size_t size = 0;
+    SyncResponse::Batch batch = db.read([&]() {
+        channel_uids = user.value()->get_channels();
+        SyncResponse::Batch result;
+        result.next_since = msg.get_since();
+        size = SyncResponse::empty_size(version);
+
+        // Channels go first, so that the client knows every channel before its messages arrive
+        uint32_t channel_offset = msg.get_channel_offset();
+        for (; channel_offset < channel_uids.size(); channel_offset++) {
+            std::optional<Channel::SharedPtr> channel =
+                db.get_channel_by_uid(channel_uids[channel_offset]);
+            if (!channel.has_value()) {
                 continue;
             }
-            SendMessageResponse send_message_response(message.value());
-            std::vector<uint8_t> buf;
-            send_message_response.serialize_msg(buf);
-            qDebug() << "SendMessageResponse: " << send_message_response.to_json().c_str();
-            emit MessageHandler::get_instance().write_data(buf);
+            auto metadata = std::make_shared<Channel>(channel.value()->get_uid(),
+                                                      channel.value()->get_name(),
+                                                      channel.value()->get_user_uids());
+            size_t entry_size = SyncResponse::entry_size(metadata, version);
+            if (size + entry_size > SyncResponse::max_size(version)) {
+                break;
+            }
+            size += entry_size;
+            result.channels.push_back(metadata);
+        }
+        result.next_channel_offset = channel_offset;
+        result.has_more = channel_offset < channel_uids.size();
+        return result;
+    });
+
+    if (!batch.has_more) {
+        size_t limit = msg.get_limit() == 0 ? SyncMessage::MAX_LIMIT
+                                            : std::min(msg.get_limit(), SyncMessage::MAX_LIMIT);
+        std::vector<Message::SharedPtr> messages =
+            db.get_messages_since(channel_uids, msg.get_since(), limit);
+        // A full page may be followed by more messages
+        batch.has_more = messages.size() == limit;
+        for (const Message::SharedPtr& message : messages) {
+            size_t entry_size = SyncResponse::entry_size(message, version);
+            if (size + entry_size > SyncResponse::max_size(version)) {
+                batch.has_more = true;
+                break;
+            }
+            size += entry_size;
+            batch.messages.push_back(message);
+            batch.next_since = message->get_snowflake();
+        }
+    }
+
+    LOG_DEBUG << "SyncResponse:" << batch.channels.size() << "channels," << batch.messages.size()
+              << "messages, more:" << batch.has_more;
+    client->send(SyncResponse(std::move(batch)));
+}
+
+void on_fetch_history(QTcpSocket* socket, FetchHistoryMessage& msg) {
+    ClientHandler* client = ClientHandler::from_socket(socket);
+    if (client == nullptr) {
+        LOG_ERROR << "ClientHandler is null";
+        return;
+    }
+    std::optional<User::SharedPtr> user = client->get_authenticated_user();
+    if (!user.has_value()) {
+        client->send(FetchHistoryResponse("Not logged in"));
+        return;
+    }
+    Database& db = Database::get_instance();
+    UUID channel_uid = msg.get_channel_uid();
+    std::optional<Channel::SharedPtr> channel = db.get_channel_by_uid(channel_uid);
+    if (!channel.has_value()) {
+        client->send(FetchHistoryResponse("Channel does not exist"));
+        return;
+    }
+    if (!channel.value()->has_user(user.value()->get_uid())) {
+        client->send(FetchHistoryResponse("Not a member of the channel"));
+        return;
+    }
+
+    size_t limit = msg.get_limit() == 0 ? FetchHistoryMessage::DEFAULT_LIMIT
+                                        : std::min(msg.get_limit(), FetchHistoryMessage::MAX_LIMIT);
+    std::variant<Database::ChannelHistory, std::string> history =
+        db.get_channel_history(channel_uid, msg.get_before(), msg.get_after(), limit);
+    if (std::holds_alternative<std::string>(history)) {
+        client->send(FetchHistoryResponse(std::get<std::string>(history)));
+        return;
+    }
+    Database::ChannelHistory& found = std::get<Database::ChannelHistory>(history);
+
+    // Keep the messages nearest to where the client is reading if they do not all fit a frame
+    bool forward = msg.get_after() != 0 && msg.get_before() == 0;
+    uint8_t version = client->get_version();
+    size_t size = FetchHistoryResponse::empty_size(version);
+    size_t fitting = 0;
+    for (; fitting < found.messages.size(); fitting++) {
+        size_t i = forward ? fitting : found.messages.size() - 1 - fitting;
+        size_t entry_size = FetchHistoryResponse::entry_size(found.messages[i], version);
+        if (size + entry_size > FetchHistoryResponse::max_size(version)) {
+            break;
         }
+        size += entry_size;
+    }
+    HistoryPage page;
+    page.channel_uid = channel_uid;
+    page.has_more = found.has_more || fitting < found.messages.size();
+    if (forward) {
+        page.messages.assign(found.messages.begin(), found.messages.begin() + fitting);
+    } else {
+        page.messages.assign(found.messages.end() - fitting, found.messages.end());
     }
+
+    LOG_DEBUG << "FetchHistoryResponse:" << page.messages.size() << "messages, more:"
+              << page.has_more;
+    client->send(FetchHistoryResponse(std::move(page)));
 }
 
 void on_list_accounts(QTcpSocket* socket, ListAccountsMessage& msg) {
-    std::string regex_string = msg.get_regex();
+    ClientHandler* client = ClientHandler::from_socket(socket);
+    if (client == nullptr) {
+        LOG_ERROR << "ClientHandler is null";
+        return;
+    }
     Database& db = Database::get_instance();
+    size_t limit = msg.get_limit() == 0 ? ListAccountsMessage::MAX_LIMIT : msg.get_limit();
 
-    std::variant<std::vector<UUID>, std::string> result = db.get_uuids_matching_regex(regex_string);
-    ListAccountsResponse response;
+    // The search may scan every account, so it runs on its own; only resolving the page into
+    // accounts is read in one go, so that none of them is seen half-way through being removed
+    std::variant<AccountSearchIndex::Page, std::string> result =
+        db.search_users(msg.get_regex(), limit, msg.get_cursor());
     if (std::holds_alternative<std::string>(result)) {
-        response = ListAccountsResponse(std::get<std::string>(result));
-    } else {
-        std::vector<UUID> uuids = std::get<std::vector<UUID>>(result);
+        client->send(ListAccountsResponse(std::get<std::string>(result)));
+        return;
+    }
+    const AccountSearchIndex::Page& page = std::get<AccountSearchIndex::Page>(result);
+    ListAccountsResponse response = db.read([&]() {
         std::vector<User::SharedPtr> users;
-        for (const auto& uuid : uuids) {
+        users.reserve(page.uids.size());
+        for (const auto& uuid : page.uids) {
             std::optional<const User::SharedPtr> user = db.get_user_by_uid(uuid);
             if (user.has_value()) {
                 users.push_back(user.value());
             }
         }
-        response = ListAccountsResponse(users);
-    }
+        return ListAccountsResponse(users, page.next_cursor);
+    });
 
-    std::vector<uint8_t> buf;
-    response.serialize_msg(buf);
-    qDebug() << "ListAccountsResponse: " << response.to_json().c_str();
-    emit MessageHandler::get_instance().write_data(buf);
+    LOG_DEBUG << "ListAccountsResponse:" << response.to_json();
+    client->send(response);
 }
 
 void on_delete_account(QTcpSocket* socket, DeleteAccountMessage& msg) {
+    ClientHandler* client = ClientHandler::from_socket(socket);
+    if (client == nullptr) {
+        LOG_ERROR << "ClientHandler is null";
+        return;
+    }
     Database& db = Database::get_instance();
-    DeleteAccountResponse response;
 
     std::optional<UUID> user_uid = db.get_uid_from_username(msg.get_username());
     if (!user_uid.has_value()) {
-        response = DeleteAccountResponse("Username does not exist");
-    } else {
-        std::variant<bool, std::string> res =
-            db.verify_password(user_uid.value(), msg.get_password());
-        if (std::holds_alternative<std::string>(res)) {
-            response = DeleteAccountResponse(std::get<std::string>(res));
-        } else if (!std::get<bool>(res)) {
-            response = DeleteAccountResponse("Username and password do not match");
-        } else {
-            response = DeleteAccountResponse(db.remove_user(user_uid.value()));
-        }
+        client->send(DeleteAccountResponse(std::string("Username does not exist")));
+        return;
     }
 
-    std::vector<uint8_t> buf;
-    response.serialize_msg(buf);
-    qDebug() << "DeleteAccountResponse: " << response.to_json().c_str();
-    emit MessageHandler::get_instance().write_data(buf);
+    // Verify the password on the hashing pool, which removes the account and answers from there
+    ConnectionRegistry::ConnectionId connection_id = client->get_connection_id();
+    bool queued = PasswordHasher::get_instance().submit(
+        [user_uid = user_uid.value(), password = msg.get_password(), connection_id]() mutable {
+            Database& db = Database::get_instance();
+            std::variant<bool, std::string> res = db.verify_password(user_uid, password);
+            DeleteAccountResponse response;
+            if (std::holds_alternative<std::string>(res)) {
+                response = DeleteAccountResponse(std::get<std::string>(res));
+            } else if (!std::get<bool>(res)) {
+                response = DeleteAccountResponse(std::string("Username and password do not match"));
+            } else {
+                response = DeleteAccountResponse(db.remove_user(user_uid));
+            }
+            ConnectionRegistry::get_instance().post(
+                connection_id, [response](ClientHandler& client) {
+                    LOG_DEBUG << "DeleteAccountResponse:" << response.to_json();
+                    client.send(response);
+                });
+        });
+    if (queued) {
+        client->defer_response();
+    } else {
+        client->send(DeleteAccountResponse(std::string(SERVER_BUSY)));
+    }
 }
 
 void on_delete_message(QTcpSocket* socket, DeleteMessageMessage& msg) {
@@ -173,12 +358,14 @@ void on_send_message(QTcpSocket* socket, SendMessageMessage& msg) {
 }
 
 void init_message_handlers(MessageHandler& messageHandler) {
-    messageHandler.register_handler<RegisterAccountMessage>(&on_register_account);
-    messageHandler.register_handler<LoginMessage>(&on_login);
-    messageHandler.register_handler<ListAccountsMessage>(&on_list_accounts);
-    messageHandler.register_handler<DeleteAccountMessage>(&on_delete_account);
-    messageHandler.register_handler<SendMessageMessage>(&on_send_message);
-    messageHandler.register_handler<DeleteMessageMessage>(&on_delete_message);
-    messageHandler.register_handler<CreateChannelMessage>(&on_create_channel);
-    messageHandler.register_handler<SendMessageMessage>(&on_send_message);
+    messageHandler.register_handler<&on_hello>();
+    messageHandler.register_handler<&on_register_account>();
+    messageHandler.register_handler<&on_login>();
+    messageHandler.register_handler<&on_sync>();
+    messageHandler.register_handler<&on_fetch_history>();
+    messageHandler.register_handler<&on_list_accounts>();
+    messageHandler.register_handler<&on_delete_account>();
+    messageHandler.register_handler<&on_send_message>();
+    messageHandler.register_handler<&on_delete_message>();
+    messageHandler.register_handler<&on_create_channel>();
 }
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <string_view>
+
+#include "server/model/metrics.hpp"
+
+namespace {
+
+/**
+ * @brief The label each operation is exported with, indexed by operation.
+ */
+constexpr const char* OPERATION_NAMES[] = {
+    "register_account",
+    "login",
+    "list_accounts",
+    "delete_account",
+    "send_message",
+    "read_message",
+    "delete_message",
+    "edit_message",
+    "unread_message",
+    "create_channel",
+    "update_channel_name",
+    "update_display_name",
+    "update_profile_picture",
+    "reset_password",
+    "sync",
+    "fetch_history",
+    "hello",
+};
+static_assert(std::size(OPERATION_NAMES) == NUM_OPERATIONS);
+
+/// The largest latency bucket exported is 2^MAX_LATENCY_BITS nanoseconds, about 17 seconds.
+constexpr unsigned MAX_LATENCY_BITS = 34;
+/// The smallest latency bucket exported is 2^MIN_LATENCY_BITS nanoseconds, about a microsecond.
+constexpr unsigned MIN_LATENCY_BITS = 10;
+/// The largest fan-out bucket exported is 2^MAX_FANOUT_BITS sessions.
+constexpr unsigned MAX_FANOUT_BITS = 16;
+/// The quantiles exported for every latency histogram.
+constexpr double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+void append_number(std::string& out, double value) {
+    char buf[32];
+    int length = std::snprintf(buf, sizeof(buf), "%.9g", value);
+    out.append(buf, length);
+}
+
+void append_header(std::string& out, const char* name, const char* type, const char* help) {
+    out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+    out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+/**
+ * @brief Appends a sample: name{labels} value.
+ */
+void append_sample(std::string& out, std::string_view name, std::string_view labels,
+                   double value) {
+    out.append(name);
+    if (!labels.empty()) {
+        out.append("{").append(labels).append("}");
+    }
+    out.append(" ");
+    append_number(out, value);
+    out.append("\n");
+}
+
+/**
+ * @brief Appends the cumulative buckets, sum and count of a histogram.
+ *
+ * Bucket bounds are one below powers of two, where the buckets of a Histogram end exactly.
+ *
+ * @param scale The unit of the exported values, per recorded unit.
+ */
+void append_histogram(std::string& out, std::string_view name, std::string_view labels,
+                      const Histogram& histogram, unsigned min_bits, unsigned max_bits,
+                      double scale) {
+    std::string prefix = labels.empty() ? std::string() : std::string(labels) + ",";
+    std::string bucket = std::string(name) + "_bucket";
+    for (unsigned bits = min_bits; bits <= max_bits; bits++) {
+        uint64_t bound = (uint64_t(1) << bits) - 1;
+        std::string le = prefix + "le=\"";
+        append_number(le, bound * scale);
+        le.append("\"");
+        append_sample(out, bucket, le, histogram.count_at_most(bound));
+    }
+    append_sample(out, bucket, prefix + "le=\"+Inf\"", histogram.get_count());
+    append_sample(out, std::string(name) + "_sum", labels, histogram.get_sum() * scale);
+    append_sample(out, std::string(name) + "_count", labels, histogram.get_count());
+}
+
+}  // namespace
+
+uint64_t Histogram::count_at_most(uint64_t bound) const {
+    uint64_t total = 0;
+    for (size_t bucket = 0; bucket < NUM_BUCKETS && last_value_of(bucket) <= bound; bucket++) {
+        total += this->buckets[bucket].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Histogram::value_at_quantile(double quantile) const {
+    uint64_t count = get_count();
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, std::ceil(std::clamp(quantile, 0.0, 1.0) * count));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        seen += this->buckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return last_value_of(bucket);
+        }
+    }
+    // Values recorded while the buckets were being read
+    return last_value_of(NUM_BUCKETS - 1);
+}
+
+Metrics& Metrics::get_instance() {
+    static Metrics instance;
+    return instance;
+}
+
+void Metrics::record_request(Operation operation, size_t bytes) {
+    OperationMetrics& metrics = metrics_for(operation);
+    metrics.requests.fetch_add(1, std::memory_order_relaxed);
+    metrics.bytes_in.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Metrics::record_response(Operation operation, size_t bytes) {
+    OperationMetrics& metrics = metrics_for(operation);
+    metrics.responses.fetch_add(1, std::memory_order_relaxed);
+    metrics.bytes_out.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Metrics::record_latency(Operation operation, std::chrono::nanoseconds latency) {
+    metrics_for(operation).latency.record(std::max<int64_t>(latency.count(), 0));
+}
+
+void Metrics::record_fanout(size_t sessions) {
+    this->fanout.record(sessions);
+}
+
+void Metrics::add_gauge(std::string name, std::string help, std::function<double()> read) {
+    std::lock_guard<std::mutex> lock(this->gauges_mutex);
+    this->gauges.push_back({std::move(name), std::move(help), std::move(read)});
+}
+
+uint64_t Metrics::get_num_requests(Operation operation) const {
+    return metrics_for(operation).requests.load(std::memory_order_relaxed);
+}
+
+const Histogram& Metrics::get_latency(Operation operation) const {
+    return metrics_for(operation).latency;
+}
+
+const Histogram& Metrics::get_fanout() const {
+    return this->fanout;
+}
+
+std::string Metrics::render() const {
+    std::string out;
+    auto for_each_operation = [this](auto&& append) {
+        for (size_t op = 0; op <= NUM_OPERATIONS; op++) {
+            const char* name = op < NUM_OPERATIONS ? OPERATION_NAMES[op] : "unknown";
+            const OperationMetrics& metrics =
+                op < NUM_OPERATIONS ? this->operations[op] : this->unknown;
+            append(std::string("operation=\"") + name + "\"", metrics);
+        }
+    };
+    auto append_counter = [&](const char* name, const char* help, auto field) {
+        append_header(out, name, "counter", help);
+        for_each_operation([&](const std::string& labels, const OperationMetrics& metrics) {
+            append_sample(out, name, labels, (metrics.*field).load(std::memory_order_relaxed));
+        });
+    };
+
+    append_counter("sockout_requests_total", "Requests received, by operation.",
+                   &OperationMetrics::requests);
+    append_counter("sockout_received_bytes_total", "Bytes of request frames, headers included.",
+                   &OperationMetrics::bytes_in);
+    append_counter("sockout_frames_sent_total", "Frames written to connections, by operation.",
+                   &OperationMetrics::responses);
+    append_counter("sockout_sent_bytes_total", "Bytes of frames written, headers included.",
+                   &OperationMetrics::bytes_out);
+
+    constexpr double NANOSECONDS = 1e-9;
+    const char* latency = "sockout_request_duration_seconds";
+    append_header(out, latency, "histogram",
+                  "Time from a request frame being complete to its response being written.");
+    for_each_operation([&](const std::string& labels, const OperationMetrics& metrics) {
+        append_histogram(out, latency, labels, metrics.latency, MIN_LATENCY_BITS,
+                         MAX_LATENCY_BITS, NANOSECONDS);
+    });
+
+    const char* quantiles = "sockout_request_duration_quantile_seconds";
+    append_header(out, quantiles, "gauge",
+                  "Request duration quantiles since startup, to within an eighth.");
+    for_each_operation([&](const std::string& labels, const OperationMetrics& metrics) {
+        for (double quantile : QUANTILES) {
+            std::string quantile_labels = labels + ",quantile=\"";
+            append_number(quantile_labels, quantile);
+            quantile_labels.append("\"");
+            append_sample(out, quantiles, quantile_labels,
+                          metrics.latency.value_at_quantile(quantile) * NANOSECONDS);
+        }
+    });
+
+    const char* fanout = "sockout_message_fanout_sessions";
+    append_header(out, fanout, "histogram", "Sessions each new message was delivered to.");
+    append_histogram(out, fanout, "", this->fanout, 0, MAX_FANOUT_BITS, 1);
+
+    std::lock_guard<std::mutex> lock(this->gauges_mutex);
+    for (const Gauge& gauge : this->gauges) {
+        append_header(out, gauge.name.c_str(), "gauge", gauge.help.c_str());
+        append_sample(out, gauge.name, "", gauge.read());
+    }
+    return out;
+}
@@ -0,0 +1,69 @@
+#include <QTcpSocket>
+#include <memory>
+
+#include "models/logger.hpp"
+#include "server/model/metrics.hpp"
+#include "server/model/metrics_server.hpp"
+
+namespace {
+
+std::string http_response(std::string_view status, std::string_view content_type,
+                          std::string_view body) {
+    std::string response;
+    response.reserve(body.size() + 128);
+    response.append("HTTP/1.1 ").append(status).append("\r\n");
+    response.append("Content-Type: ").append(content_type).append("\r\n");
+    response.append("Content-Length: ").append(std::to_string(body.size())).append("\r\n");
+    response.append("Connection: close\r\n\r\n");
+    response.append(body);
+    return response;
+}
+
+}  // namespace
+
+MetricsServer::MetricsServer(QObject* parent) : QTcpServer(parent) {}
+
+std::string MetricsServer::respond(std::string_view request) {
+    // GET /metrics HTTP/1.1
+    std::string_view line = request.substr(0, request.find("\r\n"));
+    size_t method_end = line.find(' ');
+    if (method_end == std::string_view::npos) {
+        return http_response("400 Bad Request", "text/plain", "Bad request\n");
+    }
+    std::string_view method = line.substr(0, method_end);
+    std::string_view target = line.substr(method_end + 1);
+    target = target.substr(0, target.find(' '));
+    target = target.substr(0, target.find('?'));
+
+    if (target != "/metrics") {
+        return http_response("404 Not Found", "text/plain", "Not found\n");
+    }
+    if (method != "GET") {
+        return http_response("405 Method Not Allowed", "text/plain", "Method not allowed\n");
+    }
+    return http_response("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                         Metrics::get_instance().render());
+}
+
+void MetricsServer::incomingConnection(qintptr socket_descriptor) {
+    QTcpSocket* socket = new QTcpSocket(this);
+    socket->setSocketDescriptor(socket_descriptor);
+
+    auto request = std::make_shared<std::string>();
+    connect(socket, &QTcpSocket::readyRead, this, [socket, request]() {
+        QByteArray data = socket->readAll();
+        request->append(data.constData(), data.size());
+        size_t end = request->find("\r\n\r\n");
+        if (end == std::string::npos) {
+            if (request->size() > MAX_REQUEST_SIZE) {
+                LOG_WARN << "Metrics request too large";
+                socket->abort();
+            }
+            return;
+        }
+        std::string response = respond(std::string_view(*request).substr(0, end));
+        socket->write(response.data(), response.size());
+        socket->disconnectFromHost();
+    });
+    connect(socket, &QTcpSocket::disconnected, socket, &QTcpSocket::deleteLater);
+}
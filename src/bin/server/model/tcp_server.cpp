@@ -1,21 +1,80 @@
 #include "server/model/tcp_server.hpp"
 #include "server/model/client_handler.hpp"
+#include "models/logger.hpp"
 
 #include <QThread>
+#include <algorithm>
 
-TcpServer::TcpServer(QObject* parent) : QTcpServer(parent) {}
+TcpServer::TcpServer(int num_workers, SchedulingPolicy policy, QObject* parent)
+    : QTcpServer(parent), policy(policy) {
+    num_workers = std::max(num_workers, 1);
+    for (int i = 0; i < num_workers; i++) {
+        auto worker = std::make_unique<Worker>();
+        worker->thread = new QThread(this);
+        worker->thread->setObjectName(QString("worker-") + QString::number(i));
+        worker->thread->start();
+        this->workers.push_back(std::move(worker));
+    }
+    LOG_INFO << "Started" << num_workers << "worker threads";
+}
+
+TcpServer::~TcpServer() {
+    for (auto& worker : this->workers) {
+        worker->thread->quit();
+    }
+    for (auto& worker : this->workers) {
+        worker->thread->wait();
+    }
+}
+
+size_t TcpServer::get_num_workers() const {
+    return this->workers.size();
+}
+
+size_t TcpServer::get_connection_count(size_t worker) const {
+    return this->workers.at(worker)->connections;
+}
+
+size_t TcpServer::get_connection_count() const {
+    size_t count = 0;
+    for (const auto& worker : this->workers) {
+        count += worker->connections;
+    }
+    return count;
+}
+
+size_t TcpServer::next_worker() {
+    switch (this->policy) {
+        case SchedulingPolicy::LEAST_LOADED: {
+            size_t best = 0;
+            for (size_t i = 1; i < this->workers.size(); i++) {
+                if (this->workers[i]->connections < this->workers[best]->connections) {
+                    best = i;
+                }
+            }
+            return best;
+        }
+        case SchedulingPolicy::ROUND_ROBIN:
+        default: {
+            size_t worker = this->next_round_robin;
+            this->next_round_robin = (this->next_round_robin + 1) % this->workers.size();
+            return worker;
+        }
+    }
+}
 
 void TcpServer::incomingConnection(qintptr socketDescriptor) {
-    qDebug() << "New client connected?";
-    QThread* thread = new QThread();
+    Worker* worker = this->workers[next_worker()].get();
     ClientHandler* handler = new ClientHandler(socketDescriptor);
 
-    handler->moveToThread(thread);
+    handler->moveToThread(worker->thread);
+    worker->connections++;
 
-    connect(thread, &QThread::started, handler, &ClientHandler::handle_client);
-    connect(handler, &ClientHandler::finished, thread, &QThread::quit);
     connect(handler, &ClientHandler::finished, handler, &ClientHandler::deleteLater);
-    connect(thread, &QThread::finished, thread, &QThread::deleteLater);
+    // Handlers still connected at shutdown are deleted on their worker as it stops
+    connect(worker->thread, &QThread::finished, handler, &ClientHandler::deleteLater);
+    connect(handler, &ClientHandler::finished, this, [worker]() { worker->connections--; });
 
-    thread->start();
+    // The handler now lives on the worker, so its socket must be created from the worker's loop
+    QMetaObject::invokeMethod(handler, &ClientHandler::handle_client, Qt::QueuedConnection);
 }
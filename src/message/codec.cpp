@@ -0,0 +1,105 @@
+#include "message/codec.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "constants.hpp"
+#include "json.hpp"
+#include "message/header.hpp"
+#include "message/payload.hpp"
+
+namespace {
+
+// Constant-initialized, so that payloads may be encoded by other static initializers
+constinit const BinaryCodec VARINT_CODEC(PROTOCOL_VERSION_VARINT);
+constinit const BinaryCodec CUSTOM_CODEC(PROTOCOL_VERSION_CUSTOM);
+constinit const JsonCodec JSON_CODEC;
+
+/**
+ * @brief Writes the length of the payload following a header into the end of the header.
+ */
+void patch_packet_length(std::vector<uint8_t>& buf, size_t start, size_t header_size) {
+    uint32_t packet_length = buf.size() - start - header_size;
+    for (size_t i = header_size; i > 2; i--) {
+        buf[start + i - 1] = static_cast<uint8_t>(packet_length);
+        packet_length >>= 8;
+    }
+}
+
+}  // namespace
+
+const Codec& Codec::for_version(uint8_t version) {
+    switch (version) {
+        case PROTOCOL_VERSION_VARINT:
+            return VARINT_CODEC;
+        case PROTOCOL_VERSION_JSON:
+            return JSON_CODEC;
+        case PROTOCOL_VERSION_CUSTOM:
+            return CUSTOM_CODEC;
+        default:
+            throw std::out_of_range("Codec: unsupported protocol version " +
+                                    std::to_string(version));
+    }
+}
+
+void BinaryCodec::encode(const Payload& payload, std::vector<uint8_t>& buf) const {
+    payload.serialize_binary(buf, this->get_version());
+}
+
+void BinaryCodec::encode_frame(enum Operation operation, const Payload& payload,
+                               std::vector<uint8_t>& buf) const {
+    size_t start = buf.size();
+    Header header(this->get_version(), operation, payload.binary_size(this->get_version()));
+    size_t required = start + header.size() + header.get_packet_length();
+    if (required > buf.capacity()) {
+        buf.reserve(std::max(required, 2 * buf.capacity()));
+    }
+    header.serialize(buf);
+    payload.serialize_binary(buf, this->get_version());
+    // Models may change between measuring and encoding them; the length is what was written
+    patch_packet_length(buf, start, header.size());
+}
+
+void BinaryCodec::decode(Payload& payload, ByteReader& reader) const {
+    payload.deserialize_binary(reader);
+}
+
+size_t BinaryCodec::size(const Payload& payload) const {
+    return payload.binary_size(this->get_version());
+}
+
+size_t BinaryCodec::entry_size(const Payload& entry) const {
+    return entry.binary_size(this->get_version());
+}
+
+void JsonCodec::encode(const Payload& payload, std::vector<uint8_t>& buf) const {
+    std::string msg = payload.to_json();
+    buf.insert(buf.end(), msg.begin(), msg.end());
+}
+
+void JsonCodec::encode_frame(enum Operation operation, const Payload& payload,
+                             std::vector<uint8_t>& buf) const {
+    size_t start = buf.size();
+    Header header(this->get_version(), operation, 0);
+    header.serialize(buf);
+    encode(payload, buf);
+    patch_packet_length(buf, start, header.size());
+}
+
+void JsonCodec::decode(Payload& payload, ByteReader& reader) const {
+    std::span<const uint8_t> msg = reader.read_remaining();
+    try {
+        payload.from_json(std::string(msg.begin(), msg.end()));
+    } catch (const nlohmann::json::exception& e) {
+        throw std::out_of_range(std::string("JsonCodec: malformed payload: ") + e.what());
+    }
+}
+
+size_t JsonCodec::size(const Payload& payload) const {
+    return payload.to_json().size();
+}
+
+size_t JsonCodec::entry_size(const Payload& entry) const {
+    // The entry is embedded as an escaped string, followed by a separating comma
+    return nlohmann::json(entry.to_json()).dump().size() + 1;
+}
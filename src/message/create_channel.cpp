@@ -4,60 +4,37 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 
 CreateChannelMessage::CreateChannelMessage(std::string channel_name, std::vector<UUID> members)
     : channel_name(channel_name), members(members) {}
 
-void CreateChannelMessage::serialize(std::vector<uint8_t>& buf) const {
+void CreateChannelMessage::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
 // Encode channel name length and channel name
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
-    uint8_t channel_name_length = this->channel_name.size();
-    buf.push_back(channel_name_length);
-    buf.insert(buf.end(), this->channel_name.begin(), this->channel_name.end());
+    write_prefixed_string(buf, this->channel_name, version);
 
     // Encode number of members
-    uint8_t num_members = this->members.size();
-    buf.push_back(num_members);
+    write_length(buf, this->members.size(), version);
 
     // Encode each member
     for (const UUID& member : this->members) {
         member.serialize(buf);
     }
-#endif
 }
 
-void CreateChannelMessage::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::CREATE_CHANNEL, this->size());
-    header.serialize(buf);
-
-    this->serialize(buf);
+void CreateChannelMessage::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::CREATE_CHANNEL, *this, buf, version);
 }
 
-void CreateChannelMessage::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    size_t offset = 0;
-
-    uint8_t channel_name_length = buf[offset++];
-    this->channel_name =
-        std::string(buf.begin() + offset, buf.begin() + offset + channel_name_length);
-    offset += channel_name_length;
-
-    uint8_t num_members = buf[offset++];
-
-    for (uint8_t i = 0; i < num_members; i++) {
-        UUID member;
-        member.deserialize(
-            std::vector<uint8_t>(buf.begin() + offset, buf.begin() + offset + member.size()));
-        this->members.push_back(member);
-        offset += member.size();
+void CreateChannelMessage::deserialize_binary(ByteReader& reader) {
+    this->channel_name = reader.read_prefixed_string();
+
+    size_t num_members = reader.read_length();
+    this->members.clear();
+    this->members.reserve(num_members);
+    for (size_t i = 0; i < num_members; i++) {
+        this->members.push_back(UUID::from_reader(reader));
     }
-#endif
 }
 
 std::string CreateChannelMessage::to_json() const {
@@ -81,16 +58,13 @@ void CreateChannelMessage::from_json(const std::string& json) {
     }
 }
 
-size_t CreateChannelMessage::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
-    size_t size = 1 + this->channel_name.size() + 1;  // 1 for channel name length
+size_t CreateChannelMessage::binary_size(uint8_t version) const {
+    size_t size = prefixed_string_size(this->channel_name, version);
+    size += length_size(this->members.size(), version);
     for (const UUID& member : this->members) {
         size += member.size();
     }
     return size;
-#endif
 }
 
 const std::string& CreateChannelMessage::get_channel_name() const {
@@ -4,51 +4,36 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 #include "models/channel.hpp"
 
 CreateChannelResponse::CreateChannelResponse(std::variant<Channel::SharedPtr, std::string> data)
     : data(std::move(data)) {}
 
-void CreateChannelResponse::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string json = to_json();
-    buf.insert(buf.end(), json.begin(), json.end());
-#else
+void CreateChannelResponse::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     if (std::holds_alternative<Channel::SharedPtr>(data)) {
         buf.push_back(0);
-        std::get<Channel::SharedPtr>(data)->serialize(buf);
+        std::get<Channel::SharedPtr>(data)->serialize_binary(buf, version);
     } else {
         buf.push_back(1);
         const std::string& error = std::get<std::string>(data);
-        buf.push_back(error.size());
-        buf.insert(buf.end(), error.begin(), error.end());
+        write_prefixed_string(buf, error, version);
     }
-#endif
 }
 
-void CreateChannelResponse::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::CREATE_CHANNEL, this->size());
-    header.serialize(buf);
-    serialize(buf);
+void CreateChannelResponse::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::CREATE_CHANNEL, *this, buf, version);
 }
 
-void CreateChannelResponse::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    size_t offset = 0;
-    uint8_t has_error = buf[offset++];
+void CreateChannelResponse::deserialize_binary(ByteReader& reader) {
+    uint8_t has_error = reader.read_u8();
     if (has_error == 0) {
         Channel::SharedPtr channel = std::make_shared<Channel>();
-        channel->deserialize(std::vector<uint8_t>(buf.begin() + offset, buf.end()));
+        channel->deserialize_binary(reader);
         data = channel;
     } else {
-        uint8_t error_length = buf[offset++];
-        std::string error(buf.begin() + offset, buf.begin() + offset + error_length);
-        data = error;
+        data = std::string(reader.read_prefixed_string());
     }
-#endif
 }
 
 std::string CreateChannelResponse::to_json() const {
@@ -72,19 +57,15 @@ void CreateChannelResponse::from_json(const std::string& json) {
     }
 }
 
-[[nodiscard]] size_t CreateChannelResponse::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
+[[nodiscard]] size_t CreateChannelResponse::binary_size(uint8_t version) const {
     size_t size = 1;  // for the has_error byte
     if (std::holds_alternative<Channel::SharedPtr>(data)) {
-        size += std::get<Channel::SharedPtr>(data)->size();
+        size += std::get<Channel::SharedPtr>(data)->binary_size(version);
     } else {
         const std::string& error = std::get<std::string>(data);
-        size += 1 + error.size();  // 1 for the error length + error length
+        size += prefixed_string_size(error, version);
     }
     return size;
-#endif
 }
 
 [[nodiscard]] bool CreateChannelResponse::is_success() const {
@@ -2,48 +2,35 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 
 DeleteAccountResponse::DeleteAccountResponse(std::variant<User::SharedPtr, std::string> data)
     : data(data) {}
 
-void DeleteAccountResponse::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
+void DeleteAccountResponse::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     if (is_success()) {
         buf.push_back(0);
-        std::get<User::SharedPtr>(data)->serialize(buf);
+        std::get<User::SharedPtr>(data)->serialize_binary(buf, version);
     } else {
         buf.push_back(1);
         std::string error = std::get<std::string>(data);
-        buf.push_back(error.size());
-        buf.insert(buf.end(), error.begin(), error.end());
+        write_prefixed_string(buf, error, version);
     }
-#endif
 }
 
-void DeleteAccountResponse::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::DELETE_ACCOUNT, size());
-    header.serialize(buf);
-    serialize(buf);
+void DeleteAccountResponse::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::DELETE_ACCOUNT, *this, buf, version);
 }
 
-void DeleteAccountResponse::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    if (buf[0] == 0) {
+void DeleteAccountResponse::deserialize_binary(ByteReader& reader) {
+    uint8_t has_error = reader.read_u8();
+    if (has_error == 0) {
         User::SharedPtr user = std::make_shared<User>();
-        user->deserialize(std::vector<uint8_t>(buf.begin() + 1, buf.end()));
+        user->deserialize_binary(reader);
         data = user;
     } else {
-        size_t len = buf[1];
-        std::string error(buf.begin() + 2, buf.begin() + 2 + len);
-        data = error;
+        data = std::string(reader.read_prefixed_string());
     }
-#endif
 }
 
 std::string DeleteAccountResponse::to_json() const {
@@ -69,18 +56,14 @@ void DeleteAccountResponse::from_json(const std::string& json) {
     }
 }
 
-size_t DeleteAccountResponse::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
+size_t DeleteAccountResponse::binary_size(uint8_t version) const {
     size_t size = 1;
     if (is_success()) {
-        size += std::get<User::SharedPtr>(data)->size();
+        size += std::get<User::SharedPtr>(data)->binary_size(version);
     } else {
-        size += 1 + std::get<std::string>(data).size();
+        size += prefixed_string_size(std::get<std::string>(data), version);
     }
     return size;
-#endif
 }
 
 bool DeleteAccountResponse::is_success() const {
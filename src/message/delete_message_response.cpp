@@ -2,49 +2,36 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 #include "models/message.hpp"
 
 DeleteMessageResponse::DeleteMessageResponse(std::variant<Message::SharedPtr, std::string> data)
     : data(data) {}
 
-void DeleteMessageResponse::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
+void DeleteMessageResponse::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     if (is_success()) {
         buf.push_back(0);
-        std::get<Message::SharedPtr>(data)->serialize(buf);
+        std::get<Message::SharedPtr>(data)->serialize_binary(buf, version);
     } else {
         buf.push_back(1);
         std::string error = std::get<std::string>(data);
-        buf.push_back(error.size());
-        buf.insert(buf.end(), error.begin(), error.end());
+        write_prefixed_string(buf, error, version);
     }
-#endif
 }
 
-void DeleteMessageResponse::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::DELETE_MESSAGE, size());
-    header.serialize(buf);
-    serialize(buf);
+void DeleteMessageResponse::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::DELETE_MESSAGE, *this, buf, version);
 }
 
-void DeleteMessageResponse::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    if (buf[0] == 0) {
+void DeleteMessageResponse::deserialize_binary(ByteReader& reader) {
+    uint8_t has_error = reader.read_u8();
+    if (has_error == 0) {
         Message::SharedPtr message = std::make_shared<Message>();
-        message->deserialize(std::vector<uint8_t>(buf.begin() + 1, buf.end()));
+        message->deserialize_binary(reader);
         data = message;
     } else {
-        size_t len = buf[1];
-        std::string error(buf.begin() + 2, buf.begin() + 2 + len);
-        data = error;
+        data = std::string(reader.read_prefixed_string());
     }
-#endif
 }
 
 std::string DeleteMessageResponse::to_json() const {
@@ -70,15 +57,11 @@ void DeleteMessageResponse::from_json(const std::string& json) {
     }
 }
 
-size_t DeleteMessageResponse::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
+size_t DeleteMessageResponse::binary_size(uint8_t version) const {
     if (std::holds_alternative<std::string>(data)) {
-        return 1 + (1 + std::get<std::string>(data).size());
+        return 1 + prefixed_string_size(std::get<std::string>(data), version);
     }
-    return 1 + std::get<Message::SharedPtr>(data)->size();
-#endif
+    return 1 + std::get<Message::SharedPtr>(data)->binary_size(version);
 }
 
 bool DeleteMessageResponse::is_success() const {
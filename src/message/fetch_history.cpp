@@ -0,0 +1,72 @@
+#include "message/fetch_history.hpp"
+#include <stdint.h>
+#include <string>
+#include "constants.hpp"
+#include "json.hpp"
+#include "message/header.hpp"
+
+FetchHistoryMessage::FetchHistoryMessage(UUID channel_uid, uint64_t before, uint64_t after,
+                                         uint16_t limit)
+    : channel_uid(channel_uid), before(before), after(after), limit(limit) {}
+
+void FetchHistoryMessage::serialize_binary(std::vector<uint8_t>& buf,
+                                           [[maybe_unused]] uint8_t version) const {
+    this->channel_uid.serialize(buf);
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        buf.push_back(static_cast<uint8_t>(this->before >> shift));
+    }
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        buf.push_back(static_cast<uint8_t>(this->after >> shift));
+    }
+    buf.push_back(static_cast<uint8_t>(this->limit >> 8));
+    buf.push_back(static_cast<uint8_t>(this->limit & 0xFF));
+}
+
+void FetchHistoryMessage::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::FETCH_HISTORY, *this, buf, version);
+}
+
+void FetchHistoryMessage::deserialize_binary(ByteReader& reader) {
+    this->channel_uid = UUID::from_reader(reader);
+    this->before = reader.read_u64_be();
+    this->after = reader.read_u64_be();
+    this->limit = reader.read_u16_be();
+}
+
+std::string FetchHistoryMessage::to_json() const {
+    nlohmann::json j;
+    j["channel_uid"] = this->channel_uid.to_string();
+    j["before"] = this->before;
+    j["after"] = this->after;
+    j["limit"] = this->limit;
+    return j.dump();
+}
+
+void FetchHistoryMessage::from_json(const std::string& json) {
+    nlohmann::json j = nlohmann::json::parse(json);
+    this->channel_uid = UUID::from_string(j["channel_uid"].get<std::string>());
+    this->before = j.value<uint64_t>("before", 0);
+    this->after = j.value<uint64_t>("after", 0);
+    this->limit = j.value<uint16_t>("limit", 0);
+}
+
+size_t FetchHistoryMessage::binary_size([[maybe_unused]] uint8_t version) const {
+    return this->channel_uid.size() + sizeof(this->before) + sizeof(this->after) +
+           sizeof(this->limit);
+}
+
+UUID FetchHistoryMessage::get_channel_uid() const {
+    return this->channel_uid;
+}
+
+uint64_t FetchHistoryMessage::get_before() const {
+    return this->before;
+}
+
+uint64_t FetchHistoryMessage::get_after() const {
+    return this->after;
+}
+
+uint16_t FetchHistoryMessage::get_limit() const {
+    return this->limit;
+}
@@ -0,0 +1,131 @@
+#include "message/fetch_history_response.hpp"
+#include <memory>
+#include "constants.hpp"
+#include "json.hpp"
+#include "message/header.hpp"
+#include "message/wire_format.hpp"
+
+FetchHistoryResponse::FetchHistoryResponse(std::variant<HistoryPage, std::string> data)
+    : data(std::move(data)) {}
+
+void FetchHistoryResponse::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
+    if (std::holds_alternative<HistoryPage>(data)) {
+        const HistoryPage& page = std::get<HistoryPage>(data);
+        buf.push_back(0);
+        page.channel_uid.serialize(buf);
+        write_length(buf, page.messages.size(), version, 2);
+        for (const auto& message : page.messages) {
+            message->serialize_binary(buf, version);
+        }
+        buf.push_back(page.has_more ? 1 : 0);
+    } else {
+        buf.push_back(1);
+        const std::string& error = std::get<std::string>(data);
+        write_prefixed_string(buf, error, version);
+    }
+}
+
+void FetchHistoryResponse::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::FETCH_HISTORY, *this, buf, version);
+}
+
+void FetchHistoryResponse::deserialize_binary(ByteReader& reader) {
+    uint8_t has_error = reader.read_u8();
+    if (has_error == 0) {
+        HistoryPage page;
+        page.channel_uid = UUID::from_reader(reader);
+        size_t messages_length = reader.read_length(2);
+        page.messages.reserve(messages_length);
+        for (size_t i = 0; i < messages_length; i++) {
+            Message::SharedPtr message = std::make_shared<Message>();
+            message->deserialize_binary(reader);
+            page.messages.push_back(message);
+        }
+        page.has_more = reader.read_u8() != 0;
+        data = std::move(page);
+    } else {
+        data = std::string(reader.read_prefixed_string());
+    }
+}
+
+std::string FetchHistoryResponse::to_json() const {
+    nlohmann::json j;
+    if (std::holds_alternative<HistoryPage>(data)) {
+        const HistoryPage& page = std::get<HistoryPage>(data);
+        std::vector<std::string> messages;
+        for (const auto& message : page.messages) {
+            messages.push_back(message->to_json());
+        }
+        j["channel_uid"] = page.channel_uid.to_string();
+        j["messages"] = messages;
+        j["has_more"] = page.has_more;
+    } else {
+        j["error"] = std::get<std::string>(data);
+    }
+    return j.dump();
+}
+
+void FetchHistoryResponse::from_json(const std::string& json) {
+    nlohmann::json j = nlohmann::json::parse(json);
+    if (j.contains("error")) {
+        data = j["error"].get<std::string>();
+        return;
+    }
+    HistoryPage page;
+    page.channel_uid = UUID::from_string(j["channel_uid"].get<std::string>());
+    for (const auto& message_json : j["messages"]) {
+        Message::SharedPtr message = std::make_shared<Message>();
+        message->from_json(message_json);
+        page.messages.push_back(message);
+    }
+    page.has_more = j["has_more"].get<bool>();
+    data = std::move(page);
+}
+
+size_t FetchHistoryResponse::binary_size(uint8_t version) const {
+    size_t size = 1;  // for the has_error byte
+    if (std::holds_alternative<HistoryPage>(data)) {
+        const HistoryPage& page = std::get<HistoryPage>(data);
+        // the channel, the count and has_more
+        size += page.channel_uid.size() + length_size(page.messages.size(), version, 2) + 1;
+        for (const auto& message : page.messages) {
+            size += message->binary_size(version);
+        }
+    } else {
+        const std::string& error = std::get<std::string>(data);
+        size += prefixed_string_size(error, version);
+    }
+    return size;
+}
+
+size_t FetchHistoryResponse::max_size(uint8_t version) {
+    return Header::max_packet_length(version);
+}
+
+size_t FetchHistoryResponse::empty_size(uint8_t version) {
+    // has_more is false, the longer of the two in JSON; leave room for the count to grow
+    return FetchHistoryResponse(HistoryPage()).size(version) + length_size(UINT32_MAX, version, 2) -
+           length_size(0, version, 2);
+}
+
+size_t FetchHistoryResponse::entry_size(const Message::SharedPtr& message, uint8_t version) {
+    return Codec::for_version(version).entry_size(*message);
+}
+
+bool FetchHistoryResponse::is_success() const {
+    return std::holds_alternative<HistoryPage>(data);
+}
+
+std::optional<std::string> FetchHistoryResponse::get_error_message() const {
+    if (std::holds_alternative<std::string>(data)) {
+        return std::get<std::string>(data);
+    }
+    return std::nullopt;
+}
+
+std::optional<HistoryPage> FetchHistoryResponse::get_page() const {
+    if (std::holds_alternative<HistoryPage>(data)) {
+        return std::get<HistoryPage>(data);
+    }
+    return std::nullopt;
+}
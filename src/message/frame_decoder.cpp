@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include "message/frame_compression.hpp"
+#include "message/frame_decoder.hpp"
+
+FrameDecoder::FrameDecoder(size_t initial_capacity) {
+    size_t capacity = 1;
+    while (capacity < initial_capacity) {
+        capacity <<= 1;
+    }
+    this->ring.resize(capacity);
+}
+
+void FrameDecoder::feed(const uint8_t* data, size_t length) {
+    reserve(this->count + length);
+
+    size_t mask = this->ring.size() - 1;
+    size_t tail = (this->head + this->count) & mask;
+    size_t first = std::min(length, this->ring.size() - tail);
+    std::memcpy(this->ring.data() + tail, data, first);
+    std::memcpy(this->ring.data(), data + first, length - first);
+    this->count += length;
+}
+
+std::optional<FrameDecoder::Frame> FrameDecoder::next() {
+    if (!this->header.has_value()) {
+        if (this->count == 0) {
+            return std::nullopt;
+        }
+        // The version in the first byte decides how long the rest of the header is
+        uint8_t version = this->ring[this->head] >> 4;
+        size_t header_size = Header::size_for_version(version);
+        if (this->count < header_size) {
+            return std::nullopt;
+        }
+        std::array<uint8_t, Header::MAX_SIZE> header_bytes;
+        pop(header_bytes.data(), header_size);
+        Header header;
+        header.deserialize(std::span<const uint8_t>(header_bytes.data(), header_size));
+        if (header.get_packet_length() > Header::max_packet_length(version)) {
+            throw std::out_of_range("FrameDecoder: packet longer than its version allows");
+        }
+        this->header = header;
+    }
+
+    if (this->count < this->header->get_packet_length()) {
+        return std::nullopt;
+    }
+
+    Frame frame{this->header.value(), std::vector<uint8_t>(this->header->get_packet_length())};
+    pop(frame.payload.data(), frame.payload.size());
+    this->header = std::nullopt;
+
+    if (frame.header.is_compressed()) {
+        uint8_t version = frame.header.get_version();
+        frame.payload =
+            FrameCompressor::decompress(frame.payload, Header::max_packet_length(version));
+        frame.header.set_compressed(false);
+        frame.header.set_packet_length(frame.payload.size());
+    }
+    return frame;
+}
+
+size_t FrameDecoder::buffered() const {
+    return this->count;
+}
+
+void FrameDecoder::reset() {
+    this->head = 0;
+    this->count = 0;
+    this->header = std::nullopt;
+}
+
+void FrameDecoder::pop(uint8_t* out, size_t length) {
+    size_t mask = this->ring.size() - 1;
+    size_t first = std::min(length, this->ring.size() - this->head);
+    std::memcpy(out, this->ring.data() + this->head, first);
+    std::memcpy(out + first, this->ring.data(), length - first);
+    this->head = (this->head + length) & mask;
+    this->count -= length;
+}
+
+void FrameDecoder::reserve(size_t capacity) {
+    if (capacity <= this->ring.size()) {
+        return;
+    }
+
+    size_t new_size = this->ring.size();
+    while (new_size < capacity) {
+        new_size <<= 1;
+    }
+
+    // Unwrap the buffered bytes to the front of the new buffer
+    std::vector<uint8_t> ring(new_size);
+    size_t buffered = this->count;
+    pop(ring.data(), buffered);
+    this->ring = std::move(ring);
+    this->head = 0;
+    this->count = buffered;
+}
@@ -1,29 +1,50 @@
 #include <arpa/inet.h>
 #include <cstring>
 
+#include "constants.hpp"
+#include "message/codec.hpp"
 #include "message/header.hpp"
 
-Header::Header(uint8_t version, enum Operation operation, uint16_t packet_length)
+Header::Header(uint8_t version, enum Operation operation, uint32_t packet_length)
     : version(version), operation(operation), packet_length(packet_length) {}
 
-void Header::serialize(std::vector<uint8_t>& buf) const {
-    buf.push_back((this->version << 4) | this->size());
+size_t Header::size_for_version(uint8_t version) {
+    // The version and size byte, the operation and the packet length
+    return version == PROTOCOL_VERSION_VARINT ? 1 + 1 + 4 : 1 + 1 + 2;
+}
+
+size_t Header::max_packet_length(uint8_t version) {
+    return version == PROTOCOL_VERSION_VARINT ? MAX_PACKET_LENGTH : UINT16_MAX;
+}
+
+void Header::serialize(std::vector<uint8_t>& buf, uint8_t) const {
+    size_t size = this->size();
+    buf.push_back((this->version << 4) | (this->compressed ? COMPRESSED_FLAG : 0) | size);
     buf.push_back(static_cast<uint8_t>(this->operation));
-    buf.push_back(static_cast<uint8_t>(packet_length >> 8));
-    buf.push_back(static_cast<uint8_t>(packet_length & 0xFF));
+    // The packet length takes the rest of the header, big-endian
+    for (size_t i = size - 2; i > 0; i--) {
+        buf.push_back(static_cast<uint8_t>(this->packet_length >> (8 * (i - 1))));
+    }
+}
+
+void Header::serialize_frame(enum Operation operation, const Payload& body,
+                             std::vector<uint8_t>& buf, uint8_t version) {
+    Codec::for_version(version).encode_frame(operation, body, buf);
 }
 
-void Header::deserialize(const std::vector<uint8_t>& buf) {
-    uint16_t packet_length_be;
-    memcpy(&packet_length_be, &buf[2], sizeof(uint16_t));
+void Header::deserialize(ByteReader& reader) {
+    uint8_t version_and_size = reader.read_u8();
+    uint8_t operation = reader.read_u8();
 
-    this->version = buf[0] >> 4;
-    this->operation = static_cast<enum Operation>(buf[1]);
-    this->packet_length = ntohs(packet_length_be);
+    this->version = version_and_size >> 4;
+    this->compressed = (version_and_size & COMPRESSED_FLAG) != 0;
+    this->operation = static_cast<enum Operation>(operation);
+    this->packet_length = this->version == PROTOCOL_VERSION_VARINT ? reader.read_u32_be()
+                                                                   : reader.read_u16_be();
 }
 
-size_t Header::size() const {
-    return sizeof(version) + sizeof(operation) + sizeof(packet_length);
+size_t Header::size(uint8_t) const {
+    return Header::size_for_version(this->version);
 }
 
 uint8_t Header::get_version() const {
@@ -34,10 +55,14 @@ enum Operation Header::get_operation() const {
     return this->operation;
 }
 
-uint16_t Header::get_packet_length() const {
+uint32_t Header::get_packet_length() const {
     return this->packet_length;
 }
 
+bool Header::is_compressed() const {
+    return this->compressed;
+}
+
 void Header::set_version(uint8_t version) {
     this->version = version;
 }
@@ -46,6 +71,10 @@ void Header::set_operation(enum Operation operation) {
     this->operation = operation;
 }
 
-void Header::set_packet_length(uint16_t packet_length) {
+void Header::set_packet_length(uint32_t packet_length) {
     this->packet_length = packet_length;
-}
\ No newline at end of file
+}
+
+void Header::set_compressed(bool compressed) {
+    this->compressed = compressed;
+}
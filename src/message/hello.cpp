@@ -0,0 +1,42 @@
+#include "message/hello.hpp"
+#include "constants.hpp"
+#include "json.hpp"
+#include "message/header.hpp"
+
+HelloMessage::HelloMessage(uint8_t features) : features(features) {}
+
+void HelloMessage::serialize_binary(std::vector<uint8_t>& buf,
+                                    [[maybe_unused]] uint8_t version) const {
+    buf.push_back(this->features);
+}
+
+void HelloMessage::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::HELLO, *this, buf, version);
+}
+
+void HelloMessage::deserialize_binary(ByteReader& reader) {
+    this->features = reader.read_u8();
+}
+
+std::string HelloMessage::to_json() const {
+    nlohmann::json j;
+    j["features"] = this->features;
+    return j.dump();
+}
+
+void HelloMessage::from_json(const std::string& json) {
+    nlohmann::json j = nlohmann::json::parse(json);
+    this->features = j.value<uint8_t>("features", 0);
+}
+
+size_t HelloMessage::binary_size([[maybe_unused]] uint8_t version) const {
+    return sizeof(this->features);
+}
+
+uint8_t HelloMessage::get_features() const {
+    return this->features;
+}
+
+bool HelloMessage::has_feature(uint8_t feature) const {
+    return (this->features & feature) != 0;
+}
@@ -4,57 +4,53 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 
 ListAccountsMessage::ListAccountsMessage(std::string regex) : regex(std::move(regex)) {}
 
-void ListAccountsMessage::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = this->to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
-    uint8_t regex_length = this->regex.size();
+ListAccountsMessage::ListAccountsMessage(std::string regex, uint8_t limit, std::string cursor)
+    : regex(std::move(regex)), limit(limit), cursor(std::move(cursor)) {}
 
-    buf.push_back(regex_length);
-    for (const auto& c : this->regex) {
-        buf.push_back(c);
-    }
-#endif
+void ListAccountsMessage::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
+    write_prefixed_string(buf, this->regex, version);
+    buf.push_back(this->limit);
+    write_prefixed_string(buf, this->cursor, version);
 }
 
-void ListAccountsMessage::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::LIST_ACCOUNTS, this->size());
-    header.serialize(buf);
-    this->serialize(buf);
+void ListAccountsMessage::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::LIST_ACCOUNTS, *this, buf, version);
 }
 
-void ListAccountsMessage::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    this->from_json(msg);
-#else
-    uint8_t regex_length = buf[0];
+void ListAccountsMessage::deserialize_binary(ByteReader& reader) {
+    this->regex = reader.read_prefixed_string();
 
-    this->regex = std::string(buf.begin() + 1, buf.begin() + 1 + regex_length);
-#endif
+    // Older clients only send the regex
+    this->limit = 0;
+    this->cursor.clear();
+    if (reader.remaining() > 0) {
+        this->limit = reader.read_u8();
+        this->cursor = reader.read_prefixed_string();
+    }
 }
 
 std::string ListAccountsMessage::to_json() const {
     nlohmann::json j;
     j["regex"] = this->regex;
+    j["limit"] = this->limit;
+    j["cursor"] = this->cursor;
     return j.dump();
 }
 
 void ListAccountsMessage::from_json(const std::string& json) {
     nlohmann::json j = nlohmann::json::parse(json);
     this->regex = j["regex"];
+    this->limit = j.value("limit", 0);
+    this->cursor = j.value("cursor", "");
 }
 
-size_t ListAccountsMessage::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
-    return 1 + this->regex.size();
-#endif
+size_t ListAccountsMessage::binary_size(uint8_t version) const {
+    return prefixed_string_size(this->regex, version) + 1 +
+           prefixed_string_size(this->cursor, version);
 }
 
 std::string ListAccountsMessage::get_regex() const {
@@ -64,3 +60,19 @@ std::string ListAccountsMessage::get_regex() const {
 void ListAccountsMessage::set_regex(std::string regex) {
     this->regex = std::move(regex);
 }
+
+uint8_t ListAccountsMessage::get_limit() const {
+    return this->limit;
+}
+
+std::string ListAccountsMessage::get_cursor() const {
+    return this->cursor;
+}
+
+void ListAccountsMessage::set_limit(uint8_t limit) {
+    this->limit = limit;
+}
+
+void ListAccountsMessage::set_cursor(std::string cursor) {
+    this->cursor = std::move(cursor);
+}
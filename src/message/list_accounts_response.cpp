@@ -3,66 +3,61 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 #include "models/user.hpp"
 
 ListAccountsResponse::ListAccountsResponse(std::vector<User::SharedPtr> data)
     : data(std::move(data)) {}
 
+ListAccountsResponse::ListAccountsResponse(std::vector<User::SharedPtr> data,
+                                           std::optional<std::string> next_cursor)
+    : data(std::move(data)), next_cursor(next_cursor.value_or("")) {}
+
 ListAccountsResponse::ListAccountsResponse(
     std::variant<std::vector<User::SharedPtr>, std::string> data)
     : data(data) {}
 
-void ListAccountsResponse::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
+void ListAccountsResponse::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     if (std::holds_alternative<std::vector<User::SharedPtr>>(data)) {
         buf.push_back(0);
         // Push back length of vector
-        std::vector<User::SharedPtr> users = std::get<std::vector<User::SharedPtr>>(data);
-        buf.push_back(users.size());
+        const auto& users = std::get<std::vector<User::SharedPtr>>(data);
+        write_length(buf, users.size(), version);
         for (const auto& user : users) {
-            user->serialize(buf);
+            user->serialize_binary(buf, version);
         }
+        write_prefixed_string(buf, this->next_cursor, version);
     } else {
         buf.push_back(1);
         const std::string& error = std::get<std::string>(data);
-        buf.push_back(error.size());
-        buf.insert(buf.end(), error.begin(), error.end());
+        write_prefixed_string(buf, error, version);
     }
-#endif
 }
 
-void ListAccountsResponse::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::LIST_ACCOUNTS, this->size());
-    header.serialize(buf);
-    serialize(buf);
+void ListAccountsResponse::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::LIST_ACCOUNTS, *this, buf, version);
 }
 
-void ListAccountsResponse::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    size_t offset = 0;
-    uint8_t has_error = buf[offset++];
+void ListAccountsResponse::deserialize_binary(ByteReader& reader) {
+    uint8_t has_error = reader.read_u8();
     if (has_error == 0) {
         std::vector<User::SharedPtr> users = {};
-        uint8_t users_length = buf[offset++];
-        for (int i = 0; i < users_length; i++) {
+        size_t users_length = reader.read_length();
+        users.reserve(users_length);
+        for (size_t i = 0; i < users_length; i++) {
             User::SharedPtr user = std::make_shared<User>();
-            user->deserialize(std::vector<uint8_t>(buf.begin() + offset, buf.end()));
-            offset += user->size();
+            user->deserialize_binary(reader);
             users.push_back(user);
         }
         data = users;
+        // Older servers end the response after the users
+        this->next_cursor.clear();
+        if (reader.remaining() > 0) {
+            this->next_cursor = reader.read_prefixed_string();
+        }
     } else {
-        uint8_t error_length = buf[offset++];
-        std::string error(buf.begin() + offset, buf.begin() + offset + error_length);
-        data = error;
+        data = std::string(reader.read_prefixed_string());
     }
-#endif
 }
 
 std::string ListAccountsResponse::to_json() const {
@@ -73,6 +68,9 @@ std::string ListAccountsResponse::to_json() const {
             users.push_back(user->to_json());
         }
         j["users"] = users;
+        if (!this->next_cursor.empty()) {
+            j["next_cursor"] = this->next_cursor;
+        }
     } else {
         j["error"] = std::get<std::string>(data);
     }
@@ -89,28 +87,26 @@ void ListAccountsResponse::from_json(const std::string& json) {
             users.push_back(u);
         }
         data = users;
+        this->next_cursor = j.value("next_cursor", "");
     } else {
         data = j["error"].get<std::string>();
     }
 }
 
-[[nodiscard]] size_t ListAccountsResponse::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
+[[nodiscard]] size_t ListAccountsResponse::binary_size(uint8_t version) const {
     size_t size = 1;  // for the has_error byte
     if (std::holds_alternative<std::vector<User::SharedPtr>>(data)) {
-        size += 1;  // for the users length
-        std::vector<User::SharedPtr> users = std::get<std::vector<User::SharedPtr>>(data);
+        const auto& users = std::get<std::vector<User::SharedPtr>>(data);
+        size += length_size(users.size(), version);
         for (const auto& user : users) {
-            size += user->size();
+            size += user->binary_size(version);
         }
+        size += prefixed_string_size(this->next_cursor, version);
     } else {
         const std::string& error = std::get<std::string>(data);
-        size += 1 + error.size();  // 1 for the error length + error length
+        size += prefixed_string_size(error, version);
     }
     return size;
-#endif
 }
 
 [[nodiscard]] bool ListAccountsResponse::is_success() const {
@@ -129,4 +125,11 @@ std::optional<std::string> ListAccountsResponse::get_error_message() const {
         return std::get<std::string>(data);
     }
     return std::nullopt;
-}
\ No newline at end of file
+}
+
+std::optional<std::string> ListAccountsResponse::get_next_cursor() const {
+    if (this->next_cursor.empty()) {
+        return std::nullopt;
+    }
+    return this->next_cursor;
+}
@@ -2,50 +2,35 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 
 LoginResponse::LoginResponse(std::variant<User::SharedPtr, std::string> data)
     : data(std::move(data)) {}
 
-void LoginResponse::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
+void LoginResponse::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     if (std::holds_alternative<User::SharedPtr>(data)) {
         buf.push_back(0);
-        std::get<User::SharedPtr>(data)->serialize(buf);
+        std::get<User::SharedPtr>(data)->serialize_binary(buf, version);
     } else {
         buf.push_back(1);
         const std::string& error = std::get<std::string>(data);
-        buf.push_back(error.size());
-        buf.insert(buf.end(), error.begin(), error.end());
+        write_prefixed_string(buf, error, version);
     }
-#endif
 }
 
-void LoginResponse::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::LOGIN, this->size());
-    header.serialize(buf);
-    serialize(buf);
+void LoginResponse::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::LOGIN, *this, buf, version);
 }
 
-void LoginResponse::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    size_t offset = 0;
-    uint8_t has_error = buf[offset++];
+void LoginResponse::deserialize_binary(ByteReader& reader) {
+    uint8_t has_error = reader.read_u8();
     if (has_error == 0) {
         User::SharedPtr user = std::make_shared<User>();
-        user->deserialize(std::vector<uint8_t>(buf.begin() + offset, buf.end()));
+        user->deserialize_binary(reader);
         data = user;
     } else {
-        uint8_t error_length = buf[offset++];
-        std::string error(buf.begin() + offset, buf.begin() + offset + error_length);
-        data = error;
+        data = std::string(reader.read_prefixed_string());
     }
-#endif
 }
 
 std::string LoginResponse::to_json() const {
@@ -69,19 +54,15 @@ void LoginResponse::from_json(const std::string& json) {
     }
 }
 
-[[nodiscard]] size_t LoginResponse::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
+[[nodiscard]] size_t LoginResponse::binary_size(uint8_t version) const {
     size_t size = 1;  // for the has_error byte
     if (std::holds_alternative<User::SharedPtr>(data)) {
-        size += std::get<User::SharedPtr>(data)->size();
+        size += std::get<User::SharedPtr>(data)->binary_size(version);
     } else {
         const std::string& error = std::get<std::string>(data);
-        size += 1 + error.size();  // 1 for the error length + error length
+        size += prefixed_string_size(error, version);
     }
     return size;
-#endif
 }
 
 [[nodiscard]] bool LoginResponse::is_success() const {
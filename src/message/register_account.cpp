@@ -2,60 +2,27 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 
 RegisterAccountMessage::RegisterAccountMessage(std::string username,
                                                std::string password,
                                                std::string display_name)
     : username(username), password(password), display_name(display_name) {}
 
-void RegisterAccountMessage::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = this->to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
-    uint8_t username_length = this->username.size();
-    uint8_t password_length = this->password.size();
-    uint8_t display_name_length = this->display_name.size();
-
-    buf.push_back(username_length);
-    for (const auto& c : this->username) {
-        buf.push_back(c);
-    }
-
-    buf.push_back(password_length);
-    for (const auto& c : this->password) {
-        buf.push_back(c);
-    }
-
-    buf.push_back(display_name_length);
-    for (const auto& c : this->display_name) {
-        buf.push_back(c);
-    }
-#endif
+void RegisterAccountMessage::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
+    write_prefixed_string(buf, this->username, version);
+    write_prefixed_string(buf, this->password, version);
+    write_prefixed_string(buf, this->display_name, version);
 }
 
-void RegisterAccountMessage::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::REGISTER_ACCOUNT, this->size());
-    header.serialize(buf);
-    this->serialize(buf);
+void RegisterAccountMessage::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::REGISTER_ACCOUNT, *this, buf, version);
 }
 
-void RegisterAccountMessage::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    this->from_json(msg);
-#else
-    uint8_t username_length = buf[0];
-    uint8_t password_length = buf[username_length + 1];
-    uint8_t display_name_length = buf[username_length + password_length + 2];
-
-    this->username = std::string(buf.begin() + 1, buf.begin() + 1 + username_length);
-    this->password = std::string(buf.begin() + username_length + 2,
-                                 buf.begin() + username_length + 2 + password_length);
-    this->display_name =
-        std::string(buf.begin() + username_length + password_length + 3,
-                    buf.begin() + username_length + password_length + 3 + display_name_length);
-#endif
+void RegisterAccountMessage::deserialize_binary(ByteReader& reader) {
+    this->username = reader.read_prefixed_string();
+    this->password = reader.read_prefixed_string();
+    this->display_name = reader.read_prefixed_string();
 }
 
 std::string RegisterAccountMessage::to_json() const {
@@ -73,12 +40,10 @@ void RegisterAccountMessage::from_json(const std::string& json) {
     this->display_name = j["display_name"];
 }
 
-size_t RegisterAccountMessage::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
-    return 3 + this->username.size() + this->password.size() + this->display_name.size();
-#endif
+size_t RegisterAccountMessage::binary_size(uint8_t version) const {
+    return prefixed_string_size(this->username, version) +
+           prefixed_string_size(this->password, version) +
+           prefixed_string_size(this->display_name, version);
 }
 
 const std::string& RegisterAccountMessage::get_username() const {
@@ -2,48 +2,33 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 
 RegisterAccountResponse::RegisterAccountResponse(
     std::variant<std::monostate, std::string> error_message)
     : error_message(std::move(error_message)) {}
 
-void RegisterAccountResponse::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
+void RegisterAccountResponse::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     if (std::holds_alternative<std::monostate>(error_message)) {
         buf.push_back(0);
     } else {
         buf.push_back(1);
         const std::string& error = std::get<std::string>(error_message);
-        buf.push_back(error.size());
-        buf.insert(buf.end(), error.begin(), error.end());
+        write_prefixed_string(buf, error, version);
     }
-#endif
 }
 
-void RegisterAccountResponse::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::REGISTER_ACCOUNT, this->size());
-    header.serialize(buf);
-    serialize(buf);
+void RegisterAccountResponse::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::REGISTER_ACCOUNT, *this, buf, version);
 }
 
-void RegisterAccountResponse::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    size_t offset = 0;
-    uint8_t has_error = buf[offset++];
+void RegisterAccountResponse::deserialize_binary(ByteReader& reader) {
+    uint8_t has_error = reader.read_u8();
     if (has_error == 0) {
         error_message = std::monostate();
     } else {
-        uint8_t error_length = buf[offset++];
-        std::string error(buf.begin() + offset, buf.begin() + offset + error_length);
-        error_message = error;
+        error_message = std::string(reader.read_prefixed_string());
     }
-#endif
 }
 
 std::string RegisterAccountResponse::to_json() const {
@@ -66,17 +51,13 @@ void RegisterAccountResponse::from_json(const std::string& json) {
     }
 }
 
-[[nodiscard]] size_t RegisterAccountResponse::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
+[[nodiscard]] size_t RegisterAccountResponse::binary_size(uint8_t version) const {
     size_t size = 1;  // for the has_error byte
     if (std::holds_alternative<std::string>(error_message)) {
         const std::string& error = std::get<std::string>(error_message);
-        size += 1 + error.size();  // 1 for the error length + error length
+        size += prefixed_string_size(error, version);
     }
     return size;
-#endif
 }
 
 [[nodiscard]] bool RegisterAccountResponse::is_success() const {
@@ -2,16 +2,13 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 #include "models/uuid.hpp"
 
 SendMessageMessage::SendMessageMessage(UUID channel_uid, UUID sender_uid, std::string text)
     : channel_uid(channel_uid), sender_uid(sender_uid), text(text) {}
 
-void SendMessageMessage::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
+void SendMessageMessage::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     // Encode channel UUID
     this->channel_uid.serialize(buf);
 
@@ -19,35 +16,17 @@ void SendMessageMessage::serialize(std::vector<uint8_t>& buf) const {
     this->sender_uid.serialize(buf);
 
     // Encode text length and text
-    uint8_t text_length = this->text.size();
-    buf.push_back(text_length);
-    buf.insert(buf.end(), this->text.begin(), this->text.end());
-#endif
+    write_prefixed_string(buf, this->text, version);
 }
 
-void SendMessageMessage::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::SEND_MESSAGE, this->size());
-    header.serialize(buf);
-    this->serialize(buf);
+void SendMessageMessage::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::SEND_MESSAGE, *this, buf, version);
 }
 
-void SendMessageMessage::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    size_t offset = 0;
-    this->channel_uid.deserialize(std::vector<uint8_t>(
-        buf.begin() + offset, buf.begin() + offset + this->channel_uid.size()));
-    offset += this->channel_uid.size();
-
-    this->sender_uid.deserialize(
-        std::vector<uint8_t>(buf.begin() + offset, buf.begin() + offset + this->sender_uid.size()));
-    offset += this->sender_uid.size();
-
-    uint8_t text_length = buf[offset++];
-    this->text = std::string(buf.begin() + offset, buf.begin() + offset + text_length);
-#endif
+void SendMessageMessage::deserialize_binary(ByteReader& reader) {
+    this->channel_uid.deserialize(reader);
+    this->sender_uid.deserialize(reader);
+    this->text = reader.read_prefixed_string();
 }
 
 std::string SendMessageMessage::to_json() const {
@@ -65,12 +44,9 @@ void SendMessageMessage::from_json(const std::string& json) {
     this->text = j["text"].get<std::string>();
 }
 
-size_t SendMessageMessage::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
-    return this->channel_uid.size() + this->sender_uid.size() + 1 + this->text.size();
-#endif
+size_t SendMessageMessage::binary_size(uint8_t version) const {
+    return this->channel_uid.size() + this->sender_uid.size() +
+           prefixed_string_size(this->text, version);
 }
 
 UUID SendMessageMessage::get_channel_uid() const {
@@ -2,49 +2,35 @@
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 
 SendMessageResponse::SendMessageResponse(std::variant<Message::SharedPtr, std::string> data)
     : data(std::move(data)) {}
 
-void SendMessageResponse::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
+void SendMessageResponse::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     if (std::holds_alternative<Message::SharedPtr>(data)) {
         buf.push_back(0);
-        std::get<Message::SharedPtr>(data)->serialize(buf);
+        std::get<Message::SharedPtr>(data)->serialize_binary(buf, version);
     } else {
         buf.push_back(1);
         const std::string& error = std::get<std::string>(data);
-        buf.push_back(error.size());
-        buf.insert(buf.end(), error.begin(), error.end());
+        write_prefixed_string(buf, error, version);
     }
-#endif
 }
 
-void SendMessageResponse::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::SEND_MESSAGE, this->size());
-    header.serialize(buf);
-    serialize(buf);
+void SendMessageResponse::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::SEND_MESSAGE, *this, buf, version);
 }
 
-void SendMessageResponse::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    from_json(std::string(buf.begin(), buf.end()));
-#else
-    size_t offset = 0;
-    uint8_t has_error = buf[offset++];
+void SendMessageResponse::deserialize_binary(ByteReader& reader) {
+    uint8_t has_error = reader.read_u8();
     if (has_error == 0) {
-        data = std::make_shared<Message>();
-        std::get<Message::SharedPtr>(data)->deserialize(
-            std::vector<uint8_t>(buf.begin() + offset, buf.end()));
+        Message::SharedPtr message = std::make_shared<Message>();
+        message->deserialize_binary(reader);
+        data = message;
     } else {
-        uint8_t error_length = buf[offset++];
-        std::string error(buf.begin() + offset, buf.begin() + offset + error_length);
-        data = error;
+        data = std::string(reader.read_prefixed_string());
     }
-#endif
 }
 
 std::string SendMessageResponse::to_json() const {
@@ -70,19 +56,15 @@ void SendMessageResponse::from_json(const std::string& json) {
     }
 }
 
-[[nodiscard]] size_t SendMessageResponse::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
+[[nodiscard]] size_t SendMessageResponse::binary_size(uint8_t version) const {
     size_t size = 1;  // for the has_error byte
     if (std::holds_alternative<std::string>(data)) {
         const std::string& error = std::get<std::string>(data);
-        size += 1 + error.size();  // 1 for the error length + error length
+        size += prefixed_string_size(error, version);
     } else {
-        size += std::get<Message::SharedPtr>(data)->size();
+        size += std::get<Message::SharedPtr>(data)->binary_size(version);
     }
     return size;
-#endif
 }
 
 [[nodiscard]] bool SendMessageResponse::is_success() const {
@@ -0,0 +1,62 @@
+#include "message/sync.hpp"
+#include <stdint.h>
+#include <string>
+#include "constants.hpp"
+#include "json.hpp"
+#include "message/header.hpp"
+
+SyncMessage::SyncMessage(uint64_t since, uint32_t channel_offset, uint16_t limit)
+    : since(since), channel_offset(channel_offset), limit(limit) {}
+
+void SyncMessage::serialize_binary(std::vector<uint8_t>& buf,
+                                   [[maybe_unused]] uint8_t version) const {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        buf.push_back(static_cast<uint8_t>(this->since >> shift));
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        buf.push_back(static_cast<uint8_t>(this->channel_offset >> shift));
+    }
+    buf.push_back(static_cast<uint8_t>(this->limit >> 8));
+    buf.push_back(static_cast<uint8_t>(this->limit & 0xFF));
+}
+
+void SyncMessage::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::SYNC, *this, buf, version);
+}
+
+void SyncMessage::deserialize_binary(ByteReader& reader) {
+    this->since = reader.read_u64_be();
+    this->channel_offset = reader.read_u32_be();
+    this->limit = reader.read_u16_be();
+}
+
+std::string SyncMessage::to_json() const {
+    nlohmann::json j;
+    j["since"] = this->since;
+    j["channel_offset"] = this->channel_offset;
+    j["limit"] = this->limit;
+    return j.dump();
+}
+
+void SyncMessage::from_json(const std::string& json) {
+    nlohmann::json j = nlohmann::json::parse(json);
+    this->since = j.value<uint64_t>("since", 0);
+    this->channel_offset = j.value<uint32_t>("channel_offset", 0);
+    this->limit = j.value<uint16_t>("limit", 0);
+}
+
+size_t SyncMessage::binary_size([[maybe_unused]] uint8_t version) const {
+    return sizeof(this->since) + sizeof(this->channel_offset) + sizeof(this->limit);
+}
+
+uint64_t SyncMessage::get_since() const {
+    return this->since;
+}
+
+uint32_t SyncMessage::get_channel_offset() const {
+    return this->channel_offset;
+}
+
+uint16_t SyncMessage::get_limit() const {
+    return this->limit;
+}
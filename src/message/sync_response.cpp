@@ -0,0 +1,176 @@
+#include "message/sync_response.hpp"
+#include <memory>
+#include "constants.hpp"
+#include "json.hpp"
+#include "message/header.hpp"
+#include "message/wire_format.hpp"
+
+namespace {
+
+void put_be(std::vector<uint8_t>& buf, uint64_t value, int bytes) {
+    for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8) {
+        buf.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+}  // namespace
+
+SyncResponse::SyncResponse(std::variant<Batch, std::string> data) : data(std::move(data)) {}
+
+void SyncResponse::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
+    if (std::holds_alternative<Batch>(data)) {
+        const Batch& batch = std::get<Batch>(data);
+        buf.push_back(0);
+        write_length(buf, batch.channels.size(), version, 2);
+        for (const auto& channel : batch.channels) {
+            channel->serialize_binary(buf, version);
+        }
+        write_length(buf, batch.messages.size(), version, 2);
+        for (const auto& message : batch.messages) {
+            message->serialize_binary(buf, version);
+        }
+        put_be(buf, batch.next_since, 8);
+        put_be(buf, batch.next_channel_offset, 4);
+        buf.push_back(batch.has_more ? 1 : 0);
+    } else {
+        buf.push_back(1);
+        const std::string& error = std::get<std::string>(data);
+        write_prefixed_string(buf, error, version);
+    }
+}
+
+void SyncResponse::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::SYNC, *this, buf, version);
+}
+
+void SyncResponse::deserialize_binary(ByteReader& reader) {
+    uint8_t has_error = reader.read_u8();
+    if (has_error == 0) {
+        Batch batch;
+        size_t channels_length = reader.read_length(2);
+        batch.channels.reserve(channels_length);
+        for (size_t i = 0; i < channels_length; i++) {
+            Channel::SharedPtr channel = std::make_shared<Channel>();
+            channel->deserialize_binary(reader);
+            batch.channels.push_back(channel);
+        }
+        size_t messages_length = reader.read_length(2);
+        batch.messages.reserve(messages_length);
+        for (size_t i = 0; i < messages_length; i++) {
+            Message::SharedPtr message = std::make_shared<Message>();
+            message->deserialize_binary(reader);
+            batch.messages.push_back(message);
+        }
+        batch.next_since = reader.read_u64_be();
+        batch.next_channel_offset = reader.read_u32_be();
+        batch.has_more = reader.read_u8() != 0;
+        data = std::move(batch);
+    } else {
+        data = std::string(reader.read_prefixed_string());
+    }
+}
+
+std::string SyncResponse::to_json() const {
+    nlohmann::json j;
+    if (std::holds_alternative<Batch>(data)) {
+        const Batch& batch = std::get<Batch>(data);
+        std::vector<std::string> channels;
+        for (const auto& channel : batch.channels) {
+            channels.push_back(channel->to_json());
+        }
+        std::vector<std::string> messages;
+        for (const auto& message : batch.messages) {
+            messages.push_back(message->to_json());
+        }
+        j["channels"] = channels;
+        j["messages"] = messages;
+        j["next_since"] = batch.next_since;
+        j["next_channel_offset"] = batch.next_channel_offset;
+        j["has_more"] = batch.has_more;
+    } else {
+        j["error"] = std::get<std::string>(data);
+    }
+    return j.dump();
+}
+
+void SyncResponse::from_json(const std::string& json) {
+    nlohmann::json j = nlohmann::json::parse(json);
+    if (j.contains("error")) {
+        data = j["error"].get<std::string>();
+        return;
+    }
+    Batch batch;
+    for (const auto& channel_json : j["channels"]) {
+        Channel::SharedPtr channel = std::make_shared<Channel>();
+        channel->from_json(channel_json);
+        batch.channels.push_back(channel);
+    }
+    for (const auto& message_json : j["messages"]) {
+        Message::SharedPtr message = std::make_shared<Message>();
+        message->from_json(message_json);
+        batch.messages.push_back(message);
+    }
+    batch.next_since = j["next_since"].get<uint64_t>();
+    batch.next_channel_offset = j["next_channel_offset"].get<uint32_t>();
+    batch.has_more = j["has_more"].get<bool>();
+    data = std::move(batch);
+}
+
+size_t SyncResponse::binary_size(uint8_t version) const {
+    size_t size = 1;  // for the has_error byte
+    if (std::holds_alternative<Batch>(data)) {
+        const Batch& batch = std::get<Batch>(data);
+        size += length_size(batch.channels.size(), version, 2) +
+                length_size(batch.messages.size(), version, 2);
+        size += 8 + 4 + 1;  // the watermark, the offset and has_more
+        for (const auto& channel : batch.channels) {
+            size += channel->binary_size(version);
+        }
+        for (const auto& message : batch.messages) {
+            size += message->binary_size(version);
+        }
+    } else {
+        const std::string& error = std::get<std::string>(data);
+        size += prefixed_string_size(error, version);
+    }
+    return size;
+}
+
+size_t SyncResponse::max_size(uint8_t version) {
+    return Header::max_packet_length(version);
+}
+
+size_t SyncResponse::empty_size(uint8_t version) {
+    Batch widest;
+    widest.next_since = UINT64_MAX;
+    widest.next_channel_offset = UINT32_MAX;
+    // Leave room for both counts to grow as the page fills up
+    return SyncResponse(widest).size(version) +
+           2 * (length_size(UINT32_MAX, version, 2) - length_size(0, version, 2));
+}
+
+size_t SyncResponse::entry_size(const Channel::SharedPtr& channel, uint8_t version) {
+    return Codec::for_version(version).entry_size(*channel);
+}
+
+size_t SyncResponse::entry_size(const Message::SharedPtr& message, uint8_t version) {
+    return Codec::for_version(version).entry_size(*message);
+}
+
+bool SyncResponse::is_success() const {
+    return std::holds_alternative<Batch>(data);
+}
+
+std::optional<std::string> SyncResponse::get_error_message() const {
+    if (std::holds_alternative<std::string>(data)) {
+        return std::get<std::string>(data);
+    }
+    return std::nullopt;
+}
+
+std::optional<SyncResponse::Batch> SyncResponse::get_batch() const {
+    if (std::holds_alternative<Batch>(data)) {
+        return std::get<Batch>(data);
+    }
+    return std::nullopt;
+}
@@ -1,80 +1,83 @@
 #include <algorithm>
 
 #include "json.hpp"
+#include "message/wire_format.hpp"
 #include "models/channel.hpp"
 
 Channel::Channel(std::string name, std::vector<UUID> user_uids)
-    : name(std::move(name)), user_uids(std::move(user_uids)) {
+    : state(State{std::move(name), std::move(user_uids)}) {
     this->uid = UUID();
 }
 
-void Channel::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
+Channel::Channel(UUID uid, std::string name, std::vector<UUID> user_uids,
+                 std::vector<uint64_t> message_snowflakes)
+    : uid(uid),
+      state(State{std::move(name), std::move(user_uids)}),
+      message_snowflakes(std::move(message_snowflakes)) {}
+
+void Channel::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     this->uid.serialize(buf);
 
-    uint8_t name_length = this->name.size();
-    buf.push_back(name_length);
-    buf.insert(buf.end(), this->name.begin(), this->name.end());
+    this->state.read([&buf, version](const State& state) {
+        write_prefixed_string(buf, state.name, version);
 
-    uint8_t num_users = this->user_uids.size();
-    buf.push_back(num_users);
-    for (const UUID& user_uid : this->user_uids) {
-        user_uid.serialize(buf);
-    }
+        write_length(buf, state.user_uids.size(), version);
+        for (const UUID& user_uid : state.user_uids) {
+            user_uid.serialize(buf);
+        }
+    });
 
-    uint8_t num_messages = this->message_snowflakes.size();
-    buf.push_back(num_messages);
+    std::lock_guard<std::mutex> lock(this->mutex);
+    write_length(buf, this->message_snowflakes.size(), version);
     for (const uint64_t& message_snowflake : this->message_snowflakes) {
-        buf.push_back(message_snowflake);
+        if (version == PROTOCOL_VERSION_VARINT) {
+            write_u64_be(buf, message_snowflake);
+        } else {
+            // The original binary protocol only kept the lowest byte of each snowflake
+            buf.push_back(message_snowflake);
+        }
     }
-#endif
-}
-
-void Channel::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    size_t offset = 0;
-    this->uid.deserialize(
-        std::vector<uint8_t>(buf.begin() + offset, buf.begin() + offset + this->uid.size()));
-    offset += this->uid.size();
-
-    uint8_t name_length = buf[offset++];
-    this->name = std::string(buf.begin() + offset, buf.begin() + offset + name_length);
-    offset += name_length;
-
-    uint8_t num_users = buf[offset++];
-    for (uint8_t i = 0; i < num_users; i++) {
-        UUID user_uid;
-        user_uid.deserialize(
-            std::vector<uint8_t>(buf.begin() + offset, buf.begin() + offset + user_uid.size()));
-        this->user_uids.push_back(user_uid);
-        offset += user_uid.size();
+}
+
+void Channel::deserialize_binary(ByteReader& reader) {
+    this->uid.deserialize(reader);
+    State state;
+    state.name = reader.read_prefixed_string();
+
+    size_t num_users = reader.read_length();
+    state.user_uids.reserve(num_users);
+    for (size_t i = 0; i < num_users; i++) {
+        state.user_uids.push_back(UUID::from_reader(reader));
     }
 
-    uint8_t num_messages = buf[offset++];
-    for (uint8_t i = 0; i < num_messages; i++) {
-        uint64_t message_snowflake = buf[offset++];
-        this->message_snowflakes.push_back(message_snowflake);
+    size_t num_messages = reader.read_length();
+    std::vector<uint64_t> message_snowflakes;
+    message_snowflakes.reserve(num_messages);
+    bool full_snowflakes = reader.get_version() == PROTOCOL_VERSION_VARINT;
+    for (size_t i = 0; i < num_messages; i++) {
+        uint64_t message_snowflake = full_snowflakes ? reader.read_u64_be() : reader.read_u8();
+        message_snowflakes.push_back(message_snowflake);
     }
-#endif
+
+    this->state.unshared() = std::move(state);
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->message_snowflakes = std::move(message_snowflakes);
 }
 
 std::string Channel::to_json() const {
     nlohmann::json j;
     j["uid"] = this->uid.to_string();
-    j["name"] = this->name;
+    this->state.read([&j](const State& state) {
+        j["name"] = state.name;
 
-    std::vector<std::string> user_uids;
-    for (const UUID& user_uid : this->user_uids) {
-        user_uids.push_back(user_uid.to_string());
-    }
-    j["user_uids"] = user_uids;
+        std::vector<std::string> user_uids;
+        for (const UUID& user_uid : state.user_uids) {
+            user_uids.push_back(user_uid.to_string());
+        }
+        j["user_uids"] = user_uids;
+    });
 
+    std::lock_guard<std::mutex> lock(this->mutex);
     j["message_snowflakes"] = this->message_snowflakes;
     return j.dump();
 }
@@ -82,73 +85,110 @@ std::string Channel::to_json() const {
 void Channel::from_json(const std::string& json) {
     nlohmann::json j = nlohmann::json::parse(json);
     this->uid = UUID::from_string(j["uid"].get<std::string>());
-    this->name = j["name"].get<std::string>();
+    State state;
+    state.name = j["name"].get<std::string>();
 
     for (const std::string& user_uid : j["user_uids"]) {
-        this->user_uids.push_back(UUID::from_string(user_uid));
+        state.user_uids.push_back(UUID::from_string(user_uid));
     }
+    this->state.unshared() = std::move(state);
 
+    std::lock_guard<std::mutex> lock(this->mutex);
     this->message_snowflakes = j["message_snowflakes"].get<std::vector<uint64_t>>();
 }
 
-size_t Channel::size() const {
-    size_t size = this->uid.size() + 1 + this->name.size() + 1;  // 1 for name length
-    for (const UUID& user_uid : this->user_uids) {
-        size += user_uid.size();
-    }
-    size += 1;                                // for number of messages
-    size += this->message_snowflakes.size();  // for each message snowflake
+size_t Channel::binary_size(uint8_t version) const {
+    size_t size = this->uid.size();
+    size += this->state.read([version](const State& state) {
+        size_t size = prefixed_string_size(state.name, version);
+        size += length_size(state.user_uids.size(), version);
+        for (const UUID& user_uid : state.user_uids) {
+            size += user_uid.size();
+        }
+        return size;
+    });
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    size += length_size(this->message_snowflakes.size(), version);
+    size_t snowflake_size = version == PROTOCOL_VERSION_VARINT ? sizeof(uint64_t) : 1;
+    size += this->message_snowflakes.size() * snowflake_size;
     return size;
 }
 
-const UUID& Channel::get_uid() {
-    std::lock_guard<std::mutex> lock(this->mutex);
+const UUID& Channel::get_uid() const {
     return this->uid;
 }
 
-const std::string& Channel::get_name() {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->name;
+std::string Channel::get_name() const {
+    return this->state.read([](const State& state) { return state.name; });
 }
 
-const std::vector<UUID>& Channel::get_user_uids() {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->user_uids;
+std::vector<UUID> Channel::get_user_uids() const {
+    return this->state.read([](const State& state) { return state.user_uids; });
+}
+
+bool Channel::has_user(const UUID& user_uid) const {
+    return this->state.read([&user_uid](const State& state) {
+        return std::find(state.user_uids.begin(), state.user_uids.end(), user_uid) !=
+               state.user_uids.end();
+    });
 }
 
-const std::vector<uint64_t>& Channel::get_message_snowflakes() {
+std::vector<uint64_t> Channel::get_message_snowflakes() {
     std::lock_guard<std::mutex> lock(this->mutex);
     return this->message_snowflakes;
 }
+std::vector<uint64_t> Channel::get_message_snowflakes_after(uint64_t since, size_t limit) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto first = std::upper_bound(this->message_snowflakes.begin(),
+                                  this->message_snowflakes.end(), since);
+    auto last = first + std::min<size_t>(limit, this->message_snowflakes.end() - first);
+    return std::vector<uint64_t>(first, last);
+}
 
-void Channel::set_name(std::string name) {
+std::vector<uint64_t> Channel::get_message_snowflakes_before(uint64_t before, size_t limit) {
     std::lock_guard<std::mutex> lock(this->mutex);
-    this->name = name;
+    auto last = before == 0 ? this->message_snowflakes.end()
+                            : std::lower_bound(this->message_snowflakes.begin(),
+                                               this->message_snowflakes.end(), before);
+    auto first = last - std::min<size_t>(limit, last - this->message_snowflakes.begin());
+    return std::vector<uint64_t>(first, last);
+}
+
+void Channel::set_name(std::string name) {
+    this->state.update([&name](State& state) { state.name = std::move(name); });
 }
 
 void Channel::add_user(UUID user_uid) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    this->user_uids.push_back(user_uid);
+    this->state.update([&user_uid](State& state) { state.user_uids.push_back(user_uid); });
 }
 
 void Channel::add_message(const uint64_t& message_snowflake) {
     std::lock_guard<std::mutex> lock(this->mutex);
-    this->message_snowflakes.push_back(message_snowflake);
+    // New messages almost always carry the newest snowflake, so this is usually an append
+    if (this->message_snowflakes.empty() || this->message_snowflakes.back() < message_snowflake) {
+        this->message_snowflakes.push_back(message_snowflake);
+        return;
+    }
+    auto it = std::lower_bound(this->message_snowflakes.begin(), this->message_snowflakes.end(),
+                               message_snowflake);
+    if (*it != message_snowflake) {
+        this->message_snowflakes.insert(it, message_snowflake);
+    }
 }
 
 void Channel::remove_user(const UUID& user_uid) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    this->user_uids.erase(std::remove_if(this->user_uids.begin(), this->user_uids.end(),
-                                         [&user_uid](const UUID& uid) { return uid == user_uid; }),
-                          this->user_uids.end());
+    this->state.update([&user_uid](State& state) {
+        state.user_uids.erase(std::remove(state.user_uids.begin(), state.user_uids.end(), user_uid),
+                              state.user_uids.end());
+    });
 }
 
 void Channel::remove_message(const uint64_t& message_snowflake) {
     std::lock_guard<std::mutex> lock(this->mutex);
-    this->message_snowflakes.erase(
-        std::remove_if(this->message_snowflakes.begin(), this->message_snowflakes.end(),
-                       [&message_snowflake](const uint64_t& snowflake) {
-                           return snowflake == message_snowflake;
-                       }),
-        this->message_snowflakes.end());
+    auto it = std::lower_bound(this->message_snowflakes.begin(), this->message_snowflakes.end(),
+                               message_snowflake);
+    if (it != this->message_snowflakes.end() && *it == message_snowflake) {
+        this->message_snowflakes.erase(it);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include <time.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <functional>
+
+#include "models/logger.hpp"
+
+Logger& Logger::get_instance() {
+    static Logger instance(stderr, DEFAULT_CAPACITY, []() {
+        const char* name = std::getenv("LOG_LEVEL");
+        return parse_level(name != nullptr ? name : "").value_or(LogLevel::INFO);
+    }());
+    return instance;
+}
+
+Logger::Logger(FILE* out, size_t capacity, LogLevel level)
+    : out(out), level(level), ring(std::max<size_t>(capacity, 1)) {
+    this->writer = std::thread([this]() { run(); });
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->record_ready.notify_one();
+    this->writer.join();
+}
+
+void Logger::set_level(LogLevel level) {
+    this->level.store(level, std::memory_order_relaxed);
+}
+
+LogLevel Logger::get_level() const {
+    return this->level.load(std::memory_order_relaxed);
+}
+
+void Logger::submit(LogEntry record) {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->count == this->ring.size()) {
+            this->unreported_drops++;
+            this->dropped++;
+            return;
+        }
+        this->ring[(this->head + this->count) % this->ring.size()] = std::move(record);
+        this->count++;
+        this->submitted++;
+    }
+    this->record_ready.notify_one();
+}
+
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    uint64_t target = this->submitted;
+    this->batch_written.wait(lock, [this, target]() { return this->written >= target; });
+}
+
+size_t Logger::get_num_dropped() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->dropped;
+}
+
+std::optional<LogLevel> Logger::parse_level(std::string_view name) {
+    std::string upper(name);
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return std::toupper(c); });
+    for (LogLevel level : {LogLevel::TRACE, LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARN,
+                           LogLevel::ERROR, LogLevel::OFF}) {
+        if (upper == level_name(level)) {
+            return level;
+        }
+    }
+    return std::nullopt;
+}
+
+const char* Logger::level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::TRACE:
+            return "TRACE";
+        case LogLevel::DEBUG:
+            return "DEBUG";
+        case LogLevel::INFO:
+            return "INFO";
+        case LogLevel::WARN:
+            return "WARN";
+        case LogLevel::ERROR:
+            return "ERROR";
+        case LogLevel::OFF:
+            return "OFF";
+    }
+    return "UNKNOWN";
+}
+
+void Logger::run() {
+    std::vector<LogEntry> batch;
+    std::string lines;
+    while (true) {
+        size_t drops = 0;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->record_ready.wait(lock, [this]() { return this->stopping || this->count > 0; });
+            if (this->count == 0) {
+                return;
+            }
+            for (; this->count > 0; this->count--) {
+                batch.push_back(std::move(this->ring[this->head]));
+                this->head = (this->head + 1) % this->ring.size();
+            }
+            drops = this->unreported_drops;
+            this->unreported_drops = 0;
+        }
+
+        // Format and write the batch without holding the lock, so that loggers never wait for it
+        lines.clear();
+        if (drops > 0) {
+            format({LogLevel::WARN, std::chrono::system_clock::now(), std::this_thread::get_id(),
+                    std::to_string(drops) + " log records dropped"},
+                   lines);
+        }
+        for (const LogEntry& record : batch) {
+            format(record, lines);
+        }
+        std::fwrite(lines.data(), 1, lines.size(), this->out);
+        std::fflush(this->out);
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->written += batch.size();
+        }
+        this->batch_written.notify_all();
+        batch.clear();
+    }
+}
+
+void Logger::format(const LogEntry& record, std::string& line) {
+    // 2025-02-12T10:15:30.123Z INFO [thread] message
+    auto since_epoch = record.time.time_since_epoch();
+    time_t seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch).count();
+    int millis = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count() % 1000;
+    tm utc;
+    gmtime_r(&seconds, &utc);
+
+    char prefix[64];
+    size_t length = std::strftime(prefix, sizeof(prefix), "%Y-%m-%dT%H:%M:%S", &utc);
+    length += std::snprintf(prefix + length, sizeof(prefix) - length, ".%03dZ %-5s [%zx] ", millis,
+                            level_name(record.level),
+                            std::hash<std::thread::id>{}(record.thread) & 0xFFFFFF);
+    line.append(prefix, length);
+    line.append(record.message);
+    line.push_back('\n');
+}
@@ -1,82 +1,81 @@
 #include <cstdint>
-#include <mutex>
 
 #include "constants.hpp"
 #include "json.hpp"
 #include "message/header.hpp"
+#include "message/wire_format.hpp"
 #include "models/message.hpp"
 #include "models/snowflake.hpp"
 
 Message::Message(UUID sender_id, UUID channel_id, std::string text)
-    : sender_id(sender_id), channel_id(channel_id), text(text) {
+    : sender_id(sender_id), channel_id(channel_id) {
     SnowflakeIDGenerator& generator = SnowflakeIDGenerator::get_instance();
 
     this->snowflake = generator.nextId();
     this->created_at = std::chrono::duration_cast<std::chrono::milliseconds>(
                            std::chrono::system_clock::now().time_since_epoch())
                            .count();
-    this->modified_at = this->created_at;
-    this->read_by = {this->sender_id};
+    this->state.unshared() = State{this->created_at, {this->sender_id}, std::move(text)};
 }
 
-void Message::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
+Message::Message(uint64_t snowflake, UUID sender_id, UUID channel_id, uint64_t created_at,
+                 uint64_t modified_at, std::string text)
+    : snowflake(snowflake),
+      sender_id(sender_id),
+      channel_id(channel_id),
+      created_at(created_at),
+      state(State{modified_at, {sender_id}, std::move(text)}) {}
+
+void Message::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     sender_id.serialize(buf);
     channel_id.serialize(buf);
-    buf.insert(buf.end(), reinterpret_cast<const uint8_t*>(&snowflake),
-               reinterpret_cast<const uint8_t*>(&snowflake) + sizeof(snowflake));
-    buf.insert(buf.end(), reinterpret_cast<const uint8_t*>(&created_at),
-               reinterpret_cast<const uint8_t*>(&created_at) + sizeof(created_at));
-    buf.insert(buf.end(), reinterpret_cast<const uint8_t*>(&modified_at),
-               reinterpret_cast<const uint8_t*>(&modified_at) + sizeof(modified_at));
-    uint8_t text_length = text.size();
-    buf.push_back(text_length);
-    buf.insert(buf.end(), text.begin(), text.end());
-    uint8_t read_by_size = read_by.size();
-    buf.push_back(read_by_size);
-    for (const auto& user_id : read_by) {
-        user_id.serialize(buf);
+    state.read([this, &buf, version](const State& state) {
+        if (version == PROTOCOL_VERSION_VARINT) {
+            write_u64_be(buf, snowflake);
+            write_u64_be(buf, created_at);
+            write_u64_be(buf, state.modified_at);
+        } else {
+            // The original binary protocol copies the integers in host byte order
+            buf.insert(buf.end(), reinterpret_cast<const uint8_t*>(&snowflake),
+                       reinterpret_cast<const uint8_t*>(&snowflake) + sizeof(snowflake));
+            buf.insert(buf.end(), reinterpret_cast<const uint8_t*>(&created_at),
+                       reinterpret_cast<const uint8_t*>(&created_at) + sizeof(created_at));
+            buf.insert(buf.end(), reinterpret_cast<const uint8_t*>(&state.modified_at),
+                       reinterpret_cast<const uint8_t*>(&state.modified_at) +
+                           sizeof(state.modified_at));
+        }
+        write_prefixed_string(buf, state.text, version);
+        write_length(buf, state.read_by.size(), version);
+        for (const auto& user_id : state.read_by) {
+            user_id.serialize(buf);
+        }
+    });
+}
+
+void Message::serialize_msg(std::vector<uint8_t>& buf, uint8_t version) const {
+    Header::serialize_frame(Operation::SEND_MESSAGE, *this, buf, version);
+}
+
+void Message::deserialize_binary(ByteReader& reader) {
+    sender_id.deserialize(reader);
+    channel_id.deserialize(reader);
+    State state;
+    if (reader.get_version() == PROTOCOL_VERSION_VARINT) {
+        snowflake = reader.read_u64_be();
+        created_at = reader.read_u64_be();
+        state.modified_at = reader.read_u64_be();
+    } else {
+        snowflake = reader.read_u64_native();
+        created_at = reader.read_u64_native();
+        state.modified_at = reader.read_u64_native();
     }
-#endif
-}
-
-void Message::serialize_msg(std::vector<uint8_t>& buf) const {
-    Header header(PROTOCOL_VERSION, Operation::SEND_MESSAGE, this->size());
-    header.serialize(buf);
-    serialize(buf);
-}
-
-void Message::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    size_t offset = 0;
-    sender_id.deserialize(std::vector<uint8_t>(buf.begin() + offset, buf.begin() + offset + 16));
-    offset += 16;
-    channel_id.deserialize(std::vector<uint8_t>(buf.begin() + offset, buf.begin() + offset + 16));
-    offset += 16;
-    snowflake = *reinterpret_cast<const uint64_t*>(&buf[offset]);
-    offset += sizeof(snowflake);
-    created_at = *reinterpret_cast<const uint64_t*>(&buf[offset]);
-    offset += sizeof(created_at);
-    modified_at = *reinterpret_cast<const uint64_t*>(&buf[offset]);
-    offset += sizeof(modified_at);
-    uint8_t text_length = buf[offset++];
-    text = std::string(buf.begin() + offset, buf.begin() + offset + text_length);
-    offset += text_length;
-    uint8_t read_by_size = buf[offset++];
-    read_by.clear();
-    for (uint32_t i = 0; i < read_by_size; ++i) {
-        UUID user_id;
-        user_id.deserialize(std::vector<uint8_t>(buf.begin() + offset, buf.begin() + offset + 16));
-        read_by.push_back(user_id);
-        offset += 16;
+    state.text = reader.read_prefixed_string();
+    size_t read_by_size = reader.read_length();
+    state.read_by.reserve(read_by_size);
+    for (size_t i = 0; i < read_by_size; ++i) {
+        state.read_by.emplace_back(UUID::from_reader(reader));
     }
-#endif
+    this->state.unshared() = std::move(state);
 }
 
 std::string Message::to_json() const {
@@ -85,13 +84,15 @@ std::string Message::to_json() const {
     j["channel_id"] = channel_id.to_string();
     j["snowflake"] = snowflake;
     j["created_at"] = created_at;
-    j["modified_at"] = modified_at;
-    j["text"] = text;
-    std::vector<std::string> read_by_strings;
-    for (const auto& user_id : read_by) {
-        read_by_strings.push_back(user_id.to_string());
-    }
-    j["read_by"] = read_by_strings;
+    state.read([&j](const State& state) {
+        j["modified_at"] = state.modified_at;
+        j["text"] = state.text;
+        std::vector<std::string> read_by_strings;
+        for (const auto& user_id : state.read_by) {
+            read_by_strings.push_back(user_id.to_string());
+        }
+        j["read_by"] = read_by_strings;
+    });
     return j.dump();
 }
 
@@ -101,74 +102,66 @@ void Message::from_json(const std::string& json) {
     channel_id = UUID::from_string(j["channel_id"].get<std::string>());
     snowflake = j["snowflake"].get<uint64_t>();
     created_at = j["created_at"].get<uint64_t>();
-    modified_at = j["modified_at"].get<uint64_t>();
-    text = j["text"].get<std::string>();
-    read_by.clear();
+    State state;
+    state.modified_at = j["modified_at"].get<uint64_t>();
+    state.text = j["text"].get<std::string>();
     for (const auto& user_id : j["read_by"]) {
-        read_by.push_back(UUID::from_string(user_id.get<std::string>()));
+        state.read_by.push_back(UUID::from_string(user_id.get<std::string>()));
     }
+    this->state.unshared() = std::move(state);
 }
 
-[[nodiscard]] size_t Message::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
+[[nodiscard]] size_t Message::binary_size(uint8_t version) const {
     size_t size =
         sender_id.size() + channel_id.size();  // sender_id (16 bytes) + channel_id (16 bytes)
-    size += sizeof(snowflake) + sizeof(created_at) + sizeof(modified_at);
-    size += 1 + text.size();  // 1 for the text length + text length
-    size += 1;                // read_by_size
-    for (const auto& user_id : read_by) {
-        size += 16;  // user_id (16 bytes)
-    }
+    size += sizeof(snowflake) + sizeof(created_at) + sizeof(uint64_t);  // + modified_at
+    size += state.read([version](const State& state) {
+        size_t size = prefixed_string_size(state.text, version);
+        size += length_size(state.read_by.size(), version);
+        size += state.read_by.size() * 16;  // user_id (16 bytes)
+        return size;
+    });
     return size;
-#endif
 }
 
-const uint64_t Message::get_snowflake() {
-    std::lock_guard<std::mutex> lock(this->mutex);
+uint64_t Message::get_snowflake() const {
     return this->snowflake;
 }
 
-const UUID& Message::get_sender_id() {
-    std::lock_guard<std::mutex> lock(this->mutex);
+const UUID& Message::get_sender_id() const {
     return this->sender_id;
 }
 
-const UUID& Message::get_channel_id() {
-    std::lock_guard<std::mutex> lock(this->mutex);
+const UUID& Message::get_channel_id() const {
     return this->channel_id;
 }
 
-const uint64_t Message::get_created_at() {
-    std::lock_guard<std::mutex> lock(this->mutex);
+uint64_t Message::get_created_at() const {
     return this->created_at;
 }
 
-const uint64_t Message::get_modified_at() {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->modified_at;
+uint64_t Message::get_modified_at() const {
+    return this->state.read([](const State& state) { return state.modified_at; });
 }
 
-const std::vector<UUID>& Message::get_read_by() {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->read_by;
+std::vector<UUID> Message::get_read_by() const {
+    return this->state.read([](const State& state) { return state.read_by; });
 }
 
-const std::string& Message::get_text() {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->text;
+std::string Message::get_text() const {
+    return this->state.read([](const State& state) { return state.text; });
 }
 
 void Message::set_text(std::string& text) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    this->text = text;
-    this->modified_at = std::chrono::duration_cast<std::chrono::milliseconds>(
-                            std::chrono::system_clock::now().time_since_epoch())
-                            .count();
+    uint64_t modified_at = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count();
+    this->state.update([&text, modified_at](State& state) {
+        state.text = text;
+        state.modified_at = modified_at;
+    });
 }
 
 void Message::set_read_by(UUID& user_id) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    this->read_by.push_back(user_id);
+    this->state.update([&user_id](State& state) { state.read_by.push_back(user_id); });
 }
@@ -0,0 +1,134 @@
+#include "models/published.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief The epoch a thread announced when it entered its read section, or 0 outside of one.
+ */
+struct ReaderSlot {
+    std::atomic<uint64_t> epoch{0};
+    /// Whether a thread owns the slot; guarded by the state's mutex.
+    bool in_use = true;
+};
+
+/**
+ * @brief An unpublished object, with the epoch at which it was retired.
+ */
+struct Retired {
+    uint64_t epoch;
+    void* object;
+    void (*deleter)(void*);
+};
+
+struct EpochState {
+    /// Starts at 1, since 0 marks a thread outside of any read section.
+    std::atomic<uint64_t> global{1};
+    /// Guards slots and retired.
+    std::mutex mutex;
+    /// The slots of every thread that has ever read; a deque, so that slots never move.
+    std::deque<ReaderSlot> slots;
+    /// The objects waiting for readers to leave.
+    std::vector<Retired> retired;
+};
+
+EpochState& state() {
+    // Never destroyed, since threads may still leave read sections during static destruction
+    static EpochState* state = new EpochState();
+    return *state;
+}
+
+/**
+ * @brief The slot of the calling thread, handed back for reuse when the thread exits.
+ */
+struct ThreadSlot {
+    ReaderSlot* slot = nullptr;
+    /// The number of nested guards held by the thread.
+    size_t depth = 0;
+
+    ~ThreadSlot() {
+        if (this->slot == nullptr) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(state().mutex);
+        this->slot->epoch.store(0, std::memory_order_seq_cst);
+        this->slot->in_use = false;
+    }
+};
+
+thread_local ThreadSlot thread_slot;
+
+ReaderSlot* acquire_slot() {
+    EpochState& epoch_state = state();
+    std::lock_guard<std::mutex> lock(epoch_state.mutex);
+    for (ReaderSlot& slot : epoch_state.slots) {
+        if (!slot.in_use) {
+            slot.in_use = true;
+            return &slot;
+        }
+    }
+    return &epoch_state.slots.emplace_back();
+}
+
+}  // namespace
+
+Epoch::Guard::Guard() {
+    ThreadSlot& thread = thread_slot;
+    if (thread.depth++ > 0) {
+        return;
+    }
+    if (thread.slot == nullptr) {
+        thread.slot = acquire_slot();
+    }
+    // Announcing an epoch that is already stale only keeps retired objects around for longer: a
+    // writer that misses the announcement has unpublished its object before this thread reads it
+    thread.slot->epoch.store(state().global.load(std::memory_order_seq_cst),
+                             std::memory_order_seq_cst);
+}
+
+Epoch::Guard::~Guard() {
+    ThreadSlot& thread = thread_slot;
+    if (--thread.depth == 0) {
+        thread.slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+void Epoch::retire(void* object, void (*deleter)(void*)) {
+    EpochState& epoch_state = state();
+    // Readers that announce a later epoch entered after the object was unpublished
+    uint64_t epoch = epoch_state.global.fetch_add(1, std::memory_order_seq_cst);
+
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lock(epoch_state.mutex);
+        epoch_state.retired.push_back({epoch, object, deleter});
+
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for (const ReaderSlot& slot : epoch_state.slots) {
+            uint64_t announced = slot.epoch.load(std::memory_order_seq_cst);
+            if (announced != 0) {
+                oldest = std::min(oldest, announced);
+            }
+        }
+
+        auto pending = std::partition(
+            epoch_state.retired.begin(), epoch_state.retired.end(),
+            [oldest](const Retired& retired) { return retired.epoch >= oldest; });
+        ready.assign(pending, epoch_state.retired.end());
+        epoch_state.retired.erase(pending, epoch_state.retired.end());
+    }
+
+    for (const Retired& retired : ready) {
+        retired.deleter(retired.object);
+    }
+}
+
+size_t Epoch::get_num_pending() {
+    EpochState& epoch_state = state();
+    std::lock_guard<std::mutex> lock(epoch_state.mutex);
+    return epoch_state.retired.size();
+}
@@ -2,143 +2,107 @@
 #include <cstdint>
 
 #include "json.hpp"
+#include "message/wire_format.hpp"
 #include "models/user.hpp"
 
 User::User(std::string username, std::string display_name)
-    : username(username),
-      display_name(display_name),
-      uid(UUID()),
-      profile_pic(":/assets/profile_pics/blank_profile_pic.png") {}
+    : uid(UUID()),
+      state(State{std::move(username), std::move(display_name),
+                  ":/assets/profile_pics/blank_profile_pic.png", {}}) {}
 
 User::User(std::string username, std::string display_name, UUID uid, std::string profile_pic)
-    : username(username), display_name(display_name), uid(uid), profile_pic(profile_pic) {}
-
-void User::serialize(std::vector<uint8_t>& buf) const {
-#if PROTOCOL_JSON
-    std::string msg = to_json();
-    buf.insert(buf.end(), msg.begin(), msg.end());
-#else
-    uint8_t username_length = this->username.size();
-    uint8_t display_name_length = this->display_name.size();
-    uint8_t profile_pic_length = this->profile_pic.size();
+    : uid(uid),
+      state(State{std::move(username), std::move(display_name), std::move(profile_pic), {}}) {}
 
+void User::serialize_binary(std::vector<uint8_t>& buf, uint8_t version) const {
     this->uid.serialize(buf);
-
-    buf.push_back(username_length);
-    buf.insert(buf.end(), this->username.begin(), this->username.end());
-
-    buf.push_back(display_name_length);
-    buf.insert(buf.end(), this->display_name.begin(), this->display_name.end());
-
-    buf.push_back(profile_pic_length);
-    buf.insert(buf.end(), this->profile_pic.begin(), this->profile_pic.end());
-#endif
+    this->state.read([&buf, version](const State& state) {
+        write_prefixed_string(buf, state.username, version);
+        write_prefixed_string(buf, state.display_name, version);
+        write_prefixed_string(buf, state.profile_pic, version);
+    });
 }
 
-void User::deserialize(const std::vector<uint8_t>& buf) {
-#if PROTOCOL_JSON
-    std::string msg(buf.begin(), buf.end());
-    from_json(msg);
-#else
-    size_t offset = 0;
-    this->uid.deserialize(buf);
-    offset += this->uid.size();
-
-    uint8_t username_length = buf[offset++];
-    this->username = std::string(buf.begin() + offset, buf.begin() + offset + username_length);
-    offset += username_length;
-
-    uint8_t display_name_length = buf[offset++];
-    this->display_name =
-        std::string(buf.begin() + offset, buf.begin() + offset + display_name_length);
-    offset += display_name_length;
-
-    uint8_t profile_pic_length = buf[offset++];
-    this->profile_pic =
-        std::string(buf.begin() + offset, buf.begin() + offset + profile_pic_length);
-    offset += profile_pic_length;
-#endif
+void User::deserialize_binary(ByteReader& reader) {
+    this->uid.deserialize(reader);
+    State& state = this->state.unshared();
+    state.username = reader.read_prefixed_string();
+    state.display_name = reader.read_prefixed_string();
+    state.profile_pic = reader.read_prefixed_string();
 }
 
 std::string User::to_json() const {
     nlohmann::json j;
     j["uid"] = this->uid.to_string();
-    j["username"] = this->username;
-    j["display_name"] = this->display_name;
-    j["profile_pic"] = this->profile_pic;
+    this->state.read([&j](const State& state) {
+        j["username"] = state.username;
+        j["display_name"] = state.display_name;
+        j["profile_pic"] = state.profile_pic;
+    });
     return j.dump();
 }
 
 void User::from_json(const std::string& json) {
     nlohmann::json j = nlohmann::json::parse(json);
     this->uid = UUID::from_string(j["uid"].get<std::string>());
-    this->username = j["username"].get<std::string>();
-    this->display_name = j["display_name"].get<std::string>();
-    this->profile_pic = j["profile_pic"].get<std::string>();
+    State& state = this->state.unshared();
+    state.username = j["username"].get<std::string>();
+    state.display_name = j["display_name"].get<std::string>();
+    state.profile_pic = j["profile_pic"].get<std::string>();
 }
 
-size_t User::size() const {
-#if PROTOCOL_JSON
-    return to_json().size();
-#else
+size_t User::binary_size(uint8_t version) const {
     size_t size = this->uid.size();
-    size += 1 + this->username.size();      // for the username and its length byte
-    size += 1 + this->display_name.size();  // for the display name and its length byte
-    size += 1 + this->profile_pic.size();   // for the profile pic and its length byte
-
+    size += this->state.read([version](const State& state) {
+        return prefixed_string_size(state.username, version) +
+               prefixed_string_size(state.display_name, version) +
+               prefixed_string_size(state.profile_pic, version);
+    });
     return size;
-#endif
 }
 
-const std::string& User::get_username() {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->username;
+std::string User::get_username() const {
+    return this->state.read([](const State& state) { return state.username; });
 }
 
-const UUID& User::get_uid() {
-    std::lock_guard<std::mutex> lock(this->mutex);
+const UUID& User::get_uid() const {
     return this->uid;
 }
 
-const std::string& User::get_display_name() {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->display_name;
+std::string User::get_display_name() const {
+    return this->state.read([](const State& state) { return state.display_name; });
 }
 
-const std::string& User::get_profile_pic() {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->profile_pic;
+std::string User::get_profile_pic() const {
+    return this->state.read([](const State& state) { return state.profile_pic; });
 }
 
-const std::vector<UUID>& User::get_channels() {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    return this->channels;
+std::vector<UUID> User::get_channels() const {
+    return this->state.read([](const State& state) { return state.channels; });
 }
 
 void User::set_username(std::string username) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    this->username = username;
+    this->state.update([&username](State& state) { state.username = std::move(username); });
 }
 
 void User::set_display_name(std::string display_name) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    this->display_name = display_name;
+    this->state.update(
+        [&display_name](State& state) { state.display_name = std::move(display_name); });
 }
 
 void User::set_profile_pic(std::string profile_pic) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    this->profile_pic = profile_pic;
+    this->state.update([&profile_pic](State& state) { state.profile_pic = std::move(profile_pic); });
 }
 
 void User::add_channel(UUID channel_id) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    this->channels.push_back(channel_id);
+    this->state.update([&channel_id](State& state) { state.channels.push_back(channel_id); });
 }
 
 void User::remove_channel(UUID channel_id) {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    auto it = std::find(this->channels.begin(), this->channels.end(), channel_id);
-    if (it != this->channels.end()) {
-        this->channels.erase(it);
-    }
+    this->state.update([&channel_id](State& state) {
+        auto it = std::find(state.channels.begin(), state.channels.end(), channel_id);
+        if (it != state.channels.end()) {
+            state.channels.erase(it);
+        }
+    });
 }
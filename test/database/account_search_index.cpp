@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "server/db/account_search_index.hpp"
+
+namespace {
+
+/**
+ * Usernames over a small alphabet, so that prefixes and trigrams are shared by many of them.
+ */
+std::map<std::string, UUID> make_accounts(size_t n) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> length(3, 9);
+    std::uniform_int_distribution<int> letter(0, 4);
+    std::map<std::string, UUID> accounts;
+    while (accounts.size() < n) {
+        std::string username;
+        for (int i = length(rng); i > 0; i--) {
+            username.push_back("abcde"[letter(rng)]);
+        }
+        accounts.emplace(username, UUID());
+    }
+    return accounts;
+}
+
+std::vector<UUID> brute_force(const std::map<std::string, UUID>& accounts, const std::string& regex) {
+    std::regex re(regex);
+    std::vector<UUID> uids;
+    for (const auto& [username, uid] : accounts) {
+        if (std::regex_match(username, re)) {
+            uids.push_back(uid);
+        }
+    }
+    return uids;
+}
+
+std::vector<UUID> search_all(const AccountSearchIndex& index, const std::string& regex) {
+    auto result = index.search(regex, SIZE_MAX);
+    EXPECT_TRUE(std::holds_alternative<AccountSearchIndex::Page>(result));
+    return std::get<AccountSearchIndex::Page>(result).uids;
+}
+
+const std::vector<std::string> PATTERNS = {
+    "abc",       "abc.*",       "^abc.*$",     ".*cde.*",  ".*ab.*",     "a.*bcd.*e",
+    "(ab|cd)+",  "abc|dea.*",   "[a-c]+dd.*",  "ab\\.*c.*", ".*",        "a{2}bc.*",
+    "e?abc.*",   ".*b+cde.*",   "d(eab)?c.*",  "a.c.*",    ".*[^a]eee",  "ab*cd.*",
+};
+
+}  // namespace
+
+TEST(AccountSearchIndexTest, FindsPrefixAndSubstringMatchesInOrder) {
+    AccountSearchIndex index;
+    UUID thomas, thomask, tom;
+    index.add("thomask", thomask);
+    index.add("thomas", thomas);
+    index.add("tom", tom);
+
+    EXPECT_EQ(search_all(index, "tho.*"), (std::vector<UUID>{thomas, thomask}));
+    EXPECT_EQ(search_all(index, ".*oma.*"), (std::vector<UUID>{thomas, thomask}));
+    EXPECT_EQ(search_all(index, "tom"), (std::vector<UUID>{tom}));
+    EXPECT_EQ(search_all(index, "t.m|thomas"), (std::vector<UUID>{thomas, tom}));
+}
+
+TEST(AccountSearchIndexTest, AgreesWithFullScan) {
+    std::map<std::string, UUID> accounts = make_accounts(2000);
+    AccountSearchIndex index;
+    for (const auto& [username, uid] : accounts) {
+        index.add(username, uid);
+    }
+
+    for (const std::string& pattern : PATTERNS) {
+        EXPECT_EQ(search_all(index, pattern), brute_force(accounts, pattern)) << pattern;
+    }
+}
+
+TEST(AccountSearchIndexTest, PaginatesWithCursor) {
+    std::map<std::string, UUID> accounts = make_accounts(2000);
+    AccountSearchIndex index;
+    for (const auto& [username, uid] : accounts) {
+        index.add(username, uid);
+    }
+
+    for (const std::string& pattern : PATTERNS) {
+        std::vector<UUID> paged;
+        std::string cursor;
+        while (true) {
+            auto page = std::get<AccountSearchIndex::Page>(index.search(pattern, 37, cursor));
+            EXPECT_LE(page.uids.size(), 37);
+            paged.insert(paged.end(), page.uids.begin(), page.uids.end());
+            if (!page.next_cursor.has_value()) {
+                break;
+            }
+            cursor = page.next_cursor.value();
+        }
+        EXPECT_EQ(paged, brute_force(accounts, pattern)) << pattern;
+    }
+}
+
+TEST(AccountSearchIndexTest, ForgetsRemovedAccounts) {
+    std::map<std::string, UUID> accounts = make_accounts(3000);
+    AccountSearchIndex index;
+    for (const auto& [username, uid] : accounts) {
+        index.add(username, uid);
+    }
+
+    // Remove enough accounts to compact the postings, and re-add some under new names
+    size_t i = 0;
+    for (auto it = accounts.begin(); it != accounts.end();) {
+        if (i++ % 5 != 0) {
+            index.remove(it->first);
+            it = accounts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (size_t j = 0; j < 100; j++) {
+        std::string username = "renamed" + std::to_string(j);
+        UUID uid;
+        index.add(username, uid);
+        accounts.emplace(username, uid);
+    }
+
+    EXPECT_EQ(index.size(), accounts.size());
+    for (const std::string& pattern : PATTERNS) {
+        EXPECT_EQ(search_all(index, pattern), brute_force(accounts, pattern)) << pattern;
+    }
+    EXPECT_EQ(search_all(index, ".*named1.*").size(), 11);
+}
+
+TEST(AccountSearchIndexTest, MergesChangesIntoEarlierScans) {
+    std::map<std::string, UUID> accounts = make_accounts(6000);
+    AccountSearchIndex index;
+    for (const auto& [username, uid] : accounts) {
+        index.add(username, uid);
+    }
+    // Enough changes to be merged into a snapshot, then fewer that scans merge on the fly
+    EXPECT_EQ(search_all(index, ".*"), brute_force(accounts, ".*"));
+
+    size_t i = 0;
+    for (auto it = accounts.begin(); it != accounts.end();) {
+        if (i++ % 10 == 0) {
+            index.remove(it->first);
+            it = accounts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // A username removed from the snapshot and added again belongs to its new account
+    UUID readded;
+    index.remove(accounts.begin()->first);
+    index.add(accounts.begin()->first, readded);
+    accounts.begin()->second = readded;
+    UUID added;
+    index.add("zzz", added);
+    accounts.emplace("zzz", added);
+
+    for (const std::string& pattern : PATTERNS) {
+        EXPECT_EQ(search_all(index, pattern), brute_force(accounts, pattern)) << pattern;
+    }
+    std::vector<UUID> paged;
+    std::string cursor;
+    while (true) {
+        auto page = std::get<AccountSearchIndex::Page>(index.search("(ab|cd)+.*", 7, cursor));
+        paged.insert(paged.end(), page.uids.begin(), page.uids.end());
+        if (!page.next_cursor.has_value()) {
+            break;
+        }
+        cursor = page.next_cursor.value();
+    }
+    EXPECT_EQ(paged, brute_force(accounts, "(ab|cd)+.*"));
+}
+
+TEST(AccountSearchIndexTest, ReportsInvalidRegex) {
+    AccountSearchIndex index;
+    auto result = index.search("[a-z", 10);
+    ASSERT_TRUE(std::holds_alternative<std::string>(result));
+    EXPECT_EQ(std::get<std::string>(result),
+              "Regex error: Unexpected character within '[...]' in regular expression");
+}
+
+TEST(AccountSearchIndexTest, SearchesWhileAccountsAreAdded) {
+    AccountSearchIndex index;
+    std::thread writer([&index]() {
+        for (int i = 0; i < 5000; i++) {
+            index.add("user" + std::to_string(i), UUID());
+        }
+    });
+    for (int i = 0; i < 50; i++) {
+        auto result = index.search("user1.*", 100);
+        ASSERT_TRUE(std::holds_alternative<AccountSearchIndex::Page>(result));
+    }
+    writer.join();
+
+    EXPECT_EQ(search_all(index, "user1.*").size(), 1111);
+    EXPECT_EQ(search_all(index, ".*r49.*").size(), 111);
+}
@@ -4,6 +4,10 @@
 #include "models/user.hpp"
 #include "models/message.hpp"
 #include "models/channel.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 TEST(DatabaseTest, AddUserSuccessfully) {
     Database& db = Database::get_instance();
     User::SharedPtr user = std::make_shared<User>("testusername", "testuser");
@@ -14,7 +18,7 @@ TEST(DatabaseTest, AddUserSuccessfully) {
 
 TEST(DatabaseTest, GetUserByUid) {
     Database& db = Database::get_instance();
-    User::SharedPtr user = std::make_shared<User>("testusername", "testuser");
+    User::SharedPtr user = std::make_shared<User>("getuserbyuid", "testuser");
     db.add_user(user, "securePass123");
     auto retrievedUser = db.get_user_by_uid(user->get_uid());
     EXPECT_TRUE(retrievedUser.has_value());
@@ -22,7 +26,7 @@ TEST(DatabaseTest, GetUserByUid) {
 
 TEST(DatabaseTest, GetMutUserByUid) {
     Database& db = Database::get_instance();
-    User::SharedPtr user = std::make_shared<User>("testusername", "testuser");
+    User::SharedPtr user = std::make_shared<User>("getmutuserbyuid", "testuser");
     db.add_user(user, "securePass123");
     auto retrievedUser = db.get_mut_user_by_uid(user->get_uid());
     EXPECT_TRUE(retrievedUser.has_value());
@@ -30,7 +34,7 @@ TEST(DatabaseTest, GetMutUserByUid) {
 
 TEST(DatabaseTest, RemoveUserSuccessfully) {
     Database& db = Database::get_instance();
-    User::SharedPtr user = std::make_shared<User>("testusername", "testuser");
+    User::SharedPtr user = std::make_shared<User>("removeuser", "testuser");
     db.add_user(user, "securePass123");
     auto removeResult = db.remove_user(user->get_uid());
     EXPECT_TRUE(std::holds_alternative<User::SharedPtr>(removeResult));
@@ -55,10 +59,318 @@ TEST(DatabaseTest, RemoveNonexistentUser) {
 
 TEST(DatabaseTest, VerifyPassword) {
     Database& db = Database::get_instance();
-    User::SharedPtr user = std::make_shared<User>("testusername", "testuser");
+    User::SharedPtr user = std::make_shared<User>("verifypassword", "testuser");
     db.add_user(user, "securePass123");
     UUID userUid = user->get_uid();
     auto result = db.verify_password(userUid, "securePass123");
     EXPECT_TRUE(std::holds_alternative<bool>(result));
     EXPECT_TRUE(std::get<bool>(result));
 }
+
+TEST(DatabaseTest, RejectsDuplicateUsername) {
+    Database& db = Database::get_instance();
+    User::SharedPtr user = std::make_shared<User>("duplicateusername", "first");
+    User::SharedPtr duplicate = std::make_shared<User>("duplicateusername", "second");
+    db.add_user(user, "securePass123");
+
+    auto result = db.add_user(duplicate, "otherPass456");
+    ASSERT_TRUE(std::holds_alternative<std::string>(result));
+    EXPECT_EQ(std::get<std::string>(result), "Username already exists");
+    EXPECT_FALSE(db.get_user_by_uid(duplicate->get_uid()).has_value());
+    UUID duplicate_uid = duplicate->get_uid();
+    EXPECT_TRUE(std::holds_alternative<std::string>(db.verify_password(duplicate_uid, "otherPass456")));
+    EXPECT_EQ(db.get_uid_from_username("duplicateusername"), user->get_uid());
+}
+
+TEST(DatabaseTest, GetsMessagesSinceWatermarkAcrossChannels) {
+    Database& db = Database::get_instance();
+    User::SharedPtr user = std::make_shared<User>("messagessince", "testuser");
+    db.add_user(user, "securePass123");
+    auto first_channel = db.add_channel("first", {user->get_uid()});
+    auto second_channel = db.add_channel("second", {user->get_uid()});
+    UUID first = std::get<Channel::SharedPtr>(first_channel)->get_uid();
+    UUID second = std::get<Channel::SharedPtr>(second_channel)->get_uid();
+
+    std::vector<uint64_t> snowflakes;
+    for (int i = 0; i < 6; i++) {
+        auto message = db.add_message(user->get_uid(), i % 2 == 0 ? first : second, "hi");
+        snowflakes.push_back(std::get<Message::SharedPtr>(message)->get_snowflake());
+    }
+
+    // Both channels come back interleaved in snowflake order, one page at a time
+    std::vector<Message::SharedPtr> page = db.get_messages_since({first, second}, 0, 4);
+    ASSERT_EQ(page.size(), 4);
+    for (size_t i = 0; i < page.size(); i++) {
+        EXPECT_EQ(page[i]->get_snowflake(), snowflakes[i]);
+    }
+    page = db.get_messages_since({first, second}, page.back()->get_snowflake(), 4);
+    ASSERT_EQ(page.size(), 2);
+    EXPECT_EQ(page[0]->get_snowflake(), snowflakes[4]);
+    EXPECT_EQ(page[1]->get_snowflake(), snowflakes[5]);
+
+    EXPECT_EQ(db.get_messages_since({second}, snowflakes[1], 10).size(), 2);
+    EXPECT_TRUE(db.get_messages_since({UUID()}, 0, 10).empty());
+}
+
+TEST(DatabaseTest, PagesChannelHistoryBySnowflake) {
+    Database& db = Database::get_instance();
+    User::SharedPtr user = std::make_shared<User>("channelhistory", "testuser");
+    db.add_user(user, "securePass123");
+    auto channel = db.add_channel("history", {user->get_uid()});
+    UUID uid = std::get<Channel::SharedPtr>(channel)->get_uid();
+
+    std::vector<uint64_t> snowflakes;
+    for (int i = 0; i < 5; i++) {
+        auto message = db.add_message(user->get_uid(), uid, "hi");
+        snowflakes.push_back(std::get<Message::SharedPtr>(message)->get_snowflake());
+    }
+
+    // Without bounds the newest messages come back, oldest first
+    auto page = std::get<Database::ChannelHistory>(db.get_channel_history(uid, 0, 0, 2));
+    ASSERT_EQ(page.messages.size(), 2);
+    EXPECT_EQ(page.messages[0]->get_snowflake(), snowflakes[3]);
+    EXPECT_EQ(page.messages[1]->get_snowflake(), snowflakes[4]);
+    EXPECT_TRUE(page.has_more);
+
+    page = std::get<Database::ChannelHistory>(db.get_channel_history(uid, snowflakes[3], 0, 2));
+    ASSERT_EQ(page.messages.size(), 2);
+    EXPECT_EQ(page.messages[0]->get_snowflake(), snowflakes[1]);
+    EXPECT_EQ(page.messages[1]->get_snowflake(), snowflakes[2]);
+    EXPECT_TRUE(page.has_more);
+
+    page = std::get<Database::ChannelHistory>(db.get_channel_history(uid, snowflakes[1], 0, 2));
+    ASSERT_EQ(page.messages.size(), 1);
+    EXPECT_EQ(page.messages[0]->get_snowflake(), snowflakes[0]);
+    EXPECT_FALSE(page.has_more);
+
+    page = std::get<Database::ChannelHistory>(db.get_channel_history(uid, 0, snowflakes[1], 2));
+    ASSERT_EQ(page.messages.size(), 2);
+    EXPECT_EQ(page.messages[0]->get_snowflake(), snowflakes[2]);
+    EXPECT_EQ(page.messages[1]->get_snowflake(), snowflakes[3]);
+    EXPECT_TRUE(page.has_more);
+
+    // Both bounds select the messages strictly between them
+    page = std::get<Database::ChannelHistory>(
+        db.get_channel_history(uid, snowflakes[4], snowflakes[1], 10));
+    ASSERT_EQ(page.messages.size(), 2);
+    EXPECT_EQ(page.messages[0]->get_snowflake(), snowflakes[2]);
+    EXPECT_FALSE(page.has_more);
+
+    EXPECT_TRUE(std::holds_alternative<std::string>(db.get_channel_history(UUID(), 0, 0, 2)));
+}
+
+namespace {
+
+/**
+ * Records how often each change was reported, and to how many members.
+ */
+struct RecordingObserver : DatabaseObserver {
+    std::vector<size_t> added, removed, channels;
+
+    void on_message_added(const Message::SharedPtr& message,
+                          const std::vector<UUID>& user_uids) override {
+        added.push_back(user_uids.size());
+    }
+    void on_message_removed(const Message::SharedPtr& message,
+                            const std::vector<UUID>& user_uids) override {
+        removed.push_back(user_uids.size());
+    }
+    void on_channel_added(const Channel::SharedPtr& channel,
+                          const std::vector<UUID>& user_uids) override {
+        channels.push_back(user_uids.size());
+    }
+};
+
+}  // namespace
+
+TEST(DatabaseTest, ReportsEachChangeOnceToTheObserver) {
+    Database db;
+    RecordingObserver observer;
+    db.set_observer(&observer);
+
+    std::vector<UUID> members;
+    for (int i = 0; i < 3; i++) {
+        User::SharedPtr user = std::make_shared<User>("observed" + std::to_string(i), "testuser");
+        db.add_user(user, "securePass123");
+        members.push_back(user->get_uid());
+    }
+    UUID channel_uid = std::get<Channel::SharedPtr>(db.add_channel("observed", members))->get_uid();
+    auto first = std::get<Message::SharedPtr>(db.add_message(members[0], channel_uid, "one"));
+    db.add_message(members[1], channel_uid, "two");
+    db.remove_message(first->get_snowflake());
+    // Deleting an account deletes its messages for the members that are left
+    db.remove_user(members[1]);
+
+    EXPECT_EQ(observer.channels, std::vector<size_t>({3}));
+    EXPECT_EQ(observer.added, std::vector<size_t>({3, 3}));
+    EXPECT_EQ(observer.removed, std::vector<size_t>({3, 2}));
+}
+
+TEST(DatabaseTest, RemovingAUserRemovesTheirMessagesAndPassword) {
+    Database db;
+    User::SharedPtr user = std::make_shared<User>("leaving", "testuser");
+    User::SharedPtr other = std::make_shared<User>("staying", "testuser");
+    db.add_user(user, "securePass123");
+    db.add_user(other, "securePass123");
+    UUID user_uid = user->get_uid();
+    UUID channel_uid = std::get<Channel::SharedPtr>(
+                           db.add_channel("general", {user_uid, other->get_uid()}))
+                           ->get_uid();
+    auto sent = std::get<Message::SharedPtr>(db.add_message(user_uid, channel_uid, "bye"));
+    auto kept = std::get<Message::SharedPtr>(db.add_message(other->get_uid(), channel_uid, "hi"));
+
+    db.remove_user(user_uid);
+
+    EXPECT_FALSE(db.get_message_by_uid(sent->get_snowflake()).has_value());
+    EXPECT_TRUE(db.get_message_by_uid(kept->get_snowflake()).has_value());
+    EXPECT_TRUE(std::holds_alternative<std::string>(db.verify_password(user_uid, "securePass123")));
+    EXPECT_FALSE(db.get_channel_by_uid(channel_uid).value()->has_user(user_uid));
+}
+
+TEST(DatabaseTest, ReadsNeverSeeHalfRemovedUsers) {
+    Database db;
+    UUID channel_uid = std::get<Channel::SharedPtr>(db.add_channel("general", {}))->get_uid();
+    std::atomic<bool> done = false;
+    std::atomic<uint64_t> latest = 0;
+    PasswordHasher::Credentials credentials = PasswordHasher::hash("securePass123");
+
+    std::thread writer([&]() {
+        for (int i = 0; i < 500; i++) {
+            User::SharedPtr user = std::make_shared<User>("churn" + std::to_string(i), "testuser");
+            db.add_user(user, credentials);
+            db.add_user_to_channel(user->get_uid(), channel_uid);
+            auto message =
+                std::get<Message::SharedPtr>(db.add_message(user->get_uid(), channel_uid, "hi"));
+            latest = message->get_snowflake();
+            db.remove_user(user->get_uid());
+        }
+        done = true;
+    });
+
+    // Removing a user removes their messages in the same change, so a message found first must
+    // still have its sender unless the read saw only part of the removal
+    size_t torn = 0;
+    while (!done) {
+        bool consistent = db.read([&]() {
+            std::optional<const Message::SharedPtr> message = db.get_message_by_uid(latest);
+            if (!message.has_value()) {
+                return true;
+            }
+            // Give the writer a chance to run between the two lookups
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            return db.get_user_by_uid(message.value()->get_sender_id()).has_value();
+        });
+        if (!consistent) {
+            torn++;
+        }
+    }
+    writer.join();
+
+    EXPECT_EQ(torn, 0);
+}
+
+TEST(DatabaseTest, ConcurrentReadsNeverSeeHalfRemovedUsers) {
+    Database db;
+    UUID channel_uid = std::get<Channel::SharedPtr>(db.add_channel("general", {}))->get_uid();
+    std::atomic<int> writing = 3;
+    std::atomic<uint64_t> latest = 0;
+    PasswordHasher::Credentials credentials = PasswordHasher::hash("securePass123");
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 3; w++) {
+        writers.emplace_back([&, w]() {
+            for (int i = 0; i < 200; i++) {
+                User::SharedPtr user = std::make_shared<User>(
+                    "churn" + std::to_string(w) + "_" + std::to_string(i), "testuser");
+                db.add_user(user, credentials);
+                db.add_user_to_channel(user->get_uid(), channel_uid);
+                auto message = std::get<Message::SharedPtr>(
+                    db.add_message(user->get_uid(), channel_uid, "hi"));
+                latest = message->get_snowflake();
+                db.remove_user(user->get_uid());
+            }
+            writing--;
+        });
+    }
+
+    // Every reader checks, within one read(), that the sender of the latest message and every
+    // member of the channel still exist
+    std::atomic<size_t> torn = 0;
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; r++) {
+        readers.emplace_back([&]() {
+            while (writing > 0) {
+                bool consistent = db.read([&]() {
+                    std::optional<const Message::SharedPtr> message =
+                        db.get_message_by_uid(latest);
+                    if (message.has_value() &&
+                        !db.get_user_by_uid(message.value()->get_sender_id()).has_value()) {
+                        return false;
+                    }
+                    std::optional<const Channel::SharedPtr> channel =
+                        db.get_channel_by_uid(channel_uid);
+                    for (const UUID& member : channel.value()->get_user_uids()) {
+                        if (!db.get_user_by_uid(member).has_value()) {
+                            return false;
+                        }
+                    }
+                    return true;
+                });
+                if (!consistent) {
+                    torn++;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : writers) {
+        thread.join();
+    }
+    for (std::thread& thread : readers) {
+        thread.join();
+    }
+
+    EXPECT_EQ(torn, 0);
+}
+
+TEST(DatabaseTest, SendsRacingAChannelRemovalLeaveNoMessageBehind) {
+    Database db;
+    User::SharedPtr user = std::make_shared<User>("racer", "testuser");
+    db.add_user(user, "securePass123");
+    UUID channel_uid =
+        std::get<Channel::SharedPtr>(db.add_channel("general", {user->get_uid()}))->get_uid();
+    std::atomic<int> started = 0;
+
+    // Each sender keeps sending until the channel is gone
+    std::vector<std::vector<uint64_t>> sent(4);
+    std::vector<std::thread> senders;
+    for (std::vector<uint64_t>& snowflakes : sent) {
+        senders.emplace_back([&]() {
+            started++;
+            while (true) {
+                auto res = db.add_message(user->get_uid(), channel_uid, "hi");
+                if (std::holds_alternative<std::string>(res)) {
+                    break;
+                }
+                snowflakes.push_back(std::get<Message::SharedPtr>(res)->get_snowflake());
+            }
+        });
+    }
+    while (started < 4) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    db.remove_channel(channel_uid);
+    for (std::thread& thread : senders) {
+        thread.join();
+    }
+
+    size_t left = 0;
+    for (const std::vector<uint64_t>& snowflakes : sent) {
+        for (uint64_t snowflake : snowflakes) {
+            if (db.get_message_by_uid(snowflake).has_value()) {
+                left++;
+            }
+        }
+    }
+    EXPECT_EQ(left, 0);
+}
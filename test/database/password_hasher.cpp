@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "server/db/password_hasher.hpp"
+
+namespace {
+
+/// A low cost, so that the tests do not spend their time hashing.
+constexpr uint8_t TEST_COST = 10;
+
+/**
+ * @brief Lowers the cost of every password hashed by the tests, including by the database.
+ */
+class LowHashCostEnvironment : public ::testing::Environment {
+   public:
+    void SetUp() override { PasswordHasher::set_cost(TEST_COST); }
+};
+
+// Registered before main, as the tests run from gtest's own main
+const ::testing::Environment* const low_hash_cost =
+    ::testing::AddGlobalTestEnvironment(new LowHashCostEnvironment());
+
+}  // namespace
+
+TEST(PasswordHasherTest, VerifiesTheHashedPassword) {
+    PasswordHasher::Credentials credentials = PasswordHasher::hash("password", TEST_COST);
+
+    EXPECT_TRUE(PasswordHasher::verify("password", credentials));
+    EXPECT_FALSE(PasswordHasher::verify("Password", credentials));
+    EXPECT_FALSE(PasswordHasher::verify("", credentials));
+}
+
+TEST(PasswordHasherTest, StoresRawBytesWithAFreshSalt) {
+    PasswordHasher::Credentials first = PasswordHasher::hash("password", TEST_COST);
+    PasswordHasher::Credentials second = PasswordHasher::hash("password", TEST_COST);
+
+    // A format byte, three parameters and a 32-byte key, then a 16-byte salt
+    EXPECT_EQ(first.first.size(), 36);
+    EXPECT_EQ(first.second.size(), 16);
+    EXPECT_EQ(static_cast<uint8_t>(first.first[1]), TEST_COST);
+    EXPECT_NE(first.second, second.second);
+    EXPECT_NE(first.first, second.first);
+}
+
+TEST(PasswordHasherTest, VerifiesLegacyHexHashes) {
+    // The hex SHA-256 of "passwordsalt"
+    PasswordHasher::Credentials legacy = {
+        "7a37b85c8918eac19a9089c0fa5a2ab4dce3f90528dcdeec108b23ddf3607b99", "salt"};
+
+    EXPECT_TRUE(PasswordHasher::verify("password", legacy));
+    EXPECT_FALSE(PasswordHasher::verify("passwords", legacy));
+}
+
+TEST(PasswordHasherTest, RejectsMalformedHashes) {
+    PasswordHasher::Credentials credentials = PasswordHasher::hash("password", TEST_COST);
+
+    EXPECT_FALSE(PasswordHasher::verify("password", {"", credentials.second}));
+    EXPECT_FALSE(PasswordHasher::verify("password", {credentials.first.substr(1), "salt"}));
+
+    // A cost that would need gigabytes of memory to check
+    PasswordHasher::Credentials expensive = credentials;
+    expensive.first[1] = 40;
+    EXPECT_FALSE(PasswordHasher::verify("password", expensive));
+}
+
+TEST(PasswordHasherTest, RunsSubmittedJobs) {
+    PasswordHasher pool(2, 16);
+    std::atomic<int> verified = 0;
+    PasswordHasher::Credentials credentials = PasswordHasher::hash("password", TEST_COST);
+
+    for (int i = 0; i < 8; i++) {
+        ASSERT_TRUE(pool.submit([&]() {
+            if (PasswordHasher::verify("password", credentials)) {
+                verified++;
+            }
+        }));
+    }
+    while (verified < 8) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(verified, 8);
+}
+
+TEST(PasswordHasherTest, RefusesJobsWhenTheQueueIsFull) {
+    PasswordHasher pool(1, 1);
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+
+    // Occupy the only worker, then fill the queue behind it
+    ASSERT_TRUE(pool.submit([&started, released]() {
+        started.set_value();
+        released.wait();
+    }));
+    started.get_future().wait();
+    ASSERT_TRUE(pool.submit([]() {}));
+
+    EXPECT_EQ(pool.get_num_queued(), 1);
+    EXPECT_FALSE(pool.submit([]() {}));
+
+    release.set_value();
+}
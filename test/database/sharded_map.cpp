@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "models/uuid.hpp"
+#include "models/uuid_map.hpp"
+#include "server/db/sharded_map.hpp"
+
+TEST(ShardedMapTest, InsertsFindsAndErases) {
+    ShardedMap<std::string, int> map;
+
+    EXPECT_FALSE(map.find("key").has_value());
+    EXPECT_TRUE(map.insert("key", 1));
+    EXPECT_FALSE(map.insert("key", 2));
+
+    ASSERT_TRUE(map.find("key").has_value());
+    EXPECT_EQ(map.find("key").value(), 1);
+    EXPECT_TRUE(map.contains("key"));
+    EXPECT_EQ(map.size(), 1);
+
+    EXPECT_EQ(map.erase("key"), 1);
+    EXPECT_FALSE(map.erase("key").has_value());
+    EXPECT_FALSE(map.contains("key"));
+    EXPECT_EQ(map.size(), 0);
+}
+
+TEST(ShardedMapTest, HoldsUUIDMapShards) {
+    ShardedMap<UUID, std::string, UUIDMap<std::string>> map;
+    std::vector<UUID> keys(1000);
+    for (size_t i = 0; i < keys.size(); i++) {
+        EXPECT_TRUE(map.insert(keys[i], std::to_string(i)));
+    }
+
+    EXPECT_EQ(map.size(), keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_TRUE(map.find(keys[i]).has_value());
+        EXPECT_EQ(map.find(keys[i]).value(), std::to_string(i));
+    }
+
+    size_t visited = 0;
+    map.for_each([&](const UUID& key, const std::string& value) { visited++; });
+    EXPECT_EQ(visited, keys.size());
+}
+
+TEST(ShardedMapTest, UpdatesAnEntryInPlace) {
+    ShardedMap<uint64_t, int> map;
+    map.insert(7, 1);
+
+    int previous = map.with_shard(7, [](std::unordered_map<uint64_t, int>& shard) {
+        int value = shard.at(7);
+        shard[7] = value + 1;
+        return value;
+    });
+
+    EXPECT_EQ(previous, 1);
+    EXPECT_EQ(map.find(7), 2);
+}
+
+TEST(ShardedMapTest, KeepsEveryConcurrentInsert) {
+    ShardedMap<uint64_t, uint64_t> map;
+    constexpr uint64_t NUM_THREADS = 8;
+    constexpr uint64_t PER_THREAD = 5000;
+    std::atomic<size_t> misses = 0;
+
+    std::vector<std::thread> threads;
+    for (uint64_t thread = 0; thread < NUM_THREADS; thread++) {
+        threads.emplace_back([&map, &misses, thread]() {
+            for (uint64_t i = 0; i < PER_THREAD; i++) {
+                uint64_t key = thread * PER_THREAD + i;
+                map.insert(key, key);
+                if (map.find(key) != key) {
+                    misses++;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(misses, 0);
+    EXPECT_EQ(map.size(), NUM_THREADS * PER_THREAD);
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+#include "server/db/database.hpp"
+
+namespace {
+
+/**
+ * A snapshot and a log in the temporary directory that are removed when the test ends.
+ */
+class TempFiles {
+   public:
+    explicit TempFiles(const std::string& name)
+        : snapshot(path(name, ".snapshot")), log(path(name, ".wal")) {
+        std::filesystem::remove(this->snapshot);
+        std::filesystem::remove(this->log);
+    }
+    ~TempFiles() {
+        std::filesystem::remove(this->snapshot);
+        std::filesystem::remove(this->log);
+    }
+
+    const std::string snapshot;
+    const std::string log;
+
+   private:
+    static std::string path(const std::string& name, const std::string& extension) {
+        return (std::filesystem::temp_directory_path() /
+                (name + "-" + std::to_string(::getpid()) + extension))
+            .string();
+    }
+};
+
+/**
+ * Opens a database from a snapshot and a log, returning the number of log records replayed.
+ */
+size_t restart(Database& db, const TempFiles& files) {
+    auto loaded = db.load_snapshot(files.snapshot);
+    EXPECT_TRUE(std::holds_alternative<std::monostate>(loaded));
+    auto replayed = db.open_log(files.log, SyncPolicy::NONE);
+    EXPECT_TRUE(std::holds_alternative<size_t>(replayed));
+    return std::holds_alternative<size_t>(replayed) ? std::get<size_t>(replayed) : 0;
+}
+
+uint64_t post(Database& db, const User::SharedPtr& sender, UUID channel_uid,
+              const std::string& text) {
+    auto message = db.add_message(sender->get_uid(), channel_uid, text);
+    return std::get<Message::SharedPtr>(message)->get_snowflake();
+}
+
+}  // namespace
+
+TEST(SnapshotTest, RestartsFromSnapshotAndLogTail) {
+    TempFiles files("snapshot-restart");
+    User::SharedPtr alice = std::make_shared<User>("snapalice", "Alice");
+    User::SharedPtr bob = std::make_shared<User>("snapbob", "Bob");
+    UUID channel_uid;
+    std::vector<uint64_t> snowflakes;
+    {
+        Database db;
+        restart(db, files);
+        db.add_user(alice, "alicepass");
+        db.add_user(bob, "bobpass");
+        auto channel = db.add_channel("general", {alice->get_uid()});
+        channel_uid = std::get<Channel::SharedPtr>(channel)->get_uid();
+        for (int i = 0; i < 100; i++) {
+            snowflakes.push_back(post(db, alice, channel_uid, "before " + std::to_string(i)));
+        }
+        ASSERT_TRUE(std::holds_alternative<std::monostate>(db.write_snapshot(files.snapshot)));
+
+        // Changes after the snapshot are only in the log
+        db.add_user_to_channel(bob->get_uid(), channel_uid);
+        snowflakes.push_back(post(db, bob, channel_uid, "after"));
+        db.remove_message(snowflakes[0]);
+        snowflakes.erase(snowflakes.begin());
+    }
+
+    Database db;
+    EXPECT_EQ(restart(db, files), 3);
+
+    UUID alice_uid = alice->get_uid();
+    EXPECT_TRUE(std::get<bool>(db.verify_password(alice_uid, "alicepass")));
+    auto channel = db.get_channel_by_uid(channel_uid);
+    ASSERT_TRUE(channel.has_value());
+    EXPECT_EQ(channel.value()->get_user_uids(),
+              (std::vector<UUID>{alice->get_uid(), bob->get_uid()}));
+    EXPECT_EQ(channel.value()->get_message_snowflakes(), snowflakes);
+    auto bob_copy = db.get_user_by_uid(bob->get_uid());
+    ASSERT_TRUE(bob_copy.has_value());
+    EXPECT_EQ(bob_copy.value()->get_channels(), (std::vector<UUID>{channel_uid}));
+
+    auto first = db.get_message_by_uid(snowflakes[0]);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first.value()->get_text(), "before 1");
+    EXPECT_EQ(first.value()->get_sender_id(), alice->get_uid());
+    EXPECT_EQ(db.get_message_by_uid(snowflakes.back()).value()->get_text(), "after");
+
+    // Users loaded from the snapshot can be searched for
+    auto found = db.get_uuids_matching_regex("snap.*");
+    EXPECT_EQ(std::get<std::vector<UUID>>(found).size(), 2);
+}
+
+TEST(SnapshotTest, CarriesMessagesAcrossSnapshots) {
+    TempFiles files("snapshot-carry");
+    User::SharedPtr carol = std::make_shared<User>("snapcarol", "Carol");
+    UUID channel_uid;
+    std::vector<uint64_t> snowflakes;
+    {
+        Database db;
+        restart(db, files);
+        db.add_user(carol, "carolpass");
+        auto channel = db.add_channel("random", {carol->get_uid()});
+        channel_uid = std::get<Channel::SharedPtr>(channel)->get_uid();
+        for (int i = 0; i < 10; i++) {
+            snowflakes.push_back(post(db, carol, channel_uid, std::to_string(i)));
+        }
+        ASSERT_TRUE(std::holds_alternative<std::monostate>(db.write_snapshot(files.snapshot)));
+    }
+    {
+        // Messages still in the first snapshot are copied into the second without being used,
+        // except for the removed one
+        Database db;
+        EXPECT_EQ(restart(db, files), 0);
+        db.remove_message(snowflakes[4]);
+        snowflakes.erase(snowflakes.begin() + 4);
+        snowflakes.push_back(post(db, carol, channel_uid, "new"));
+        ASSERT_TRUE(std::holds_alternative<std::monostate>(db.write_snapshot(files.snapshot)));
+    }
+
+    Database db;
+    EXPECT_EQ(restart(db, files), 0);
+    EXPECT_EQ(db.get_channel_by_uid(channel_uid).value()->get_message_snowflakes(), snowflakes);
+    for (size_t i = 0; i < snowflakes.size(); i++) {
+        auto message = db.get_message_by_uid(snowflakes[i]);
+        ASSERT_TRUE(message.has_value());
+        EXPECT_EQ(message.value()->get_text(), i < 9 ? std::to_string(i < 4 ? i : i + 1) : "new");
+    }
+}
+
+TEST(SnapshotTest, RejectsCorruptSnapshot) {
+    TempFiles files("snapshot-corrupt");
+    {
+        Database db;
+        restart(db, files);
+        db.add_user(std::make_shared<User>("snapdave", "Dave"), "davepass");
+        ASSERT_TRUE(std::holds_alternative<std::monostate>(db.write_snapshot(files.snapshot)));
+    }
+    std::filesystem::resize_file(files.snapshot, std::filesystem::file_size(files.snapshot) - 1);
+
+    Database db;
+    EXPECT_TRUE(std::holds_alternative<std::string>(db.load_snapshot(files.snapshot)));
+}
+
+TEST(SnapshotTest, RefusesLogWithoutTheSnapshotOfItsStart) {
+    TempFiles files("snapshot-missing");
+    std::vector<User::SharedPtr> users;
+    for (int i = 0; i < 60; i++) {
+        users.push_back(std::make_shared<User>("snapmissing" + std::to_string(i), "Missing"));
+    }
+    {
+        Database db;
+        restart(db, files);
+        for (int i = 0; i < 50; i++) {
+            db.add_user(users[i], "password");
+        }
+        ASSERT_TRUE(std::holds_alternative<std::monostate>(db.write_snapshot(files.snapshot)));
+        for (int i = 50; i < 60; i++) {
+            db.add_user(users[i], "password");
+        }
+    }
+    std::string kept = files.snapshot + ".kept";
+    std::filesystem::rename(files.snapshot, kept);
+    uintmax_t size = std::filesystem::file_size(files.log);
+
+    // The records the snapshot held are gone from the log, which is left untouched
+    {
+        Database db;
+        EXPECT_TRUE(std::holds_alternative<std::monostate>(db.load_snapshot(files.snapshot)));
+        EXPECT_TRUE(std::holds_alternative<std::string>(db.open_log(files.log, SyncPolicy::NONE)));
+        EXPECT_EQ(std::filesystem::file_size(files.log), size);
+    }
+
+    std::filesystem::rename(kept, files.snapshot);
+    Database db;
+    EXPECT_EQ(restart(db, files), 10);
+    for (const User::SharedPtr& user : users) {
+        EXPECT_TRUE(db.get_user_by_uid(user->get_uid()).has_value());
+    }
+}
+
+TEST(SnapshotTest, NeedsTheLog) {
+    TempFiles files("snapshot-order");
+    Database db;
+    EXPECT_TRUE(std::holds_alternative<std::string>(db.write_snapshot(files.snapshot)));
+    restart(db, files);
+    EXPECT_TRUE(std::holds_alternative<std::string>(db.load_snapshot(files.snapshot)));
+}
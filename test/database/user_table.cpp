@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include "server/db/user_table.hpp"
 #include "server/db/database.hpp"
+#include <atomic>
 #include <regex>
+#include <thread>
 
 TEST(UserTableTest, AddUser) {
     UserTable db;
@@ -60,4 +62,60 @@ TEST(UserTableTest, HandlesInvalidRegex) {
     ASSERT_TRUE(std::holds_alternative<std::string>(user_uiids));
     error = std::get<std::string>(user_uiids);
     EXPECT_EQ(error, "Regex error: Unexpected character within '[...]' in regular expression");
-}
\ No newline at end of file
+}
+
+TEST(UserTableTest, FindsUidFromUsername) {
+    UserTable db;
+    User::SharedPtr user = std::make_shared<User>("thomask", "Thomas");
+    db.add_user(user);
+    EXPECT_EQ(db.get_uid_from_username("thomask"), user->get_uid());
+    EXPECT_FALSE(db.get_uid_from_username("thomas").has_value());
+
+    db.remove_user(user->get_uid());
+    EXPECT_FALSE(db.get_uid_from_username("thomask").has_value());
+}
+
+TEST(UserTableTest, RejectsDuplicateUsername) {
+    UserTable db;
+    User::SharedPtr user1 = std::make_shared<User>("thomask", "Thomas");
+    User::SharedPtr user2 = std::make_shared<User>("thomask", "Tom");
+    EXPECT_TRUE(std::holds_alternative<std::monostate>(db.add_user(user1)));
+    EXPECT_TRUE(std::holds_alternative<std::string>(db.add_user(user2)));
+    EXPECT_FALSE(db.get_by_uid(user2->get_uid()).has_value());
+    EXPECT_TRUE(std::holds_alternative<std::string>(db.add_user(user1)));
+}
+
+TEST(UserTableTest, RenamesUserAndIndex) {
+    UserTable db;
+    User::SharedPtr user1 = std::make_shared<User>("thomask", "Thomas");
+    User::SharedPtr user2 = std::make_shared<User>("tom", "Tom");
+    db.add_user(user1);
+    db.add_user(user2);
+
+    EXPECT_TRUE(std::holds_alternative<std::string>(db.set_username(user1->get_uid(), "tom")));
+    EXPECT_TRUE(std::holds_alternative<std::monostate>(db.set_username(user1->get_uid(), "thomas")));
+    EXPECT_EQ(user1->get_username(), "thomas");
+    EXPECT_EQ(db.get_uid_from_username("thomas"), user1->get_uid());
+    EXPECT_FALSE(db.get_uid_from_username("thomask").has_value());
+
+    User::SharedPtr user3 = std::make_shared<User>("thomask", "Thomas");
+    EXPECT_TRUE(std::holds_alternative<std::monostate>(db.add_user(user3)));
+}
+
+TEST(UserTableTest, ConcurrentRegistrationsClaimUsernameOnce) {
+    UserTable db;
+    std::atomic<int> successes = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&db, &successes]() {
+            User::SharedPtr user = std::make_shared<User>("contested", "Contested");
+            if (std::holds_alternative<std::monostate>(db.add_user(user))) {
+                successes++;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(successes, 1);
+}
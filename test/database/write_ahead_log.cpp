@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+#include "server/db/database.hpp"
+#include "server/db/write_ahead_log.hpp"
+
+namespace {
+
+/**
+ * A log file in the temporary directory that is removed when the test ends.
+ */
+class TempLog {
+   public:
+    explicit TempLog(const std::string& name)
+        : path((std::filesystem::temp_directory_path() /
+                (name + "-" + std::to_string(::getpid()) + ".wal"))
+                   .string()) {
+        std::filesystem::remove(this->path);
+    }
+    ~TempLog() { std::filesystem::remove(this->path); }
+
+    const std::string path;
+};
+
+std::vector<std::string> replay_strings(const std::string& path) {
+    std::vector<std::string> values;
+    auto res = WriteAheadLog::replay(path, [&values](LogRecordType type, ByteReader& reader) {
+        EXPECT_EQ(type, LogRecordType::SET_USERNAME);
+        values.push_back(LogRecord::read_string(reader));
+    });
+    EXPECT_TRUE(std::holds_alternative<size_t>(res));
+    return values;
+}
+
+void append_strings(const std::string& path, int first, int last) {
+    WriteAheadLog wal(path, SyncPolicy::COMMIT);
+    for (int i = first; i < last; i++) {
+        wal.wait_durable(wal.append(
+            LogRecord(LogRecordType::SET_USERNAME).put_string("record" + std::to_string(i))));
+    }
+}
+
+}  // namespace
+
+TEST(WriteAheadLogTest, ReplaysRecordsInOrder) {
+    TempLog log("replay-order");
+    append_strings(log.path, 0, 50);
+    append_strings(log.path, 50, 100);
+
+    std::vector<std::string> values = replay_strings(log.path);
+    ASSERT_EQ(values.size(), 100);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(values[i], "record" + std::to_string(i));
+    }
+}
+
+TEST(WriteAheadLogTest, MissingLogIsEmpty) {
+    TempLog log("missing");
+    auto res = WriteAheadLog::replay(log.path, [](LogRecordType, ByteReader&) { FAIL(); });
+    ASSERT_TRUE(std::holds_alternative<size_t>(res));
+    EXPECT_EQ(std::get<size_t>(res), 0);
+}
+
+TEST(WriteAheadLogTest, DiscardsTornTail) {
+    TempLog log("torn-tail");
+    append_strings(log.path, 0, 10);
+    uintmax_t complete = std::filesystem::file_size(log.path);
+    append_strings(log.path, 10, 11);
+
+    // Cut the last record short, as a crash in the middle of a write would
+    std::filesystem::resize_file(log.path, std::filesystem::file_size(log.path) - 3);
+    EXPECT_EQ(replay_strings(log.path).size(), 10);
+    EXPECT_EQ(std::filesystem::file_size(log.path), complete);
+
+    // New records follow the last complete one
+    append_strings(log.path, 10, 12);
+    std::vector<std::string> values = replay_strings(log.path);
+    ASSERT_EQ(values.size(), 12);
+    EXPECT_EQ(values.back(), "record11");
+}
+
+TEST(WriteAheadLogTest, DiscardsCorruptLastRecord) {
+    TempLog log("corrupt-last");
+    append_strings(log.path, 0, 5);
+    uintmax_t intact = std::filesystem::file_size(log.path);
+    append_strings(log.path, 5, 6);
+
+    {
+        std::fstream file(log.path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(intact + 12);
+        file.put('X');
+    }
+    EXPECT_EQ(replay_strings(log.path).size(), 5);
+    EXPECT_EQ(std::filesystem::file_size(log.path), intact);
+}
+
+TEST(WriteAheadLogTest, DiscardsZerosAfterLastRecord) {
+    TempLog log("zero-tail");
+    append_strings(log.path, 0, 5);
+    uintmax_t complete = std::filesystem::file_size(log.path);
+
+    // The file was extended, but its data never reached the disk
+    std::filesystem::resize_file(log.path, complete + 4096);
+    EXPECT_EQ(replay_strings(log.path).size(), 5);
+    EXPECT_EQ(std::filesystem::file_size(log.path), complete);
+}
+
+TEST(WriteAheadLogTest, RefusesCorruptRecordBeforeTheEnd) {
+    TempLog log("corrupt");
+    append_strings(log.path, 0, 5);
+    uintmax_t intact = std::filesystem::file_size(log.path);
+    append_strings(log.path, 5, 10);
+    uintmax_t size = std::filesystem::file_size(log.path);
+
+    for (int offset : {12, 0}) {
+        // A changed byte, then a record read back as zeros, with records after each
+        {
+            std::fstream file(log.path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(intact + offset);
+            file.write(offset == 0 ? "\0\0\0\0" : "X", offset == 0 ? 4 : 1);
+        }
+        auto res = WriteAheadLog::replay(log.path, [](LogRecordType, ByteReader&) {});
+        EXPECT_TRUE(std::holds_alternative<std::string>(res));
+        EXPECT_EQ(std::filesystem::file_size(log.path), size);
+    }
+}
+
+TEST(WriteAheadLogTest, GroupsConcurrentCommits) {
+    TempLog log("concurrent");
+    {
+        WriteAheadLog wal(log.path, SyncPolicy::COMMIT, std::chrono::microseconds(200));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; t++) {
+            threads.emplace_back([&wal, t]() {
+                for (int i = 0; i < 100; i++) {
+                    wal.wait_durable(wal.append(LogRecord(LogRecordType::SET_USERNAME)
+                                                    .put_string(std::to_string(t * 100 + i))));
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::vector<std::string> values = replay_strings(log.path);
+    ASSERT_EQ(values.size(), 800);
+    std::vector<bool> seen(800);
+    for (const std::string& value : values) {
+        seen[std::stoi(value)] = true;
+    }
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), true), 800);
+}
+
+TEST(WriteAheadLogTest, RebuildsDatabase) {
+    TempLog log("database");
+    User::SharedPtr alice = std::make_shared<User>("walalice", "Alice");
+    User::SharedPtr bob = std::make_shared<User>("walbob", "Bob");
+    User::SharedPtr carol = std::make_shared<User>("walcarol", "Carol");
+    UUID channel_uid;
+    uint64_t kept, removed;
+    {
+        Database db;
+        ASSERT_TRUE(std::holds_alternative<size_t>(db.open_log(log.path, SyncPolicy::NONE)));
+        db.add_user(alice, "alicepass");
+        db.add_user(bob, "bobpass");
+        db.add_user(carol, "carolpass");
+        Channel::SharedPtr channel = std::get<Channel::SharedPtr>(
+            db.add_channel("general", {alice->get_uid(), bob->get_uid()}));
+        channel_uid = channel->get_uid();
+        db.add_user_to_channel(carol->get_uid(), channel_uid);
+        auto hi = db.add_message(alice->get_uid(), channel_uid, "hi");
+        kept = std::get<Message::SharedPtr>(hi)->get_snowflake();
+        auto oops = db.add_message(bob->get_uid(), channel_uid, "oops");
+        removed = std::get<Message::SharedPtr>(oops)->get_snowflake();
+        db.remove_message(removed);
+        db.set_username(bob->get_uid(), "walrobert");
+        db.remove_user(carol->get_uid());
+    }
+
+    Database db;
+    auto replayed = db.open_log(log.path, SyncPolicy::NONE);
+    ASSERT_TRUE(std::holds_alternative<size_t>(replayed));
+    EXPECT_EQ(std::get<size_t>(replayed), 10);
+
+    UUID alice_uid = alice->get_uid();
+    EXPECT_TRUE(std::get<bool>(db.verify_password(alice_uid, "alicepass")));
+    EXPECT_FALSE(std::get<bool>(db.verify_password(alice_uid, "bobpass")));
+    auto bob_copy = db.get_user_by_uid(bob->get_uid());
+    ASSERT_TRUE(bob_copy.has_value());
+    EXPECT_EQ(bob_copy.value()->get_username(), "walrobert");
+    EXPECT_EQ(bob_copy.value()->get_display_name(), "Bob");
+    EXPECT_FALSE(db.get_user_by_uid(carol->get_uid()).has_value());
+
+    auto channel = db.get_channel_by_uid(channel_uid);
+    ASSERT_TRUE(channel.has_value());
+    EXPECT_EQ(channel.value()->get_name(), "general");
+    EXPECT_EQ(channel.value()->get_user_uids(),
+              (std::vector<UUID>{alice->get_uid(), bob->get_uid()}));
+    EXPECT_EQ(channel.value()->get_message_snowflakes(), (std::vector<uint64_t>{kept}));
+
+    auto message = db.get_message_by_uid(kept);
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ(message.value()->get_text(), "hi");
+    EXPECT_EQ(message.value()->get_sender_id(), alice->get_uid());
+    EXPECT_FALSE(db.get_message_by_uid(removed).has_value());
+
+    // The log can only be opened once
+    EXPECT_TRUE(std::holds_alternative<std::string>(db.open_log(log.path, SyncPolicy::NONE)));
+}
+
+TEST(WriteAheadLogDeathTest, AbortsOnceWritingFails) {
+    // Every write to /dev/full fails, as if the disk were full
+    if (!std::filesystem::exists("/dev/full")) {
+        GTEST_SKIP() << "/dev/full is not available";
+    }
+    // The log and the logger run threads of their own
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+
+    // Changes are visible once applied, so the server must not go on without logging them
+    EXPECT_DEATH(
+        {
+            Database db;
+            db.open_log("/dev/full", SyncPolicy::COMMIT);
+            db.add_user(std::make_shared<User>("walfullalice", "Alice"), "walpass");
+        },
+        "Failed to write the write-ahead log");
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+#include "message/byte_reader.hpp"
+#include "message/header.hpp"
+#include "message/wire_format.hpp"
+#include "models/uuid.hpp"
+
+TEST(ByteReaderTest, ReadsIntegers) {
+    std::vector<uint8_t> buf = {0x7f, 0x12, 0x34, 0, 0, 0, 0, 0, 0, 0x01, 0x02};
+    ByteReader reader(buf);
+
+    EXPECT_EQ(reader.read_u8(), 0x7f);
+    EXPECT_EQ(reader.read_u16_be(), 0x1234);
+    EXPECT_EQ(reader.read_u64_be(), 0x0102);
+    EXPECT_EQ(reader.remaining(), 0);
+    EXPECT_EQ(reader.get_offset(), buf.size());
+}
+
+TEST(ByteReaderTest, ReadsStringsInPlace) {
+    std::vector<uint8_t> buf = {5, 'h', 'e', 'l', 'l', 'o', 'w', 'o', 'r', 'l', 'd'};
+    ByteReader reader(buf);
+
+    std::string_view hello = reader.read_prefixed_string();
+    EXPECT_EQ(hello, "hello");
+    EXPECT_EQ(reinterpret_cast<const uint8_t*>(hello.data()), buf.data() + 1);
+
+    std::span<const uint8_t> rest = reader.read_remaining();
+    EXPECT_EQ(rest.size(), 5);
+    EXPECT_EQ(rest.data(), buf.data() + 6);
+}
+
+TEST(ByteReaderTest, ThrowsPastEndWithoutAdvancing) {
+    std::vector<uint8_t> buf = {10, 'a', 'b'};
+    ByteReader reader(buf);
+
+    EXPECT_THROW(reader.read_prefixed_string(), std::out_of_range);
+    EXPECT_EQ(reader.get_offset(), 0);
+    EXPECT_THROW(reader.read_u64_native(), std::out_of_range);
+    EXPECT_EQ(reader.read_u8(), 10);
+}
+
+TEST(ByteReaderTest, DecodesConsecutiveObjects) {
+    UUID first;
+    UUID second;
+    Header header(1, Operation::LOGIN, 42);
+
+    std::vector<uint8_t> buf;
+    header.serialize(buf);
+    first.serialize(buf);
+    second.serialize(buf);
+
+    ByteReader reader(buf);
+    Header decoded_header;
+    decoded_header.deserialize(reader);
+    EXPECT_EQ(decoded_header.get_operation(), Operation::LOGIN);
+    EXPECT_EQ(decoded_header.get_packet_length(), 42);
+    EXPECT_EQ(UUID::from_reader(reader), first);
+    EXPECT_EQ(UUID::from_reader(reader), second);
+    EXPECT_EQ(reader.remaining(), 0);
+}
+
+TEST(ByteReaderTest, TruncatedUUIDThrows) {
+    UUID uuid;
+    std::vector<uint8_t> buf;
+    uuid.serialize(buf);
+    buf.pop_back();
+
+    UUID decoded;
+    EXPECT_THROW(decoded.deserialize(buf), std::out_of_range);
+}
+
+TEST(ByteReaderTest, RoundTripsVarints) {
+    std::vector<uint64_t> values = {0, 1, 127, 128, 300, 16384, UINT32_MAX, UINT64_MAX};
+    std::vector<uint8_t> buf;
+    for (uint64_t value : values) {
+        size_t before = buf.size();
+        write_varint(buf, value);
+        EXPECT_EQ(buf.size() - before, varint_size(value));
+    }
+    EXPECT_EQ(varint_size(127), 1);
+    EXPECT_EQ(varint_size(128), 2);
+    EXPECT_EQ(varint_size(UINT64_MAX), ByteReader::MAX_VARINT_SIZE);
+
+    ByteReader reader(buf);
+    for (uint64_t value : values) {
+        EXPECT_EQ(reader.read_varint(), value);
+    }
+    EXPECT_EQ(reader.remaining(), 0);
+}
+
+TEST(ByteReaderTest, TruncatedVarintThrowsWithoutAdvancing) {
+    std::vector<uint8_t> buf = {0x80, 0x80};
+    ByteReader reader(buf);
+
+    EXPECT_THROW(reader.read_varint(), std::out_of_range);
+    EXPECT_EQ(reader.get_offset(), 0);
+}
+
+TEST(ByteReaderTest, ReadsLengthsInTheReadersVersion) {
+    std::vector<uint8_t> buf = {0x00, 0x03, 'a', 'b', 'c'};
+
+    ByteReader legacy(buf, PROTOCOL_VERSION_CUSTOM);
+    EXPECT_EQ(legacy.read_length(2), 3);
+    EXPECT_EQ(legacy.get_offset(), 2);
+
+    ByteReader varint(buf, PROTOCOL_VERSION_VARINT);
+    EXPECT_EQ(varint.read_length(2), 0);
+    EXPECT_EQ(varint.get_offset(), 1);
+}
+
+TEST(ByteReaderTest, RoundTripsLongStrings) {
+    std::string text(300, 'x');
+    std::vector<uint8_t> buf;
+    write_prefixed_string(buf, text, PROTOCOL_VERSION_VARINT);
+    EXPECT_EQ(buf.size(), 2 + text.size());
+    EXPECT_EQ(buf.size(), prefixed_string_size(text, PROTOCOL_VERSION_VARINT));
+
+    ByteReader reader(buf, PROTOCOL_VERSION_VARINT);
+    EXPECT_EQ(reader.read_prefixed_string(), text);
+
+    // A length longer than the buffer is rejected before anything is read
+    buf.pop_back();
+    ByteReader truncated(buf, PROTOCOL_VERSION_VARINT);
+    EXPECT_THROW(truncated.read_prefixed_string(), std::out_of_range);
+    EXPECT_EQ(truncated.get_offset(), 0);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/codec.hpp"
+#include "message/header.hpp"
+#include "message/login.hpp"
+#include "message/send_message_response.hpp"
+#include "models/message.hpp"
+
+TEST(CodecTest, SelectsCodecByVersion) {
+    for (uint8_t version :
+         {PROTOCOL_VERSION_CUSTOM, PROTOCOL_VERSION_JSON, PROTOCOL_VERSION_VARINT}) {
+        EXPECT_EQ(Codec::for_version(version).get_version(), version);
+    }
+    EXPECT_THROW((void)Codec::for_version(0), std::out_of_range);
+    EXPECT_THROW((void)Codec::for_version(15), std::out_of_range);
+}
+
+TEST(CodecTest, JsonRoundTrip) {
+    LoginMessage message("username", "password");
+    std::vector<uint8_t> buf;
+    message.serialize(buf, PROTOCOL_VERSION_JSON);
+
+    EXPECT_EQ(std::string(buf.begin(), buf.end()), message.to_json());
+    EXPECT_EQ(buf.size(), message.size(PROTOCOL_VERSION_JSON));
+
+    LoginMessage deserialized;
+    deserialized.deserialize(buf, PROTOCOL_VERSION_JSON);
+    EXPECT_EQ(deserialized.get_username(), "username");
+    EXPECT_EQ(deserialized.get_password(), "password");
+}
+
+TEST(CodecTest, SameMessageInEveryVersion) {
+    SendMessageResponse response(
+        std::make_shared<Message>(UUID(), UUID(), "hello from either protocol"));
+    for (uint8_t version :
+         {PROTOCOL_VERSION_CUSTOM, PROTOCOL_VERSION_JSON, PROTOCOL_VERSION_VARINT}) {
+        std::vector<uint8_t> buf;
+        response.serialize_msg(buf, version);
+
+        Header header;
+        header.deserialize(buf);
+        EXPECT_EQ(header.get_version(), version);
+        EXPECT_EQ(header.get_packet_length(), buf.size() - header.size());
+        EXPECT_EQ(header.get_packet_length(), response.size(version));
+
+        SendMessageResponse deserialized;
+        deserialized.deserialize(std::span<const uint8_t>(buf).subspan(header.size()), version);
+        ASSERT_TRUE(deserialized.get_data().has_value());
+        EXPECT_EQ((*deserialized.get_data())->get_text(), "hello from either protocol");
+    }
+}
+
+TEST(CodecTest, RejectsMalformedJson) {
+    std::string json = R"({"username":"username")";
+    std::vector<uint8_t> buf(json.begin(), json.end());
+    LoginMessage message;
+    EXPECT_THROW(message.deserialize(buf, PROTOCOL_VERSION_JSON), std::out_of_range);
+
+    json = R"({"username":"username"})";
+    buf.assign(json.begin(), json.end());
+    EXPECT_THROW(message.deserialize(buf, PROTOCOL_VERSION_JSON), std::out_of_range);
+}
+
+TEST(CodecTest, EntrySizes) {
+    Message message(UUID(), UUID(), "plain text");
+    EXPECT_EQ(Codec::for_version(PROTOCOL_VERSION_VARINT).entry_size(message),
+              message.size(PROTOCOL_VERSION_VARINT));
+    // Embedded as an escaped string, so every quote grows by a backslash, plus a comma
+    std::string json = message.to_json();
+    size_t quotes = std::count(json.begin(), json.end(), '"');
+    EXPECT_EQ(Codec::for_version(PROTOCOL_VERSION_JSON).entry_size(message),
+              json.size() + quotes + 2 + 1);
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/fetch_history.hpp"
+#include "message/fetch_history_response.hpp"
+#include "message/header.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+
+TEST(FetchHistoryMessageTest, SerializesBounds) {
+    UUID channel_uid;
+    FetchHistoryMessage message(channel_uid, 0x0123456789abcdefULL, 42, 50);
+
+    std::vector<uint8_t> buf;
+    message.serialize_msg(buf);
+
+    Header header;
+    header.deserialize(std::vector<uint8_t>(buf.begin(), buf.begin() + header.size()));
+    EXPECT_EQ(header.get_version(), PROTOCOL_VERSION);
+    EXPECT_EQ(header.get_operation(), Operation::FETCH_HISTORY);
+    EXPECT_EQ(header.get_packet_length(), buf.size() - header.size());
+
+    FetchHistoryMessage deserialized;
+    deserialized.deserialize(std::vector<uint8_t>(buf.begin() + header.size(), buf.end()));
+    EXPECT_EQ(deserialized.get_channel_uid(), channel_uid);
+    EXPECT_EQ(deserialized.get_before(), 0x0123456789abcdefULL);
+    EXPECT_EQ(deserialized.get_after(), 42);
+    EXPECT_EQ(deserialized.get_limit(), 50);
+}
+
+TEST(FetchHistoryResponseTest, SerializesPage) {
+    User user("historyuser", "History User");
+    HistoryPage page;
+    page.channel_uid = UUID();
+    for (int i = 0; i < 3; i++) {
+        page.messages.push_back(
+            std::make_shared<Message>(user.get_uid(), page.channel_uid, "message"));
+    }
+    page.has_more = true;
+    FetchHistoryResponse response(page);
+
+    std::vector<uint8_t> buf;
+    response.serialize(buf);
+    EXPECT_EQ(buf.size(), response.size());
+    EXPECT_LE(response.size(), FetchHistoryResponse::empty_size() +
+                                   3 * FetchHistoryResponse::entry_size(page.messages[0]));
+
+    FetchHistoryResponse deserialized;
+    deserialized.deserialize(buf);
+    ASSERT_TRUE(deserialized.is_success());
+    HistoryPage copy = deserialized.get_page().value();
+    EXPECT_EQ(copy.channel_uid, page.channel_uid);
+    ASSERT_EQ(copy.messages.size(), 3);
+    for (size_t i = 0; i < copy.messages.size(); i++) {
+        EXPECT_EQ(copy.messages[i]->get_snowflake(), page.messages[i]->get_snowflake());
+        EXPECT_EQ(copy.messages[i]->get_text(), "message");
+    }
+    EXPECT_TRUE(copy.has_more);
+}
+
+TEST(FetchHistoryResponseTest, SerializesError) {
+    FetchHistoryResponse response("Not a member of the channel");
+
+    std::vector<uint8_t> buf;
+    response.serialize(buf);
+
+    FetchHistoryResponse deserialized;
+    deserialized.deserialize(buf);
+    ASSERT_FALSE(deserialized.is_success());
+    EXPECT_EQ(deserialized.get_error_message().value(), "Not a member of the channel");
+}
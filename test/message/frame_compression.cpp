@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/frame_compression.hpp"
+#include "message/frame_decoder.hpp"
+#include "message/header.hpp"
+#include "message/list_accounts_response.hpp"
+#include "message/login.hpp"
+#include "models/user.hpp"
+
+static ListAccountsResponse make_response(size_t n) {
+    std::vector<User::SharedPtr> users;
+    for (size_t i = 0; i < n; i++) {
+        users.push_back(std::make_shared<User>("user" + std::to_string(i), "Display Name"));
+    }
+    return ListAccountsResponse(users);
+}
+
+TEST(FrameCompressionTest, CompressesLargeFrames) {
+    ListAccountsResponse response = make_response(32);
+    std::vector<uint8_t> original;
+    response.serialize_msg(original);
+    std::vector<uint8_t> buf = original;
+
+    ASSERT_TRUE(FrameCompressor::compress_frame(buf));
+    EXPECT_LT(buf.size(), original.size() / 2);
+
+    Header header;
+    header.deserialize(buf);
+    EXPECT_TRUE(header.is_compressed());
+    EXPECT_EQ(header.get_operation(), Operation::LIST_ACCOUNTS);
+    EXPECT_EQ(header.get_packet_length(), buf.size() - header.size());
+
+    std::vector<uint8_t> payload = FrameCompressor::decompress(
+        std::span<const uint8_t>(buf).subspan(header.size()), Header::MAX_PACKET_LENGTH);
+    EXPECT_EQ(payload, std::vector<uint8_t>(original.begin() + header.size(), original.end()));
+}
+
+TEST(FrameCompressionTest, LeavesSmallFramesAlone) {
+    LoginMessage login("username", "password");
+    std::vector<uint8_t> original;
+    login.serialize_msg(original);
+    std::vector<uint8_t> buf = original;
+
+    EXPECT_FALSE(FrameCompressor::compress_frame(buf));
+    EXPECT_EQ(buf, original);
+}
+
+TEST(FrameCompressionTest, CompressesFrameAtOffset) {
+    std::vector<uint8_t> buf = {0xFF, 0xFF};
+    make_response(32).serialize_msg(buf);
+
+    ASSERT_TRUE(FrameCompressor::compress_frame(buf, 2));
+    EXPECT_EQ(buf[0], 0xFF);
+    EXPECT_EQ(buf[1], 0xFF);
+    Header header;
+    header.deserialize(std::span<const uint8_t>(buf).subspan(2));
+    EXPECT_TRUE(header.is_compressed());
+}
+
+TEST(FrameCompressionTest, RejectsCorruptPayloads) {
+    std::vector<uint8_t> buf;
+    make_response(32).serialize_msg(buf);
+    ASSERT_TRUE(FrameCompressor::compress_frame(buf));
+    Header header;
+    header.deserialize(buf);
+    std::vector<uint8_t> payload(buf.begin() + header.size(), buf.end());
+
+    // The announced length is checked before anything is inflated
+    EXPECT_THROW(FrameCompressor::decompress(payload, 16), std::out_of_range);
+
+    std::vector<uint8_t> truncated(payload.begin(), payload.end() - 4);
+    EXPECT_THROW(FrameCompressor::decompress(truncated, Header::MAX_PACKET_LENGTH),
+                 std::out_of_range);
+
+    std::vector<uint8_t> garbage = {0x00, 0x00, 0x01, 0x00, 0xFF, 0xFF, 0xFF, 0xFF};
+    EXPECT_THROW(FrameCompressor::decompress(garbage, Header::MAX_PACKET_LENGTH),
+                 std::out_of_range);
+}
+
+TEST(FrameCompressionTest, DecoderDecompressesFrames) {
+    ListAccountsResponse response = make_response(32);
+    std::vector<uint8_t> buf;
+    response.serialize_msg(buf);
+    size_t payload_length = response.size();
+    ASSERT_TRUE(FrameCompressor::compress_frame(buf));
+
+    FrameDecoder decoder;
+    decoder.feed(buf.data(), buf.size());
+    auto frame = decoder.next();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_FALSE(frame->header.is_compressed());
+    EXPECT_EQ(frame->header.get_packet_length(), payload_length);
+    EXPECT_EQ(frame->payload.size(), payload_length);
+
+    ListAccountsResponse decoded;
+    decoded.deserialize(frame->payload);
+    ASSERT_TRUE(decoded.get_users().has_value());
+    EXPECT_EQ(decoded.get_users()->size(), 32);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "constants.hpp"
+#include "message/frame_decoder.hpp"
+#include "message/header.hpp"
+#include "message/list_accounts.hpp"
+
+static std::vector<uint8_t> make_frame(Operation operation, std::vector<uint8_t> payload) {
+    std::vector<uint8_t> buf;
+    Header header(PROTOCOL_VERSION, operation, payload.size());
+    header.serialize(buf);
+    buf.insert(buf.end(), payload.begin(), payload.end());
+    return buf;
+}
+
+TEST(FrameDecoderTest, DecodesSingleFrame) {
+    FrameDecoder decoder;
+    std::vector<uint8_t> buf = make_frame(Operation::LOGIN, {1, 2, 3});
+    decoder.feed(buf.data(), buf.size());
+
+    auto frame = decoder.next();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->header.get_operation(), Operation::LOGIN);
+    EXPECT_EQ(frame->payload, std::vector<uint8_t>({1, 2, 3}));
+    EXPECT_FALSE(decoder.next().has_value());
+    EXPECT_EQ(decoder.buffered(), 0);
+}
+
+TEST(FrameDecoderTest, WaitsForPartialFrame) {
+    FrameDecoder decoder;
+    std::vector<uint8_t> buf = make_frame(Operation::SEND_MESSAGE, {1, 2, 3, 4, 5});
+
+    // Feed one byte at a time; the frame completes only with the last byte
+    for (size_t i = 0; i + 1 < buf.size(); i++) {
+        decoder.feed(&buf[i], 1);
+        EXPECT_FALSE(decoder.next().has_value());
+    }
+    decoder.feed(&buf.back(), 1);
+
+    auto frame = decoder.next();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->header.get_operation(), Operation::SEND_MESSAGE);
+    EXPECT_EQ(frame->payload, std::vector<uint8_t>({1, 2, 3, 4, 5}));
+}
+
+TEST(FrameDecoderTest, DecodesManyFramesFromOneRead) {
+    FrameDecoder decoder;
+    std::vector<uint8_t> buf;
+    for (uint8_t i = 0; i < 10; i++) {
+        std::vector<uint8_t> frame = make_frame(Operation::LIST_ACCOUNTS, {i, i});
+        buf.insert(buf.end(), frame.begin(), frame.end());
+    }
+    decoder.feed(buf.data(), buf.size());
+
+    for (uint8_t i = 0; i < 10; i++) {
+        auto frame = decoder.next();
+        ASSERT_TRUE(frame.has_value());
+        EXPECT_EQ(frame->payload, std::vector<uint8_t>({i, i}));
+    }
+    EXPECT_FALSE(decoder.next().has_value());
+}
+
+TEST(FrameDecoderTest, DecodesEmptyPayload) {
+    FrameDecoder decoder;
+    std::vector<uint8_t> buf = make_frame(Operation::DELETE_ACCOUNT, {});
+    decoder.feed(buf.data(), buf.size());
+
+    auto frame = decoder.next();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_TRUE(frame->payload.empty());
+}
+
+TEST(FrameDecoderTest, WrapsAroundRingBuffer) {
+    FrameDecoder decoder(16);
+    for (uint8_t i = 0; i < 100; i++) {
+        std::vector<uint8_t> buf = make_frame(Operation::LOGIN, {i, 1, 2, 3, 4, 5, 6});
+        decoder.feed(buf.data(), buf.size());
+        auto frame = decoder.next();
+        ASSERT_TRUE(frame.has_value());
+        EXPECT_EQ(frame->payload, std::vector<uint8_t>({i, 1, 2, 3, 4, 5, 6}));
+    }
+}
+
+TEST(FrameDecoderTest, GrowsForLargeFrames) {
+    FrameDecoder decoder(16);
+    std::vector<uint8_t> first = make_frame(Operation::LOGIN, {1, 2, 3});
+    decoder.feed(first.data(), 5);
+
+    std::vector<uint8_t> payload(1000);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = i % 256;
+    }
+    std::vector<uint8_t> second = make_frame(Operation::SEND_MESSAGE, payload);
+    std::vector<uint8_t> rest(first.begin() + 5, first.end());
+    rest.insert(rest.end(), second.begin(), second.end());
+    decoder.feed(rest.data(), rest.size());
+
+    auto frame = decoder.next();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->payload, std::vector<uint8_t>({1, 2, 3}));
+    frame = decoder.next();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->payload, payload);
+}
+
+TEST(FrameDecoderTest, DecodesSerializedMessage) {
+    FrameDecoder decoder;
+    ListAccountsMessage message("^user.*$");
+    std::vector<uint8_t> buf;
+    message.serialize_msg(buf);
+    decoder.feed(buf.data(), buf.size());
+
+    auto frame = decoder.next();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->header.get_operation(), Operation::LIST_ACCOUNTS);
+    ListAccountsMessage deserialized;
+    deserialized.deserialize(frame->payload);
+    EXPECT_EQ(deserialized.get_regex(), "^user.*$");
+}
+
+TEST(FrameDecoderTest, DecodesHeadersOfEitherWidth) {
+    FrameDecoder decoder;
+    std::vector<uint8_t> buf;
+    Header(PROTOCOL_VERSION_CUSTOM, Operation::LOGIN, 2).serialize(buf);
+    buf.insert(buf.end(), {1, 2});
+    Header(PROTOCOL_VERSION_VARINT, Operation::SYNC, 3).serialize(buf);
+    buf.insert(buf.end(), {3, 4, 5});
+    decoder.feed(buf.data(), buf.size());
+
+    auto frame = decoder.next();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->header.get_version(), PROTOCOL_VERSION_CUSTOM);
+    EXPECT_EQ(frame->payload, std::vector<uint8_t>({1, 2}));
+    frame = decoder.next();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->header.get_version(), PROTOCOL_VERSION_VARINT);
+    EXPECT_EQ(frame->payload, std::vector<uint8_t>({3, 4, 5}));
+}
+
+TEST(FrameDecoderTest, RejectsFrameLongerThanItsVersionAllows) {
+    FrameDecoder decoder;
+    std::vector<uint8_t> buf;
+    Header(PROTOCOL_VERSION_VARINT, Operation::SYNC, Header::MAX_PACKET_LENGTH + 1).serialize(buf);
+    decoder.feed(buf.data(), buf.size());
+
+    EXPECT_THROW(decoder.next(), std::out_of_range);
+}
@@ -2,6 +2,7 @@
 
 #include "constants.hpp"
 #include "message/header.hpp"
+#include "message/login.hpp"
 
 TEST(HeaderTest, ConstructsValidHeader) {
     Header header(1, Operation::REGISTER_ACCOUNT, 10);
@@ -35,4 +36,79 @@ TEST(HeaderTest, HeaderDeserializesProperly) {
     EXPECT_EQ(header.get_version(), 1);
     EXPECT_EQ(header.get_operation(), Operation::DELETE_MESSAGE);
     EXPECT_EQ(header.get_packet_length(), 10);
-}
\ No newline at end of file
+}
+
+TEST(HeaderTest, SerializesFrameInOnePass) {
+    LoginMessage login("username", "password");
+    std::vector<uint8_t> expected;
+    Header(PROTOCOL_VERSION, Operation::LOGIN, login.size()).serialize(expected);
+    login.serialize(expected);
+
+    std::vector<uint8_t> buf = {0xFF};
+    Header::serialize_frame(Operation::LOGIN, login, buf);
+
+    EXPECT_EQ(std::vector<uint8_t>(buf.begin() + 1, buf.end()), expected);
+
+    Header header;
+    header.deserialize(std::span<const uint8_t>(buf).subspan(1));
+    EXPECT_EQ(header.get_operation(), Operation::LOGIN);
+    EXPECT_EQ(header.get_packet_length(), buf.size() - 1 - header.size());
+}
+
+TEST(HeaderTest, ReusedFrameBufferKeepsItsCapacity) {
+    LoginMessage login("username", "password");
+    std::vector<uint8_t> buf;
+    Header::serialize_frame(Operation::LOGIN, login, buf);
+    const uint8_t* data = buf.data();
+
+    for (int i = 0; i < 10; i++) {
+        buf.clear();
+        Header::serialize_frame(Operation::LOGIN, login, buf);
+    }
+    EXPECT_EQ(buf.data(), data);
+}
+
+TEST(HeaderTest, VarintHeaderCarriesThirtyTwoBitLength) {
+    Header header(PROTOCOL_VERSION_VARINT, Operation::SYNC, 100000);
+    std::vector<uint8_t> buf;
+    header.serialize(buf);
+
+    ASSERT_EQ(buf.size(), 6);  // 1 byte for version, 1 byte for operation, 4 bytes for length
+    EXPECT_EQ(buf[0], (PROTOCOL_VERSION_VARINT << 4) | 6);
+    EXPECT_EQ(std::vector<uint8_t>(buf.begin() + 2, buf.end()),
+              std::vector<uint8_t>({0x00, 0x01, 0x86, 0xA0}));
+
+    Header decoded;
+    decoded.deserialize(buf);
+    EXPECT_EQ(decoded.get_version(), PROTOCOL_VERSION_VARINT);
+    EXPECT_EQ(decoded.get_operation(), Operation::SYNC);
+    EXPECT_EQ(decoded.get_packet_length(), 100000);
+    EXPECT_EQ(decoded.size(), 6);
+}
+
+TEST(HeaderTest, SerializesFrameInRequestedVersion) {
+    LoginMessage login("username", "password");
+    std::vector<uint8_t> buf;
+    Header::serialize_frame(Operation::LOGIN, login, buf, PROTOCOL_VERSION_CUSTOM);
+
+    Header header;
+    header.deserialize(buf);
+    EXPECT_EQ(header.get_version(), PROTOCOL_VERSION_CUSTOM);
+    EXPECT_EQ(header.size(), 4);
+    EXPECT_EQ(header.get_packet_length(), buf.size() - 4);
+}
+
+TEST(HeaderTest, CarriesCompressedFlag) {
+    Header header(PROTOCOL_VERSION_CUSTOM, Operation::SYNC, 10);
+    header.set_compressed(true);
+    std::vector<uint8_t> buf;
+    header.serialize(buf);
+
+    EXPECT_EQ(buf[0], (PROTOCOL_VERSION_CUSTOM << 4) | Header::COMPRESSED_FLAG | 4);
+
+    Header decoded;
+    decoded.deserialize(buf);
+    EXPECT_TRUE(decoded.is_compressed());
+    EXPECT_EQ(decoded.size(), 4);
+    EXPECT_EQ(decoded.get_packet_length(), 10);
+}
@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/header.hpp"
+#include "message/hello.hpp"
+
+TEST(HelloMessageTest, SerializesFeatures) {
+    HelloMessage message(HelloMessage::FEATURE_COMPRESSION);
+
+    std::vector<uint8_t> buf;
+    message.serialize_msg(buf);
+
+    Header header;
+    header.deserialize(std::vector<uint8_t>(buf.begin(), buf.begin() + header.size()));
+    EXPECT_EQ(header.get_operation(), Operation::HELLO);
+    EXPECT_EQ(header.get_packet_length(), buf.size() - header.size());
+
+    HelloMessage deserialized;
+    deserialized.deserialize(std::vector<uint8_t>(buf.begin() + header.size(), buf.end()));
+    EXPECT_EQ(deserialized.get_features(), HelloMessage::FEATURE_COMPRESSION);
+    EXPECT_TRUE(deserialized.has_feature(HelloMessage::FEATURE_COMPRESSION));
+}
+
+TEST(HelloMessageTest, DefaultsToNoFeatures) {
+    HelloMessage message;
+    EXPECT_EQ(message.get_features(), 0);
+    EXPECT_FALSE(message.has_feature(HelloMessage::FEATURE_COMPRESSION));
+}
@@ -68,3 +68,19 @@ TEST(ListAccountsMessageTest, TestSizeWithEmptyRegex) {
     size_t serialized_size = message.size();
     ASSERT_GT(serialized_size, 0);  // Ensure the size is greater than 0, even with an empty regex
 }
+
+// Test case for serializing and deserializing the pagination fields
+TEST(ListAccountsMessageTest, TestSerializationWithLimitAndCursor) {
+    ListAccountsMessage message("user.*", 50, "user49");
+
+    std::vector<uint8_t> buf;
+    message.serialize(buf);
+    ASSERT_EQ(buf.size(), message.size());
+
+    ListAccountsMessage deserialized_message;
+    deserialized_message.deserialize(buf);
+
+    ASSERT_EQ(deserialized_message.get_regex(), "user.*");
+    ASSERT_EQ(deserialized_message.get_limit(), 50);
+    ASSERT_EQ(deserialized_message.get_cursor(), "user49");
+}
@@ -82,3 +82,45 @@ TEST(ListAccountsResponseTest, TestIsSuccessWithErrorMessage) {
     // Check if is_success() returns false when error message is present
     ASSERT_FALSE(response.is_success());
 }
+
+// Test case for serializing and deserializing the cursor of the next page
+TEST(ListAccountsResponseTest, TestSerializationWithNextCursor) {
+    User::SharedPtr user = std::make_shared<User>("username", "display_name");
+    ListAccountsResponse response(std::vector<User::SharedPtr>{user}, "username");
+
+    std::vector<uint8_t> buf;
+    response.serialize(buf);
+    ASSERT_EQ(buf.size(), response.size());
+
+    ListAccountsResponse deserialized_response;
+    deserialized_response.deserialize(buf);
+
+    ASSERT_EQ(deserialized_response.get_users().value().size(), 1);
+    ASSERT_EQ(deserialized_response.get_next_cursor(), "username");
+
+    // The last page has no cursor
+    ListAccountsResponse last_page(std::vector<User::SharedPtr>{user}, std::nullopt);
+    buf.clear();
+    last_page.serialize(buf);
+    deserialized_response.deserialize(buf);
+    ASSERT_FALSE(deserialized_response.get_next_cursor().has_value());
+}
+
+TEST(ListAccountsResponseTest, TestSerializationWithManyUsers) {
+    std::vector<User::SharedPtr> users;
+    for (int i = 0; i < 300; i++) {
+        users.push_back(std::make_shared<User>("user" + std::to_string(i), "display_name"));
+    }
+    ListAccountsResponse response(users);
+
+    std::vector<uint8_t> buf;
+    response.serialize(buf);
+    EXPECT_EQ(buf.size(), response.size());
+
+    ListAccountsResponse deserialized_response;
+    deserialized_response.deserialize(buf);
+    ASSERT_TRUE(deserialized_response.get_users().has_value());
+    std::vector<User::SharedPtr> deserialized_users = deserialized_response.get_users().value();
+    ASSERT_EQ(deserialized_users.size(), 300);
+    EXPECT_EQ(deserialized_users[299]->get_username(), "user299");
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/header.hpp"
+#include "message/sync.hpp"
+#include "message/sync_response.hpp"
+#include "models/channel.hpp"
+#include "models/message.hpp"
+#include "models/user.hpp"
+
+TEST(SyncMessageTest, SerializesWatermarkAndOffset) {
+    SyncMessage message(0x0123456789abcdefULL, 70000, 500);
+
+    std::vector<uint8_t> buf;
+    message.serialize_msg(buf);
+
+    Header header;
+    header.deserialize(std::vector<uint8_t>(buf.begin(), buf.begin() + header.size()));
+    EXPECT_EQ(header.get_version(), PROTOCOL_VERSION);
+    EXPECT_EQ(header.get_operation(), Operation::SYNC);
+    EXPECT_EQ(header.get_packet_length(), buf.size() - header.size());
+
+    SyncMessage deserialized;
+    deserialized.deserialize(std::vector<uint8_t>(buf.begin() + header.size(), buf.end()));
+    EXPECT_EQ(deserialized.get_since(), 0x0123456789abcdefULL);
+    EXPECT_EQ(deserialized.get_channel_offset(), 70000);
+    EXPECT_EQ(deserialized.get_limit(), 500);
+}
+
+TEST(SyncResponseTest, SerializesBatch) {
+    User user("syncuser", "Sync User");
+    auto channel = std::make_shared<Channel>("general", std::vector<UUID>{user.get_uid()});
+
+    SyncResponse::Batch batch;
+    batch.channels.push_back(channel);
+    for (int i = 0; i < 3; i++) {
+        batch.messages.push_back(
+            std::make_shared<Message>(user.get_uid(), channel->get_uid(), "message"));
+    }
+    batch.next_since = batch.messages.back()->get_snowflake();
+    batch.next_channel_offset = 1;
+    batch.has_more = true;
+    SyncResponse response(batch);
+
+    std::vector<uint8_t> buf;
+    response.serialize(buf);
+    EXPECT_EQ(buf.size(), response.size());
+
+    SyncResponse deserialized;
+    deserialized.deserialize(buf);
+    ASSERT_TRUE(deserialized.is_success());
+    SyncResponse::Batch copy = deserialized.get_batch().value();
+    ASSERT_EQ(copy.channels.size(), 1);
+    EXPECT_EQ(copy.channels[0]->get_uid(), channel->get_uid());
+    EXPECT_EQ(copy.channels[0]->get_name(), "general");
+    EXPECT_EQ(copy.channels[0]->get_user_uids(), channel->get_user_uids());
+    ASSERT_EQ(copy.messages.size(), 3);
+    for (size_t i = 0; i < copy.messages.size(); i++) {
+        EXPECT_EQ(copy.messages[i]->get_snowflake(), batch.messages[i]->get_snowflake());
+        EXPECT_EQ(copy.messages[i]->get_text(), "message");
+    }
+    EXPECT_EQ(copy.next_since, batch.next_since);
+    EXPECT_EQ(copy.next_channel_offset, 1);
+    EXPECT_TRUE(copy.has_more);
+}
+
+TEST(SyncResponseTest, EntrySizesBoundTheResponse) {
+    User user("syncsize", "Sync Size");
+    auto channel = std::make_shared<Channel>("sizes", std::vector<UUID>{user.get_uid()});
+    auto message = std::make_shared<Message>(user.get_uid(), channel->get_uid(), "sized");
+
+    SyncResponse::Batch batch;
+    batch.channels.push_back(channel);
+    batch.messages.push_back(message);
+    size_t bound = SyncResponse::empty_size() + SyncResponse::entry_size(channel) +
+                   SyncResponse::entry_size(message);
+    EXPECT_LE(SyncResponse(batch).size(), bound);
+}
+
+TEST(SyncResponseTest, SerializesError) {
+    SyncResponse response("Not logged in");
+
+    std::vector<uint8_t> buf;
+    response.serialize(buf);
+
+    SyncResponse deserialized;
+    deserialized.deserialize(buf);
+    ASSERT_FALSE(deserialized.is_success());
+    EXPECT_EQ(deserialized.get_error_message().value(), "Not logged in");
+}
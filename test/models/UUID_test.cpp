@@ -21,3 +21,10 @@ TEST(UUIDTest, IsHashable) {
     // Test whether UUID can be used as a key in an unordered_map
     std::unordered_map<UUID, int> uuid_map;
 }
+
+TEST(UUIDTest, HashDependsOnlyOnBytes) {
+    UUID uuid;
+    UUID copy = UUID::from_string(uuid.to_string());
+    EXPECT_EQ(std::hash<UUID>{}(uuid), std::hash<UUID>{}(copy));
+    EXPECT_NE(std::hash<UUID>{}(uuid), std::hash<UUID>{}(UUID()));
+}
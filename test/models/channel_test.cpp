@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "constants.hpp"
+#include "models/channel.hpp"
+
+TEST(ChannelTest, SerializesLargeChannels) {
+    std::vector<UUID> user_uids(300);
+    Channel channel("general", user_uids);
+    for (uint64_t snowflake = 1; snowflake <= 300; snowflake++) {
+        channel.add_message(snowflake << 22);
+    }
+
+    std::vector<uint8_t> buf;
+    channel.serialize(buf, PROTOCOL_VERSION_VARINT);
+    EXPECT_EQ(buf.size(), channel.size(PROTOCOL_VERSION_VARINT));
+
+    Channel deserialized;
+    deserialized.deserialize(buf, PROTOCOL_VERSION_VARINT);
+    EXPECT_EQ(deserialized.get_uid(), channel.get_uid());
+    EXPECT_EQ(deserialized.get_name(), "general");
+    EXPECT_EQ(deserialized.get_user_uids(), channel.get_user_uids());
+    EXPECT_EQ(deserialized.get_message_snowflakes(), channel.get_message_snowflakes());
+}
+
+TEST(ChannelTest, SerializesInOriginalVersion) {
+    Channel channel("general", {UUID(), UUID()});
+
+    std::vector<uint8_t> buf;
+    channel.serialize(buf, PROTOCOL_VERSION_CUSTOM);
+    EXPECT_EQ(buf.size(), channel.size(PROTOCOL_VERSION_CUSTOM));
+
+    Channel deserialized;
+    deserialized.deserialize(buf, PROTOCOL_VERSION_CUSTOM);
+    EXPECT_EQ(deserialized.get_name(), "general");
+    EXPECT_EQ(deserialized.get_user_uids(), channel.get_user_uids());
+}
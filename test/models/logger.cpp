@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+
+#include "models/logger.hpp"
+#include "models/uuid.hpp"
+
+namespace {
+
+/**
+ * Reads back everything written to a temporary file.
+ */
+std::string read_all(FILE* file) {
+    std::string contents;
+    std::rewind(file);
+    char buf[256];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), file)) > 0) {
+        contents.append(buf, n);
+    }
+    return contents;
+}
+
+/**
+ * Counts how often a log statement evaluated its arguments.
+ */
+int evaluations = 0;
+
+int evaluate() {
+    return ++evaluations;
+}
+
+}  // namespace
+
+TEST(LoggerTest, WritesRecordsInOrderWithTheirLevel) {
+    FILE* out = std::tmpfile();
+    {
+        Logger logger(out, 16, LogLevel::INFO);
+        UUID uuid;
+        LogLine(logger, LogLevel::INFO) << "first" << 42 << -1.5 << true;
+        LogLine(logger, LogLevel::ERROR) << "uuid" << uuid;
+        logger.flush();
+
+        std::string contents = read_all(out);
+        size_t first = contents.find(" INFO  [");
+        size_t second = contents.find(" ERROR [");
+        ASSERT_NE(first, std::string::npos);
+        ASSERT_NE(second, std::string::npos);
+        EXPECT_LT(first, second);
+        EXPECT_NE(contents.find("] first 42 -1.5 true\n"), std::string::npos);
+        EXPECT_NE(contents.find("] uuid " + uuid.to_string() + "\n"), std::string::npos);
+    }
+    std::fclose(out);
+}
+
+TEST(LoggerTest, WritesWhatIsLeftWhenDestroyed) {
+    FILE* out = std::tmpfile();
+    {
+        Logger logger(out, 1024, LogLevel::INFO);
+        for (int i = 0; i < 100; i++) {
+            LogLine(logger, LogLevel::INFO) << "record" << i;
+        }
+    }
+    std::string contents = read_all(out);
+    EXPECT_NE(contents.find("] record 0\n"), std::string::npos);
+    EXPECT_NE(contents.find("] record 99\n"), std::string::npos);
+    std::fclose(out);
+}
+
+TEST(LoggerTest, ParsesLevelNames) {
+    EXPECT_EQ(Logger::parse_level("debug"), LogLevel::DEBUG);
+    EXPECT_EQ(Logger::parse_level("WARN"), LogLevel::WARN);
+    EXPECT_EQ(Logger::parse_level("Off"), LogLevel::OFF);
+    EXPECT_FALSE(Logger::parse_level("verbose").has_value());
+    EXPECT_FALSE(Logger::parse_level("").has_value());
+}
+
+TEST(LoggerTest, SkipsTheArgumentsOfDisabledLevels) {
+    Logger& logger = Logger::get_instance();
+    LogLevel level = logger.get_level();
+    evaluations = 0;
+
+    logger.set_level(LogLevel::WARN);
+    LOG_DEBUG << "not rendered" << evaluate();
+    EXPECT_EQ(evaluations, 0);
+
+    // Compiled out, whatever the level at runtime
+    logger.set_level(LogLevel::TRACE);
+    LOG_TRACE << "not compiled" << evaluate();
+    EXPECT_EQ(evaluations, COMPILED_LOG_LEVEL <= LogLevel::TRACE ? 1 : 0);
+
+    int before = evaluations;
+    logger.set_level(LogLevel::OFF);
+    LOG_ERROR << "not rendered" << evaluate();
+    EXPECT_EQ(evaluations, before);
+
+    logger.set_level(level);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "message/header.hpp"
+#include "message/login.hpp"
+#include "message/login_response.hpp"
+#include "message/message_types.hpp"
+#include "models/message_handler.hpp"
+
+static_assert(OPERATION_OF<LoginMessage> == Operation::LOGIN);
+static_assert(OPERATION_OF<LoginResponse> == Operation::LOGIN);
+static_assert(OPERATION_OF<HelloMessage> == Operation::HELLO);
+static_assert(!OPERATION_OF<Header>.has_value());
+
+namespace {
+
+/// The last login seen by on_test_login.
+std::optional<std::string> last_username;
+
+void on_test_login(QTcpSocket* socket, LoginMessage& msg) {
+    last_username = msg.get_username();
+}
+
+std::vector<uint8_t> encode(const Payload& payload, uint8_t version) {
+    std::vector<uint8_t> buf;
+    payload.serialize(buf, version);
+    return buf;
+}
+
+}  // namespace
+
+TEST(MessageHandlerTest, DecodesAndDispatchesByOperation) {
+    for (uint8_t version : {PROTOCOL_VERSION_VARINT, PROTOCOL_VERSION_JSON}) {
+        MessageHandler handler;
+        handler.register_handler<&on_test_login>();
+        last_username.reset();
+
+        std::vector<uint8_t> payload = encode(LoginMessage("alice", "password"), version);
+        Header header(version, Operation::LOGIN, payload.size());
+
+        EXPECT_TRUE(handler.dispatch(nullptr, header, payload));
+        EXPECT_EQ(last_username, "alice");
+    }
+}
+
+TEST(MessageHandlerTest, RejectsOperationsWithoutAHandler) {
+    MessageHandler handler;
+    handler.register_handler<&on_test_login>();
+    last_username.reset();
+    std::vector<uint8_t> payload = encode(LoginMessage("alice", "password"), PROTOCOL_VERSION);
+
+    EXPECT_FALSE(handler.dispatch(nullptr, Header(PROTOCOL_VERSION, Operation::SYNC, 0), payload));
+    EXPECT_FALSE(handler.dispatch(
+        nullptr, Header(PROTOCOL_VERSION, static_cast<Operation>(NUM_OPERATIONS), 0), payload));
+    EXPECT_FALSE(last_username.has_value());
+}
+
+TEST(MessageHandlerTest, PropagatesMalformedPayloads) {
+    MessageHandler handler;
+    handler.register_handler<&on_test_login>();
+    std::vector<uint8_t> payload = encode(LoginMessage("alice", "password"), PROTOCOL_VERSION);
+    payload.resize(payload.size() / 2);
+
+    EXPECT_THROW(
+        handler.dispatch(nullptr, Header(PROTOCOL_VERSION, Operation::LOGIN, payload.size()),
+                         payload),
+        std::out_of_range);
+}
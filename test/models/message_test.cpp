@@ -49,3 +49,34 @@ TEST(MessageTest, AddReadBy) {
     message.set_read_by(user_id);
     EXPECT_EQ(message.get_read_by().size(), 2);
 }
+
+TEST(MessageTest, SerializesLongMessages) {
+    Message message(UUID(), UUID(), std::string(1000, 'x'));
+    for (int i = 0; i < 300; i++) {
+        UUID reader_id;
+        message.set_read_by(reader_id);
+    }
+
+    std::vector<uint8_t> buf;
+    message.serialize(buf, PROTOCOL_VERSION_VARINT);
+    EXPECT_EQ(buf.size(), message.size(PROTOCOL_VERSION_VARINT));
+
+    Message deserialized;
+    deserialized.deserialize(buf, PROTOCOL_VERSION_VARINT);
+    EXPECT_EQ(deserialized.get_snowflake(), message.get_snowflake());
+    EXPECT_EQ(deserialized.get_text(), message.get_text());
+    EXPECT_EQ(deserialized.get_read_by(), message.get_read_by());
+}
+
+TEST(MessageTest, SerializesInOriginalVersion) {
+    Message message(UUID(), UUID(), "Hello world");
+
+    std::vector<uint8_t> buf;
+    message.serialize(buf, PROTOCOL_VERSION_CUSTOM);
+    EXPECT_EQ(buf.size(), message.size(PROTOCOL_VERSION_CUSTOM));
+
+    Message deserialized;
+    deserialized.deserialize(buf, PROTOCOL_VERSION_CUSTOM);
+    EXPECT_EQ(deserialized.get_snowflake(), message.get_snowflake());
+    EXPECT_EQ(deserialized.get_text(), message.get_text());
+}
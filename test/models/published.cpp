@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "models/message.hpp"
+#include "models/published.hpp"
+
+namespace {
+
+/**
+ * Counts its live instances, to tell when retired versions are freed.
+ */
+struct Tracked {
+    static inline std::atomic<int> live{0};
+    int value = 0;
+
+    Tracked() { live++; }
+    Tracked(const Tracked& other) : value(other.value) { live++; }
+    ~Tracked() { live--; }
+};
+
+}  // namespace
+
+TEST(PublishedTest, ReadsTheLatestVersion) {
+    Published<std::vector<int>> published({1, 2});
+    published.update([](std::vector<int>& value) { value.push_back(3); });
+    EXPECT_EQ(published.read([](const std::vector<int>& value) { return value; }),
+              std::vector<int>({1, 2, 3}));
+}
+
+TEST(PublishedTest, KeepsRetiredVersionsUntilReadersLeave) {
+    {
+        Published<Tracked> published;
+        std::optional<Epoch::Guard> guard;
+        guard.emplace();
+        published.update([](Tracked& value) { value.value = 1; });
+        published.update([](Tracked& value) { value.value = 2; });
+        // Both replaced versions may still be in use by the reader
+        EXPECT_EQ(Tracked::live, 3);
+
+        guard.reset();
+        published.update([](Tracked& value) { value.value = 3; });
+        EXPECT_EQ(Tracked::live, 1);
+    }
+    EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(PublishedTest, ReadersNeverSeeHalfAppliedEdits) {
+    Message message(UUID(), UUID(), "aaaa");
+    std::atomic<bool> done = false;
+    std::atomic<size_t> torn = 0;
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&message, &done, &torn] {
+            while (!done) {
+                std::string text = message.get_text();
+                if (text.find_first_not_of(text[0]) != std::string::npos) {
+                    torn++;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 2000; i++) {
+        std::string text(64 + i % 64, static_cast<char>('a' + i % 26));
+        message.set_text(text);
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(message.get_text(), std::string(64 + 1999 % 64, 'a' + 1999 % 26));
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "models/uuid_map.hpp"
+
+TEST(UUIDMapTest, InsertsAndFinds) {
+    UUIDMap<std::string> map;
+    UUID key;
+
+    EXPECT_EQ(map.find(key), nullptr);
+    EXPECT_TRUE(map.insert(key, "value"));
+    EXPECT_FALSE(map.insert(key, "other"));
+
+    ASSERT_NE(map.find(key), nullptr);
+    EXPECT_EQ(*map.find(key), "value");
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_FALSE(map.contains(UUID()));
+}
+
+TEST(UUIDMapTest, ErasesAndKeepsOtherKeysReachable) {
+    UUIDMap<int> map;
+    std::vector<UUID> keys(1000);
+    for (size_t i = 0; i < keys.size(); i++) {
+        map.insert(keys[i], i);
+    }
+
+    for (size_t i = 0; i < keys.size(); i += 2) {
+        EXPECT_TRUE(map.erase(keys[i]));
+    }
+    EXPECT_FALSE(map.erase(keys[0]));
+    EXPECT_EQ(map.size(), keys.size() / 2);
+
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (i % 2 == 0) {
+            EXPECT_FALSE(map.contains(keys[i]));
+        } else {
+            ASSERT_NE(map.find(keys[i]), nullptr);
+            EXPECT_EQ(*map.find(keys[i]), i);
+        }
+    }
+}
+
+TEST(UUIDMapTest, IteratesOverEveryEntry) {
+    UUIDMap<int> map;
+    std::unordered_map<UUID, int> expected;
+    for (int i = 0; i < 100; i++) {
+        UUID key;
+        map.insert(key, i);
+        expected[key] = i;
+    }
+
+    size_t visited = 0;
+    for (const auto& [key, value] : map) {
+        EXPECT_EQ(expected.at(key), value);
+        visited++;
+    }
+    EXPECT_EQ(visited, expected.size());
+}
+
+TEST(UUIDMapTest, MatchesUnorderedMapUnderMixedOperations) {
+    UUIDMap<int> map;
+    std::unordered_map<UUID, int> reference;
+    std::vector<UUID> keys(64);
+
+    for (int step = 0; step < 5000; step++) {
+        const UUID& key = keys[(step * 7919) % keys.size()];
+        if (step % 3 == 0) {
+            EXPECT_EQ(map.erase(key), reference.erase(key) == 1);
+        } else {
+            EXPECT_EQ(map.insert(key, step), reference.insert({key, step}).second);
+        }
+    }
+
+    EXPECT_EQ(map.size(), reference.size());
+    for (const auto& [key, value] : reference) {
+        ASSERT_NE(map.find(key), nullptr);
+        EXPECT_EQ(*map.find(key), value);
+    }
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.begin(), map.end());
+}
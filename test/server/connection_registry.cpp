@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "constants.hpp"
+#include "message/header.hpp"
+#include "models/user.hpp"
+#include "server/model/client_handler.hpp"
+#include "server/model/connection_registry.hpp"
+
+TEST(ConnectionRegistryTest, RegistersConnections) {
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+    size_t before = registry.get_num_connections();
+    {
+        ClientHandler handler(-1);
+        EXPECT_EQ(registry.get_num_connections(), before + 1);
+        EXPECT_FALSE(registry.get_user_for_connection(handler.get_connection_id()).has_value());
+    }
+    EXPECT_EQ(registry.get_num_connections(), before);
+}
+
+TEST(ConnectionRegistryTest, AssignsDistinctIds) {
+    ClientHandler handler1(-1);
+    ClientHandler handler2(-1);
+    EXPECT_NE(handler1.get_connection_id(), handler2.get_connection_id());
+}
+
+TEST(ConnectionRegistryTest, BindsUserToConnection) {
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+    ClientHandler handler(-1);
+    User::SharedPtr user = std::make_shared<User>("registryuser", "Registry");
+    handler.set_authenticated_user(user);
+
+    std::vector<ConnectionRegistry::ConnectionId> ids =
+        registry.get_connections_for_user(user->get_uid());
+    ASSERT_EQ(ids.size(), 1);
+    EXPECT_EQ(ids[0], handler.get_connection_id());
+    EXPECT_EQ(registry.get_user_for_connection(handler.get_connection_id()), user->get_uid());
+}
+
+TEST(ConnectionRegistryTest, TracksMultipleSessionsPerUser) {
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+    User::SharedPtr user = std::make_shared<User>("registryuser", "Registry");
+    ClientHandler handler1(-1);
+    handler1.set_authenticated_user(user);
+    {
+        ClientHandler handler2(-1);
+        handler2.set_authenticated_user(user);
+        EXPECT_EQ(registry.get_connections_for_user(user->get_uid()).size(), 2);
+        EXPECT_EQ(registry.send_to_user(user->get_uid(), {1, 2, 3}), 2);
+    }
+    EXPECT_EQ(registry.get_connections_for_user(user->get_uid()).size(), 1);
+}
+
+TEST(ConnectionRegistryTest, RebindingMovesConnectionToNewUser) {
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+    User::SharedPtr user1 = std::make_shared<User>("registryuser1", "Registry");
+    User::SharedPtr user2 = std::make_shared<User>("registryuser2", "Registry");
+    ClientHandler handler(-1);
+    handler.set_authenticated_user(user1);
+    handler.set_authenticated_user(user2);
+
+    EXPECT_TRUE(registry.get_connections_for_user(user1->get_uid()).empty());
+    EXPECT_EQ(registry.get_connections_for_user(user2->get_uid()).size(), 1);
+}
+
+TEST(ConnectionRegistryTest, SendToUnknownTargets) {
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+    EXPECT_EQ(registry.send_to_user(UUID(), {1, 2, 3}), 0);
+
+    ConnectionRegistry::ConnectionId connection_id;
+    {
+        ClientHandler handler(-1);
+        connection_id = handler.get_connection_id();
+        EXPECT_TRUE(registry.send(connection_id, {1, 2, 3}));
+    }
+    EXPECT_FALSE(registry.send(connection_id, {1, 2, 3}));
+}
+
+TEST(ConnectionRegistryTest, EncodesNothingForOfflineUsers) {
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+    size_t encoded = 0;
+    size_t sent = registry.send_to_user(
+        UUID(), [&encoded](uint8_t version, std::vector<uint8_t>& buf) { encoded++; });
+    EXPECT_EQ(sent, 0);
+    EXPECT_EQ(encoded, 0);
+}
+
+TEST(ConnectionRegistryTest, EncodesOncePerCodec) {
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+    User::SharedPtr user = std::make_shared<User>("registryuser", "Registry");
+    ClientHandler binary1(-1);
+    ClientHandler binary2(-1);
+    ClientHandler json(-1);
+    for (ClientHandler* handler : {&binary1, &binary2, &json}) {
+        handler->set_authenticated_user(user);
+    }
+    registry.set_version(json.get_connection_id(), PROTOCOL_VERSION_JSON);
+
+    std::vector<uint8_t> versions;
+    size_t sent = registry.send_to_user(
+        user->get_uid(), [&versions](uint8_t version, std::vector<uint8_t>& buf) {
+            versions.push_back(version);
+            buf.push_back(version);
+        });
+    EXPECT_EQ(sent, 3);
+    std::sort(versions.begin(), versions.end());
+    EXPECT_EQ(versions, std::vector<uint8_t>({PROTOCOL_VERSION_JSON, PROTOCOL_VERSION_VARINT}));
+}
+
+TEST(ConnectionRegistryTest, SharesOneFrameAcrossUsers) {
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+    std::vector<User::SharedPtr> users;
+    std::vector<std::unique_ptr<ClientHandler>> handlers;
+    std::vector<UUID> user_uids;
+    for (int i = 0; i < 4; i++) {
+        users.push_back(std::make_shared<User>("fanout" + std::to_string(i), "Fan-out"));
+        user_uids.push_back(users.back()->get_uid());
+        handlers.push_back(std::make_unique<ClientHandler>(-1));
+        handlers.back()->set_authenticated_user(users.back());
+    }
+    registry.set_compression(handlers[3]->get_connection_id(), true);
+    // Offline users are skipped
+    user_uids.push_back(UUID());
+
+    size_t encoded = 0;
+    size_t sent = registry.send_to_users(
+        user_uids, [&encoded](uint8_t version, std::vector<uint8_t>& buf) {
+            encoded++;
+            Header(version, Operation::SEND_MESSAGE, 0).serialize(buf);
+        });
+    EXPECT_EQ(sent, 4);
+    EXPECT_EQ(encoded, 2);
+}
+
+TEST(ConnectionRegistryTest, EncodesWithoutHoldingTheRegistry) {
+    ConnectionRegistry& registry = ConnectionRegistry::get_instance();
+    User::SharedPtr user = std::make_shared<User>("registryuser", "Registry");
+    ClientHandler handler(-1);
+    handler.set_authenticated_user(user);
+
+    // Would deadlock if the registry were still locked while encoding
+    size_t num_connections = 0;
+    size_t sent = registry.send_to_user(
+        user->get_uid(), [&](uint8_t version, std::vector<uint8_t>& buf) {
+            num_connections = registry.get_num_connections();
+            Header(version, Operation::SEND_MESSAGE, 0).serialize(buf);
+        });
+    EXPECT_EQ(sent, 1);
+    EXPECT_GE(num_connections, 1);
+}
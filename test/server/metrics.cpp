@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+
+#include "message/header.hpp"
+#include "server/model/metrics.hpp"
+#include "server/model/metrics_server.hpp"
+
+TEST(HistogramTest, CountsSmallValuesExactly) {
+    for (uint64_t value = 0; value < Histogram::SUB_BUCKETS; value++) {
+        EXPECT_EQ(Histogram::bucket_of(value), value);
+        EXPECT_EQ(Histogram::last_value_of(value), value);
+    }
+}
+
+TEST(HistogramTest, BucketsAreContiguousAndWithinAnEighth) {
+    uint64_t first = 0;
+    for (size_t bucket = 0; bucket < Histogram::NUM_BUCKETS; bucket++) {
+        uint64_t last = Histogram::last_value_of(bucket);
+        ASSERT_EQ(Histogram::bucket_of(first), bucket);
+        ASSERT_EQ(Histogram::bucket_of(last), bucket);
+        ASSERT_LE(last - first, first / Histogram::SUB_BUCKETS);
+        if (bucket + 1 < Histogram::NUM_BUCKETS) {
+            first = last + 1;
+        }
+    }
+    EXPECT_EQ(Histogram::last_value_of(Histogram::NUM_BUCKETS - 1), UINT64_MAX);
+}
+
+TEST(HistogramTest, ComputesQuantilesAndCumulativeCounts) {
+    Histogram histogram;
+    EXPECT_EQ(histogram.value_at_quantile(0.5), 0);
+    for (uint64_t value = 1; value <= 1000; value++) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(histogram.get_count(), 1000);
+    EXPECT_EQ(histogram.get_sum(), 500500);
+
+    uint64_t median = histogram.value_at_quantile(0.5);
+    EXPECT_GE(median, 500);
+    EXPECT_LE(median, 500 + 500 / Histogram::SUB_BUCKETS);
+    uint64_t p99 = histogram.value_at_quantile(0.99);
+    EXPECT_GE(p99, 990);
+    EXPECT_LE(p99, 990 + 990 / Histogram::SUB_BUCKETS);
+    EXPECT_EQ(histogram.value_at_quantile(1.0),
+              Histogram::last_value_of(Histogram::bucket_of(1000)));
+
+    EXPECT_EQ(histogram.count_at_most(0), 0);
+    EXPECT_EQ(histogram.count_at_most(7), 7);
+    EXPECT_EQ(histogram.count_at_most(511), 511);
+    EXPECT_EQ(histogram.count_at_most(UINT64_MAX), 1000);
+}
+
+TEST(MetricsTest, RecordsByOperation) {
+    Metrics metrics;
+    metrics.record_request(LOGIN, 40);
+    metrics.record_request(LOGIN, 40);
+    metrics.record_latency(LOGIN, std::chrono::microseconds(50));
+    metrics.record_request(static_cast<Operation>(200), 6);
+
+    EXPECT_EQ(metrics.get_num_requests(LOGIN), 2);
+    EXPECT_EQ(metrics.get_num_requests(SYNC), 0);
+    EXPECT_EQ(metrics.get_num_requests(static_cast<Operation>(201)), 1);
+    EXPECT_EQ(metrics.get_latency(LOGIN).get_count(), 1);
+    EXPECT_EQ(metrics.get_latency(SYNC).get_count(), 0);
+}
+
+TEST(MetricsTest, RendersPrometheusText) {
+    Metrics metrics;
+    metrics.record_request(SEND_MESSAGE, 100);
+    metrics.record_response(SEND_MESSAGE, 120);
+    metrics.record_response(SEND_MESSAGE, 120);
+    metrics.record_latency(SEND_MESSAGE, std::chrono::nanoseconds(1500));
+    metrics.record_fanout(3);
+    metrics.add_gauge("sockout_test_gauge", "A gauge.", []() { return 42; });
+
+    std::string text = metrics.render();
+    auto contains = [&text](const std::string& line) {
+        return text.find(line + "\n") != std::string::npos;
+    };
+    EXPECT_TRUE(contains("# TYPE sockout_requests_total counter"));
+    EXPECT_TRUE(contains("sockout_requests_total{operation=\"send_message\"} 1"));
+    EXPECT_TRUE(contains("sockout_requests_total{operation=\"login\"} 0"));
+    EXPECT_TRUE(contains("sockout_received_bytes_total{operation=\"send_message\"} 100"));
+    EXPECT_TRUE(contains("sockout_frames_sent_total{operation=\"send_message\"} 2"));
+    EXPECT_TRUE(contains("sockout_sent_bytes_total{operation=\"send_message\"} 240"));
+
+    EXPECT_TRUE(contains("# TYPE sockout_request_duration_seconds histogram"));
+    EXPECT_TRUE(contains(
+        "sockout_request_duration_seconds_bucket{operation=\"send_message\",le=\"1.023e-06\"} 0"));
+    EXPECT_TRUE(contains(
+        "sockout_request_duration_seconds_bucket{operation=\"send_message\",le=\"2.047e-06\"} 1"));
+    EXPECT_TRUE(contains(
+        "sockout_request_duration_seconds_bucket{operation=\"send_message\",le=\"+Inf\"} 1"));
+    EXPECT_TRUE(
+        contains("sockout_request_duration_seconds_sum{operation=\"send_message\"} 1.5e-06"));
+    EXPECT_TRUE(contains("sockout_request_duration_seconds_count{operation=\"send_message\"} 1"));
+
+    EXPECT_TRUE(contains("sockout_message_fanout_sessions_bucket{le=\"1\"} 0"));
+    EXPECT_TRUE(contains("sockout_message_fanout_sessions_bucket{le=\"3\"} 1"));
+    EXPECT_TRUE(contains("sockout_message_fanout_sessions_count 1"));
+
+    EXPECT_TRUE(contains("# TYPE sockout_test_gauge gauge"));
+    EXPECT_TRUE(contains("sockout_test_gauge 42"));
+}
+
+TEST(MetricsServerTest, AnswersScrapesOfMetricsOnly) {
+    std::string ok = MetricsServer::respond("GET /metrics HTTP/1.1\r\nHost: localhost");
+    EXPECT_EQ(ok.rfind("HTTP/1.1 200 OK\r\n", 0), 0);
+    EXPECT_NE(ok.find("Content-Type: text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(ok.find("\r\n\r\n# HELP "), std::string::npos);
+
+    EXPECT_EQ(MetricsServer::respond("GET /metrics?x=1 HTTP/1.1").rfind("HTTP/1.1 200", 0), 0);
+    EXPECT_EQ(MetricsServer::respond("GET / HTTP/1.1").rfind("HTTP/1.1 404", 0), 0);
+    EXPECT_EQ(MetricsServer::respond("POST /metrics HTTP/1.1").rfind("HTTP/1.1 405", 0), 0);
+    EXPECT_EQ(MetricsServer::respond("garbage").rfind("HTTP/1.1 400", 0), 0);
+}